@@ -212,8 +212,34 @@ fn make_library(outdir: &str, cef_dir: &str) -> Result<()> {
         .file("./cxx/runtime.cpp")
         .file("./cxx/request.cpp")
         .file("./cxx/subprocess.cpp")
+        .file("./cxx/plugin.cpp")
+        .file("./cxx/ring.cpp")
+        .file("./cxx/bus.cpp")
+        .file("./cxx/proxy.cpp")
+        .file("./cxx/blob.cpp")
+        .file("./cxx/scheduler.cpp")
+        .file("./cxx/watcher.cpp")
         .file("./cxx/webview.cpp")
-        .file("./cxx/cookie.cpp");
+        .file("./cxx/cookie.cpp")
+        .file("./cxx/metrics.cpp")
+        .file("./cxx/watchdog.cpp")
+        .file("./cxx/trace.cpp")
+        .file("./cxx/accounting.cpp")
+        .file("./cxx/framebuffer.cpp")
+        .file("./cxx/motion.cpp")
+        .file("./cxx/alpha.cpp")
+        .file("./cxx/transform.cpp")
+        .file("./cxx/fanout.cpp")
+        .file("./cxx/overlay.cpp")
+        .file("./cxx/encoder.cpp");
+
+    if env::var("CARGO_FEATURE_TRACING").is_ok() {
+        compiler.define("WEW_TRACING", None);
+    }
+
+    if env::var("CARGO_FEATURE_VPX").is_ok() {
+        compiler.define("WEW_VPX", None);
+    }
 
     #[cfg(target_os = "windows")]
     compiler
@@ -290,6 +316,8 @@ fn main() -> Result<()> {
     {
         println!("cargo:rustc-link-lib=cef");
         println!("cargo:rustc-link-lib=cef_dll_wrapper");
+        println!("cargo:rustc-link-lib=dl");
+        println!("cargo:rustc-link-lib=rt");
         println!(
             "cargo:rustc-link-search=all={}",
             join(cef_dir, "./libcef_dll_wrapper")
@@ -318,5 +346,9 @@ fn main() -> Result<()> {
         );
     }
 
+    if env::var("CARGO_FEATURE_VPX").is_ok() {
+        println!("cargo:rustc-link-lib=vpx");
+    }
+
     Ok(())
 }
@@ -0,0 +1,108 @@
+//
+//  accounting.cpp
+//  webview
+//
+//  Bytes held by the library on behalf of a webview, per subsystem, with optional budgets
+//
+
+#include "accounting.h"
+
+// When the webview as a whole is over budget the cheapest to rebuild state goes first.
+static const MemorySubsystem EVICTION_ORDER[] = {
+    WEW_MEMORY_FRAME_BUFFERS,
+    WEW_MEMORY_MESSAGE_QUEUES,
+};
+
+bool IMemoryAccount::Charge(MemorySubsystem subsystem, uint64_t bytes)
+{
+    assert(subsystem < WEW_MEMORY_TOTAL);
+
+    _bytes[subsystem].fetch_add(bytes, std::memory_order_relaxed);
+    uint64_t total = _bytes[WEW_MEMORY_TOTAL].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    uint64_t peak = _peak.load(std::memory_order_relaxed);
+    while (total > peak && !_peak.compare_exchange_weak(peak, total, std::memory_order_relaxed))
+    {
+    }
+
+    if (!IsOverBudget(subsystem) && !IsOverBudget(WEW_MEMORY_TOTAL))
+    {
+        return true;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    if (IsOverBudget(subsystem))
+    {
+        Evict(subsystem, GetBytes(subsystem) - _budgets[subsystem].load(std::memory_order_relaxed));
+    }
+
+    for (auto it : EVICTION_ORDER)
+    {
+        if (!IsOverBudget(WEW_MEMORY_TOTAL))
+        {
+            break;
+        }
+
+        Evict(it, GetBytes(WEW_MEMORY_TOTAL) - _budgets[WEW_MEMORY_TOTAL].load(std::memory_order_relaxed));
+    }
+
+    return !IsOverBudget(subsystem) && !IsOverBudget(WEW_MEMORY_TOTAL);
+}
+
+void IMemoryAccount::Release(MemorySubsystem subsystem, uint64_t bytes)
+{
+    assert(subsystem < WEW_MEMORY_TOTAL);
+
+    _bytes[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+    _bytes[WEW_MEMORY_TOTAL].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void IMemoryAccount::SetBudget(MemorySubsystem subsystem, uint64_t bytes)
+{
+    assert(subsystem <= WEW_MEMORY_TOTAL);
+
+    _budgets[subsystem].store(bytes, std::memory_order_relaxed);
+}
+
+void IMemoryAccount::SetEvictor(MemorySubsystem subsystem, Evictor evictor)
+{
+    assert(subsystem < WEW_MEMORY_TOTAL);
+
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+    _evictors[subsystem] = evictor;
+}
+
+uint64_t IMemoryAccount::GetBytes(MemorySubsystem subsystem)
+{
+    return _bytes[subsystem].load(std::memory_order_relaxed);
+}
+
+void IMemoryAccount::GetUsage(MemoryUsage *usage)
+{
+    for (size_t i = 0; i < WEW_MEMORY_TOTAL; i++)
+    {
+        usage->bytes[i] = _bytes[i].load(std::memory_order_relaxed);
+    }
+
+    usage->total = GetBytes(WEW_MEMORY_TOTAL);
+    usage->peak = _peak.load(std::memory_order_relaxed);
+    usage->evicted = _evicted.load(std::memory_order_relaxed);
+}
+
+bool IMemoryAccount::IsOverBudget(MemorySubsystem subsystem)
+{
+    uint64_t budget = _budgets[subsystem].load(std::memory_order_relaxed);
+
+    return budget > 0 && GetBytes(subsystem) > budget;
+}
+
+void IMemoryAccount::Evict(MemorySubsystem subsystem, uint64_t bytes)
+{
+    if (_evictors[subsystem] == nullptr)
+    {
+        return;
+    }
+
+    _evicted.fetch_add(_evictors[subsystem](bytes), std::memory_order_relaxed);
+}
@@ -0,0 +1,64 @@
+//
+//  accounting.h
+//  webview
+//
+//  Bytes held by the library on behalf of a webview, per subsystem, with optional budgets
+//
+
+#ifndef accounting_h
+#define accounting_h
+#pragma once
+
+#include <assert.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "wew.h"
+
+class IMemoryAccount
+{
+  public:
+    ///
+    /// Asked to free at least the given number of bytes, returns the bytes actually freed. Evictors must release
+    /// what they free through Release and must not charge the account themselves.
+    ///
+    using Evictor = std::function<uint64_t(uint64_t bytes)>;
+
+    ///
+    /// Accounts bytes now held by a subsystem and evicts if that exceeds a budget.
+    ///
+    /// Returns false if the subsystem or the webview is still over budget after eviction, the caller decides
+    /// whether to keep the allocation.
+    ///
+    bool Charge(MemorySubsystem subsystem, uint64_t bytes);
+
+    void Release(MemorySubsystem subsystem, uint64_t bytes);
+
+    ///
+    /// Sets the budget of a subsystem, or of the whole webview with WEW_MEMORY_TOTAL. Zero means unlimited.
+    ///
+    void SetBudget(MemorySubsystem subsystem, uint64_t bytes);
+
+    void SetEvictor(MemorySubsystem subsystem, Evictor evictor);
+
+    uint64_t GetBytes(MemorySubsystem subsystem);
+
+    void GetUsage(MemoryUsage *usage);
+
+  private:
+    std::atomic<uint64_t> _bytes[WEW_MEMORY_TOTAL + 1] = {};
+    std::atomic<uint64_t> _budgets[WEW_MEMORY_TOTAL + 1] = {};
+    std::atomic<uint64_t> _peak{0};
+    std::atomic<uint64_t> _evicted{0};
+
+    // Evictors run one at a time, they may touch the subsystem state the charge came from.
+    std::recursive_mutex _mutex;
+    Evictor _evictors[WEW_MEMORY_TOTAL];
+
+    bool IsOverBudget(MemorySubsystem subsystem);
+    void Evict(MemorySubsystem subsystem, uint64_t bytes);
+};
+
+#endif /* accounting_h */
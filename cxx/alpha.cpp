@@ -0,0 +1,103 @@
+//
+//  alpha.cpp
+//  webview
+//
+//  Per tile alpha classification of windowless view frames
+//
+
+#include "alpha.h"
+
+#include <algorithm>
+
+static const uint32_t ALPHA_MASK = 0xff000000;
+
+// BGRA pixels read as little endian words keep alpha in the top byte. The rows are reduced with a plain AND and
+// OR, which the compiler vectorizes, and the tile stops early once it is known to be mixed.
+static uint8_t Classify(const uint32_t *pixels, int width, int x, int y, int right, int bottom)
+{
+    uint32_t all = ALPHA_MASK;
+    uint32_t any = 0;
+    for (int i = y; i < bottom; i++)
+    {
+        const uint32_t *row = pixels + static_cast<size_t>(i) * width;
+        for (int j = x; j < right; j++)
+        {
+            all &= row[j];
+            any |= row[j];
+        }
+
+        if ((any & ALPHA_MASK) != 0 && (all & ALPHA_MASK) != ALPHA_MASK)
+        {
+            return WEW_TILE_MIXED;
+        }
+    }
+
+    if ((any & ALPHA_MASK) == 0)
+    {
+        return WEW_TILE_TRANSPARENT;
+    }
+
+    return (all & ALPHA_MASK) == ALPHA_MASK ? WEW_TILE_OPAQUE : WEW_TILE_MIXED;
+}
+
+IAlphaTiles::IAlphaTiles(uint32_t size) : _size(size)
+{
+}
+
+void IAlphaTiles::Update(const CefRenderHandler::RectList &dirty_rects, const void *buffer, int width, int height)
+{
+    auto pixels = static_cast<const uint32_t *>(buffer);
+    int size = static_cast<int>(_size);
+
+    uint32_t columns = (width + _size - 1) / _size;
+    uint32_t rows = (height + _size - 1) / _size;
+
+    CefRenderHandler::RectList everything = {CefRect(0, 0, width, height)};
+    const CefRenderHandler::RectList *rects = &dirty_rects;
+    if (columns != _columns || rows != _rows)
+    {
+        _columns = columns;
+        _rows = rows;
+        _tiles.assign(columns * rows, WEW_TILE_MIXED);
+        rects = &everything;
+    }
+
+    for (auto &rect : *rects)
+    {
+        int first_column = std::max(rect.x, 0) / size;
+        int first_row = std::max(rect.y, 0) / size;
+        int last_column = std::min((rect.x + rect.width - 1) / size, static_cast<int>(columns) - 1);
+        int last_row = std::min((rect.y + rect.height - 1) / size, static_cast<int>(rows) - 1);
+
+        for (int row = first_row; row <= last_row; row++)
+        {
+            for (int column = first_column; column <= last_column; column++)
+            {
+                int x = column * size;
+                int y = row * size;
+                _tiles[row * columns + column] =
+                    Classify(pixels, width, x, y, std::min(x + size, width), std::min(y + size, height));
+            }
+        }
+    }
+}
+
+const uint8_t *IAlphaTiles::GetTiles() const
+{
+    return _tiles.data();
+}
+
+uint32_t IAlphaTiles::GetSize() const
+{
+    return _size;
+}
+
+uint32_t IAlphaTiles::GetColumns() const
+{
+    return _columns;
+}
+
+uint32_t IAlphaTiles::GetRows() const
+{
+    return _rows;
+}
@@ -0,0 +1,44 @@
+//
+//  alpha.h
+//  webview
+//
+//  Per tile alpha classification of windowless view frames
+//
+
+#ifndef alpha_h
+#define alpha_h
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "include/cef_client.h"
+
+#include "wew.h"
+
+///
+/// Classifies the view in square tiles as fully transparent, fully opaque or mixed, so a compositor can skip or
+/// plainly copy most of a transparent overlay instead of blending all of it.
+///
+/// The map is kept between frames, a paint only reclassifies the tiles its dirty rects touch.
+///
+class IAlphaTiles
+{
+  public:
+    IAlphaTiles(uint32_t size);
+
+    void Update(const CefRenderHandler::RectList &dirty_rects, const void *buffer, int width, int height);
+
+    const uint8_t *GetTiles() const;
+    uint32_t GetSize() const;
+    uint32_t GetColumns() const;
+    uint32_t GetRows() const;
+
+  private:
+    uint32_t _size;
+    uint32_t _columns = 0;
+    uint32_t _rows = 0;
+    std::vector<uint8_t> _tiles;
+};
+
+#endif /* alpha_h */
@@ -0,0 +1,408 @@
+//
+//  main.cpp
+//  webview
+//
+//  Per-call cost of the hot C ABI entry points, reported as ns per call, heap allocations per call and calls per
+//  second. Built against the CEF mock by default, the cases that need a synthetic paint or request are only
+//  available there.
+//
+//  usage: wew_benches [iterations]
+//
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef WEW_MOCK_CEF
+#include "cef_mock.h"
+#endif
+
+#include "wew.h"
+
+/* Allocation counting */
+
+static thread_local bool COUNT_ALLOCATIONS = false;
+static thread_local uint64_t ALLOCATIONS = 0;
+
+void *operator new(size_t size)
+{
+    if (COUNT_ALLOCATIONS)
+    {
+        ALLOCATIONS += 1;
+    }
+
+    if (void *ptr = malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+/* Harness */
+
+struct BenchContext
+{
+    bool initialized = false;
+    bool loaded = false;
+    uint64_t frames = 0;
+    uint64_t messages = 0;
+};
+
+struct Case
+{
+    const char *name;
+
+    ///
+    /// Bytes moved by a single call, used for the throughput column when non zero.
+    ///
+    size_t bytes;
+    std::function<void()> call;
+
+    ///
+    /// Untimed work run between batches, drains whatever the calls queued up.
+    ///
+    std::function<void()> drain;
+};
+
+static const size_t BATCH_SIZE = 1024;
+
+static BenchContext CONTEXT;
+
+static void pump_until(const std::function<bool()> &done)
+{
+#ifdef WEW_MOCK_CEF
+    cef_mock::Settle();
+    assert(done());
+#else
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+    {
+        poll_message_loop();
+    }
+
+    assert(done());
+#endif
+}
+
+static void pump()
+{
+#ifdef WEW_MOCK_CEF
+    cef_mock::Settle();
+#else
+    poll_message_loop();
+#endif
+}
+
+static void run_case(const Case &bench, size_t iterations)
+{
+    size_t batches = (iterations + BATCH_SIZE - 1) / BATCH_SIZE;
+
+    // Warm up caches and any lazily created state before measuring.
+    for (size_t i = 0; i < BATCH_SIZE; i++)
+    {
+        bench.call();
+    }
+
+    bench.drain();
+
+    std::chrono::nanoseconds elapsed(0);
+    uint64_t allocations = 0;
+    for (size_t batch = 0; batch < batches; batch++)
+    {
+        ALLOCATIONS = 0;
+        COUNT_ALLOCATIONS = true;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < BATCH_SIZE; i++)
+        {
+            bench.call();
+        }
+
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        COUNT_ALLOCATIONS = false;
+        allocations += ALLOCATIONS;
+
+        bench.drain();
+    }
+
+    double calls = static_cast<double>(batches * BATCH_SIZE);
+    double ns_per_call = static_cast<double>(elapsed.count()) / calls;
+    double calls_per_sec = 1e9 / ns_per_call;
+
+    printf("%-36s %12.1f %14.2f %16.0f", bench.name, ns_per_call, allocations / calls, calls_per_sec);
+    if (bench.bytes > 0)
+    {
+        printf(" %12.1f", calls_per_sec * bench.bytes / (1024 * 1024));
+    }
+
+    printf("\n");
+}
+
+/* Host callbacks */
+
+static void on_context_initialized(void *context)
+{
+    static_cast<BenchContext *>(context)->initialized = true;
+}
+
+static void on_schedule_message_pump_work(int64_t delay_ms, void *context)
+{
+}
+
+static void on_state_change(WebViewState state, void *context)
+{
+    if (state == WEW_LOADED)
+    {
+        static_cast<BenchContext *>(context)->loaded = true;
+    }
+}
+
+static void on_frame(const Frame *frame, void *context)
+{
+    static_cast<BenchContext *>(context)->frames += 1;
+}
+
+static void on_message(const char *message, void *context)
+{
+    static_cast<BenchContext *>(context)->messages += 1;
+}
+
+static void on_cursor(CursorType type, void *context)
+{
+}
+
+static void on_ime_rect(Rect rect, void *context)
+{
+}
+
+static void on_title_change(const char *title, void *context)
+{
+}
+
+static void on_fullscreen_change(bool fullscreen, void *context)
+{
+}
+
+static bool resource_open(void *context)
+{
+    return true;
+}
+
+static bool resource_skip(size_t size, int *cursor, void *context)
+{
+    return false;
+}
+
+static bool resource_read(uint8_t *buffer, size_t size, int *cursor, void *context)
+{
+    return false;
+}
+
+static void resource_get_response(Response *response, void *context)
+{
+}
+
+static void resource_cancel(void *context)
+{
+}
+
+static void resource_destroy(void *context)
+{
+}
+
+static RequestHandler *request_handler(Request *request, void *context)
+{
+    static RequestHandler handler = {
+        .open = resource_open,
+        .skip = resource_skip,
+        .read = resource_read,
+        .get_response = resource_get_response,
+        .cancel = resource_cancel,
+        .destroy = resource_destroy,
+        .context = nullptr,
+    };
+
+    return &handler;
+}
+
+static void destroy_request_handler(RequestHandler *handler)
+{
+}
+
+static const RequestHandlerFactory REQUEST_HANDLER_FACTORY = {
+    .request = request_handler,
+    .destroy_request_handler = destroy_request_handler,
+    .context = nullptr,
+};
+
+static void noop_task(void *context)
+{
+}
+
+int main(int argc, char **argv)
+{
+    int exit_code = execute_subprocess(argc, const_cast<const char **>(argv));
+    if (exit_code >= 0)
+    {
+        return exit_code;
+    }
+
+    size_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+
+    RuntimeSettings runtime_settings{};
+    runtime_settings.windowless_rendering_enabled = true;
+
+    RuntimeHandler runtime_handler{
+        .on_context_initialized = on_context_initialized,
+        .on_schedule_message_pump_work = on_schedule_message_pump_work,
+        .context = &CONTEXT,
+    };
+
+    void *runtime = create_runtime(&runtime_settings, runtime_handler);
+    if (!execute_runtime(runtime, argc, const_cast<const char **>(argv)))
+    {
+        fprintf(stderr, "failed to initialize the runtime\n");
+        return 1;
+    }
+
+    pump_until([]() { return CONTEXT.initialized; });
+
+    WebViewSettings settings{};
+    settings.width = 1920;
+    settings.height = 1080;
+    settings.device_scale_factor = 1.0;
+    settings.javascript = true;
+    settings.windowless_frame_rate = 60;
+    settings.request_handler_factory = &REQUEST_HANDLER_FACTORY;
+
+    WebViewHandler handler{
+        .on_cursor = on_cursor,
+        .on_state_change = on_state_change,
+        .on_ime_rect = on_ime_rect,
+        .on_frame = on_frame,
+        .on_title_change = on_title_change,
+        .on_fullscreen_change = on_fullscreen_change,
+        .on_message = on_message,
+        .context = &CONTEXT,
+    };
+
+    void *webview = create_webview(runtime, "about:blank", &settings, handler);
+    pump_until([]() { return CONTEXT.loaded; });
+
+    std::string message_16(16, 'x');
+    std::string message_4k(4096, 'x');
+
+    std::vector<Case> cases;
+    cases.push_back({
+        .name = "webview_mouse_move",
+        .bytes = 0,
+        .call = [webview]() { webview_mouse_move(webview, MouseEvent{.x = 100, .y = 100, .modifiers = 0}); },
+        .drain = pump,
+    });
+
+    cases.push_back({
+        .name = "webview_keyboard",
+        .bytes = 0,
+        .call =
+            [webview]() {
+                KeyEvent event{};
+                event.type = WEW_KEYEVENT_CHAR;
+                event.windows_key_code = 65;
+                event.character = 'a';
+                webview_keyboard(webview, event);
+            },
+        .drain = pump,
+    });
+
+    cases.push_back({
+        .name = "webview_send_message (16 B)",
+        .bytes = message_16.size(),
+        .call = [webview, &message_16]() { webview_send_message(webview, message_16.c_str()); },
+        .drain = pump,
+    });
+
+    cases.push_back({
+        .name = "webview_send_message (4 KiB)",
+        .bytes = message_4k.size(),
+        .call = [webview, &message_4k]() { webview_send_message(webview, message_4k.c_str()); },
+        .drain = pump,
+    });
+
+    cases.push_back({
+        .name = "post_task_with_main_thread",
+        .bytes = 0,
+        .call = []() { post_task_with_main_thread(noop_task, nullptr); },
+        .drain = pump,
+    });
+
+#ifdef WEW_MOCK_CEF
+    auto browser = cef_mock::GetLastBrowser();
+    auto buffer = std::make_shared<std::vector<uint8_t>>(1920 * 1080 * 4);
+    std::vector<CefRect> dirty_rects = {CefRect(0, 0, 1920, 1080)};
+
+    cases.push_back({
+        .name = "on_frame dispatch (1080p)",
+        .bytes = 0,
+        .call = [browser, buffer, dirty_rects]() {
+            cef_mock::Paint(browser, PET_VIEW, dirty_rects, buffer->data(), 1920, 1080);
+        },
+        .drain = []() {},
+    });
+
+    auto request = cef_mock::CreateRequest("https://localhost/index.html");
+    cases.push_back({
+        .name = "GetResourceHandler",
+        .bytes = 0,
+        .call = [browser, request]() { cef_mock::CreateResourceHandler(browser, request); },
+        .drain = []() {},
+    });
+#endif
+
+    printf("%-36s %12s %14s %16s %12s\n", "entry point", "ns/call", "allocs/call", "calls/s", "MiB/s");
+    for (auto &bench : cases)
+    {
+        run_case(bench, iterations);
+    }
+
+    close_webview(webview);
+    pump();
+    close_runtime(runtime);
+
+    return 0;
+}
@@ -0,0 +1,273 @@
+//
+//  blob.cpp
+//  webview
+//
+//  Host memory served under URLs, without calling the host per request or read
+//
+
+#include "blob.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "metrics.h"
+#include "watchdog.h"
+
+namespace
+{
+    struct BlobState
+    {
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<IBlob>> blobs;
+    };
+
+    BlobState &GetState()
+    {
+        static BlobState state;
+        return state;
+    }
+
+    // Fragments never reach the network, a blob registered with one is found without it.
+    std::string GetKey(const std::string &url)
+    {
+        return url.substr(0, url.find('#'));
+    }
+} // namespace
+
+IBlob::~IBlob()
+{
+    IWatchdog::Call(HostCallback::BlobRelease, release, data, context);
+}
+
+/* IBlobRegistry */
+
+void IBlobRegistry::Register(const std::string &url, std::shared_ptr<IBlob> blob)
+{
+    auto &state = GetState();
+
+    // The replaced blob is released outside the lock, the host may register again from its release callback.
+    std::shared_ptr<IBlob> previous;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        previous = std::exchange(state.blobs[GetKey(url)], std::move(blob));
+    }
+}
+
+bool IBlobRegistry::Unregister(const std::string &url)
+{
+    auto &state = GetState();
+
+    // Requests in progress keep the blob, it is released with the last one.
+    std::shared_ptr<IBlob> blob;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        auto it = state.blobs.find(GetKey(url));
+        if (it == state.blobs.end())
+        {
+            return false;
+        }
+
+        blob = std::move(it->second);
+        state.blobs.erase(it);
+    }
+
+    return true;
+}
+
+CefRefPtr<CefResourceHandler> IBlobRegistry::Create(CefRefPtr<CefRequest> request)
+{
+    auto &state = GetState();
+    std::shared_ptr<IBlob> blob;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        if (state.blobs.empty())
+        {
+            return nullptr;
+        }
+
+        auto it = state.blobs.find(GetKey(request->GetURL().ToString()));
+        if (it == state.blobs.end())
+        {
+            return nullptr;
+        }
+
+        blob = it->second;
+    }
+
+    IMetrics::Add(MetricCounter::BlobRequests);
+
+    return new IBlobResourceHandler(std::move(blob));
+}
+
+/* IBlobResourceHandler */
+
+IBlobResourceHandler::IBlobResourceHandler(std::shared_ptr<IBlob> blob) : _blob(std::move(blob))
+{
+    _end = _blob->size;
+}
+
+bool IBlobResourceHandler::Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback)
+{
+    handle_request = true;
+
+    CefRequest::HeaderMap headers;
+    request->GetHeaderMap(headers);
+    for (auto &it : headers)
+    {
+        std::string name = it.first.ToString();
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (name != "range")
+        {
+            continue;
+        }
+
+        bool partial = false;
+        if (!ParseRange(it.second.ToString(), partial))
+        {
+            _status = 416;
+            _offset = _end = 0;
+        }
+        else if (partial)
+        {
+            _status = 206;
+        }
+
+        break;
+    }
+
+    return true;
+}
+
+bool IBlobResourceHandler::ParseRange(const std::string &range, bool &partial)
+{
+    size_t size = _blob->size;
+
+    // bytes=start-end, bytes=start- or bytes=-suffix. Several ranges are answered with the whole blob.
+    if (range.compare(0, 6, "bytes=") != 0 || range.find(',') != std::string::npos)
+    {
+        return true;
+    }
+
+    std::string spec = range.substr(6);
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos)
+    {
+        return true;
+    }
+
+    std::string first = spec.substr(0, dash);
+    std::string last = spec.substr(dash + 1);
+    char *end = nullptr;
+    if (first.empty())
+    {
+        uint64_t suffix = strtoull(last.c_str(), &end, 10);
+        if (last.empty() || *end != '\0')
+        {
+            return true;
+        }
+
+        if (suffix == 0 || size == 0)
+        {
+            return false;
+        }
+
+        _offset = size - std::min<uint64_t>(suffix, size);
+        _end = size;
+    }
+    else
+    {
+        uint64_t start = strtoull(first.c_str(), &end, 10);
+        if (*end != '\0')
+        {
+            return true;
+        }
+
+        uint64_t stop = size;
+        if (!last.empty())
+        {
+            stop = strtoull(last.c_str(), &end, 10);
+            if (*end != '\0' || stop < start)
+            {
+                return true;
+            }
+
+            stop = std::min<uint64_t>(stop + 1, size);
+        }
+
+        if (start >= size)
+        {
+            return false;
+        }
+
+        _offset = static_cast<size_t>(start);
+        _end = static_cast<size_t>(stop);
+    }
+
+    partial = true;
+    return true;
+}
+
+void IBlobResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
+                                              int64_t &response_length,
+                                              CefString &redirectUrl)
+{
+    std::string total = std::to_string(_blob->size);
+
+    CefResponse::HeaderMap headers;
+    headers.insert({"Accept-Ranges", "bytes"});
+    if (_status == 206)
+    {
+        headers.insert(
+            {"Content-Range", "bytes " + std::to_string(_offset) + "-" + std::to_string(_end - 1) + "/" + total});
+    }
+    else if (_status == 416)
+    {
+        headers.insert({"Content-Range", "bytes */" + total});
+    }
+
+    response->SetStatus(_status);
+    response->SetMimeType(_blob->mime_type);
+    response->SetHeaderMap(headers);
+
+    response_length = static_cast<int64_t>(_end - _offset);
+}
+
+bool IBlobResourceHandler::Skip(int64_t bytes_to_skip,
+                                int64_t &bytes_skipped,
+                                CefRefPtr<CefResourceSkipCallback> callback)
+{
+    size_t count = std::min(static_cast<size_t>(bytes_to_skip), _end - _offset);
+    _offset += count;
+    bytes_skipped = static_cast<int64_t>(count);
+
+    return count > 0;
+}
+
+bool IBlobResourceHandler::Read(void *data_out,
+                                int bytes_to_read,
+                                int &bytes_read,
+                                CefRefPtr<CefResourceReadCallback> callback)
+{
+    size_t count = std::min(static_cast<size_t>(bytes_to_read), _end - _offset);
+    memcpy(data_out, _blob->data + _offset, count);
+    _offset += count;
+    bytes_read = static_cast<int>(count);
+
+    if (count > 0)
+    {
+        IMetrics::Observe(MetricHistogram::ResourceReadBytes, count);
+    }
+
+    return count > 0;
+}
+
+void IBlobResourceHandler::Cancel()
+{
+}
@@ -0,0 +1,80 @@
+//
+//  blob.h
+//  webview
+//
+//  Host memory served under URLs, without calling the host per request or read
+//
+
+#ifndef blob_h
+#define blob_h
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "include/cef_resource_handler.h"
+
+#include "wew.h"
+
+///
+/// A registered blob, released once it is unregistered and no request reads it anymore.
+///
+struct IBlob
+{
+    const uint8_t *data;
+    size_t size;
+    std::string mime_type;
+    void (*release)(const void *data, void *context);
+    void *context;
+
+    ~IBlob();
+};
+
+class IBlobRegistry
+{
+  public:
+    ///
+    /// Registers a blob under a URL, replacing the blob registered under it before.
+    ///
+    static void Register(const std::string &url, std::shared_ptr<IBlob> blob);
+    static bool Unregister(const std::string &url);
+
+    ///
+    /// Returns the handler serving the blob registered under the request's URL, nullptr when there is none.
+    ///
+    static CefRefPtr<CefResourceHandler> Create(CefRefPtr<CefRequest> request);
+};
+
+///
+/// Serves a blob straight from the host's memory, one byte range of it when the request asks for a single range.
+///
+class IBlobResourceHandler : public CefResourceHandler
+{
+  public:
+    IBlobResourceHandler(std::shared_ptr<IBlob> blob);
+
+    bool Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback) override;
+
+    void GetResponseHeaders(CefRefPtr<CefResponse> response, int64_t &response_length, CefString &redirectUrl) override;
+
+    bool Skip(int64_t bytes_to_skip, int64_t &bytes_skipped, CefRefPtr<CefResourceSkipCallback> callback) override;
+
+    bool Read(void *data_out, int bytes_to_read, int &bytes_read, CefRefPtr<CefResourceReadCallback> callback) override;
+
+    void Cancel() override;
+
+  private:
+    std::shared_ptr<IBlob> _blob;
+    int _status = 200;
+    size_t _offset = 0;
+    size_t _end = 0;
+
+    ///
+    /// Parses a single range of a Range header, returns false when the header asks for none of the blob.
+    ///
+    bool ParseRange(const std::string &range, bool &partial);
+
+    IMPLEMENT_REFCOUNTING(IBlobResourceHandler);
+};
+
+#endif /* blob_h */
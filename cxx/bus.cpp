@@ -0,0 +1,293 @@
+//
+//  bus.cpp
+//  webview
+//
+//  Named channels between pages, routed in the browser process without the host
+//
+
+#include "bus.h"
+
+#include <mutex>
+#include <vector>
+
+#include "metrics.h"
+#include "watchdog.h"
+
+namespace
+{
+    struct Observer
+    {
+        std::string channel;
+        BusObserver config;
+    };
+
+    struct BusState
+    {
+        // Recursive so observers can publish, held while calling them so an observer is never called once
+        // Unobserve returned on another thread.
+        std::recursive_mutex mutex;
+        std::map<std::string, std::map<int, CefRefPtr<CefBrowser>>> channels;
+        std::map<int, Observer> observers;
+        int next_id = 0;
+    };
+
+    BusState &GetState()
+    {
+        static BusState state;
+        return state;
+    }
+
+    // The arguments of a received message are read only, every subscriber gets its own copy of the message.
+    void Forward(BusState &state, int source, const std::string &channel, CefRefPtr<CefProcessMessage> message)
+    {
+        auto it = state.channels.find(channel);
+        if (it == state.channels.end())
+        {
+            return;
+        }
+
+        for (auto &subscriber : it->second)
+        {
+            if (subscriber.first == source)
+            {
+                continue;
+            }
+
+            auto frame = subscriber.second->GetMainFrame();
+            if (frame != nullptr)
+            {
+                frame->SendProcessMessage(PID_RENDERER, message->Copy());
+                IMetrics::Add(MetricCounter::BusMessagesForwarded);
+            }
+        }
+    }
+
+    void Notify(BusState &state, const std::string &channel, CefRefPtr<CefListValue> args)
+    {
+        std::vector<int> ids;
+        for (auto &it : state.observers)
+        {
+            if (it.second.channel == channel)
+            {
+                ids.push_back(it.first);
+            }
+        }
+
+        if (ids.empty())
+        {
+            return;
+        }
+
+        std::string message = args->GetString(1);
+        for (int id : ids)
+        {
+            // An observer may have removed another one.
+            auto it = state.observers.find(id);
+            if (it != state.observers.end())
+            {
+                auto &config = it->second.config;
+                IWatchdog::Call(
+                    HostCallback::OnBusMessage, config.on_message, channel.c_str(), message.c_str(), config.context);
+            }
+        }
+    }
+} // namespace
+
+/* IMessageBus */
+
+bool IMessageBus::OnProcessMessage(CefRefPtr<CefBrowser> browser, CefRefPtr<CefProcessMessage> message, bool enabled)
+{
+    std::string name = message->GetName();
+    if (name.compare(0, 4, "BUS_") != 0)
+    {
+        return false;
+    }
+
+    if (!enabled)
+    {
+        return true;
+    }
+
+    int id = browser->GetIdentifier();
+    if (name == "BUS_RESET")
+    {
+        Remove(id);
+
+        return true;
+    }
+
+    auto &state = GetState();
+    std::lock_guard<std::recursive_mutex> lock(state.mutex);
+
+    auto args = message->GetArgumentList();
+    std::string channel = args->GetString(0);
+    if (name == "BUS_MESSAGE")
+    {
+        Forward(state, id, channel, message);
+        Notify(state, channel, args);
+    }
+    else if (name == "BUS_SUBSCRIBE")
+    {
+        state.channels[channel][id] = browser;
+    }
+    else if (name == "BUS_UNSUBSCRIBE")
+    {
+        auto it = state.channels.find(channel);
+        if (it != state.channels.end() && it->second.erase(id) > 0 && it->second.empty())
+        {
+            state.channels.erase(it);
+        }
+    }
+
+    return true;
+}
+
+void IMessageBus::Publish(const std::string &channel, const std::string &message)
+{
+    auto msg = CefProcessMessage::Create("BUS_MESSAGE");
+    CefRefPtr<CefListValue> args = msg->GetArgumentList();
+    args->SetSize(2);
+    args->SetString(0, channel);
+    args->SetString(1, message);
+
+    auto &state = GetState();
+    std::lock_guard<std::recursive_mutex> lock(state.mutex);
+
+    Forward(state, -1, channel, msg);
+}
+
+int IMessageBus::Observe(const std::string &channel, const BusObserver *observer)
+{
+    auto &state = GetState();
+    std::lock_guard<std::recursive_mutex> lock(state.mutex);
+
+    int id = state.next_id++;
+    state.observers[id] = {channel, *observer};
+
+    return id;
+}
+
+void IMessageBus::Unobserve(int id)
+{
+    auto &state = GetState();
+    std::lock_guard<std::recursive_mutex> lock(state.mutex);
+
+    state.observers.erase(id);
+}
+
+void IMessageBus::Remove(int id)
+{
+    auto &state = GetState();
+    std::lock_guard<std::recursive_mutex> lock(state.mutex);
+
+    for (auto it = state.channels.begin(); it != state.channels.end();)
+    {
+        it->second.erase(id);
+        it = it->second.empty() ? state.channels.erase(it) : std::next(it);
+    }
+}
+
+/* IBusBinding */
+
+bool IBusBinding::Execute(const CefString &name,
+                          CefRefPtr<CefV8Value> object,
+                          const CefV8ValueList &arguments,
+                          CefRefPtr<CefV8Value> &retval,
+                          CefString &exception)
+{
+    std::string function = name.ToString();
+    if (arguments.empty() || !arguments[0]->IsString())
+    {
+        exception = "MessageBus." + function + ": expected a channel name";
+        return true;
+    }
+
+    auto browser = CefV8Context::GetCurrentContext()->GetBrowser();
+    auto &callbacks = _callbacks[browser->GetIdentifier()];
+    std::string channel = arguments[0]->GetStringValue();
+
+    CefRefPtr<CefProcessMessage> msg;
+    if (function == "publish")
+    {
+        if (arguments.size() != 2 || !arguments[1]->IsString())
+        {
+            exception = "MessageBus.publish: expected a string message";
+            return true;
+        }
+
+        msg = CefProcessMessage::Create("BUS_MESSAGE");
+        msg->GetArgumentList()->SetSize(2);
+        msg->GetArgumentList()->SetString(1, arguments[1]->GetStringValue());
+    }
+    else if (function == "subscribe")
+    {
+        if (arguments.size() != 2 || !arguments[1]->IsFunction())
+        {
+            exception = "MessageBus.subscribe: expected a callback";
+            return true;
+        }
+
+        // One callback per channel, replacing it does not concern the browser.
+        bool subscribed = callbacks.count(channel) > 0;
+        callbacks[channel] = arguments[1];
+        if (!subscribed)
+        {
+            msg = CefProcessMessage::Create("BUS_SUBSCRIBE");
+        }
+    }
+    else if (callbacks.erase(channel) > 0)
+    {
+        msg = CefProcessMessage::Create("BUS_UNSUBSCRIBE");
+    }
+
+    if (msg != nullptr)
+    {
+        msg->GetArgumentList()->SetString(0, channel);
+        browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, msg);
+    }
+
+    retval = CefV8Value::CreateUndefined();
+
+    return true;
+}
+
+CefRefPtr<CefV8Value> IBusBinding::CreateObject()
+{
+    CefRefPtr<CefV8Value> object = CefV8Value::CreateObject(nullptr, nullptr);
+    for (auto name : {"publish", "subscribe", "unsubscribe"})
+    {
+        object->SetValue(name, CefV8Value::CreateFunction(name, this), V8_PROPERTY_ATTRIBUTE_NONE);
+    }
+
+    return object;
+}
+
+void IBusBinding::Recv(CefRefPtr<CefBrowser> browser,
+                       CefRefPtr<CefV8Context> context,
+                       const std::string &channel,
+                       const std::string &message)
+{
+    auto it = _callbacks.find(browser->GetIdentifier());
+    if (it == _callbacks.end())
+    {
+        return;
+    }
+
+    auto callback = it->second.find(channel);
+    if (callback == it->second.end())
+    {
+        return;
+    }
+
+    // The callback may unsubscribe, keep it alive for the call.
+    CefRefPtr<CefV8Value> function = callback->second;
+
+    context->Enter();
+    function->ExecuteFunction(nullptr, {CefV8Value::CreateString(message), CefV8Value::CreateString(channel)});
+    context->Exit();
+}
+
+void IBusBinding::Reset(int id)
+{
+    _callbacks.erase(id);
+}
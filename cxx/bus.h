@@ -0,0 +1,86 @@
+//
+//  bus.h
+//  webview
+//
+//  Named channels between pages, routed in the browser process without the host
+//
+
+#ifndef bus_h
+#define bus_h
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "include/cef_browser.h"
+#include "include/cef_process_message.h"
+#include "include/cef_v8.h"
+
+#include "wew.h"
+
+///
+/// The browser process end of the bus, shared by every webview of the process.
+///
+/// A page's renderer tells it which channels the page subscribed to, and a message the page publishes is copied by
+/// CEF straight to the renderers of the other subscribers. The host only sees the messages of channels it observes.
+///
+class IMessageBus
+{
+  public:
+    ///
+    /// Handles a bus message from a webview's renderer, returns false for other messages. The messages of a webview
+    /// that is not on the bus are dropped, its renderer has no MessageBus unless the page was compromised.
+    ///
+    static bool OnProcessMessage(CefRefPtr<CefBrowser> browser, CefRefPtr<CefProcessMessage> message, bool enabled);
+
+    ///
+    /// Publishes a message of the host to every subscribed page, from any thread.
+    ///
+    static void Publish(const std::string &channel, const std::string &message);
+
+    static int Observe(const std::string &channel, const BusObserver *observer);
+    static void Unobserve(int id);
+
+    ///
+    /// Drops the subscriptions of a browser, its webview is closing.
+    ///
+    static void Remove(int id);
+};
+
+///
+/// The renderer end of the bus, the page's MessageBus object with publish, subscribe and unsubscribe.
+///
+class IBusBinding : public CefV8Handler
+{
+  public:
+    bool Execute(const CefString &name,
+                 CefRefPtr<CefV8Value> object,
+                 const CefV8ValueList &arguments,
+                 CefRefPtr<CefV8Value> &retval,
+                 CefString &exception) override;
+
+    ///
+    /// Creates the page object of the bus, in the entered context.
+    ///
+    CefRefPtr<CefV8Value> CreateObject();
+
+    ///
+    /// Calls the page's callback of the channel, in the browser's main frame context.
+    ///
+    void Recv(CefRefPtr<CefBrowser> browser,
+              CefRefPtr<CefV8Context> context,
+              const std::string &channel,
+              const std::string &message);
+
+    ///
+    /// Drops the callbacks of a browser, its page is gone.
+    ///
+    void Reset(int id);
+
+  private:
+    std::map<int, std::map<std::string, CefRefPtr<CefV8Value>>> _callbacks;
+
+    IMPLEMENT_REFCOUNTING(IBusBinding);
+};
+
+#endif /* bus_h */
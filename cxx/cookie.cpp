@@ -6,7 +6,10 @@
 //
 
 #include "cookie.h"
+#include "metrics.h"
+#include "trace.h"
 #include "util.h"
+#include "watchdog.h"
 #include "include/cef_app.h"
 #include "include/wrapper/cef_helpers.h"
 #include <assert.h>
@@ -50,13 +53,15 @@ private:
 // Task for posting cookie operations to IO thread
 class CookieTask : public CefTask {
 public:
-    CookieTask(std::function<void()> func) : func_(func) {}
+    CookieTask(const char* name, std::function<void()> func) : name_(name), func_(func) {}
     
     void Execute() override {
+        TRACE_SPAN(name_);
         func_();
     }
     
 private:
+    const char* name_;
     std::function<void()> func_;
     IMPLEMENT_REFCOUNTING(CookieTask);
 };
@@ -103,13 +108,17 @@ bool ICookieManager::SetCookie(const char* url, const Cookie* cookie)
     cef_url.FromASCII(url);
     
     // Handle thread safety
+    IMetrics::Add(MetricCounter::CookieOperations);
+
     if (CefCurrentlyOn(TID_IO)) {
         return _manager->SetCookie(cef_url, cef_cookie, nullptr);
     } else {
         auto result = std::make_shared<AsyncResult<bool>>();
+        auto start = std::chrono::steady_clock::now();
         
-        CefPostTask(TID_IO, new CookieTask([this, cef_url, cef_cookie, result]() {
+        CefPostTask(TID_IO, new CookieTask("ICookieManager::SetCookie", [this, cef_url, cef_cookie, result, start]() {
             bool success = _manager->SetCookie(cef_url, cef_cookie, nullptr);
+            IMetrics::Observe(MetricHistogram::CookieOperationDuration, IMetrics::Elapsed(start));
             result->SetResult(success);
         }));
         
@@ -134,13 +143,17 @@ bool ICookieManager::DeleteCookies(const char* url, const char* name)
     }
 
     // Handle thread safety
+    IMetrics::Add(MetricCounter::CookieOperations);
+
     if (CefCurrentlyOn(TID_IO)) {
         return _manager->DeleteCookies(cef_url, cef_name, nullptr);
     } else {
         auto result = std::make_shared<AsyncResult<bool>>();
+        auto start = std::chrono::steady_clock::now();
         
-        CefPostTask(TID_IO, new CookieTask([this, cef_url, cef_name, result]() {
+        CefPostTask(TID_IO, new CookieTask("ICookieManager::DeleteCookies", [this, cef_url, cef_name, result, start]() {
             bool success = _manager->DeleteCookies(cef_url, cef_name, nullptr);
+            IMetrics::Observe(MetricHistogram::CookieOperationDuration, IMetrics::Elapsed(start));
             result->SetResult(success);
         }));
         
@@ -156,11 +169,16 @@ void ICookieManager::VisitAllCookies(CookieVisitor* visitor)
 
     CefRefPtr<ICookieVisitor> cef_visitor = new ICookieVisitor(visitor);
     
+    IMetrics::Add(MetricCounter::CookieOperations);
+
     if (CefCurrentlyOn(TID_IO)) {
         _manager->VisitAllCookies(cef_visitor);
     } else {
-        CefPostTask(TID_IO, new CookieTask([this, cef_visitor]() {
+        auto start = std::chrono::steady_clock::now();
+
+        CefPostTask(TID_IO, new CookieTask("ICookieManager::VisitAllCookies", [this, cef_visitor, start]() {
             _manager->VisitAllCookies(cef_visitor);
+            IMetrics::Observe(MetricHistogram::CookieOperationDuration, IMetrics::Elapsed(start));
         }));
     }
 }
@@ -176,11 +194,16 @@ void ICookieManager::VisitUrlCookies(const char* url, bool includeHttpOnly, Cook
     
     CefRefPtr<ICookieVisitor> cef_visitor = new ICookieVisitor(visitor);
     
+    IMetrics::Add(MetricCounter::CookieOperations);
+
     if (CefCurrentlyOn(TID_IO)) {
         _manager->VisitUrlCookies(cef_url, includeHttpOnly, cef_visitor);
     } else {
-        CefPostTask(TID_IO, new CookieTask([this, cef_url, includeHttpOnly, cef_visitor]() {
+        auto start = std::chrono::steady_clock::now();
+
+        CefPostTask(TID_IO, new CookieTask("ICookieManager::VisitUrlCookies", [this, cef_url, includeHttpOnly, cef_visitor, start]() {
             _manager->VisitUrlCookies(cef_url, includeHttpOnly, cef_visitor);
+            IMetrics::Observe(MetricHistogram::CookieOperationDuration, IMetrics::Elapsed(start));
         }));
     }
 }
@@ -192,13 +215,17 @@ bool ICookieManager::FlushStore()
     }
 
     // Handle thread safety
+    IMetrics::Add(MetricCounter::CookieOperations);
+
     if (CefCurrentlyOn(TID_IO)) {
         return _manager->FlushStore(nullptr);
     } else {
         auto result = std::make_shared<AsyncResult<bool>>();
+        auto start = std::chrono::steady_clock::now();
         
-        CefPostTask(TID_IO, new CookieTask([this, result]() {
+        CefPostTask(TID_IO, new CookieTask("ICookieManager::FlushStore", [this, result, start]() {
             bool success = _manager->FlushStore(nullptr);
+            IMetrics::Observe(MetricHistogram::CookieOperationDuration, IMetrics::Elapsed(start));
             result->SetResult(success);
         }));
         
@@ -215,7 +242,7 @@ ICookieVisitor::ICookieVisitor(CookieVisitor* visitor) : _visitor(visitor)
 ICookieVisitor::~ICookieVisitor()
 {
     if (_visitor && _visitor->destroy) {
-        _visitor->destroy(_visitor->context);
+        IWatchdog::Call(HostCallback::CookieVisitorDestroy, _visitor->destroy, _visitor->context);
     }
 }
 
@@ -262,7 +289,13 @@ bool ICookieVisitor::Visit(const CefCookie& cef_cookie, int count, int total, bo
     data->cookie.priority = static_cast<int>(cef_cookie.priority);
     
     bool delete_cookie = false;
-    bool continue_visiting = _visitor->visit(&data->cookie, count, total, &delete_cookie, _visitor->context);
+    bool continue_visiting = IWatchdog::Call(HostCallback::CookieVisitorVisit,
+                                             _visitor->visit,
+                                             &data->cookie,
+                                             count,
+                                             total,
+                                             &delete_cookie,
+                                             _visitor->context);
     deleteCookie = delete_cookie;
     
     return continue_visiting;
@@ -0,0 +1,389 @@
+//
+//  encoder.cpp
+//  webview
+//
+//  Software VP8 and VP9 encoding of windowless view frames on a dedicated thread
+//
+
+#include "encoder.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#ifdef WEW_VPX
+#include <vpx/vp8cx.h>
+#endif
+
+#include "metrics.h"
+#include "watchdog.h"
+
+// Chroma is sampled per 2x2 block, damage is widened to whole blocks.
+static bool AlignRect(const CefRect &rect, int width, int height, CefRect &output)
+{
+    int left = std::max(rect.x, 0);
+    int top = std::max(rect.y, 0);
+    int right = std::min(rect.x + rect.width, width);
+    int bottom = std::min(rect.y + rect.height, height);
+    if (right <= left || bottom <= top)
+    {
+        return false;
+    }
+
+    left &= ~1;
+    top &= ~1;
+    output = CefRect(left, top, ((right + 1) & ~1) - left, ((bottom + 1) & ~1) - top);
+    return true;
+}
+
+/* IVideoEncoder::Image */
+
+uint8_t *IVideoEncoder::Image::GetPlane(int plane)
+{
+    size_t luma = static_cast<size_t>(luma_stride) * ((height + 1) & ~1);
+    size_t chroma = static_cast<size_t>(chroma_stride) * ((height + 1) / 2);
+
+    return data.data() + (plane == 0 ? 0 : luma + (plane - 1) * chroma);
+}
+
+/* IVideoEncoder */
+
+std::unique_ptr<IVideoEncoder> IVideoEncoder::Create(const VideoEncoderSettings *settings, IMemoryAccount &memory)
+{
+#ifdef WEW_VPX
+    return std::make_unique<IVideoEncoder>(settings, memory);
+#else
+    return nullptr;
+#endif
+}
+
+// clang-format off
+IVideoEncoder::IVideoEncoder(const VideoEncoderSettings *settings, IMemoryAccount &memory)
+    : _settings(*settings)
+    , _memory(memory)
+    , _bitrate(settings->bitrate)
+    , _start(std::chrono::steady_clock::now())
+{
+    _thread = std::thread([this]() { Run(); });
+}
+// clang-format on
+
+IVideoEncoder::~IVideoEncoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _running = false;
+    }
+
+    _condition.notify_one();
+    _thread.join();
+
+#ifdef WEW_VPX
+    if (_open)
+    {
+        vpx_codec_destroy(&_codec);
+    }
+#endif
+
+    _memory.Release(WEW_MEMORY_FRAME_BUFFERS, _staging.data.size() + _encoding.data.size());
+}
+
+void IVideoEncoder::Submit(const CefRenderHandler::RectList &dirty_rects, const void *buffer, int width, int height)
+{
+    auto pixels = static_cast<const uint32_t *>(buffer);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    CefRenderHandler::RectList everything = {CefRect(0, 0, width, height)};
+    const CefRenderHandler::RectList *rects = &dirty_rects;
+    if (width != _staging.width || height != _staging.height)
+    {
+        Resize(_staging, width, height);
+        rects = &everything;
+        _stale = true;
+        _damage.clear();
+    }
+
+    uint8_t *luma = _staging.GetPlane(0);
+    uint8_t *u = _staging.GetPlane(1);
+    uint8_t *v = _staging.GetPlane(2);
+
+    bool damaged = false;
+    for (auto &it : *rects)
+    {
+        CefRect rect;
+        if (!AlignRect(it, width, height, rect))
+        {
+            continue;
+        }
+
+        damaged = true;
+        if (!_stale)
+        {
+            if (_damage.size() >= MAX_DAMAGE_RECTS)
+            {
+                _stale = true;
+                _damage.clear();
+            }
+            else
+            {
+                _damage.push_back(rect);
+            }
+        }
+
+        // BT.601 limited range from BGRA read as little endian words, the odd last column and row of a frame
+        // repeat the pixels before them.
+        for (int y = rect.y; y < rect.y + rect.height; y += 2)
+        {
+            const uint32_t *rows[2] = {pixels + static_cast<size_t>(y) * width,
+                                       pixels + static_cast<size_t>(std::min(y + 1, height - 1)) * width};
+            uint8_t *luma_rows[2] = {luma + static_cast<size_t>(y) * _staging.luma_stride,
+                                     luma + static_cast<size_t>(y + 1) * _staging.luma_stride};
+            size_t chroma_row = static_cast<size_t>(y / 2) * _staging.chroma_stride;
+
+            for (int x = rect.x; x < rect.x + rect.width; x += 2)
+            {
+                int columns[2] = {x, std::min(x + 1, width - 1)};
+                int r = 0;
+                int g = 0;
+                int b = 0;
+                for (int i = 0; i < 4; i++)
+                {
+                    uint32_t pixel = rows[i / 2][columns[i % 2]];
+                    int pr = (pixel >> 16) & 0xff;
+                    int pg = (pixel >> 8) & 0xff;
+                    int pb = pixel & 0xff;
+
+                    int luma_value = ((66 * pr + 129 * pg + 25 * pb + 128) >> 8) + 16;
+                    luma_rows[i / 2][x + i % 2] = static_cast<uint8_t>(luma_value);
+                    r += pr;
+                    g += pg;
+                    b += pb;
+                }
+
+                r = (r + 2) >> 2;
+                g = (g + 2) >> 2;
+                b = (b + 2) >> 2;
+
+                u[chroma_row + x / 2] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                v[chroma_row + x / 2] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+    }
+
+    // Paints without damage leave nothing to encode.
+    if (damaged)
+    {
+        _pending = true;
+        _condition.notify_one();
+    }
+}
+
+void IVideoEncoder::RequestKeyframe()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _keyframe = true;
+    _condition.notify_one();
+}
+
+void IVideoEncoder::SetBitrate(uint32_t bitrate)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _bitrate = bitrate;
+}
+
+void IVideoEncoder::Run()
+{
+    while (true)
+    {
+        bool keyframe;
+        uint32_t bitrate;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            // A keyframe request before the first frame waits for it, the first frame is a keyframe anyway.
+            _condition.wait(lock, [&]() { return !_running || _pending || (_keyframe && _encoding.width > 0); });
+            if (!_running)
+            {
+                break;
+            }
+
+            if (_pending)
+            {
+                if (_stale)
+                {
+                    if (_encoding.width != _staging.width || _encoding.height != _staging.height)
+                    {
+                        Resize(_encoding, _staging.width, _staging.height);
+                    }
+
+                    _encoding.data = _staging.data;
+                }
+                else
+                {
+                    for (auto &rect : _damage)
+                    {
+                        CopyRect(rect);
+                    }
+                }
+
+                _damage.clear();
+                _stale = false;
+                _pending = false;
+            }
+
+            keyframe = _keyframe;
+            bitrate = _bitrate;
+            _keyframe = false;
+        }
+
+        Encode(keyframe, bitrate);
+    }
+}
+
+void IVideoEncoder::Encode(bool keyframe, uint32_t bitrate)
+{
+#ifdef WEW_VPX
+    // The codec is opened again on a resize, which starts with a keyframe.
+    if (_open && (_config.g_w != static_cast<unsigned int>(_encoding.width) ||
+                  _config.g_h != static_cast<unsigned int>(_encoding.height)))
+    {
+        vpx_codec_destroy(&_codec);
+        _open = false;
+    }
+
+    if (!_open)
+    {
+        vpx_codec_iface_t *iface = _settings.codec == WEW_CODEC_VP9 ? vpx_codec_vp9_cx() : vpx_codec_vp8_cx();
+        if (vpx_codec_enc_config_default(iface, &_config, 0) != VPX_CODEC_OK)
+        {
+            return;
+        }
+
+        // One pass constant bitrate without lookahead, what a live stream needs.
+        _config.g_w = _encoding.width;
+        _config.g_h = _encoding.height;
+        _config.g_timebase.num = 1;
+        _config.g_timebase.den = 1000;
+        _config.g_pass = VPX_RC_ONE_PASS;
+        _config.g_lag_in_frames = 0;
+        _config.g_threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        _config.rc_end_usage = VPX_CBR;
+        _config.rc_target_bitrate = bitrate;
+        _config.kf_mode = VPX_KF_AUTO;
+        if (_settings.keyframe_interval > 0)
+        {
+            _config.kf_max_dist = _settings.keyframe_interval;
+        }
+
+        if (vpx_codec_enc_init(&_codec, iface, &_config, 0) != VPX_CODEC_OK)
+        {
+            return;
+        }
+
+        // Pages are screen content, and the realtime speeds keep the thread ahead of the paints.
+        if (_settings.codec == WEW_CODEC_VP9)
+        {
+            vpx_codec_control(&_codec, VP8E_SET_CPUUSED, 7);
+            vpx_codec_control(&_codec, VP9E_SET_TUNE_CONTENT, static_cast<int>(VP9E_CONTENT_SCREEN));
+        }
+        else
+        {
+            vpx_codec_control(&_codec, VP8E_SET_CPUUSED, -6);
+            vpx_codec_control(&_codec, VP8E_SET_SCREEN_CONTENT_MODE, 1);
+        }
+
+        _open = true;
+        keyframe = true;
+    }
+
+    if (_config.rc_target_bitrate != bitrate)
+    {
+        _config.rc_target_bitrate = bitrate;
+        vpx_codec_enc_config_set(&_codec, &_config);
+    }
+
+    vpx_image_t image;
+    vpx_img_wrap(&image, VPX_IMG_FMT_I420, _encoding.width, _encoding.height, 1, _encoding.data.data());
+    for (int plane = 0; plane < 3; plane++)
+    {
+        image.planes[plane] = _encoding.GetPlane(plane);
+        image.stride[plane] = plane == 0 ? _encoding.luma_stride : _encoding.chroma_stride;
+    }
+
+    // The codec wants increasing timestamps, paints can come faster than the millisecond timebase.
+    auto elapsed = std::chrono::steady_clock::now() - _start;
+    int64_t pts = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), _last_pts + 1);
+    unsigned long duration = _last_pts < 0 ? 1 : static_cast<unsigned long>(pts - _last_pts);
+    _last_pts = pts;
+
+    if (vpx_codec_encode(&_codec, &image, pts, duration, keyframe ? VPX_EFLAG_FORCE_KF : 0, VPX_DL_REALTIME) !=
+        VPX_CODEC_OK)
+    {
+        return;
+    }
+
+    IMetrics::Add(MetricCounter::FramesEncoded);
+
+    vpx_codec_iter_t iter = nullptr;
+    const vpx_codec_cx_pkt_t *packet;
+    while ((packet = vpx_codec_get_cx_data(&_codec, &iter)) != nullptr)
+    {
+        if (packet->kind != VPX_CODEC_CX_FRAME_PKT)
+        {
+            continue;
+        }
+
+        EncodedPacket output;
+        output.data = static_cast<const uint8_t *>(packet->data.frame.buf);
+        output.size = packet->data.frame.sz;
+        output.pts = packet->data.frame.pts;
+        output.keyframe = (packet->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
+
+        IMetrics::Add(MetricCounter::EncodedBytes, output.size);
+        IWatchdog::Call(HostCallback::OnEncodedPacket, _settings.on_packet, &output, _settings.context);
+    }
+#endif
+}
+
+void IVideoEncoder::Resize(Image &image, int width, int height)
+{
+    _memory.Release(WEW_MEMORY_FRAME_BUFFERS, image.data.size());
+
+    image.width = width;
+    image.height = height;
+    image.luma_stride = (width + 1) & ~1;
+    image.chroma_stride = image.luma_stride / 2;
+
+    size_t luma = static_cast<size_t>(image.luma_stride) * ((height + 1) & ~1);
+    image.data.assign(luma + luma / 2, 0);
+    image.data.shrink_to_fit();
+
+    _memory.Charge(WEW_MEMORY_FRAME_BUFFERS, image.data.size());
+}
+
+void IVideoEncoder::CopyRect(const CefRect &rect)
+{
+    auto from = _staging.data.data();
+    auto to = _encoding.data.data();
+
+    // The rects are aligned to the 2x2 chroma blocks, and both images have the same layout.
+    for (int y = rect.y; y < rect.y + rect.height; y++)
+    {
+        size_t offset = static_cast<size_t>(y) * _encoding.luma_stride + rect.x;
+        memcpy(to + offset, from + offset, rect.width);
+    }
+
+    for (int plane = 1; plane < 3; plane++)
+    {
+        size_t base = _encoding.GetPlane(plane) - to;
+        for (int y = rect.y / 2; y < (rect.y + rect.height) / 2; y++)
+        {
+            size_t offset = base + static_cast<size_t>(y) * _encoding.chroma_stride + rect.x / 2;
+            memcpy(to + offset, from + offset, rect.width / 2);
+        }
+    }
+}
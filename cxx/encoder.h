@@ -0,0 +1,111 @@
+//
+//  encoder.h
+//  webview
+//
+//  Software VP8 and VP9 encoding of windowless view frames on a dedicated thread
+//
+
+#ifndef encoder_h
+#define encoder_h
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef WEW_VPX
+#include <vpx/vpx_encoder.h>
+#endif
+
+#include "include/cef_client.h"
+
+#include "accounting.h"
+#include "wew.h"
+
+///
+/// Encodes view frames for streaming. Paints convert their damage to I420 right away, the encoder thread copies
+/// the damage it has not seen into its own image and encodes it, so paints that arrive while it is busy are merged
+/// into the next frame and paints without damage are never encoded.
+///
+class IVideoEncoder
+{
+  public:
+    ///
+    /// Returns nullptr when the codec is not built in, libvpx is only linked with WEW_VPX.
+    ///
+    static std::unique_ptr<IVideoEncoder> Create(const VideoEncoderSettings *settings, IMemoryAccount &memory);
+
+    IVideoEncoder(const VideoEncoderSettings *settings, IMemoryAccount &memory);
+
+    ///
+    /// Stops the encoder thread, packets are not delivered once this returns.
+    ///
+    ~IVideoEncoder();
+
+    void Submit(const CefRenderHandler::RectList &dirty_rects, const void *buffer, int width, int height);
+    void RequestKeyframe();
+    void SetBitrate(uint32_t bitrate);
+
+  private:
+    ///
+    /// Above this many pending rects the encoder image is copied as a whole.
+    ///
+    static const size_t MAX_DAMAGE_RECTS = 32;
+
+    ///
+    /// I420 planes in one allocation, the planes cover the frame rounded up to even sizes.
+    ///
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        int luma_stride = 0;
+        int chroma_stride = 0;
+        std::vector<uint8_t> data;
+
+        uint8_t *GetPlane(int plane);
+    };
+
+    VideoEncoderSettings _settings;
+    IMemoryAccount &_memory;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _running = true;
+    bool _pending = false;
+    bool _keyframe = false;
+    uint32_t _bitrate;
+
+    ///
+    /// Written by paints under the mutex.
+    ///
+    Image _staging;
+    std::vector<CefRect> _damage;
+    bool _stale = true;
+
+    ///
+    /// Owned by the encoder thread.
+    ///
+    Image _encoding;
+    std::chrono::steady_clock::time_point _start;
+    int64_t _last_pts = -1;
+
+#ifdef WEW_VPX
+    vpx_codec_ctx_t _codec;
+    vpx_codec_enc_cfg_t _config;
+    bool _open = false;
+#endif
+
+    std::thread _thread;
+
+    void Run();
+    void Encode(bool keyframe, uint32_t bitrate);
+    void Resize(Image &image, int width, int height);
+    void CopyRect(const CefRect &rect);
+};
+
+#endif /* encoder_h */
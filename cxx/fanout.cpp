@@ -0,0 +1,307 @@
+//
+//  fanout.cpp
+//  webview
+//
+//  Windowless frames shared by several consumers, each at its own rate and format
+//
+
+#include "fanout.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "metrics.h"
+#include "watchdog.h"
+
+static void CopyFrame(const Frame &frame, FrameFormat format, uint8_t *dst)
+{
+    size_t row = static_cast<size_t>(frame.width) * 4;
+    auto src = static_cast<const uint8_t *>(frame.buffer);
+    for (uint32_t y = 0; y < frame.height; y++)
+    {
+        const uint8_t *line = src + static_cast<size_t>(y) * frame.stride;
+        uint8_t *out = dst + y * row;
+        if (format == WEW_FRAME_BGRA)
+        {
+            memcpy(out, line, row);
+            continue;
+        }
+
+        // Swapping blue and red as whole words vectorizes, unlike byte shuffles.
+        auto in_pixels = reinterpret_cast<const uint32_t *>(line);
+        auto out_pixels = reinterpret_cast<uint32_t *>(out);
+        for (uint32_t x = 0; x < frame.width; x++)
+        {
+            uint32_t pixel = in_pixels[x];
+            out_pixels[x] = (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+        }
+    }
+}
+
+/* IFramePool */
+
+IFramePool::IFramePool(IMemoryAccount *account) : _account(account)
+{
+}
+
+IFramePool::~IFramePool()
+{
+    for (auto frame : _idle)
+    {
+        Free(frame);
+    }
+}
+
+IPooledFrame *IFramePool::Acquire(size_t size)
+{
+    IPooledFrame *frame = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        while (!_idle.empty() && frame == nullptr)
+        {
+            frame = _idle.back();
+            _idle.pop_back();
+
+            // Snapshots of an old size are useless after a resize.
+            if (frame->data.size() != size)
+            {
+                Free(frame);
+                frame = nullptr;
+            }
+        }
+    }
+
+    if (frame == nullptr)
+    {
+        // Charged outside the lock, the evictor takes it.
+        if (_account != nullptr && !_account->Charge(WEW_MEMORY_FRAME_BUFFERS, size))
+        {
+            _account->Release(WEW_MEMORY_FRAME_BUFFERS, size);
+
+            return nullptr;
+        }
+
+        frame = new IPooledFrame();
+        frame->data.resize(size);
+    }
+
+    frame->refs.store(1, std::memory_order_relaxed);
+    frame->pool = shared_from_this();
+
+    return frame;
+}
+
+void IFramePool::Retain(IPooledFrame *frame)
+{
+    frame->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void IFramePool::Release(IPooledFrame *frame)
+{
+    if (frame->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+
+    // The frame's reference may be the last one to the pool, keep it alive until Recycle returns.
+    auto pool = std::move(frame->pool);
+    pool->Recycle(frame);
+}
+
+uint64_t IFramePool::Evict(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    uint64_t freed = 0;
+    while (!_idle.empty() && freed < bytes)
+    {
+        freed += _idle.back()->data.size();
+        Free(_idle.back());
+        _idle.pop_back();
+    }
+
+    return freed;
+}
+
+void IFramePool::Detach()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _account = nullptr;
+}
+
+void IFramePool::Recycle(IPooledFrame *frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_idle.size() < MAX_IDLE)
+    {
+        _idle.push_back(frame);
+    }
+    else
+    {
+        Free(frame);
+    }
+}
+
+void IFramePool::Free(IPooledFrame *frame)
+{
+    if (_account != nullptr)
+    {
+        _account->Release(WEW_MEMORY_FRAME_BUFFERS, frame->data.size());
+    }
+
+    delete frame;
+}
+
+/* IFrameFanout */
+
+IFrameFanout::IFrameFanout(IMemoryAccount *account) : _pool(std::make_shared<IFramePool>(account))
+{
+    if (account != nullptr)
+    {
+        std::weak_ptr<IFramePool> pool = _pool;
+        account->SetEvictor(WEW_MEMORY_FRAME_BUFFERS, [pool](uint64_t bytes) -> uint64_t {
+            auto it = pool.lock();
+            return it != nullptr ? it->Evict(bytes) : 0;
+        });
+    }
+}
+
+IFrameFanout::~IFrameFanout()
+{
+    _pool->Detach();
+}
+
+void IFrameFanout::Detach()
+{
+    _pool->Detach();
+}
+
+int IFrameFanout::Subscribe(const FrameConsumer *consumer)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    int id = _next_id++;
+    _consumers.push_back({id, *consumer, std::chrono::steady_clock::now(), 0, false});
+    _count.fetch_add(1, std::memory_order_relaxed);
+
+    return id;
+}
+
+void IFrameFanout::Unsubscribe(int id)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    for (auto it = _consumers.begin(); it != _consumers.end(); it++)
+    {
+        if (it->id != id || it->removed)
+        {
+            continue;
+        }
+
+        // A dispatch in progress on this thread is iterating the list, it compacts it when done.
+        if (_dispatching)
+        {
+            it->removed = true;
+        }
+        else
+        {
+            _consumers.erase(it);
+        }
+
+        _count.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+}
+
+bool IFrameFanout::HasConsumers()
+{
+    return _count.load(std::memory_order_relaxed) > 0;
+}
+
+void IFrameFanout::Dispatch(const Frame &frame)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    auto now = std::chrono::steady_clock::now();
+    uint64_t sequence = ++_sequence;
+    size_t size = static_cast<size_t>(frame.width) * frame.height * 4;
+
+    _everything = {0, 0, static_cast<int>(frame.width), static_cast<int>(frame.height)};
+    IPooledFrame *snapshots[WEW_FRAME_FORMAT_COUNT] = {};
+
+    _dispatching = true;
+
+    // Consumers added from a callback wait for the next frame.
+    size_t count = _consumers.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        auto &consumer = _consumers[i];
+        if (consumer.removed)
+        {
+            continue;
+        }
+
+        if (consumer.config.max_fps > 0)
+        {
+            if (now < consumer.next)
+            {
+                continue;
+            }
+
+            // Keep the cadence, unless the consumer fell behind by more than a frame.
+            auto interval = std::chrono::nanoseconds(1000000000 / consumer.config.max_fps);
+            consumer.next = now - consumer.next > interval ? now + interval : consumer.next + interval;
+        }
+
+        auto format = consumer.config.format;
+        if (snapshots[format] == nullptr)
+        {
+            snapshots[format] = _pool->Acquire(size);
+            if (snapshots[format] == nullptr)
+            {
+                IMetrics::Add(MetricCounter::FramesDropped);
+                continue;
+            }
+
+            CopyFrame(frame, format, snapshots[format]->data.data());
+        }
+
+        // Damage and moves are relative to the previous frame, a consumer that skipped it gets the whole frame.
+        bool consecutive = consumer.last_sequence + 1 == sequence;
+        consumer.last_sequence = sequence;
+
+        Frame output = frame;
+        output.buffer = snapshots[format]->data.data();
+        output.stride = frame.width * 4;
+        output.buffer_index = -1;
+        output.shared = snapshots[format];
+        if (!consecutive)
+        {
+            output.dirty_rects = &_everything;
+            output.dirty_rects_count = 1;
+            output.moves = nullptr;
+            output.moves_count = 0;
+        }
+
+        IWatchdog::Call(HostCallback::OnFrameConsumer, consumer.config.on_frame, &output, consumer.config.context);
+    }
+
+    _dispatching = false;
+
+    _consumers.erase(std::remove_if(_consumers.begin(),
+                                    _consumers.end(),
+                                    [](const Consumer &consumer) { return consumer.removed; }),
+                     _consumers.end());
+
+    for (auto snapshot : snapshots)
+    {
+        if (snapshot != nullptr)
+        {
+            IFramePool::Release(snapshot);
+        }
+    }
+}
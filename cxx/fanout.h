@@ -0,0 +1,123 @@
+//
+//  fanout.h
+//  webview
+//
+//  Windowless frames shared by several consumers, each at its own rate and format
+//
+
+#ifndef fanout_h
+#define fanout_h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "accounting.h"
+#include "wew.h"
+
+class IFramePool;
+
+///
+/// An immutable frame snapshot shared by the consumers that received it.
+///
+struct IPooledFrame
+{
+    std::atomic<uint32_t> refs{0};
+    std::vector<uint8_t> data;
+
+    ///
+    /// Keeps the pool alive while the frame is out, null while the frame is idle in the pool.
+    ///
+    std::shared_ptr<IFramePool> pool;
+};
+
+///
+/// Recycles frame snapshots once their last reference is released. Idle snapshots are the pool's to evict, the ones
+/// out with consumers are only accounted.
+///
+class IFramePool : public std::enable_shared_from_this<IFramePool>
+{
+  public:
+    IFramePool(IMemoryAccount *account);
+    ~IFramePool();
+
+    ///
+    /// Returns a snapshot of the given size holding one reference, or nullptr when the frame budget is exhausted.
+    ///
+    IPooledFrame *Acquire(size_t size);
+
+    static void Retain(IPooledFrame *frame);
+    static void Release(IPooledFrame *frame);
+
+    ///
+    /// Frees idle snapshots, returns the bytes freed.
+    ///
+    uint64_t Evict(uint64_t bytes);
+
+    ///
+    /// Stops accounting, the account goes away with the webview while snapshots may still be out.
+    ///
+    void Detach();
+
+  private:
+    ///
+    /// Idle snapshots kept for reuse, enough for a few consumers holding on to one frame each.
+    ///
+    static const size_t MAX_IDLE = 4;
+
+    std::mutex _mutex;
+    std::vector<IPooledFrame *> _idle;
+    IMemoryAccount *_account;
+
+    void Recycle(IPooledFrame *frame);
+    void Free(IPooledFrame *frame);
+};
+
+class IFrameFanout
+{
+  public:
+    IFrameFanout(IMemoryAccount *account);
+    ~IFrameFanout();
+
+    int Subscribe(const FrameConsumer *consumer);
+    void Unsubscribe(int id);
+    bool HasConsumers();
+
+    ///
+    /// Stops accounting snapshots that are still out once the webview is gone.
+    ///
+    void Detach();
+
+    ///
+    /// Hands a view frame to every consumer that is due, converting it once per format that is needed.
+    ///
+    void Dispatch(const Frame &frame);
+
+  private:
+    struct Consumer
+    {
+        int id;
+        FrameConsumer config;
+        std::chrono::steady_clock::time_point next;
+        uint64_t last_sequence;
+        bool removed;
+    };
+
+    // Held while dispatching, so a consumer is never called once Unsubscribe returned on another thread, and
+    // recursive so consumers can unsubscribe from their own callback.
+    std::recursive_mutex _mutex;
+    std::vector<Consumer> _consumers;
+    std::atomic<size_t> _count{0};
+    std::shared_ptr<IFramePool> _pool;
+    int _next_id = 0;
+    uint64_t _sequence = 0;
+    bool _dispatching = false;
+
+    // The whole frame as damage, for the consumers that missed the previous one.
+    Rect _everything = {};
+};
+
+#endif /* fanout_h */
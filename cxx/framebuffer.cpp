@@ -0,0 +1,126 @@
+//
+//  framebuffer.cpp
+//  webview
+//
+//  Host registered frame buffers that windowless paints are copied into directly
+//
+
+#include "framebuffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+static void CopyRect(const CefRect &rect, const uint8_t *src, int width, int height, const FrameBuffer &dst)
+{
+    int x = std::max(rect.x, 0);
+    int y = std::max(rect.y, 0);
+    int right = std::min(rect.x + rect.width, width);
+    int bottom = std::min(rect.y + rect.height, height);
+    if (right <= x || bottom <= y)
+    {
+        return;
+    }
+
+    size_t src_stride = static_cast<size_t>(width) * 4;
+    size_t row = static_cast<size_t>(right - x) * 4;
+    for (int i = y; i < bottom; i++)
+    {
+        memcpy(static_cast<uint8_t *>(dst.data) + i * dst.stride + x * 4, src + i * src_stride + x * 4, row);
+    }
+}
+
+void IFrameBuffers::Set(const FrameBuffer *buffers, size_t count)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _slots.clear();
+    _slots.resize(count);
+    _next = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        _slots[i].buffer = buffers[i];
+    }
+}
+
+void IFrameBuffers::Release(uint32_t index)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (index < _slots.size())
+    {
+        _slots[index].busy = false;
+    }
+}
+
+bool IFrameBuffers::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    return !_slots.empty();
+}
+
+int IFrameBuffers::Write(const CefRenderHandler::RectList &dirty_rects,
+                         const void *buffer,
+                         int width,
+                         int height,
+                         FrameBuffer *output)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto &slot : _slots)
+    {
+        if (slot.stale)
+        {
+            continue;
+        }
+
+        if (slot.damage.size() + dirty_rects.size() > MAX_DAMAGE_RECTS)
+        {
+            slot.stale = true;
+            slot.damage.clear();
+        }
+        else
+        {
+            slot.damage.insert(slot.damage.end(), dirty_rects.begin(), dirty_rects.end());
+        }
+    }
+
+    size_t row = static_cast<size_t>(width) * 4;
+    for (size_t n = 0; n < _slots.size(); n++)
+    {
+        size_t index = (_next + n) % _slots.size();
+        auto &slot = _slots[index];
+        if (slot.busy || slot.buffer.stride < row || slot.buffer.size < slot.buffer.stride * height)
+        {
+            continue;
+        }
+
+        auto src = static_cast<const uint8_t *>(buffer);
+        if (slot.stale || slot.width != width || slot.height != height)
+        {
+            CopyRect(CefRect(0, 0, width, height), src, width, height, slot.buffer);
+        }
+        else
+        {
+            for (auto &rect : slot.damage)
+            {
+                CopyRect(rect, src, width, height, slot.buffer);
+            }
+        }
+
+        slot.busy = true;
+        slot.stale = false;
+        slot.width = width;
+        slot.height = height;
+        slot.damage.clear();
+
+        _next = index + 1;
+        *output = slot.buffer;
+
+        return static_cast<int>(index);
+    }
+
+    return -1;
+}
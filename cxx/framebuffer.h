@@ -0,0 +1,77 @@
+//
+//  framebuffer.h
+//  webview
+//
+//  Host registered frame buffers that windowless paints are copied into directly
+//
+
+#ifndef framebuffer_h
+#define framebuffer_h
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "include/cef_client.h"
+
+#include "wew.h"
+
+///
+/// The host buffers of a view, used round robin. A buffer handed to the host stays busy until it is released.
+///
+/// Every buffer keeps the damage it has not seen yet, so writing a buffer only copies what changed since that
+/// buffer was last written instead of the whole frame.
+///
+class IFrameBuffers
+{
+  public:
+    ///
+    /// Replaces the registered buffers, an empty list disables host buffers.
+    ///
+    void Set(const FrameBuffer *buffers, size_t count);
+
+    ///
+    /// Returns a buffer handed out by Write to the free list.
+    ///
+    void Release(uint32_t index);
+
+    bool IsEnabled();
+
+    ///
+    /// Brings the next free buffer up to date with the view buffer and marks it busy.
+    ///
+    /// Returns the index of the written buffer, or -1 when no buffer is free or large enough, the damage is then
+    /// kept for the next write.
+    ///
+    int Write(const CefRenderHandler::RectList &dirty_rects,
+              const void *buffer,
+              int width,
+              int height,
+              FrameBuffer *output);
+
+  private:
+    ///
+    /// Above this many pending rects a buffer is rewritten as a whole.
+    ///
+    static const size_t MAX_DAMAGE_RECTS = 32;
+
+    struct Slot
+    {
+        FrameBuffer buffer;
+        bool busy = false;
+
+        ///
+        /// The whole buffer is stale, such as after a resize or too many small updates.
+        ///
+        bool stale = true;
+        int width = 0;
+        int height = 0;
+        std::vector<CefRect> damage;
+    };
+
+    std::mutex _mutex;
+    std::vector<Slot> _slots;
+    size_t _next = 0;
+};
+
+#endif /* framebuffer_h */
@@ -0,0 +1,180 @@
+//
+//  metrics.cpp
+//  webview
+//
+//  Process wide counters and histograms recorded by the browser side subsystems
+//
+
+#include "metrics.h"
+
+struct IMetricInfo
+{
+    const char *name;
+    const char *help;
+};
+
+static const IMetricInfo COUNTERS[] = {
+    {"wew_frames_total", "Frames delivered through on_frame, including popups."},
+    {"wew_frame_bytes_total", "Bytes of BGRA frame buffers delivered through on_frame."},
+    {"wew_frames_dropped_total", "Frames dropped because no host frame buffer was free or the frame budget was exhausted."},
+    {"wew_frames_encoded_total", "Frames encoded by the video encoder."},
+    {"wew_encoded_bytes_total", "Bytes of packets delivered by the video encoder."},
+    {"wew_resource_handlers_total", "Resource handlers created by the request handler factory."},
+    {"wew_resource_requests_unhandled_total", "Requests the request handler factory declined."},
+    {"wew_cookie_operations_total", "Cookie manager operations."},
+    {"wew_tasks_posted_total", "Tasks posted to the main thread."},
+    {"wew_bus_messages_forwarded_total", "Messages the message bus forwarded to a subscribed page."},
+    {"wew_api_connections_total", "Connections opened to the app-api socket."},
+    {"wew_api_requests_total", "Requests proxied to the app-api socket."},
+    {"wew_blob_requests_total", "Requests served from a registered blob."},
+};
+
+static const IMetricInfo HISTOGRAMS[] = {
+    {"wew_frame_dirty_pixels", "Area of the dirty rects of a painted frame."},
+    {"wew_message_sent_bytes", "Size of the messages sent to the page."},
+    {"wew_message_received_bytes", "Size of the messages received from the page."},
+    {"wew_resource_read_bytes", "Bytes returned by a single resource handler read."},
+    {"wew_cookie_operation_duration_ns", "Time from posting a cookie operation to the IO thread until it completes."},
+    {"wew_task_queue_duration_ns", "Time a task posted to the main thread waits before it runs."},
+    {"wew_request_queue_duration_ns", "Time a request handler call waits for a request thread."},
+    {"wew_callback_on_context_initialized_duration_ns", "Time spent in RuntimeHandler::on_context_initialized."},
+    {"wew_callback_on_schedule_message_pump_work_duration_ns",
+     "Time spent in RuntimeHandler::on_schedule_message_pump_work."},
+    {"wew_callback_on_cursor_duration_ns", "Time spent in WebViewHandler::on_cursor."},
+    {"wew_callback_on_cursor_image_duration_ns", "Time spent in WebViewHandler::on_cursor_image."},
+    {"wew_callback_on_state_change_duration_ns", "Time spent in WebViewHandler::on_state_change."},
+    {"wew_callback_on_ime_rect_duration_ns", "Time spent in WebViewHandler::on_ime_rect."},
+    {"wew_callback_on_frame_duration_ns", "Time spent in WebViewHandler::on_frame."},
+    {"wew_callback_frame_consumer_on_frame_duration_ns", "Time spent in FrameConsumer::on_frame."},
+    {"wew_callback_video_encoder_on_packet_duration_ns", "Time spent in VideoEncoderSettings::on_packet."},
+    {"wew_callback_on_title_change_duration_ns", "Time spent in WebViewHandler::on_title_change."},
+    {"wew_callback_on_fullscreen_change_duration_ns", "Time spent in WebViewHandler::on_fullscreen_change."},
+    {"wew_callback_on_message_duration_ns", "Time spent in WebViewHandler::on_message."},
+    {"wew_callback_ring_on_ready_duration_ns", "Time spent in RingSettings::on_ready."},
+    {"wew_callback_bus_on_message_duration_ns", "Time spent in BusObserver::on_message."},
+    {"wew_callback_blob_release_duration_ns", "Time spent in the release callback of a blob."},
+    {"wew_callback_directory_on_change_duration_ns", "Time spent in DirectoryObserver::on_change."},
+    {"wew_callback_request_handler_factory_request_duration_ns", "Time spent in RequestHandlerFactory::request."},
+    {"wew_callback_request_handler_factory_destroy_duration_ns",
+     "Time spent in RequestHandlerFactory::destroy_request_handler."},
+    {"wew_callback_request_handler_open_duration_ns", "Time spent in RequestHandler::open."},
+    {"wew_callback_request_handler_get_response_duration_ns", "Time spent in RequestHandler::get_response."},
+    {"wew_callback_request_handler_skip_duration_ns", "Time spent in RequestHandler::skip."},
+    {"wew_callback_request_handler_read_duration_ns", "Time spent in RequestHandler::read."},
+    {"wew_callback_request_handler_cancel_duration_ns", "Time spent in RequestHandler::cancel."},
+    {"wew_callback_request_handler_destroy_duration_ns", "Time spent in RequestHandler::destroy."},
+    {"wew_callback_cookie_visitor_visit_duration_ns", "Time spent in CookieVisitor::visit."},
+    {"wew_callback_cookie_visitor_destroy_duration_ns", "Time spent in CookieVisitor::destroy."},
+    {"wew_callback_task_duration_ns", "Time spent in tasks posted to the main thread."},
+};
+
+static_assert(sizeof(COUNTERS) / sizeof(IMetricInfo) == static_cast<size_t>(MetricCounter::Count));
+static_assert(sizeof(HISTOGRAMS) / sizeof(IMetricInfo) == static_cast<size_t>(MetricHistogram::Count));
+
+IMetrics::Shard IMetrics::_shards[IMetrics::SHARDS] = {};
+
+std::atomic<size_t> IMetrics::_next_shard{0};
+
+const uint64_t IMetrics::_bases[] = {
+    1024, // FrameDirtyPixels
+    64,   // MessageSentBytes
+    64,   // MessageReceivedBytes
+    64,   // ResourceReadBytes
+    1000, // CookieOperationDuration
+    1000, // TaskQueueDuration
+    1000, // RequestQueueDuration
+};
+
+size_t IMetrics::Snapshot(Metric *metrics, size_t capacity)
+{
+    size_t counters = static_cast<size_t>(MetricCounter::Count);
+    size_t histograms = static_cast<size_t>(MetricHistogram::Count);
+
+    for (size_t i = 0; i < counters + histograms && i < capacity; i++)
+    {
+        Metric &metric = metrics[i];
+        metric = {};
+
+        if (i < counters)
+        {
+            metric.name = COUNTERS[i].name;
+            metric.help = COUNTERS[i].help;
+            metric.kind = WEW_METRIC_COUNTER;
+
+            for (auto &shard : _shards)
+            {
+                metric.count += shard.counters[i].load(std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            size_t index = i - counters;
+
+            metric.name = HISTOGRAMS[index].name;
+            metric.help = HISTOGRAMS[index].help;
+            metric.kind = WEW_METRIC_HISTOGRAM;
+
+            uint64_t bound = GetBase(static_cast<MetricHistogram>(index));
+            for (size_t bucket = 0; bucket < WEW_METRIC_BUCKETS; bucket++)
+            {
+                metric.bounds[bucket] = bucket == WEW_METRIC_BUCKETS - 1 ? UINT64_MAX : bound;
+                bound <<= 2;
+            }
+
+            // The count is derived from the buckets so that it always matches their total, even while other
+            // threads keep recording.
+            for (auto &shard : _shards)
+            {
+                auto &histogram = shard.histograms[index];
+                for (size_t bucket = 0; bucket < WEW_METRIC_BUCKETS; bucket++)
+                {
+                    uint64_t value = histogram.buckets[bucket].load(std::memory_order_relaxed);
+                    metric.buckets[bucket] += value;
+                    metric.count += value;
+                }
+
+                metric.sum += histogram.sum.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    return counters + histograms;
+}
+
+std::string IMetrics::Prometheus()
+{
+    Metric metrics[static_cast<size_t>(MetricCounter::Count) + static_cast<size_t>(MetricHistogram::Count)];
+    size_t size = Snapshot(metrics, sizeof(metrics) / sizeof(Metric));
+
+    std::string text;
+    for (size_t i = 0; i < size; i++)
+    {
+        const Metric &metric = metrics[i];
+        std::string name = metric.name;
+
+        text += "# HELP " + name + " " + metric.help + "\n";
+
+        if (metric.kind == WEW_METRIC_COUNTER)
+        {
+            text += "# TYPE " + name + " counter\n";
+            text += name + " " + std::to_string(metric.count) + "\n";
+            continue;
+        }
+
+        text += "# TYPE " + name + " histogram\n";
+
+        uint64_t cumulative = 0;
+        for (size_t bucket = 0; bucket < WEW_METRIC_BUCKETS; bucket++)
+        {
+            cumulative += metric.buckets[bucket];
+
+            std::string le = metric.bounds[bucket] == UINT64_MAX ? "+Inf" : std::to_string(metric.bounds[bucket]);
+            text += name + "_bucket{le=\"" + le + "\"} " + std::to_string(cumulative) + "\n";
+        }
+
+        text += name + "_sum " + std::to_string(metric.sum) + "\n";
+        text += name + "_count " + std::to_string(metric.count) + "\n";
+    }
+
+    return text;
+}
@@ -0,0 +1,187 @@
+//
+//  metrics.h
+//  webview
+//
+//  Process wide counters and histograms recorded by the browser side subsystems
+//
+
+#ifndef metrics_h
+#define metrics_h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "wew.h"
+
+///
+/// Monotonic counters.
+///
+enum class MetricCounter : size_t
+{
+    Frames,
+    FrameBytes,
+    FramesDropped,
+    FramesEncoded,
+    EncodedBytes,
+    ResourceHandlers,
+    ResourceRequestsUnhandled,
+    CookieOperations,
+    TasksPosted,
+    BusMessagesForwarded,
+    ApiConnections,
+    ApiRequests,
+    BlobRequests,
+    Count,
+};
+
+///
+/// Host callbacks invoked by the library, each one has its own duration histogram.
+///
+enum class HostCallback : size_t
+{
+    OnContextInitialized,
+    OnScheduleMessagePumpWork,
+    OnCursor,
+    OnCursorImage,
+    OnStateChange,
+    OnImeRect,
+    OnFrame,
+    OnFrameConsumer,
+    OnEncodedPacket,
+    OnTitleChange,
+    OnFullscreenChange,
+    OnMessage,
+    OnRingReady,
+    OnBusMessage,
+    BlobRelease,
+    OnDirectoryChange,
+    RequestHandlerFactoryRequest,
+    RequestHandlerFactoryDestroy,
+    RequestHandlerOpen,
+    RequestHandlerGetResponse,
+    RequestHandlerSkip,
+    RequestHandlerRead,
+    RequestHandlerCancel,
+    RequestHandlerDestroy,
+    CookieVisitorVisit,
+    CookieVisitorDestroy,
+    Task,
+    Count,
+};
+
+///
+/// Fixed bucket histograms, bucket bounds grow by a factor of 4 from a per histogram base.
+///
+enum class MetricHistogram : size_t
+{
+    FrameDirtyPixels,
+    MessageSentBytes,
+    MessageReceivedBytes,
+    ResourceReadBytes,
+    CookieOperationDuration,
+    TaskQueueDuration,
+    RequestQueueDuration,
+
+    ///
+    /// First of the per host callback duration histograms, in HostCallback order.
+    ///
+    CallbackDuration,
+    Count = CallbackDuration + static_cast<size_t>(HostCallback::Count),
+};
+
+class IMetrics
+{
+  public:
+    ///
+    /// Number of independent copies of every metric, a thread always writes to the same shard so concurrent writers
+    /// rarely share a cache line. Must be a power of two.
+    ///
+    static const size_t SHARDS = 16;
+
+    static void Add(MetricCounter counter, uint64_t value = 1)
+    {
+        GetShard().counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static void Observe(HostCallback callback, uint64_t duration)
+    {
+        Observe(static_cast<MetricHistogram>(static_cast<size_t>(MetricHistogram::CallbackDuration) +
+                                             static_cast<size_t>(callback)),
+                duration);
+    }
+
+    static void Observe(MetricHistogram histogram, uint64_t value)
+    {
+        auto &it = GetShard().histograms[static_cast<size_t>(histogram)];
+        it.buckets[GetBucket(histogram, value)].fetch_add(1, std::memory_order_relaxed);
+        it.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    ///
+    /// Nanoseconds elapsed since the given time point, for the duration histograms.
+    ///
+    static uint64_t Elapsed(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    ///
+    /// Merges all shards into the flat metric array, returns the total number of metrics which may exceed capacity.
+    ///
+    static size_t Snapshot(Metric *metrics, size_t capacity);
+
+    ///
+    /// Renders all metrics in the Prometheus text exposition format.
+    ///
+    static std::string Prometheus();
+
+  private:
+    struct Histogram
+    {
+        std::atomic<uint64_t> buckets[WEW_METRIC_BUCKETS];
+        std::atomic<uint64_t> sum;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> counters[static_cast<size_t>(MetricCounter::Count)];
+        Histogram histograms[static_cast<size_t>(MetricHistogram::Count)];
+    };
+
+    static Shard _shards[SHARDS];
+    static const uint64_t _bases[static_cast<size_t>(MetricHistogram::CallbackDuration)];
+    static std::atomic<size_t> _next_shard;
+
+    static Shard &GetShard()
+    {
+        static thread_local size_t index = _next_shard.fetch_add(1, std::memory_order_relaxed) & (SHARDS - 1);
+
+        return _shards[index];
+    }
+
+    ///
+    /// Upper bound of the first bucket, callback durations all start at 1us.
+    ///
+    static uint64_t GetBase(MetricHistogram histogram)
+    {
+        return histogram < MetricHistogram::CallbackDuration ? _bases[static_cast<size_t>(histogram)] : 1000;
+    }
+
+    static size_t GetBucket(MetricHistogram histogram, uint64_t value)
+    {
+        uint64_t bound = GetBase(histogram);
+
+        size_t bucket = 0;
+        while (bucket < WEW_METRIC_BUCKETS - 1 && value > bound)
+        {
+            bound <<= 2;
+            bucket += 1;
+        }
+
+        return bucket;
+    }
+};
+
+#endif /* metrics_h */
@@ -0,0 +1,1569 @@
+//
+//  cef_mock.cpp
+//  webview
+//
+//  In-process implementation of the CEF mock
+//
+
+#include "cef_mock.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    class FunctionTask : public CefTask
+    {
+      public:
+        FunctionTask(std::function<void()> func) : _func(std::move(func))
+        {
+        }
+
+        void Execute() override
+        {
+            _func();
+        }
+
+      private:
+        std::function<void()> _func;
+
+        IMPLEMENT_REFCOUNTING(FunctionTask);
+    };
+
+    class TaskQueue
+    {
+      public:
+        using Clock = std::chrono::steady_clock;
+
+        ~TaskQueue()
+        {
+            Stop();
+        }
+
+        void StartWorker()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_worker.joinable())
+            {
+                return;
+            }
+
+            _worker = std::thread([this]() {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _thread_id = std::this_thread::get_id();
+                }
+
+                _cv.notify_all();
+                Run([]() { return false; });
+            });
+
+            // Make sure CefCurrentlyOn sees the worker before anything is posted to it.
+            std::unique_lock<std::mutex> lock_id(_mutex, std::adopt_lock);
+            _cv.wait(lock_id, [this]() { return _thread_id != std::thread::id(); });
+            lock_id.release();
+        }
+
+        bool HasWorker()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _worker.joinable();
+        }
+
+        void SetThreadId(std::thread::id id)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _thread_id = id;
+        }
+
+        bool IsCurrent()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _thread_id == std::this_thread::get_id();
+        }
+
+        void Post(CefRefPtr<CefTask> task, int64_t delay_ms)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _tasks.push_back({Clock::now() + std::chrono::milliseconds(delay_ms), std::move(task)});
+            }
+
+            _cv.notify_all();
+        }
+
+        ///
+        /// Execute every task that is due, returns the number executed.
+        ///
+        size_t RunPending()
+        {
+            std::deque<Entry> due;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                TakeDue(due);
+            }
+
+            for (auto &entry : due)
+            {
+                _executed.fetch_add(1, std::memory_order_relaxed);
+                entry.task->Execute();
+            }
+
+            return due.size();
+        }
+
+        ///
+        /// Keep executing tasks on the calling thread until |quit| returns true or the queue is stopped.
+        ///
+        void Run(std::function<bool()> quit)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stopped && !quit())
+            {
+                std::deque<Entry> due;
+                TakeDue(due);
+
+                if (due.empty())
+                {
+                    auto deadline = NextDeadline();
+                    _cv.wait_until(lock, deadline);
+                    continue;
+                }
+
+                lock.unlock();
+                for (auto &entry : due)
+                {
+                    _executed.fetch_add(1, std::memory_order_relaxed);
+                    entry.task->Execute();
+                }
+
+                lock.lock();
+            }
+        }
+
+        uint64_t GetExecutedCount() const
+        {
+            return _executed.load(std::memory_order_relaxed);
+        }
+
+        void Wake()
+        {
+            _cv.notify_all();
+        }
+
+        void Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopped = true;
+            }
+
+            _cv.notify_all();
+            if (_worker.joinable() && _worker.get_id() != std::this_thread::get_id())
+            {
+                _worker.join();
+            }
+        }
+
+      private:
+        struct Entry
+        {
+            Clock::time_point due;
+            CefRefPtr<CefTask> task;
+        };
+
+        void TakeDue(std::deque<Entry> &due)
+        {
+            auto now = Clock::now();
+            for (auto it = _tasks.begin(); it != _tasks.end();)
+            {
+                if (it->due <= now)
+                {
+                    due.push_back(std::move(*it));
+                    it = _tasks.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        Clock::time_point NextDeadline()
+        {
+            auto deadline = Clock::now() + std::chrono::milliseconds(100);
+            for (auto &entry : _tasks)
+            {
+                deadline = std::min(deadline, entry.due);
+            }
+
+            return deadline;
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::deque<Entry> _tasks;
+        std::thread _worker;
+        std::thread::id _thread_id;
+        std::atomic<uint64_t> _executed = 0;
+        bool _stopped = false;
+    };
+
+    class Browser;
+
+    struct State
+    {
+        std::mutex mutex;
+        TaskQueue queues[TID_NUM_VALUES];
+        CefRefPtr<CefApp> browser_app;
+        CefRefPtr<CefApp> render_app;
+        CefSettings settings;
+        bool initialized = false;
+        std::atomic<bool> quit = false;
+        int next_browser_id = 1;
+        std::map<int, CefRefPtr<Browser>> browsers;
+        std::map<int, CefRefPtr<CefV8Context>> contexts;
+        std::map<std::pair<std::string, std::string>, CefRefPtr<CefSchemeHandlerFactory>> scheme_factories;
+        CefRefPtr<CefCookieManager> cookie_manager;
+
+        ~State()
+        {
+            for (auto &queue : queues)
+            {
+                queue.Stop();
+            }
+        }
+    };
+
+    State &GetState()
+    {
+        static State state;
+        return state;
+    }
+
+    TaskQueue &GetQueue(CefThreadId thread_id)
+    {
+        auto &queue = GetState().queues[thread_id];
+
+        // Every thread except UI is a worker, UI is pumped by the message loop functions unless the runtime asked
+        // for a multi-threaded message loop.
+        if (thread_id != TID_UI && !queue.HasWorker())
+        {
+            queue.StartWorker();
+        }
+
+        return queue;
+    }
+
+    void Post(CefThreadId thread_id, std::function<void()> func)
+    {
+        CefPostTask(thread_id, new FunctionTask(std::move(func)));
+    }
+
+    class Frame : public CefFrame
+    {
+      public:
+        Frame(CefRawPtr<Browser> browser, const std::string &url) : _browser(browser), _url(url)
+        {
+        }
+
+        bool IsValid() override
+        {
+            return true;
+        }
+
+        bool IsMain() override
+        {
+            return true;
+        }
+
+        CefString GetURL() override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _url;
+        }
+
+        void LoadURL(const CefString &url) override;
+        CefRefPtr<CefBrowser> GetBrowser() override;
+        void SendProcessMessage(CefProcessId target_process, CefRefPtr<CefProcessMessage> message) override;
+
+      private:
+        CefRawPtr<Browser> _browser;
+        std::mutex _mutex;
+        std::string _url;
+
+        IMPLEMENT_REFCOUNTING(Frame);
+    };
+
+    class Browser : public CefBrowser
+    {
+      public:
+        Browser(int id,
+                CefRefPtr<CefClient> client,
+                const CefWindowInfo &window_info,
+                const CefBrowserSettings &settings,
+                const std::string &url)
+            : _id(id)
+        {
+            _host = new cef_mock::BrowserHost(this, client, window_info, settings);
+            _frame = new Frame(this, url);
+        }
+
+        bool IsValid() override
+        {
+            return !_host->IsClosed();
+        }
+
+        int GetIdentifier() override
+        {
+            return _id;
+        }
+
+        CefRefPtr<CefBrowserHost> GetHost() override
+        {
+            return _host;
+        }
+
+        CefRefPtr<CefFrame> GetMainFrame() override
+        {
+            return _frame;
+        }
+
+        CefRefPtr<cef_mock::BrowserHost> GetMockHost()
+        {
+            return _host;
+        }
+
+        CefRefPtr<Frame> GetMockFrame()
+        {
+            return _frame;
+        }
+
+        void Load(const std::string &url);
+
+      private:
+        int _id;
+        CefRefPtr<cef_mock::BrowserHost> _host;
+        CefRefPtr<Frame> _frame;
+
+        IMPLEMENT_REFCOUNTING(Browser);
+    };
+
+    void Browser::Load(const std::string &url)
+    {
+        CefRefPtr<Browser> browser = this;
+        auto client = _host->GetClient();
+
+        Post(TID_UI, [browser, client]() {
+            if (auto handler = client->GetLoadHandler())
+            {
+                handler->OnLoadStart(browser, browser->GetMainFrame(), TT_EXPLICIT);
+            }
+        });
+
+        // The renderer creates a fresh context for every navigation.
+        Post(TID_RENDERER, [browser]() {
+            auto &state = GetState();
+            CefRefPtr<CefRenderProcessHandler> handler;
+            if (state.render_app)
+            {
+                handler = state.render_app->GetRenderProcessHandler();
+            }
+
+            CefRefPtr<CefV8Context> context = new CefV8Context(browser, browser->GetMainFrame());
+            CefRefPtr<CefV8Context> previous;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                previous = std::exchange(state.contexts[browser->GetIdentifier()], context);
+            }
+
+            if (previous)
+            {
+                if (handler)
+                {
+                    handler->OnContextReleased(browser, browser->GetMainFrame(), previous);
+                }
+
+                previous->Dispose();
+            }
+
+            if (handler)
+            {
+                context->Enter();
+                handler->OnContextCreated(browser, browser->GetMainFrame(), context);
+                context->Exit();
+            }
+        });
+
+        Post(TID_UI, [browser, client]() {
+            if (auto handler = client->GetLoadHandler())
+            {
+                handler->OnLoadEnd(browser, browser->GetMainFrame(), 200);
+            }
+        });
+    }
+
+    void Frame::LoadURL(const CefString &url)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _url = url.ToString();
+        }
+
+        _browser->Load(url.ToString());
+    }
+
+    CefRefPtr<CefBrowser> Frame::GetBrowser()
+    {
+        return _browser;
+    }
+
+    void Frame::SendProcessMessage(CefProcessId target_process, CefRefPtr<CefProcessMessage> message)
+    {
+        CefRefPtr<Browser> browser = _browser;
+        CefRefPtr<CefFrame> frame = this;
+
+        // Serialize the message like the IPC channel would, the sender must not observe the receiver's copy.
+        auto copy = message->Copy();
+
+        if (target_process == PID_RENDERER)
+        {
+            Post(TID_RENDERER, [browser, frame, copy]() {
+                auto &state = GetState();
+                if (!state.render_app)
+                {
+                    return;
+                }
+
+                if (auto handler = state.render_app->GetRenderProcessHandler())
+                {
+                    handler->OnProcessMessageReceived(browser, frame, PID_BROWSER, copy);
+                }
+            });
+        }
+        else
+        {
+            Post(TID_UI, [browser, frame, copy]() {
+                if (!browser->IsValid())
+                {
+                    return;
+                }
+
+                browser->GetHost()->GetClient()->OnProcessMessageReceived(browser, frame, PID_RENDERER, copy);
+            });
+        }
+    }
+
+    class SchemeRegistrar : public CefSchemeRegistrar
+    {
+      public:
+        bool AddCustomScheme(const CefString &scheme_name, int options) override
+        {
+            return !scheme_name.empty();
+        }
+    };
+
+    struct StoredCookie
+    {
+        std::string url;
+        CefCookie cookie;
+    };
+
+    class CookieManager : public CefCookieManager
+    {
+      public:
+        bool VisitAllCookies(CefRefPtr<CefCookieVisitor> visitor) override
+        {
+            return Visit(visitor, [](const StoredCookie &) { return true; });
+        }
+
+        bool VisitUrlCookies(const CefString &url, bool includeHttpOnly, CefRefPtr<CefCookieVisitor> visitor) override
+        {
+            std::string target = url.ToString();
+            return Visit(visitor, [&](const StoredCookie &it) {
+                return it.url == target && (includeHttpOnly || !it.cookie.httponly);
+            });
+        }
+
+        bool SetCookie(const CefString &url, const CefCookie &cookie, CefRefPtr<CefSetCookieCallback> callback) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                std::string target = url.ToString();
+                for (auto it = _cookies.begin(); it != _cookies.end(); ++it)
+                {
+                    if (it->url == target && it->cookie.name.str == cookie.name.str)
+                    {
+                        _cookies.erase(it);
+                        break;
+                    }
+                }
+
+                _cookies.push_back({target, cookie});
+            }
+
+            if (callback)
+            {
+                callback->OnComplete(true);
+            }
+
+            return true;
+        }
+
+        bool DeleteCookies(const CefString &url,
+                           const CefString &cookie_name,
+                           CefRefPtr<CefDeleteCookiesCallback> callback) override
+        {
+            int deleted = 0;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto it = _cookies.begin(); it != _cookies.end();)
+                {
+                    if ((url.empty() || it->url == url.ToString()) &&
+                        (cookie_name.empty() || it->cookie.name.str == cookie_name.ToString()))
+                    {
+                        it = _cookies.erase(it);
+                        deleted += 1;
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            if (callback)
+            {
+                callback->OnComplete(deleted);
+            }
+
+            return true;
+        }
+
+        bool FlushStore(CefRefPtr<CefCompletionCallback> callback) override
+        {
+            if (callback)
+            {
+                callback->OnComplete();
+            }
+
+            return true;
+        }
+
+      private:
+        template <class F> bool Visit(CefRefPtr<CefCookieVisitor> visitor, F filter)
+        {
+            std::vector<StoredCookie> matched;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (auto &it : _cookies)
+                {
+                    if (filter(it))
+                    {
+                        matched.push_back(it);
+                    }
+                }
+            }
+
+            int total = static_cast<int>(matched.size());
+            for (int i = 0; i < total; i++)
+            {
+                bool delete_cookie = false;
+                bool next = visitor->Visit(matched[i].cookie, i, total, delete_cookie);
+                if (delete_cookie)
+                {
+                    DeleteCookies(matched[i].url, &matched[i].cookie.name, nullptr);
+                }
+
+                if (!next)
+                {
+                    break;
+                }
+            }
+
+            return true;
+        }
+
+        std::mutex _mutex;
+        std::vector<StoredCookie> _cookies;
+
+        IMPLEMENT_REFCOUNTING(CookieManager);
+    };
+
+    thread_local std::vector<CefRefPtr<CefV8Context>> current_contexts;
+
+    class Waiter
+    {
+      public:
+        void Notify(int64_t value)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _value = value;
+                _ready = true;
+            }
+
+            _cv.notify_all();
+        }
+
+        int64_t Wait()
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]() { return _ready; });
+            _ready = false;
+            return _value;
+        }
+
+      private:
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        bool _ready = false;
+        int64_t _value = 0;
+    };
+
+    class Callback : public CefCallback
+    {
+      public:
+        Callback(std::shared_ptr<Waiter> waiter) : _waiter(waiter)
+        {
+        }
+
+        void Continue() override
+        {
+            _waiter->Notify(1);
+        }
+
+        void Cancel() override
+        {
+            _waiter->Notify(0);
+        }
+
+      private:
+        std::shared_ptr<Waiter> _waiter;
+
+        IMPLEMENT_REFCOUNTING(Callback);
+    };
+
+    class NativeHandler : public CefV8Handler
+    {
+      public:
+        NativeHandler(cef_mock::NativeFunction func) : _func(std::move(func))
+        {
+        }
+
+        bool Execute(const CefString &name,
+                     CefRefPtr<CefV8Value> object,
+                     const CefV8ValueList &arguments,
+                     CefRefPtr<CefV8Value> &retval,
+                     CefString &exception) override
+        {
+            retval = _func(arguments);
+            return true;
+        }
+
+      private:
+        cef_mock::NativeFunction _func;
+
+        IMPLEMENT_REFCOUNTING(NativeHandler);
+    };
+
+    class ReadCallback : public CefResourceReadCallback
+    {
+      public:
+        ReadCallback(std::shared_ptr<Waiter> waiter) : _waiter(waiter)
+        {
+        }
+
+        void Continue(int bytes_read) override
+        {
+            _waiter->Notify(bytes_read);
+        }
+
+      private:
+        std::shared_ptr<Waiter> _waiter;
+
+        IMPLEMENT_REFCOUNTING(ReadCallback);
+    };
+} // namespace
+
+/* cef_task.h */
+
+bool CefCurrentlyOn(CefThreadId thread_id)
+{
+    return GetState().queues[thread_id].IsCurrent();
+}
+
+bool CefPostTask(CefThreadId thread_id, CefRefPtr<CefTask> task)
+{
+    return CefPostDelayedTask(thread_id, task, 0);
+}
+
+bool CefPostDelayedTask(CefThreadId thread_id, CefRefPtr<CefTask> task, int64_t delay_ms)
+{
+    if (task == nullptr || thread_id >= TID_NUM_VALUES)
+    {
+        return false;
+    }
+
+    auto &state = GetState();
+    GetQueue(thread_id).Post(task, delay_ms);
+
+    if (thread_id == TID_UI && state.settings.external_message_pump && state.browser_app)
+    {
+        if (auto handler = state.browser_app->GetBrowserProcessHandler())
+        {
+            handler->OnScheduleMessagePumpWork(delay_ms);
+        }
+    }
+
+    return true;
+}
+
+/* cef_app.h */
+
+int CefExecuteProcess(const CefMainArgs &args, CefRefPtr<CefApp> application, void *windows_sandbox_info)
+{
+    auto &state = GetState();
+    state.render_app = application;
+
+    if (application)
+    {
+        SchemeRegistrar registrar;
+        application->OnRegisterCustomSchemes(&registrar);
+    }
+
+    return -1;
+}
+
+bool CefInitialize(const CefMainArgs &args,
+                   const CefSettings &settings,
+                   CefRefPtr<CefApp> application,
+                   void *windows_sandbox_info)
+{
+    auto &state = GetState();
+    if (state.initialized)
+    {
+        return false;
+    }
+
+    state.initialized = true;
+    state.settings = settings;
+    state.browser_app = application;
+
+    auto &ui = state.queues[TID_UI];
+    if (settings.multi_threaded_message_loop)
+    {
+        ui.StartWorker();
+    }
+    else
+    {
+        ui.SetThreadId(std::this_thread::get_id());
+    }
+
+    if (application)
+    {
+        application->OnBeforeCommandLineProcessing("", CefCommandLine::GetGlobalCommandLine());
+
+        SchemeRegistrar registrar;
+        application->OnRegisterCustomSchemes(&registrar);
+
+        if (auto handler = application->GetBrowserProcessHandler())
+        {
+            handler->OnBeforeChildProcessLaunch(CefCommandLine::GetGlobalCommandLine());
+            Post(TID_UI, [handler]() { handler->OnContextInitialized(); });
+        }
+    }
+
+    return true;
+}
+
+int CefGetExitCode()
+{
+    return 0;
+}
+
+void CefShutdown()
+{
+    cef_mock::Settle();
+}
+
+void CefDoMessageLoopWork()
+{
+    cef_mock::RunPendingTasks();
+}
+
+void CefRunMessageLoop()
+{
+    auto &state = GetState();
+    state.quit = false;
+    state.queues[TID_UI].Run([&state]() { return state.quit.load(); });
+}
+
+void CefQuitMessageLoop()
+{
+    auto &state = GetState();
+    state.quit = true;
+    state.queues[TID_UI].Wake();
+}
+
+/* cef_browser.h */
+
+bool CefBrowserHost::CreateBrowser(const CefWindowInfo &windowInfo,
+                                   CefRefPtr<CefClient> client,
+                                   const CefString &url,
+                                   const CefBrowserSettings &settings,
+                                   CefRefPtr<CefDictionaryValue> extra_info,
+                                   CefRefPtr<CefRequestContext> request_context)
+{
+    auto &state = GetState();
+    if (!state.initialized || client == nullptr)
+    {
+        return false;
+    }
+
+    CefRefPtr<Browser> browser;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        int id = state.next_browser_id++;
+        browser = new Browser(id, client, windowInfo, settings, url.ToString());
+        state.browsers[id] = browser;
+    }
+
+    Post(TID_UI, [browser, client]() {
+        if (auto handler = client->GetLifeSpanHandler())
+        {
+            handler->OnAfterCreated(browser);
+        }
+    });
+
+    // The extra info is copied to the renderer, which hears of the browser before its first context.
+    auto copy = extra_info != nullptr ? extra_info->Copy(false) : nullptr;
+
+    Post(TID_RENDERER, [browser, copy]() {
+        auto &state = GetState();
+        if (!state.render_app)
+        {
+            return;
+        }
+
+        if (auto handler = state.render_app->GetRenderProcessHandler())
+        {
+            handler->OnBrowserCreated(browser, copy);
+        }
+    });
+
+    browser->Load(url.ToString());
+    return true;
+}
+
+/* cef_process_message.h */
+
+CefRefPtr<CefProcessMessage> CefProcessMessage::Create(const CefString &name)
+{
+    CefRefPtr<CefProcessMessage> message = new CefProcessMessage();
+    message->_name = name;
+    return message;
+}
+
+CefRefPtr<CefProcessMessage> CefProcessMessage::Copy() const
+{
+    CefRefPtr<CefProcessMessage> message = new CefProcessMessage();
+    message->_name = _name;
+    message->_args = _args->Copy();
+    return message;
+}
+
+/* cef_values.h */
+
+CefRefPtr<CefListValue> CefListValue::Create()
+{
+    return new CefListValue();
+}
+
+CefRefPtr<CefDictionaryValue> CefDictionaryValue::Create()
+{
+    return new CefDictionaryValue();
+}
+
+/* cef_command_line.h */
+
+CefRefPtr<CefCommandLine> CefCommandLine::CreateCommandLine()
+{
+    return new CefCommandLine();
+}
+
+CefRefPtr<CefCommandLine> CefCommandLine::GetGlobalCommandLine()
+{
+    static CefRefPtr<CefCommandLine> command_line = CreateCommandLine();
+    return command_line;
+}
+
+/* cef_request.h */
+
+CefRefPtr<CefRequest> CefRequest::Create()
+{
+    return new CefRequest();
+}
+
+CefRefPtr<CefResponse> CefResponse::Create()
+{
+    return new CefResponse();
+}
+
+CefRefPtr<CefPostData> CefPostData::Create()
+{
+    return new CefPostData();
+}
+
+CefRefPtr<CefPostDataElement> CefPostDataElement::Create()
+{
+    return new CefPostDataElement();
+}
+
+/* cef_scheme.h */
+
+bool CefRegisterSchemeHandlerFactory(const CefString &scheme_name,
+                                     const CefString &domain_name,
+                                     CefRefPtr<CefSchemeHandlerFactory> factory)
+{
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.scheme_factories[{scheme_name.ToString(), domain_name.ToString()}] = factory;
+    return true;
+}
+
+/* cef_cookie.h */
+
+CefRefPtr<CefCookieManager> CefCookieManager::GetGlobalManager(CefRefPtr<CefCompletionCallback> callback)
+{
+    auto &state = GetState();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.cookie_manager == nullptr)
+        {
+            state.cookie_manager = new CookieManager();
+        }
+    }
+
+    if (callback)
+    {
+        callback->OnComplete();
+    }
+
+    return state.cookie_manager;
+}
+
+/* cef_v8.h */
+
+CefV8Context::CefV8Context(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame)
+    : _browser(browser)
+    , _frame(frame)
+    , _global(CefV8Value::CreateObject(nullptr, nullptr))
+{
+}
+
+CefRefPtr<CefV8Context> CefV8Context::GetCurrentContext()
+{
+    return current_contexts.empty() ? nullptr : current_contexts.back();
+}
+
+bool CefV8Context::Enter()
+{
+    current_contexts.push_back(this);
+    return true;
+}
+
+void CefV8Context::Dispose()
+{
+    _global->_properties.clear();
+}
+
+bool CefV8Context::Exit()
+{
+    if (current_contexts.empty() || current_contexts.back() != this)
+    {
+        return false;
+    }
+
+    current_contexts.pop_back();
+    return true;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateUndefined()
+{
+    return new CefV8Value(Kind::Undefined);
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateNull()
+{
+    return new CefV8Value(Kind::Null);
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateBool(bool value)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::Bool);
+    result->_bool = value;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateInt(int32_t value)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::Int);
+    result->_number = value;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateDouble(double value)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::Double);
+    result->_number = value;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateString(const CefString &value)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::String);
+    result->_string = value;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateObject(CefRefPtr<CefV8Accessor> accessor,
+                                               CefRefPtr<CefV8Interceptor> interceptor)
+{
+    return new CefV8Value(Kind::Object);
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateFunction(const CefString &name, CefRefPtr<CefV8Handler> handler)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::Function);
+    result->_string = name;
+    result->_handler = handler;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateArrayBuffer(void *buffer,
+                                                    size_t length,
+                                                    CefRefPtr<CefV8ArrayBufferReleaseCallback> release_callback)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::ArrayBuffer);
+    result->_buffer = buffer;
+    result->_length = length;
+    result->_release = release_callback;
+    return result;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::CreateArrayBufferWithCopy(void *buffer, size_t length)
+{
+    CefRefPtr<CefV8Value> result = new CefV8Value(Kind::ArrayBuffer);
+    auto bytes = static_cast<const uint8_t *>(buffer);
+    result->_copy.assign(bytes, bytes + length);
+    result->_buffer = result->_copy.data();
+    result->_length = length;
+    return result;
+}
+
+CefV8Value::~CefV8Value()
+{
+    // Stands in for the garbage collector releasing an external backing store.
+    if (_release != nullptr)
+    {
+        _release->ReleaseBuffer(_buffer);
+    }
+}
+
+CefRefPtr<CefV8Value> CefV8Value::GetValue(const CefString &key)
+{
+    auto it = _properties.find(key.ToString());
+    return it != _properties.end() ? it->second : CreateUndefined();
+}
+
+bool CefV8Value::SetValue(const CefString &key, CefRefPtr<CefV8Value> value, PropertyAttribute attribute)
+{
+    if (!IsObject())
+    {
+        return false;
+    }
+
+    _properties[key.ToString()] = value;
+    return true;
+}
+
+bool CefV8Value::DeleteValue(const CefString &key)
+{
+    return _properties.erase(key.ToString()) > 0;
+}
+
+CefRefPtr<CefV8Value> CefV8Value::ExecuteFunction(CefRefPtr<CefV8Value> object, const CefV8ValueList &arguments)
+{
+    if (!IsFunction() || _handler == nullptr)
+    {
+        return nullptr;
+    }
+
+    CefRefPtr<CefV8Value> retval;
+    CefString exception;
+    if (!_handler->Execute(_string, object, arguments, retval, exception) || !exception.empty())
+    {
+        return nullptr;
+    }
+
+    return retval != nullptr ? retval : CreateUndefined();
+}
+
+/* cef_mock.h */
+
+namespace cef_mock
+{
+    // clang-format off
+    BrowserHost::BrowserHost(CefRawPtr<CefBrowser> browser,
+                             CefRefPtr<CefClient> client,
+                             const CefWindowInfo &window_info,
+                             const CefBrowserSettings &settings)
+        : _browser(browser)
+        , _client(client)
+        , _window_info(window_info)
+        , _settings(settings)
+    {
+    }
+    // clang-format on
+
+    CefRefPtr<CefBrowser> BrowserHost::GetBrowser()
+    {
+        return _browser;
+    }
+
+    CefRefPtr<CefClient> BrowserHost::GetClient()
+    {
+        return _client;
+    }
+
+    void BrowserHost::CloseBrowser(bool force_close)
+    {
+        if (_closed.exchange(true))
+        {
+            return;
+        }
+
+        CefRefPtr<CefBrowser> browser = _browser;
+        auto client = _client;
+
+        Post(TID_RENDERER, [browser]() {
+            auto &state = GetState();
+            CefRefPtr<CefV8Context> context;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                auto it = state.contexts.find(browser->GetIdentifier());
+                if (it != state.contexts.end())
+                {
+                    context = it->second;
+                    state.contexts.erase(it);
+                }
+            }
+
+            CefRefPtr<CefRenderProcessHandler> handler;
+            if (state.render_app)
+            {
+                handler = state.render_app->GetRenderProcessHandler();
+            }
+
+            if (context)
+            {
+                if (handler)
+                {
+                    handler->OnContextReleased(browser, browser->GetMainFrame(), context);
+                }
+
+                context->Dispose();
+            }
+
+            if (handler)
+            {
+                handler->OnBrowserDestroyed(browser);
+            }
+        });
+
+        Post(TID_UI, [browser, client]() {
+            if (auto handler = client->GetLifeSpanHandler())
+            {
+                handler->DoClose(browser);
+                handler->OnBeforeClose(browser);
+            }
+
+            auto &state = GetState();
+            CefRefPtr<Browser> removed;
+            {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                auto it = state.browsers.find(browser->GetIdentifier());
+                if (it != state.browsers.end())
+                {
+                    removed = it->second;
+                    state.browsers.erase(it);
+                }
+            }
+        });
+    }
+
+    void BrowserHost::SetFocus(bool focus)
+    {
+        _focus = focus;
+        Record(HostEvent::Focus);
+    }
+
+    CefWindowHandle BrowserHost::GetWindowHandle()
+    {
+        return _window_info.parent_window;
+    }
+
+    void BrowserHost::ShowDevTools(const CefWindowInfo &windowInfo,
+                                   CefRefPtr<CefClient> client,
+                                   const CefBrowserSettings &settings,
+                                   const CefPoint &inspect_element_at)
+    {
+        Record(HostEvent::DevTools);
+    }
+
+    void BrowserHost::CloseDevTools()
+    {
+        Record(HostEvent::DevTools);
+    }
+
+    void BrowserHost::WasResized()
+    {
+        Record(HostEvent::Resized);
+
+        if (auto handler = _client->GetRenderHandler())
+        {
+            handler->GetViewRect(_browser, last_view_rect);
+            handler->GetScreenInfo(_browser, last_screen_info);
+        }
+    }
+
+    void BrowserHost::Invalidate(cef_paint_element_type_t type)
+    {
+        Record(HostEvent::Invalidate);
+    }
+
+    void BrowserHost::SendKeyEvent(const CefKeyEvent &event)
+    {
+        last_key_event = event;
+        Record(HostEvent::Key);
+    }
+
+    void BrowserHost::SendMouseClickEvent(const CefMouseEvent &event,
+                                          cef_mouse_button_type_t type,
+                                          bool mouseUp,
+                                          int clickCount)
+    {
+        last_mouse_event = event;
+        last_mouse_button = type;
+        last_mouse_up = mouseUp;
+        Record(HostEvent::MouseClick);
+    }
+
+    void BrowserHost::SendMouseMoveEvent(const CefMouseEvent &event, bool mouseLeave)
+    {
+        last_mouse_event = event;
+        Record(HostEvent::MouseMove);
+    }
+
+    void BrowserHost::SendMouseWheelEvent(const CefMouseEvent &event, int deltaX, int deltaY)
+    {
+        last_mouse_event = event;
+        last_wheel_delta_x = deltaX;
+        last_wheel_delta_y = deltaY;
+        Record(HostEvent::MouseWheel);
+    }
+
+    void BrowserHost::SendTouchEvent(const CefTouchEvent &event)
+    {
+        last_touch_event = event;
+        Record(HostEvent::Touch);
+    }
+
+    void BrowserHost::ImeSetComposition(const CefString &text,
+                                        const std::vector<CefCompositionUnderline> &underlines,
+                                        const CefRange &replacement_range,
+                                        const CefRange &selection_range)
+    {
+        last_ime_text = text.ToString();
+        last_ime_selection = selection_range;
+        Record(HostEvent::ImeSetComposition);
+    }
+
+    void BrowserHost::ImeCommitText(const CefString &text, const CefRange &replacement_range, int relative_cursor_pos)
+    {
+        last_ime_text = text.ToString();
+        Record(HostEvent::ImeCommitText);
+    }
+
+    uint64_t BrowserHost::GetEventCount(HostEvent event) const
+    {
+        return _counts[static_cast<size_t>(event)].load(std::memory_order_relaxed);
+    }
+
+    void BrowserHost::Record(HostEvent event)
+    {
+        _counts[static_cast<size_t>(event)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t RunPendingTasks()
+    {
+        return GetState().queues[TID_UI].RunPending();
+    }
+
+    ///
+    /// Returns true when a marker task was posted and waited for, which counts as an executed task.
+    ///
+    static bool FlushQueue(CefThreadId thread_id)
+    {
+        auto &queue = GetState().queues[thread_id];
+        if (!queue.HasWorker())
+        {
+            while (queue.RunPending() > 0)
+            {
+            }
+
+            return false;
+        }
+
+        if (queue.IsCurrent())
+        {
+            return false;
+        }
+
+        auto waiter = std::make_shared<Waiter>();
+        Post(thread_id, [waiter]() { waiter->Notify(1); });
+        waiter->Wait();
+        return true;
+    }
+
+    void Flush(CefThreadId thread_id)
+    {
+        FlushQueue(thread_id);
+    }
+
+    void Settle()
+    {
+        auto &state = GetState();
+
+        // Work hops between the UI and worker queues, keep going until a full round executed nothing but the
+        // flush markers themselves.
+        while (true)
+        {
+            uint64_t before = 0;
+            for (auto &queue : state.queues)
+            {
+                before += queue.GetExecutedCount();
+            }
+
+            uint64_t markers = 0;
+            for (int id = 0; id < TID_NUM_VALUES; id++)
+            {
+                markers += FlushQueue(static_cast<CefThreadId>(id)) ? 1 : 0;
+            }
+
+            uint64_t after = 0;
+            for (auto &queue : state.queues)
+            {
+                after += queue.GetExecutedCount();
+            }
+
+            if (after - before == markers)
+            {
+                break;
+            }
+        }
+    }
+
+    CefRefPtr<CefBrowser> GetLastBrowser()
+    {
+        auto &state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (auto it = state.browsers.rbegin(); it != state.browsers.rend(); ++it)
+        {
+            if (it->second->IsValid())
+            {
+                return it->second;
+            }
+        }
+
+        return nullptr;
+    }
+
+    CefRefPtr<BrowserHost> GetHost(CefRefPtr<CefBrowser> browser)
+    {
+        return static_cast<Browser *>(browser.get())->GetMockHost();
+    }
+
+    CefRefPtr<CefV8Context> GetV8Context(CefRefPtr<CefBrowser> browser)
+    {
+        auto &state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.contexts.find(browser->GetIdentifier());
+        return it != state.contexts.end() ? it->second : nullptr;
+    }
+
+    void Paint(CefRefPtr<CefBrowser> browser,
+               cef_paint_element_type_t type,
+               const std::vector<CefRect> &dirty_rects,
+               const void *buffer,
+               int width,
+               int height)
+    {
+        if (auto handler = browser->GetHost()->GetClient()->GetRenderHandler())
+        {
+            handler->OnPaint(browser, type, dirty_rects, buffer, width, height);
+        }
+    }
+
+    void ChangeCursor(CefRefPtr<CefBrowser> browser, cef_cursor_type_t type, const CefCursorInfo &info)
+    {
+        if (auto handler = browser->GetHost()->GetClient()->GetDisplayHandler())
+        {
+            handler->OnCursorChange(browser, CefCursorHandle(), type, info);
+        }
+    }
+
+    CefRefPtr<CefResourceHandler> CreateSchemeHandler(CefRefPtr<CefBrowser> browser, CefRefPtr<CefRequest> request)
+    {
+        std::string url = request->GetURL();
+        auto scheme_end = url.find("://");
+        if (scheme_end == std::string::npos)
+        {
+            return nullptr;
+        }
+
+        std::string scheme = url.substr(0, scheme_end);
+        std::string domain = url.substr(scheme_end + 3);
+        domain = domain.substr(0, domain.find_first_of("/?#"));
+
+        CefRefPtr<CefSchemeHandlerFactory> factory;
+        {
+            auto &state = GetState();
+            std::lock_guard<std::mutex> lock(state.mutex);
+            // An empty domain matches every domain of the scheme.
+            auto it = state.scheme_factories.find({scheme, domain});
+            if (it == state.scheme_factories.end())
+            {
+                it = state.scheme_factories.find({scheme, ""});
+            }
+
+            if (it == state.scheme_factories.end())
+            {
+                return nullptr;
+            }
+
+            factory = it->second;
+        }
+
+        return factory->Create(browser, browser ? browser->GetMainFrame() : nullptr, scheme, request);
+    }
+
+    CefRefPtr<CefResourceHandler> CreateResourceHandler(CefRefPtr<CefBrowser> browser, CefRefPtr<CefRequest> request)
+    {
+        auto request_handler = browser->GetHost()->GetClient()->GetRequestHandler();
+        if (request_handler == nullptr)
+        {
+            return nullptr;
+        }
+
+        bool disable_default_handling = false;
+        auto resource_request_handler = request_handler->GetResourceRequestHandler(
+            browser, browser->GetMainFrame(), request, false, false, "", disable_default_handling);
+        if (resource_request_handler == nullptr)
+        {
+            return nullptr;
+        }
+
+        return resource_request_handler->GetResourceHandler(browser, browser->GetMainFrame(), request);
+    }
+
+    Resource LoadResource(CefRefPtr<CefResourceHandler> handler, CefRefPtr<CefRequest> request, int chunk_size)
+    {
+        Resource resource;
+        if (handler == nullptr)
+        {
+            return resource;
+        }
+
+        auto waiter = std::make_shared<Waiter>();
+
+        // Returning true with |handle_request| unset means the handler decides later through the callback.
+        bool handle_request = false;
+        bool result = handler->Open(request, handle_request, new Callback(waiter));
+        if (!result || (!handle_request && waiter->Wait() == 0))
+        {
+            handler->Cancel();
+            return resource;
+        }
+
+        auto response = CefResponse::Create();
+        CefString redirect_url;
+        handler->GetResponseHeaders(response, resource.content_length, redirect_url);
+
+        resource.handled = true;
+        resource.status = response->GetStatus();
+        resource.mime_type = response->GetMimeType();
+        resource.status_text = response->GetStatusText();
+        response->GetHeaderMap(resource.headers);
+
+        std::vector<char> chunk(chunk_size);
+        while (true)
+        {
+            int bytes_read = 0;
+            bool result = handler->Read(chunk.data(), chunk_size, bytes_read, new ReadCallback(waiter));
+            if (result && bytes_read == 0)
+            {
+                bytes_read = static_cast<int>(waiter->Wait());
+            }
+
+            if (bytes_read <= 0)
+            {
+                break;
+            }
+
+            resource.body.append(chunk.data(), bytes_read);
+            if (!result)
+            {
+                break;
+            }
+        }
+
+        return resource;
+    }
+
+    CefRefPtr<CefRequest> CreateRequest(const std::string &url, const std::string &method)
+    {
+        auto request = CefRequest::Create();
+        request->SetURL(url);
+        request->SetMethod(method);
+        return request;
+    }
+
+    void RunInRenderer(CefRefPtr<CefBrowser> browser, Script script)
+    {
+        Post(TID_RENDERER, [browser, script]() {
+            auto context = GetV8Context(browser);
+            if (context == nullptr)
+            {
+                return;
+            }
+
+            context->Enter();
+            script(context);
+            context->Exit();
+        });
+    }
+
+    CefRefPtr<CefV8Value> CreateFunction(const std::string &name, NativeFunction func)
+    {
+        return CefV8Value::CreateFunction(name, new NativeHandler(std::move(func)));
+    }
+} // namespace cef_mock
@@ -0,0 +1,214 @@
+//
+//  cef_mock.h
+//  webview
+//
+//  Controls for the in-process CEF mock used by the cxx tests and benchmarks
+//
+
+#ifndef cef_mock_h
+#define cef_mock_h
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "include/cef_app.h"
+
+namespace cef_mock
+{
+    ///
+    /// Input and control calls recorded by the mock browser host.
+    ///
+    enum class HostEvent
+    {
+        MouseClick,
+        MouseMove,
+        MouseWheel,
+        Key,
+        Touch,
+        ImeSetComposition,
+        ImeCommitText,
+        Focus,
+        Resized,
+        DevTools,
+        Invalidate,
+        Count,
+    };
+
+    class BrowserHost : public CefBrowserHost
+    {
+      public:
+        BrowserHost(CefRawPtr<CefBrowser> browser,
+                    CefRefPtr<CefClient> client,
+                    const CefWindowInfo &window_info,
+                    const CefBrowserSettings &settings);
+
+        CefRefPtr<CefBrowser> GetBrowser() override;
+        CefRefPtr<CefClient> GetClient() override;
+        void CloseBrowser(bool force_close) override;
+        void SetFocus(bool focus) override;
+        CefWindowHandle GetWindowHandle() override;
+        void ShowDevTools(const CefWindowInfo &windowInfo,
+                          CefRefPtr<CefClient> client,
+                          const CefBrowserSettings &settings,
+                          const CefPoint &inspect_element_at) override;
+        void CloseDevTools() override;
+        void WasResized() override;
+        void Invalidate(cef_paint_element_type_t type) override;
+        void SendKeyEvent(const CefKeyEvent &event) override;
+        void SendMouseClickEvent(const CefMouseEvent &event,
+                                 cef_mouse_button_type_t type,
+                                 bool mouseUp,
+                                 int clickCount) override;
+        void SendMouseMoveEvent(const CefMouseEvent &event, bool mouseLeave) override;
+        void SendMouseWheelEvent(const CefMouseEvent &event, int deltaX, int deltaY) override;
+        void SendTouchEvent(const CefTouchEvent &event) override;
+        void ImeSetComposition(const CefString &text,
+                               const std::vector<CefCompositionUnderline> &underlines,
+                               const CefRange &replacement_range,
+                               const CefRange &selection_range) override;
+        void ImeCommitText(const CefString &text, const CefRange &replacement_range, int relative_cursor_pos) override;
+
+        uint64_t GetEventCount(HostEvent event) const;
+
+        const CefBrowserSettings &GetSettings() const
+        {
+            return _settings;
+        }
+
+        const CefWindowInfo &GetWindowInfo() const
+        {
+            return _window_info;
+        }
+
+        bool IsClosed() const
+        {
+            return _closed;
+        }
+
+        bool HasFocus() const
+        {
+            return _focus;
+        }
+
+        ///
+        /// Last values forwarded by wew, only meaningful when read from the thread that sent them.
+        ///
+        CefMouseEvent last_mouse_event;
+        cef_mouse_button_type_t last_mouse_button = MBT_LEFT;
+        bool last_mouse_up = false;
+        int last_wheel_delta_x = 0;
+        int last_wheel_delta_y = 0;
+        CefKeyEvent last_key_event;
+        CefTouchEvent last_touch_event;
+        std::string last_ime_text;
+        CefRange last_ime_selection;
+        CefRect last_view_rect;
+        CefScreenInfo last_screen_info;
+
+      private:
+        void Record(HostEvent event);
+
+        CefRawPtr<CefBrowser> _browser;
+        CefRefPtr<CefClient> _client;
+        CefWindowInfo _window_info;
+        CefBrowserSettings _settings;
+        std::atomic<uint64_t> _counts[static_cast<size_t>(HostEvent::Count)] = {};
+        std::atomic<bool> _closed = false;
+        bool _focus = false;
+
+        IMPLEMENT_REFCOUNTING(BrowserHost);
+    };
+
+    ///
+    /// Result of driving a resource handler to completion.
+    ///
+    struct Resource
+    {
+        bool handled = false;
+        int status = 0;
+        std::string mime_type;
+        std::string status_text;
+        CefResponse::HeaderMap headers;
+        int64_t content_length = 0;
+        std::string body;
+    };
+
+    ///
+    /// Run the tasks currently queued for the UI thread on the calling thread, returns the number executed.
+    ///
+    size_t RunPendingTasks();
+
+    ///
+    /// Block until every task posted to |thread_id| before this call has executed.
+    ///
+    void Flush(CefThreadId thread_id);
+
+    ///
+    /// Pump the UI queue and flush the worker queues until no more work is produced.
+    ///
+    void Settle();
+
+    ///
+    /// The most recently created browser that has not been closed yet.
+    ///
+    CefRefPtr<CefBrowser> GetLastBrowser();
+
+    CefRefPtr<BrowserHost> GetHost(CefRefPtr<CefBrowser> browser);
+
+    ///
+    /// The renderer side V8 context of the main frame, created once the browser finished loading.
+    ///
+    CefRefPtr<CefV8Context> GetV8Context(CefRefPtr<CefBrowser> browser);
+
+    ///
+    /// Deliver a paint to the client's render handler on the calling thread.
+    ///
+    void Paint(CefRefPtr<CefBrowser> browser,
+               cef_paint_element_type_t type,
+               const std::vector<CefRect> &dirty_rects,
+               const void *buffer,
+               int width,
+               int height);
+
+    ///
+    /// Deliver a cursor change to the client's display handler on the calling thread.
+    ///
+    void ChangeCursor(CefRefPtr<CefBrowser> browser, cef_cursor_type_t type, const CefCursorInfo &info = {});
+
+    ///
+    /// Resolve |url| against the scheme handler factories registered with CefRegisterSchemeHandlerFactory.
+    ///
+    CefRefPtr<CefResourceHandler> CreateSchemeHandler(CefRefPtr<CefBrowser> browser, CefRefPtr<CefRequest> request);
+
+    ///
+    /// Resolve |request| through the browser client's request handler.
+    ///
+    CefRefPtr<CefResourceHandler> CreateResourceHandler(CefRefPtr<CefBrowser> browser, CefRefPtr<CefRequest> request);
+
+    ///
+    /// Drive |handler| through Open, GetResponseHeaders and Read like the network service does, waiting on the
+    /// callbacks when the handler continues asynchronously. |chunk_size| is the size of every Read buffer.
+    ///
+    Resource LoadResource(CefRefPtr<CefResourceHandler> handler, CefRefPtr<CefRequest> request, int chunk_size = 65536);
+
+    CefRefPtr<CefRequest> CreateRequest(const std::string &url, const std::string &method = "GET");
+
+    using Script = std::function<void(CefRefPtr<CefV8Context> context)>;
+
+    ///
+    /// Run |script| on the renderer thread with the browser's V8 context entered, standing in for page script.
+    ///
+    void RunInRenderer(CefRefPtr<CefBrowser> browser, Script script);
+
+    using NativeFunction = std::function<CefRefPtr<CefV8Value>(const CefV8ValueList &arguments)>;
+
+    ///
+    /// Create a V8 function value backed by |func|, used to emulate callbacks defined by page script.
+    ///
+    CefRefPtr<CefV8Value> CreateFunction(const std::string &name, NativeFunction func);
+} // namespace cef_mock
+
+#endif /* cef_mock_h */
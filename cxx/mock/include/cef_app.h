@@ -0,0 +1,91 @@
+//
+//  cef_app.h
+//  webview
+//
+//  Mock CEF: application entry points
+//
+//  Only the surface wew touches is modelled. Browsers, frames, cookies and scheme handlers live in the same
+//  process and every CEF thread is an in-process task queue, see cxx/mock/cef_mock.h for the test controls.
+//
+
+#ifndef cef_mock_app_h
+#define cef_mock_app_h
+#pragma once
+
+#include "include/cef_base.h"
+#include "include/cef_browser.h"
+#include "include/cef_client.h"
+#include "include/cef_command_line.h"
+#include "include/cef_cookie.h"
+#include "include/cef_process_message.h"
+#include "include/cef_render_process_handler.h"
+#include "include/cef_request_handler.h"
+#include "include/cef_scheme.h"
+#include "include/cef_task.h"
+#include "include/cef_v8.h"
+#include "include/cef_values.h"
+
+class CefBrowserProcessHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnContextInitialized()
+    {
+    }
+
+    virtual void OnBeforeChildProcessLaunch(CefRefPtr<CefCommandLine> command_line)
+    {
+    }
+
+    virtual void OnScheduleMessagePumpWork(int64_t delay_ms)
+    {
+    }
+
+    virtual CefRefPtr<CefClient> GetDefaultClient()
+    {
+        return nullptr;
+    }
+};
+
+class CefApp : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnBeforeCommandLineProcessing(const CefString &process_type, CefRefPtr<CefCommandLine> command_line)
+    {
+    }
+
+    virtual void OnRegisterCustomSchemes(CefRawPtr<CefSchemeRegistrar> registrar)
+    {
+    }
+
+    virtual CefRefPtr<CefBrowserProcessHandler> GetBrowserProcessHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefRenderProcessHandler> GetRenderProcessHandler()
+    {
+        return nullptr;
+    }
+};
+
+///
+/// Register |application| as the renderer side application. Returns -1 like the browser process does.
+///
+int CefExecuteProcess(const CefMainArgs &args, CefRefPtr<CefApp> application, void *windows_sandbox_info);
+
+bool CefInitialize(const CefMainArgs &args,
+                   const CefSettings &settings,
+                   CefRefPtr<CefApp> application,
+                   void *windows_sandbox_info);
+
+int CefGetExitCode();
+
+void CefShutdown();
+
+void CefDoMessageLoopWork();
+
+void CefRunMessageLoop();
+
+void CefQuitMessageLoop();
+
+#endif /* cef_mock_app_h */
@@ -0,0 +1,17 @@
+//
+//  cef_base.h
+//  webview
+//
+//  Mock CEF: common base header
+//
+
+#ifndef cef_mock_base_h
+#define cef_mock_base_h
+#pragma once
+
+#include <assert.h>
+
+#include "include/internal/cef_ptr.h"
+#include "include/internal/cef_types.h"
+
+#endif /* cef_mock_base_h */
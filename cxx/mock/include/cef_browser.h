@@ -0,0 +1,85 @@
+//
+//  cef_browser.h
+//  webview
+//
+//  Mock CEF: browser, frame and browser host
+//
+
+#ifndef cef_mock_browser_h
+#define cef_mock_browser_h
+#pragma once
+
+#include "include/cef_base.h"
+#include "include/cef_process_message.h"
+#include "include/cef_values.h"
+
+class CefBrowser;
+class CefBrowserHost;
+class CefClient;
+
+class CefRequestContext : public virtual CefBaseRefCounted
+{
+};
+
+class CefFrame : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool IsValid() = 0;
+    virtual bool IsMain() = 0;
+    virtual CefString GetURL() = 0;
+    virtual void LoadURL(const CefString &url) = 0;
+    virtual CefRefPtr<CefBrowser> GetBrowser() = 0;
+
+    ///
+    /// Send a message to the specified |target_process|, the mock delivers it through the target side task queue.
+    ///
+    virtual void SendProcessMessage(CefProcessId target_process, CefRefPtr<CefProcessMessage> message) = 0;
+};
+
+class CefBrowser : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool IsValid() = 0;
+    virtual int GetIdentifier() = 0;
+    virtual CefRefPtr<CefBrowserHost> GetHost() = 0;
+    virtual CefRefPtr<CefFrame> GetMainFrame() = 0;
+};
+
+class CefBrowserHost : public virtual CefBaseRefCounted
+{
+  public:
+    static bool CreateBrowser(const CefWindowInfo &windowInfo,
+                              CefRefPtr<CefClient> client,
+                              const CefString &url,
+                              const CefBrowserSettings &settings,
+                              CefRefPtr<CefDictionaryValue> extra_info,
+                              CefRefPtr<CefRequestContext> request_context);
+
+    virtual CefRefPtr<CefBrowser> GetBrowser() = 0;
+    virtual CefRefPtr<CefClient> GetClient() = 0;
+    virtual void CloseBrowser(bool force_close) = 0;
+    virtual void SetFocus(bool focus) = 0;
+    virtual CefWindowHandle GetWindowHandle() = 0;
+    virtual void ShowDevTools(const CefWindowInfo &windowInfo,
+                              CefRefPtr<CefClient> client,
+                              const CefBrowserSettings &settings,
+                              const CefPoint &inspect_element_at) = 0;
+    virtual void CloseDevTools() = 0;
+    virtual void WasResized() = 0;
+    virtual void Invalidate(cef_paint_element_type_t type) = 0;
+    virtual void SendKeyEvent(const CefKeyEvent &event) = 0;
+    virtual void SendMouseClickEvent(const CefMouseEvent &event,
+                                     cef_mouse_button_type_t type,
+                                     bool mouseUp,
+                                     int clickCount) = 0;
+    virtual void SendMouseMoveEvent(const CefMouseEvent &event, bool mouseLeave) = 0;
+    virtual void SendMouseWheelEvent(const CefMouseEvent &event, int deltaX, int deltaY) = 0;
+    virtual void SendTouchEvent(const CefTouchEvent &event) = 0;
+    virtual void ImeSetComposition(const CefString &text,
+                                   const std::vector<CefCompositionUnderline> &underlines,
+                                   const CefRange &replacement_range,
+                                   const CefRange &selection_range) = 0;
+    virtual void ImeCommitText(const CefString &text, const CefRange &replacement_range, int relative_cursor_pos) = 0;
+};
+
+#endif /* cef_mock_browser_h */
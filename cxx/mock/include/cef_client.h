@@ -0,0 +1,230 @@
+//
+//  cef_client.h
+//  webview
+//
+//  Mock CEF: client and per-browser handler interfaces
+//
+
+#ifndef cef_mock_client_h
+#define cef_mock_client_h
+#pragma once
+
+#include "include/cef_browser.h"
+#include "include/cef_request_handler.h"
+
+class CefDragData : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool IsLink() = 0;
+};
+
+class CefMenuModel : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool Clear() = 0;
+    virtual size_t GetCount() = 0;
+};
+
+class CefContextMenuParams : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_context_menu_type_flags_t TypeFlags;
+
+    virtual TypeFlags GetTypeFlags() = 0;
+};
+
+class CefDragHandler : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_drag_operations_mask_t DragOperationsMask;
+
+    virtual bool OnDragEnter(CefRefPtr<CefBrowser> browser, CefRefPtr<CefDragData> dragData, DragOperationsMask mask)
+    {
+        return false;
+    }
+};
+
+class CefContextMenuHandler : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_event_flags_t EventFlags;
+
+    virtual void OnBeforeContextMenu(CefRefPtr<CefBrowser> browser,
+                                     CefRefPtr<CefFrame> frame,
+                                     CefRefPtr<CefContextMenuParams> params,
+                                     CefRefPtr<CefMenuModel> model)
+    {
+    }
+
+    virtual bool OnContextMenuCommand(CefRefPtr<CefBrowser> browser,
+                                      CefRefPtr<CefFrame> frame,
+                                      CefRefPtr<CefContextMenuParams> params,
+                                      int command_id,
+                                      EventFlags event_flags)
+    {
+        return false;
+    }
+};
+
+class CefLoadHandler : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_errorcode_t ErrorCode;
+    typedef cef_transition_type_t TransitionType;
+
+    virtual void OnLoadStart(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, TransitionType transition_type)
+    {
+    }
+
+    virtual void OnLoadEnd(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, int httpStatusCode)
+    {
+    }
+
+    virtual void OnLoadError(CefRefPtr<CefBrowser> browser,
+                             CefRefPtr<CefFrame> frame,
+                             ErrorCode errorCode,
+                             const CefString &errorText,
+                             const CefString &failedUrl)
+    {
+    }
+};
+
+class CefLifeSpanHandler : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_window_open_disposition_t WindowOpenDisposition;
+
+    virtual bool OnBeforePopup(CefRefPtr<CefBrowser> browser,
+                               CefRefPtr<CefFrame> frame,
+                               int popup_id,
+                               const CefString &target_url,
+                               const CefString &target_frame_name,
+                               WindowOpenDisposition target_disposition,
+                               bool user_gesture,
+                               const CefPopupFeatures &popupFeatures,
+                               CefWindowInfo &windowInfo,
+                               CefRefPtr<CefClient> &client,
+                               CefBrowserSettings &settings,
+                               CefRefPtr<CefDictionaryValue> &extra_info,
+                               bool *no_javascript_access)
+    {
+        return false;
+    }
+
+    virtual void OnAfterCreated(CefRefPtr<CefBrowser> browser)
+    {
+    }
+
+    virtual bool DoClose(CefRefPtr<CefBrowser> browser)
+    {
+        return false;
+    }
+
+    virtual void OnBeforeClose(CefRefPtr<CefBrowser> browser)
+    {
+    }
+};
+
+class CefDisplayHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnTitleChange(CefRefPtr<CefBrowser> browser, const CefString &title)
+    {
+    }
+
+    virtual void OnFullscreenModeChange(CefRefPtr<CefBrowser> browser, bool fullscreen)
+    {
+    }
+
+    virtual bool OnCursorChange(CefRefPtr<CefBrowser> browser,
+                                CefCursorHandle cursor,
+                                cef_cursor_type_t type,
+                                const CefCursorInfo &custom_cursor_info)
+    {
+        return false;
+    }
+};
+
+class CefRenderHandler : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_paint_element_type_t PaintElementType;
+    typedef std::vector<CefRect> RectList;
+
+    virtual bool GetScreenInfo(CefRefPtr<CefBrowser> browser, CefScreenInfo &screen_info)
+    {
+        return false;
+    }
+
+    virtual void GetViewRect(CefRefPtr<CefBrowser> browser, CefRect &rect) = 0;
+
+    virtual void OnPopupShow(CefRefPtr<CefBrowser> browser, bool show)
+    {
+    }
+
+    virtual void OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect &rect)
+    {
+    }
+
+    virtual void OnPaint(CefRefPtr<CefBrowser> browser,
+                         PaintElementType type,
+                         const RectList &dirtyRects,
+                         const void *buffer,
+                         int width,
+                         int height) = 0;
+
+    virtual void OnImeCompositionRangeChanged(CefRefPtr<CefBrowser> browser,
+                                              const CefRange &selected_range,
+                                              const RectList &character_bounds)
+    {
+    }
+};
+
+class CefClient : public virtual CefBaseRefCounted
+{
+  public:
+    virtual CefRefPtr<CefContextMenuHandler> GetContextMenuHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefDisplayHandler> GetDisplayHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefDragHandler> GetDragHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefLifeSpanHandler> GetLifeSpanHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefLoadHandler> GetLoadHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefRenderHandler> GetRenderHandler()
+    {
+        return nullptr;
+    }
+
+    virtual CefRefPtr<CefRequestHandler> GetRequestHandler()
+    {
+        return nullptr;
+    }
+
+    virtual bool OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
+                                          CefRefPtr<CefFrame> frame,
+                                          CefProcessId source_process,
+                                          CefRefPtr<CefProcessMessage> message)
+    {
+        return false;
+    }
+};
+
+#endif /* cef_mock_client_h */
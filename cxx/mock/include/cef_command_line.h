@@ -0,0 +1,53 @@
+//
+//  cef_command_line.h
+//  webview
+//
+//  Mock CEF: command line switches
+//
+
+#ifndef cef_mock_command_line_h
+#define cef_mock_command_line_h
+#pragma once
+
+#include <map>
+
+#include "include/cef_base.h"
+
+class CefCommandLine : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefCommandLine> CreateCommandLine();
+
+    ///
+    /// Returns the singleton global command line, the mock shares it between the browser and renderer side.
+    ///
+    static CefRefPtr<CefCommandLine> GetGlobalCommandLine();
+
+    bool HasSwitch(const CefString &name)
+    {
+        return _switches.count(name.ToString()) > 0;
+    }
+
+    CefString GetSwitchValue(const CefString &name)
+    {
+        auto it = _switches.find(name.ToString());
+        return it != _switches.end() ? CefString(it->second) : CefString();
+    }
+
+    void AppendSwitch(const CefString &name)
+    {
+        _switches[name.ToString()] = "";
+    }
+
+    void AppendSwitchWithValue(const CefString &name, const CefString &value)
+    {
+        _switches[name.ToString()] = value.ToString();
+    }
+
+  private:
+    std::map<std::string, std::string> _switches;
+
+    IMPLEMENT_REFCOUNTING(CefCommandLine);
+};
+
+#endif /* cef_mock_command_line_h */
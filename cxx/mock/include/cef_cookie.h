@@ -0,0 +1,52 @@
+//
+//  cef_cookie.h
+//  webview
+//
+//  Mock CEF: in-memory cookie store
+//
+
+#ifndef cef_mock_cookie_h
+#define cef_mock_cookie_h
+#pragma once
+
+#include "include/cef_base.h"
+
+class CefCookieVisitor : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool Visit(const CefCookie &cookie, int count, int total, bool &deleteCookie) = 0;
+};
+
+class CefCompletionCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnComplete() = 0;
+};
+
+class CefSetCookieCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnComplete(bool success) = 0;
+};
+
+class CefDeleteCookiesCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnComplete(int num_deleted) = 0;
+};
+
+class CefCookieManager : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefCookieManager> GetGlobalManager(CefRefPtr<CefCompletionCallback> callback);
+
+    virtual bool VisitAllCookies(CefRefPtr<CefCookieVisitor> visitor) = 0;
+    virtual bool VisitUrlCookies(const CefString &url, bool includeHttpOnly, CefRefPtr<CefCookieVisitor> visitor) = 0;
+    virtual bool SetCookie(const CefString &url, const CefCookie &cookie, CefRefPtr<CefSetCookieCallback> callback) = 0;
+    virtual bool DeleteCookies(const CefString &url,
+                               const CefString &cookie_name,
+                               CefRefPtr<CefDeleteCookiesCallback> callback) = 0;
+    virtual bool FlushStore(CefRefPtr<CefCompletionCallback> callback) = 0;
+};
+
+#endif /* cef_mock_cookie_h */
@@ -0,0 +1,47 @@
+//
+//  cef_process_message.h
+//  webview
+//
+//  Mock CEF: inter-process messages
+//
+
+#ifndef cef_mock_process_message_h
+#define cef_mock_process_message_h
+#pragma once
+
+#include "include/cef_base.h"
+#include "include/cef_values.h"
+
+class CefProcessMessage : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefProcessMessage> Create(const CefString &name);
+
+    bool IsValid() const
+    {
+        return true;
+    }
+
+    CefString GetName() const
+    {
+        return _name;
+    }
+
+    CefRefPtr<CefListValue> GetArgumentList()
+    {
+        return _args;
+    }
+
+    ///
+    /// Returns a writable copy of this object, used by the mock to emulate serialization across processes.
+    ///
+    CefRefPtr<CefProcessMessage> Copy() const;
+
+  private:
+    CefString _name;
+    CefRefPtr<CefListValue> _args = CefListValue::Create();
+
+    IMPLEMENT_REFCOUNTING(CefProcessMessage);
+};
+
+#endif /* cef_mock_process_message_h */
@@ -0,0 +1,49 @@
+//
+//  cef_render_process_handler.h
+//  webview
+//
+//  Mock CEF: render process callbacks
+//
+
+#ifndef cef_mock_render_process_handler_h
+#define cef_mock_render_process_handler_h
+#pragma once
+
+#include "include/cef_browser.h"
+#include "include/cef_process_message.h"
+#include "include/cef_v8.h"
+#include "include/cef_values.h"
+
+class CefRenderProcessHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void OnBrowserCreated(CefRefPtr<CefBrowser> browser, CefRefPtr<CefDictionaryValue> extra_info)
+    {
+    }
+
+    virtual void OnBrowserDestroyed(CefRefPtr<CefBrowser> browser)
+    {
+    }
+
+    virtual void OnContextCreated(CefRefPtr<CefBrowser> browser,
+                                  CefRefPtr<CefFrame> frame,
+                                  CefRefPtr<CefV8Context> context)
+    {
+    }
+
+    virtual void OnContextReleased(CefRefPtr<CefBrowser> browser,
+                                   CefRefPtr<CefFrame> frame,
+                                   CefRefPtr<CefV8Context> context)
+    {
+    }
+
+    virtual bool OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
+                                          CefRefPtr<CefFrame> frame,
+                                          CefProcessId source_process,
+                                          CefRefPtr<CefProcessMessage> message)
+    {
+        return false;
+    }
+};
+
+#endif /* cef_mock_render_process_handler_h */
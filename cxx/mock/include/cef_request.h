@@ -0,0 +1,251 @@
+//
+//  cef_request.h
+//  webview
+//
+//  Mock CEF: request and response objects
+//
+
+#ifndef cef_mock_request_h
+#define cef_mock_request_h
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "include/cef_base.h"
+
+class CefPostDataElement : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefPostDataElement> Create();
+
+    void SetToBytes(size_t size, const void *bytes)
+    {
+        _type = PDE_TYPE_BYTES;
+        _bytes.assign(static_cast<const char *>(bytes), static_cast<const char *>(bytes) + size);
+    }
+
+    void SetToFile(const CefString &file_name)
+    {
+        _type = PDE_TYPE_FILE;
+        _file = file_name;
+    }
+
+    cef_postdataelement_type_t GetType()
+    {
+        return _type;
+    }
+
+    CefString GetFile()
+    {
+        return _file;
+    }
+
+    size_t GetBytesCount()
+    {
+        return _bytes.size();
+    }
+
+    size_t GetBytes(size_t size, void *bytes)
+    {
+        size_t count = std::min(size, _bytes.size());
+        std::copy(_bytes.begin(), _bytes.begin() + count, static_cast<char *>(bytes));
+        return count;
+    }
+
+  private:
+    cef_postdataelement_type_t _type = PDE_TYPE_EMPTY;
+    std::vector<char> _bytes;
+    CefString _file;
+
+    IMPLEMENT_REFCOUNTING(CefPostDataElement);
+};
+
+class CefPostData : public virtual CefBaseRefCounted
+{
+  public:
+    typedef std::vector<CefRefPtr<CefPostDataElement>> ElementVector;
+
+    static CefRefPtr<CefPostData> Create();
+
+    size_t GetElementCount()
+    {
+        return _elements.size();
+    }
+
+    void GetElements(ElementVector &elements)
+    {
+        elements = _elements;
+    }
+
+    bool AddElement(CefRefPtr<CefPostDataElement> element)
+    {
+        _elements.push_back(element);
+        return true;
+    }
+
+  private:
+    ElementVector _elements;
+
+    IMPLEMENT_REFCOUNTING(CefPostData);
+};
+
+class CefRequest : public virtual CefBaseRefCounted
+{
+  public:
+    typedef std::multimap<CefString, CefString> HeaderMap;
+    typedef cef_resource_type_t ResourceType;
+
+    static CefRefPtr<CefRequest> Create();
+
+    CefString GetURL()
+    {
+        return _url;
+    }
+
+    void SetURL(const CefString &url)
+    {
+        _url = url;
+    }
+
+    CefString GetMethod()
+    {
+        return _method;
+    }
+
+    void SetMethod(const CefString &method)
+    {
+        _method = method;
+    }
+
+    CefString GetReferrerURL()
+    {
+        return _referrer;
+    }
+
+    void SetReferrer(const CefString &referrer_url)
+    {
+        _referrer = referrer_url;
+    }
+
+    void GetHeaderMap(HeaderMap &headers)
+    {
+        headers = _headers;
+    }
+
+    void SetHeaderMap(const HeaderMap &headers)
+    {
+        _headers = headers;
+    }
+
+    CefRefPtr<CefPostData> GetPostData()
+    {
+        return _post_data;
+    }
+
+    void SetPostData(CefRefPtr<CefPostData> post_data)
+    {
+        _post_data = post_data;
+    }
+
+    ResourceType GetResourceType()
+    {
+        return _resource_type;
+    }
+
+    ///
+    /// Mock only: CEF sets the resource type of the requests it creates.
+    ///
+    void SetResourceType(ResourceType resource_type)
+    {
+        _resource_type = resource_type;
+    }
+
+  private:
+    CefString _url;
+    CefString _method = "GET";
+    CefString _referrer;
+    HeaderMap _headers;
+    CefRefPtr<CefPostData> _post_data;
+    ResourceType _resource_type = RT_SUB_RESOURCE;
+
+    IMPLEMENT_REFCOUNTING(CefRequest);
+};
+
+class CefResponse : public virtual CefBaseRefCounted
+{
+  public:
+    typedef std::multimap<CefString, CefString> HeaderMap;
+
+    static CefRefPtr<CefResponse> Create();
+
+    int GetStatus()
+    {
+        return _status;
+    }
+
+    void SetStatus(int status)
+    {
+        _status = status;
+    }
+
+    CefString GetStatusText()
+    {
+        return _status_text;
+    }
+
+    void SetStatusText(const CefString &status_text)
+    {
+        _status_text = status_text;
+    }
+
+    CefString GetMimeType()
+    {
+        return _mime_type;
+    }
+
+    void SetMimeType(const CefString &mime_type)
+    {
+        _mime_type = mime_type;
+    }
+
+    void GetHeaderMap(HeaderMap &headers)
+    {
+        headers = _headers;
+    }
+
+    void SetHeaderMap(const HeaderMap &headers)
+    {
+        _headers = headers;
+    }
+
+  private:
+    int _status = 0;
+    CefString _status_text;
+    CefString _mime_type;
+    HeaderMap _headers;
+
+    IMPLEMENT_REFCOUNTING(CefResponse);
+};
+
+class CefCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void Continue() = 0;
+    virtual void Cancel() = 0;
+};
+
+class CefResourceSkipCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void Continue(int64_t bytes_skipped) = 0;
+};
+
+class CefResourceReadCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void Continue(int bytes_read) = 0;
+};
+
+#endif /* cef_mock_request_h */
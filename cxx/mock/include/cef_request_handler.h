@@ -0,0 +1,42 @@
+//
+//  cef_request_handler.h
+//  webview
+//
+//  Mock CEF: browser request handlers
+//
+
+#ifndef cef_mock_request_handler_h
+#define cef_mock_request_handler_h
+#pragma once
+
+#include "include/cef_browser.h"
+#include "include/cef_request.h"
+#include "include/cef_resource_handler.h"
+
+class CefResourceRequestHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual CefRefPtr<CefResourceHandler> GetResourceHandler(CefRefPtr<CefBrowser> browser,
+                                                             CefRefPtr<CefFrame> frame,
+                                                             CefRefPtr<CefRequest> request)
+    {
+        return nullptr;
+    }
+};
+
+class CefRequestHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual CefRefPtr<CefResourceRequestHandler> GetResourceRequestHandler(CefRefPtr<CefBrowser> browser,
+                                                                           CefRefPtr<CefFrame> frame,
+                                                                           CefRefPtr<CefRequest> request,
+                                                                           bool is_navigation,
+                                                                           bool is_download,
+                                                                           const CefString &request_initiator,
+                                                                           bool &disable_default_handling)
+    {
+        return nullptr;
+    }
+};
+
+#endif /* cef_mock_request_handler_h */
@@ -0,0 +1,42 @@
+//
+//  cef_resource_handler.h
+//  webview
+//
+//  Mock CEF: custom resource handler interface
+//
+
+#ifndef cef_mock_resource_handler_h
+#define cef_mock_resource_handler_h
+#pragma once
+
+#include "include/cef_request.h"
+
+class CefResourceHandler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback)
+    {
+        handle_request = false;
+        return false;
+    }
+
+    virtual void GetResponseHeaders(CefRefPtr<CefResponse> response,
+                                    int64_t &response_length,
+                                    CefString &redirectUrl) = 0;
+
+    virtual bool Skip(int64_t bytes_to_skip, int64_t &bytes_skipped, CefRefPtr<CefResourceSkipCallback> callback)
+    {
+        bytes_skipped = -2;
+        return false;
+    }
+
+    virtual bool Read(void *data_out, int bytes_to_read, int &bytes_read, CefRefPtr<CefResourceReadCallback> callback)
+    {
+        bytes_read = -2;
+        return false;
+    }
+
+    virtual void Cancel() = 0;
+};
+
+#endif /* cef_mock_resource_handler_h */
@@ -0,0 +1,41 @@
+//
+//  cef_scheme.h
+//  webview
+//
+//  Mock CEF: custom scheme registration
+//
+
+#ifndef cef_mock_scheme_h
+#define cef_mock_scheme_h
+#pragma once
+
+#include "include/cef_browser.h"
+#include "include/cef_resource_handler.h"
+
+class CefSchemeRegistrar
+{
+  public:
+    virtual ~CefSchemeRegistrar()
+    {
+    }
+
+    virtual bool AddCustomScheme(const CefString &scheme_name, int options) = 0;
+};
+
+class CefSchemeHandlerFactory : public virtual CefBaseRefCounted
+{
+  public:
+    virtual CefRefPtr<CefResourceHandler> Create(CefRefPtr<CefBrowser> browser,
+                                                 CefRefPtr<CefFrame> frame,
+                                                 const CefString &scheme_name,
+                                                 CefRefPtr<CefRequest> request) = 0;
+};
+
+///
+/// Register a scheme handler factory, the mock keeps one factory per scheme and domain pair.
+///
+bool CefRegisterSchemeHandlerFactory(const CefString &scheme_name,
+                                     const CefString &domain_name,
+                                     CefRefPtr<CefSchemeHandlerFactory> factory);
+
+#endif /* cef_mock_scheme_h */
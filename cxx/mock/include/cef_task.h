@@ -0,0 +1,37 @@
+//
+//  cef_task.h
+//  webview
+//
+//  Mock CEF: task posting
+//
+
+#ifndef cef_mock_task_h
+#define cef_mock_task_h
+#pragma once
+
+#include "include/cef_base.h"
+
+class CefTask : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void Execute() = 0;
+};
+
+///
+/// Returns true if called on the specified thread.
+///
+bool CefCurrentlyOn(CefThreadId thread_id);
+
+///
+/// Post a task for execution on the specified thread.
+///
+/// The UI queue is drained by the message loop functions, every other thread id is backed by a worker thread.
+///
+bool CefPostTask(CefThreadId thread_id, CefRefPtr<CefTask> task);
+
+///
+/// Post a task for delayed execution on the specified thread.
+///
+bool CefPostDelayedTask(CefThreadId thread_id, CefRefPtr<CefTask> task, int64_t delay_ms);
+
+#endif /* cef_mock_task_h */
@@ -0,0 +1,252 @@
+//
+//  cef_v8.h
+//  webview
+//
+//  Mock CEF: a tiny value model standing in for V8
+//
+
+#ifndef cef_mock_v8_h
+#define cef_mock_v8_h
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "include/cef_browser.h"
+
+class CefV8Value;
+class CefV8Context;
+
+typedef std::vector<CefRefPtr<CefV8Value>> CefV8ValueList;
+
+class CefV8Handler : public virtual CefBaseRefCounted
+{
+  public:
+    virtual bool Execute(const CefString &name,
+                         CefRefPtr<CefV8Value> object,
+                         const CefV8ValueList &arguments,
+                         CefRefPtr<CefV8Value> &retval,
+                         CefString &exception) = 0;
+};
+
+class CefV8Accessor : public virtual CefBaseRefCounted
+{
+};
+
+class CefV8ArrayBufferReleaseCallback : public virtual CefBaseRefCounted
+{
+  public:
+    virtual void ReleaseBuffer(void *buffer) = 0;
+};
+
+class CefV8Interceptor : public virtual CefBaseRefCounted
+{
+};
+
+class CefV8Context : public virtual CefBaseRefCounted
+{
+  public:
+    ///
+    /// Returns the innermost context entered on the calling thread.
+    ///
+    static CefRefPtr<CefV8Context> GetCurrentContext();
+
+    CefV8Context(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame);
+
+    CefRefPtr<CefBrowser> GetBrowser()
+    {
+        return _browser;
+    }
+
+    CefRefPtr<CefFrame> GetFrame()
+    {
+        return _frame;
+    }
+
+    CefRefPtr<CefV8Value> GetGlobal()
+    {
+        return _global;
+    }
+
+    bool IsValid()
+    {
+        return true;
+    }
+
+    bool IsSame(CefRefPtr<CefV8Context> that)
+    {
+        return this == that.get();
+    }
+
+    bool Enter();
+    bool Exit();
+
+    ///
+    /// Mock only: stands in for garbage collection when the context is released, dropping everything reachable
+    /// from the global object so script objects referencing the context do not keep it alive.
+    ///
+    void Dispose();
+
+  private:
+    CefRefPtr<CefBrowser> _browser;
+    CefRefPtr<CefFrame> _frame;
+    CefRefPtr<CefV8Value> _global;
+
+    IMPLEMENT_REFCOUNTING(CefV8Context);
+};
+
+class CefV8Value : public virtual CefBaseRefCounted
+{
+  public:
+    typedef cef_v8_propertyattribute_t PropertyAttribute;
+
+    static CefRefPtr<CefV8Value> CreateUndefined();
+    static CefRefPtr<CefV8Value> CreateNull();
+    static CefRefPtr<CefV8Value> CreateBool(bool value);
+    static CefRefPtr<CefV8Value> CreateInt(int32_t value);
+    static CefRefPtr<CefV8Value> CreateDouble(double value);
+    static CefRefPtr<CefV8Value> CreateString(const CefString &value);
+    static CefRefPtr<CefV8Value> CreateObject(CefRefPtr<CefV8Accessor> accessor,
+                                              CefRefPtr<CefV8Interceptor> interceptor);
+    static CefRefPtr<CefV8Value> CreateFunction(const CefString &name, CefRefPtr<CefV8Handler> handler);
+    static CefRefPtr<CefV8Value> CreateArrayBuffer(void *buffer,
+                                                   size_t length,
+                                                   CefRefPtr<CefV8ArrayBufferReleaseCallback> release_callback);
+    static CefRefPtr<CefV8Value> CreateArrayBufferWithCopy(void *buffer, size_t length);
+
+    ~CefV8Value();
+
+    bool IsUndefined()
+    {
+        return _kind == Kind::Undefined;
+    }
+
+    bool IsNull()
+    {
+        return _kind == Kind::Null;
+    }
+
+    bool IsBool()
+    {
+        return _kind == Kind::Bool;
+    }
+
+    bool IsInt()
+    {
+        return _kind == Kind::Int;
+    }
+
+    bool IsDouble()
+    {
+        return _kind == Kind::Double || _kind == Kind::Int;
+    }
+
+    bool IsString()
+    {
+        return _kind == Kind::String;
+    }
+
+    bool IsObject()
+    {
+        return _kind == Kind::Object || _kind == Kind::Function || _kind == Kind::ArrayBuffer;
+    }
+
+    bool IsArrayBuffer()
+    {
+        return _kind == Kind::ArrayBuffer;
+    }
+
+    bool IsFunction()
+    {
+        return _kind == Kind::Function;
+    }
+
+    bool GetBoolValue()
+    {
+        return _bool;
+    }
+
+    int32_t GetIntValue()
+    {
+        return static_cast<int32_t>(_number);
+    }
+
+    double GetDoubleValue()
+    {
+        return _number;
+    }
+
+    CefString GetStringValue()
+    {
+        return _string;
+    }
+
+    bool HasValue(const CefString &key)
+    {
+        return _properties.count(key.ToString()) > 0;
+    }
+
+    CefRefPtr<CefV8Value> GetValue(const CefString &key);
+    bool SetValue(const CefString &key, CefRefPtr<CefV8Value> value, PropertyAttribute attribute);
+    bool DeleteValue(const CefString &key);
+
+    size_t GetArrayBufferByteLength()
+    {
+        return _length;
+    }
+
+    void *GetArrayBufferData()
+    {
+        return _buffer;
+    }
+
+    CefString GetFunctionName()
+    {
+        return _string;
+    }
+
+    CefRefPtr<CefV8Handler> GetFunctionHandler()
+    {
+        return _handler;
+    }
+
+    ///
+    /// Invoke the native handler behind a function value, returns nullptr when the handler raised an exception.
+    ///
+    CefRefPtr<CefV8Value> ExecuteFunction(CefRefPtr<CefV8Value> object, const CefV8ValueList &arguments);
+
+  private:
+    friend class CefV8Context;
+
+    enum class Kind
+    {
+        Undefined,
+        Null,
+        Bool,
+        Int,
+        Double,
+        String,
+        Object,
+        Function,
+        ArrayBuffer,
+    };
+
+    explicit CefV8Value(Kind kind) : _kind(kind)
+    {
+    }
+
+    Kind _kind;
+    bool _bool = false;
+    double _number = 0;
+    CefString _string;
+    CefRefPtr<CefV8Handler> _handler;
+    void *_buffer = nullptr;
+    size_t _length = 0;
+    std::vector<uint8_t> _copy;
+    CefRefPtr<CefV8ArrayBufferReleaseCallback> _release;
+    std::map<std::string, CefRefPtr<CefV8Value>> _properties;
+
+    IMPLEMENT_REFCOUNTING(CefV8Value);
+};
+
+#endif /* cef_mock_v8_h */
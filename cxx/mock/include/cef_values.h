@@ -0,0 +1,150 @@
+//
+//  cef_values.h
+//  webview
+//
+//  Mock CEF: list and dictionary values
+//
+
+#ifndef cef_mock_values_h
+#define cef_mock_values_h
+#pragma once
+
+#include <map>
+#include <variant>
+#include <vector>
+
+#include "include/cef_base.h"
+
+class CefListValue : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefListValue> Create();
+
+    bool SetSize(size_t size)
+    {
+        _values.resize(size);
+        return true;
+    }
+
+    size_t GetSize() const
+    {
+        return _values.size();
+    }
+
+    bool SetString(size_t index, const CefString &value)
+    {
+        return Set(index, value.ToString());
+    }
+
+    bool SetInt(size_t index, int value)
+    {
+        return Set(index, value);
+    }
+
+    bool SetBool(size_t index, bool value)
+    {
+        return Set(index, value);
+    }
+
+    CefString GetString(size_t index) const
+    {
+        return Get<std::string>(index);
+    }
+
+    int GetInt(size_t index) const
+    {
+        return Get<int>(index);
+    }
+
+    bool GetBool(size_t index) const
+    {
+        return Get<bool>(index);
+    }
+
+    CefRefPtr<CefListValue> Copy() const
+    {
+        CefRefPtr<CefListValue> copy = Create();
+        copy->_values = _values;
+        return copy;
+    }
+
+  private:
+    using Value = std::variant<std::monostate, std::string, int, bool>;
+
+    template <class T> bool Set(size_t index, T value)
+    {
+        if (index >= _values.size())
+        {
+            _values.resize(index + 1);
+        }
+
+        _values[index] = std::move(value);
+        return true;
+    }
+
+    template <class T> T Get(size_t index) const
+    {
+        if (index < _values.size())
+        {
+            if (auto value = std::get_if<T>(&_values[index]))
+            {
+                return *value;
+            }
+        }
+
+        return T{};
+    }
+
+    std::vector<Value> _values;
+
+    IMPLEMENT_REFCOUNTING(CefListValue);
+};
+
+class CefDictionaryValue : public virtual CefBaseRefCounted
+{
+  public:
+    static CefRefPtr<CefDictionaryValue> Create();
+
+    bool SetString(const CefString &key, const CefString &value)
+    {
+        _values[key.ToString()] = value.ToString();
+        return true;
+    }
+
+    CefString GetString(const CefString &key) const
+    {
+        auto it = _values.find(key.ToString());
+        return it != _values.end() ? CefString(it->second) : CefString();
+    }
+
+    bool SetBool(const CefString &key, bool value)
+    {
+        _values[key.ToString()] = value ? "true" : "false";
+        return true;
+    }
+
+    bool GetBool(const CefString &key) const
+    {
+        auto it = _values.find(key.ToString());
+        return it != _values.end() && it->second == "true";
+    }
+
+    bool HasKey(const CefString &key) const
+    {
+        return _values.count(key.ToString()) > 0;
+    }
+
+    CefRefPtr<CefDictionaryValue> Copy(bool exclude_empty_children) const
+    {
+        CefRefPtr<CefDictionaryValue> copy = Create();
+        copy->_values = _values;
+        return copy;
+    }
+
+  private:
+    std::map<std::string, std::string> _values;
+
+    IMPLEMENT_REFCOUNTING(CefDictionaryValue);
+};
+
+#endif /* cef_mock_values_h */
@@ -0,0 +1,200 @@
+//
+//  cef_ptr.h
+//  webview
+//
+//  Mock CEF: reference counting primitives
+//
+
+#ifndef cef_mock_ptr_h
+#define cef_mock_ptr_h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+class CefBaseRefCounted
+{
+  public:
+    virtual void AddRef() const = 0;
+    virtual bool Release() const = 0;
+    virtual bool HasOneRef() const = 0;
+    virtual bool HasAtLeastOneRef() const = 0;
+
+  protected:
+    virtual ~CefBaseRefCounted()
+    {
+    }
+};
+
+class CefRefCount
+{
+  public:
+    void AddRef() const
+    {
+        _count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool Release() const
+    {
+        return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    bool HasOneRef() const
+    {
+        return _count.load(std::memory_order_acquire) == 1;
+    }
+
+    bool HasAtLeastOneRef() const
+    {
+        return _count.load(std::memory_order_acquire) > 0;
+    }
+
+  private:
+    mutable std::atomic<int> _count{0};
+};
+
+template <class T> class CefRefPtr
+{
+  public:
+    CefRefPtr() = default;
+
+    CefRefPtr(std::nullptr_t)
+    {
+    }
+
+    CefRefPtr(T *ptr) : _ptr(ptr)
+    {
+        if (_ptr != nullptr)
+        {
+            _ptr->AddRef();
+        }
+    }
+
+    CefRefPtr(const CefRefPtr &other) : CefRefPtr(other._ptr)
+    {
+    }
+
+    CefRefPtr(CefRefPtr &&other) noexcept : _ptr(std::exchange(other._ptr, nullptr))
+    {
+    }
+
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    CefRefPtr(const CefRefPtr<U> &other) : CefRefPtr(other.get())
+    {
+    }
+
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U *, T *>>>
+    CefRefPtr(CefRefPtr<U> &&other) noexcept : _ptr(other.release())
+    {
+    }
+
+    ~CefRefPtr()
+    {
+        if (_ptr != nullptr)
+        {
+            _ptr->Release();
+        }
+    }
+
+    CefRefPtr &operator=(CefRefPtr other) noexcept
+    {
+        std::swap(_ptr, other._ptr);
+        return *this;
+    }
+
+    T *get() const
+    {
+        return _ptr;
+    }
+
+    T *release()
+    {
+        return std::exchange(_ptr, nullptr);
+    }
+
+    T &operator*() const
+    {
+        return *_ptr;
+    }
+
+    T *operator->() const
+    {
+        return _ptr;
+    }
+
+    explicit operator bool() const
+    {
+        return _ptr != nullptr;
+    }
+
+  private:
+    T *_ptr = nullptr;
+};
+
+template <class T, class U> bool operator==(const CefRefPtr<T> &lhs, const CefRefPtr<U> &rhs)
+{
+    return lhs.get() == rhs.get();
+}
+
+template <class T, class U> bool operator!=(const CefRefPtr<T> &lhs, const CefRefPtr<U> &rhs)
+{
+    return lhs.get() != rhs.get();
+}
+
+template <class T> bool operator==(const CefRefPtr<T> &lhs, std::nullptr_t)
+{
+    return lhs.get() == nullptr;
+}
+
+template <class T> bool operator!=(const CefRefPtr<T> &lhs, std::nullptr_t)
+{
+    return lhs.get() != nullptr;
+}
+
+template <class T> bool operator==(const CefRefPtr<T> &lhs, const T *rhs)
+{
+    return lhs.get() == rhs;
+}
+
+template <class T> bool operator!=(const CefRefPtr<T> &lhs, const T *rhs)
+{
+    return lhs.get() != rhs;
+}
+
+template <class T> using CefRawPtr = T *;
+
+// clang-format off
+#define IMPLEMENT_REFCOUNTING(ClassName) \
+  public: \
+    void AddRef() const override \
+    { \
+        _ref_count.AddRef(); \
+    } \
+    bool Release() const override \
+    { \
+        if (_ref_count.Release()) \
+        { \
+            delete static_cast<const ClassName *>(this); \
+            return true; \
+        } \
+        return false; \
+    } \
+    bool HasOneRef() const override \
+    { \
+        return _ref_count.HasOneRef(); \
+    } \
+    bool HasAtLeastOneRef() const override \
+    { \
+        return _ref_count.HasAtLeastOneRef(); \
+    } \
+  private: \
+    CefRefCount _ref_count
+
+#define DISALLOW_COPY_AND_ASSIGN(TypeName) \
+    TypeName(const TypeName &) = delete; \
+    TypeName &operator=(const TypeName &) = delete
+// clang-format on
+
+#endif /* cef_mock_ptr_h */
@@ -0,0 +1,620 @@
+//
+//  cef_types.h
+//  webview
+//
+//  Mock CEF: plain value types, enums and settings structures
+//
+
+#ifndef cef_mock_types_h
+#define cef_mock_types_h
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///
+/// The mock keeps strings as UTF-8 instead of UTF-16, conversion is not what is being exercised.
+///
+typedef struct _cef_string_t
+{
+    std::string str;
+} cef_string_t;
+
+class CefString
+{
+  public:
+    CefString() : _target(&_owned)
+    {
+    }
+
+    CefString(const CefString &other) : _owned{other.ToString()}, _target(&_owned)
+    {
+    }
+
+    CefString(const std::string &value) : _owned{value}, _target(&_owned)
+    {
+    }
+
+    CefString(const char *value) : _owned{value != nullptr ? value : ""}, _target(&_owned)
+    {
+    }
+
+    ///
+    /// Attach to an existing structure member, writes go straight to |value|.
+    ///
+    CefString(cef_string_t *value) : _target(value)
+    {
+    }
+
+    CefString(const cef_string_t *value) : _owned(*value), _target(&_owned)
+    {
+    }
+
+    CefString &operator=(const CefString &other)
+    {
+        _target->str = other.ToString();
+        return *this;
+    }
+
+    bool FromString(const std::string &value)
+    {
+        _target->str = value;
+        return true;
+    }
+
+    bool FromASCII(const char *value)
+    {
+        _target->str = value != nullptr ? value : "";
+        return true;
+    }
+
+    std::string ToString() const
+    {
+        return _target->str;
+    }
+
+    operator std::string() const
+    {
+        return _target->str;
+    }
+
+    const char *c_str() const
+    {
+        return _target->str.c_str();
+    }
+
+    size_t length() const
+    {
+        return _target->str.length();
+    }
+
+    bool empty() const
+    {
+        return _target->str.empty();
+    }
+
+    bool operator==(const CefString &other) const
+    {
+        return _target->str == other._target->str;
+    }
+
+    bool operator!=(const CefString &other) const
+    {
+        return _target->str != other._target->str;
+    }
+
+    bool operator<(const CefString &other) const
+    {
+        return _target->str < other._target->str;
+    }
+
+  private:
+    cef_string_t _owned;
+    cef_string_t *_target;
+};
+
+#ifdef WIN32
+typedef void *CefWindowHandle;
+typedef void *CefCursorHandle;
+#elif defined(LINUX)
+typedef unsigned long CefWindowHandle;
+typedef unsigned long CefCursorHandle;
+#else
+typedef void *CefWindowHandle;
+typedef void *CefCursorHandle;
+#endif
+
+typedef enum
+{
+    TID_UI,
+    TID_FILE_BACKGROUND,
+    TID_FILE_USER_VISIBLE,
+    TID_FILE_USER_BLOCKING,
+    TID_PROCESS_LAUNCHER,
+    TID_IO,
+    TID_RENDERER,
+    TID_NUM_VALUES,
+} cef_thread_id_t;
+
+typedef cef_thread_id_t CefThreadId;
+
+typedef enum
+{
+    PID_BROWSER,
+    PID_RENDERER,
+} cef_process_id_t;
+
+typedef cef_process_id_t CefProcessId;
+
+typedef enum
+{
+    RT_MAIN_FRAME = 0,
+    RT_SUB_FRAME,
+    RT_STYLESHEET,
+    RT_SCRIPT,
+    RT_IMAGE,
+    RT_FONT_RESOURCE,
+    RT_SUB_RESOURCE,
+    RT_OBJECT,
+    RT_MEDIA,
+    RT_WORKER,
+    RT_SHARED_WORKER,
+    RT_PREFETCH,
+    RT_FAVICON,
+    RT_XHR,
+    RT_PING,
+    RT_SERVICE_WORKER,
+    RT_CSP_REPORT,
+    RT_PLUGIN_RESOURCE,
+    RT_NAVIGATION_PRELOAD_MAIN_FRAME = 19,
+    RT_NAVIGATION_PRELOAD_SUB_FRAME,
+} cef_resource_type_t;
+
+typedef enum
+{
+    PDE_TYPE_EMPTY = 0,
+    PDE_TYPE_BYTES,
+    PDE_TYPE_FILE,
+} cef_postdataelement_type_t;
+
+typedef enum
+{
+    STATE_DEFAULT = 0,
+    STATE_ENABLED,
+    STATE_DISABLED,
+} cef_state_t;
+
+typedef enum
+{
+    LOGSEVERITY_DEFAULT,
+    LOGSEVERITY_VERBOSE,
+    LOGSEVERITY_DEBUG = LOGSEVERITY_VERBOSE,
+    LOGSEVERITY_INFO,
+    LOGSEVERITY_WARNING,
+    LOGSEVERITY_ERROR,
+    LOGSEVERITY_FATAL,
+    LOGSEVERITY_DISABLE = 99
+} cef_log_severity_t;
+
+typedef enum
+{
+    EVENTFLAG_NONE = 0,
+    EVENTFLAG_CAPS_LOCK_ON = 1 << 0,
+    EVENTFLAG_SHIFT_DOWN = 1 << 1,
+    EVENTFLAG_CONTROL_DOWN = 1 << 2,
+    EVENTFLAG_ALT_DOWN = 1 << 3,
+    EVENTFLAG_LEFT_MOUSE_BUTTON = 1 << 4,
+    EVENTFLAG_MIDDLE_MOUSE_BUTTON = 1 << 5,
+    EVENTFLAG_RIGHT_MOUSE_BUTTON = 1 << 6,
+} cef_event_flags_t;
+
+typedef enum
+{
+    MBT_LEFT = 0,
+    MBT_MIDDLE,
+    MBT_RIGHT,
+} cef_mouse_button_type_t;
+
+typedef enum
+{
+    KEYEVENT_RAWKEYDOWN = 0,
+    KEYEVENT_KEYDOWN,
+    KEYEVENT_KEYUP,
+    KEYEVENT_CHAR
+} cef_key_event_type_t;
+
+typedef enum
+{
+    CEF_TET_RELEASED = 0,
+    CEF_TET_PRESSED,
+    CEF_TET_MOVED,
+    CEF_TET_CANCELLED
+} cef_touch_event_type_t;
+
+typedef enum
+{
+    CEF_POINTER_TYPE_TOUCH = 0,
+    CEF_POINTER_TYPE_MOUSE,
+    CEF_POINTER_TYPE_PEN,
+    CEF_POINTER_TYPE_ERASER,
+    CEF_POINTER_TYPE_UNKNOWN
+} cef_pointer_type_t;
+
+typedef enum
+{
+    CT_POINTER,
+    CT_CROSS,
+    CT_HAND,
+    CT_IBEAM,
+    CT_WAIT,
+    CT_HELP,
+    CT_CUSTOM = 45,
+    CT_NUM_VALUES = 50,
+} cef_cursor_type_t;
+
+typedef enum
+{
+    PET_VIEW = 0,
+    PET_POPUP,
+} cef_paint_element_type_t;
+
+typedef enum
+{
+    TT_LINK = 0,
+    TT_EXPLICIT = 1,
+} cef_transition_type_t;
+
+typedef enum
+{
+    ERR_NONE = 0,
+    ERR_FAILED = -2,
+    ERR_ABORTED = -3,
+} cef_errorcode_t;
+
+typedef enum
+{
+    DRAG_OPERATION_NONE = 0,
+    DRAG_OPERATION_COPY = 1,
+    DRAG_OPERATION_EVERY = 0xFFFFFFFF,
+} cef_drag_operations_mask_t;
+
+typedef enum
+{
+    CEF_WOD_UNKNOWN,
+    CEF_WOD_CURRENT_TAB,
+    CEF_WOD_NEW_FOREGROUND_TAB,
+} cef_window_open_disposition_t;
+
+typedef enum
+{
+    CM_TYPEFLAG_NONE = 0,
+    CM_TYPEFLAG_PAGE = 1 << 0,
+    CM_TYPEFLAG_FRAME = 1 << 1,
+    CM_TYPEFLAG_LINK = 1 << 2,
+    CM_TYPEFLAG_MEDIA = 1 << 3,
+    CM_TYPEFLAG_SELECTION = 1 << 4,
+    CM_TYPEFLAG_EDITABLE = 1 << 5,
+} cef_context_menu_type_flags_t;
+
+typedef enum
+{
+    CEF_CUS_SOLID,
+    CEF_CUS_DOT,
+    CEF_CUS_DASH,
+    CEF_CUS_NONE,
+} cef_composition_underline_style_t;
+
+typedef enum
+{
+    CEF_SCHEME_OPTION_NONE = 0,
+    CEF_SCHEME_OPTION_STANDARD = 1 << 0,
+    CEF_SCHEME_OPTION_LOCAL = 1 << 1,
+    CEF_SCHEME_OPTION_DISPLAY_ISOLATED = 1 << 2,
+    CEF_SCHEME_OPTION_SECURE = 1 << 3,
+    CEF_SCHEME_OPTION_CORS_ENABLED = 1 << 4,
+    CEF_SCHEME_OPTION_CSP_BYPASSING = 1 << 5,
+    CEF_SCHEME_OPTION_FETCH_ENABLED = 1 << 6,
+} cef_scheme_options_t;
+
+typedef enum
+{
+    CEF_COOKIE_SAME_SITE_UNSPECIFIED,
+    CEF_COOKIE_SAME_SITE_NO_RESTRICTION,
+    CEF_COOKIE_SAME_SITE_LAX_MODE,
+    CEF_COOKIE_SAME_SITE_STRICT_MODE,
+} cef_cookie_same_site_t;
+
+typedef enum
+{
+    CEF_COOKIE_PRIORITY_LOW = -1,
+    CEF_COOKIE_PRIORITY_MEDIUM = 0,
+    CEF_COOKIE_PRIORITY_HIGH = 1,
+} cef_cookie_priority_t;
+
+typedef enum
+{
+    V8_PROPERTY_ATTRIBUTE_NONE = 0,
+    V8_PROPERTY_ATTRIBUTE_READONLY = 1 << 0,
+    V8_PROPERTY_ATTRIBUTE_DONTENUM = 1 << 1,
+    V8_PROPERTY_ATTRIBUTE_DONTDELETE = 1 << 2
+} cef_v8_propertyattribute_t;
+
+typedef struct
+{
+    int x;
+    int y;
+    uint32_t modifiers;
+} cef_mouse_event_t;
+
+typedef struct
+{
+    cef_key_event_type_t type;
+    uint32_t modifiers;
+    int windows_key_code;
+    int native_key_code;
+    int is_system_key;
+    char16_t character;
+    char16_t unmodified_character;
+    int focus_on_editable_field;
+} cef_key_event_t;
+
+typedef struct
+{
+    int id;
+    float x;
+    float y;
+    float radius_x;
+    float radius_y;
+    float rotation_angle;
+    float pressure;
+    cef_touch_event_type_t type;
+    uint32_t modifiers;
+    cef_pointer_type_t pointer_type;
+} cef_touch_event_t;
+
+class CefMouseEvent : public cef_mouse_event_t
+{
+  public:
+    CefMouseEvent() : cef_mouse_event_t{}
+    {
+    }
+
+    CefMouseEvent(const cef_mouse_event_t &event) : cef_mouse_event_t(event)
+    {
+    }
+};
+
+class CefKeyEvent : public cef_key_event_t
+{
+  public:
+    CefKeyEvent() : cef_key_event_t{}
+    {
+    }
+
+    CefKeyEvent(const cef_key_event_t &event) : cef_key_event_t(event)
+    {
+    }
+};
+
+class CefTouchEvent : public cef_touch_event_t
+{
+  public:
+    CefTouchEvent() : cef_touch_event_t{}
+    {
+    }
+
+    CefTouchEvent(const cef_touch_event_t &event) : cef_touch_event_t(event)
+    {
+    }
+};
+
+class CefPoint
+{
+  public:
+    CefPoint() = default;
+    CefPoint(int x, int y) : x(x), y(y)
+    {
+    }
+
+    int x = 0;
+    int y = 0;
+};
+
+class CefSize
+{
+  public:
+    CefSize() = default;
+    CefSize(int width, int height) : width(width), height(height)
+    {
+    }
+
+    int width = 0;
+    int height = 0;
+};
+
+class CefRect
+{
+  public:
+    CefRect() = default;
+    CefRect(int x, int y, int width, int height) : x(x), y(y), width(width), height(height)
+    {
+    }
+
+    bool IsEmpty() const
+    {
+        return width <= 0 || height <= 0;
+    }
+
+    bool operator==(const CefRect &other) const
+    {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+class CefRange
+{
+  public:
+    CefRange() = default;
+    CefRange(uint32_t from, uint32_t to) : from(from), to(to)
+    {
+    }
+
+    static CefRange InvalidRange()
+    {
+        return CefRange(UINT32_MAX, UINT32_MAX);
+    }
+
+    uint32_t from = 0;
+    uint32_t to = 0;
+};
+
+class CefCompositionUnderline
+{
+  public:
+    CefRange range;
+    uint32_t color = 0;
+    uint32_t background_color = 0;
+    int thick = 0;
+    cef_composition_underline_style_t style = CEF_CUS_SOLID;
+};
+
+class CefCursorInfo
+{
+  public:
+    CefPoint hotspot;
+    float image_scale_factor = 1.0f;
+    void *buffer = nullptr;
+    CefSize size;
+};
+
+class CefScreenInfo
+{
+  public:
+    float device_scale_factor = 1.0f;
+    int depth = 24;
+    int depth_per_component = 8;
+    bool is_monochrome = false;
+    CefRect rect;
+    CefRect available_rect;
+};
+
+class CefPopupFeatures
+{
+  public:
+    int x = 0;
+    bool xSet = false;
+    int y = 0;
+    bool ySet = false;
+    int width = 0;
+    bool widthSet = false;
+    int height = 0;
+    bool heightSet = false;
+    bool isPopup = false;
+};
+
+typedef struct
+{
+    int64_t val;
+} cef_basetime_t;
+
+class CefCookie
+{
+  public:
+    cef_string_t name;
+    cef_string_t value;
+    cef_string_t domain;
+    cef_string_t path;
+    int secure = 0;
+    int httponly = 0;
+    cef_basetime_t creation{};
+    cef_basetime_t last_access{};
+    int has_expires = 0;
+    cef_basetime_t expires{};
+    cef_cookie_same_site_t same_site = CEF_COOKIE_SAME_SITE_UNSPECIFIED;
+    cef_cookie_priority_t priority = CEF_COOKIE_PRIORITY_MEDIUM;
+};
+
+class CefSettings
+{
+  public:
+    bool no_sandbox = false;
+    cef_string_t browser_subprocess_path;
+    cef_string_t framework_dir_path;
+    cef_string_t main_bundle_path;
+    bool multi_threaded_message_loop = false;
+    bool external_message_pump = false;
+    bool windowless_rendering_enabled = false;
+    bool command_line_args_disabled = false;
+    cef_string_t cache_path;
+    cef_string_t root_cache_path;
+    bool persist_session_cookies = false;
+    cef_string_t user_agent;
+    cef_string_t user_agent_product;
+    cef_string_t locale;
+    cef_string_t log_file;
+    cef_log_severity_t log_severity = LOGSEVERITY_DEFAULT;
+    cef_string_t javascript_flags;
+    cef_string_t resources_dir_path;
+    cef_string_t locales_dir_path;
+    uint32_t background_color = 0;
+    bool disable_signal_handlers = false;
+};
+
+class CefBrowserSettings
+{
+  public:
+    int windowless_frame_rate = 30;
+    int default_font_size = 0;
+    int default_fixed_font_size = 0;
+    int minimum_font_size = 0;
+    int minimum_logical_font_size = 0;
+    cef_state_t javascript = STATE_DEFAULT;
+    cef_state_t javascript_close_windows = STATE_DEFAULT;
+    cef_state_t javascript_access_clipboard = STATE_DEFAULT;
+    cef_state_t javascript_dom_paste = STATE_DEFAULT;
+    cef_state_t local_storage = STATE_DEFAULT;
+    cef_state_t databases = STATE_DEFAULT;
+    cef_state_t webgl = STATE_DEFAULT;
+    uint32_t background_color = 0;
+};
+
+class CefWindowInfo
+{
+  public:
+    void SetAsWindowless(CefWindowHandle parent)
+    {
+        windowless_rendering_enabled = true;
+        parent_window = parent;
+    }
+
+    void SetAsChild(CefWindowHandle parent, const CefRect &rect)
+    {
+        windowless_rendering_enabled = false;
+        parent_window = parent;
+        bounds = rect;
+    }
+
+    bool windowless_rendering_enabled = false;
+    CefWindowHandle parent_window{};
+    CefRect bounds;
+};
+
+class CefMainArgs
+{
+  public:
+    CefMainArgs() = default;
+    CefMainArgs(int argc, char **argv) : argc(argc), argv(argv)
+    {
+    }
+
+    int argc = 0;
+    char **argv = nullptr;
+};
+
+#endif /* cef_mock_types_h */
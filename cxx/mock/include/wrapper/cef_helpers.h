@@ -0,0 +1,18 @@
+//
+//  cef_helpers.h
+//  webview
+//
+//  Mock CEF: thread assertion helpers
+//
+
+#ifndef cef_mock_helpers_h
+#define cef_mock_helpers_h
+#pragma once
+
+#include "include/cef_task.h"
+
+#define CEF_REQUIRE_UI_THREAD() assert(CefCurrentlyOn(TID_UI));
+#define CEF_REQUIRE_IO_THREAD() assert(CefCurrentlyOn(TID_IO));
+#define CEF_REQUIRE_RENDERER_THREAD() assert(CefCurrentlyOn(TID_RENDERER));
+
+#endif /* cef_mock_helpers_h */
@@ -0,0 +1,252 @@
+//
+//  motion.cpp
+//  webview
+//
+//  Scroll detection between successive windowless view frames
+//
+
+#include "motion.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+static const uint64_t PRIME = 0x100000001b3;
+
+// Four independent lanes keep the multiplies out of a single dependency chain and let the compiler vectorize.
+static uint64_t HashRow(const uint32_t *row, int width)
+{
+    uint64_t lanes[4] = {1, 2, 3, 4};
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            lanes[i] = (lanes[i] ^ row[x + i]) * PRIME;
+        }
+    }
+
+    for (; x < width; x++)
+    {
+        lanes[0] = (lanes[0] ^ row[x]) * PRIME;
+    }
+
+    return lanes[0] ^ (lanes[1] << 1) ^ (lanes[2] << 2) ^ (lanes[3] << 3);
+}
+
+// Finds the shift with the most lines of next equal to lines of prev, then the longest run of lines at that shift.
+static bool FindShift(const std::vector<uint64_t> &prev,
+                      const std::vector<uint64_t> &next,
+                      int min_band,
+                      int &shift,
+                      int &start,
+                      int &length)
+{
+    int count = static_cast<int>(next.size());
+
+    // Lines that repeat, such as blank ones, say nothing about the shift.
+    std::unordered_map<uint64_t, int> lines;
+    lines.reserve(prev.size());
+    for (int i = 0; i < count; i++)
+    {
+        auto it = lines.emplace(prev[i], i);
+        if (!it.second)
+        {
+            it.first->second = -1;
+        }
+    }
+
+    std::unordered_map<int, int> votes;
+    for (int i = 0; i < count; i++)
+    {
+        auto it = lines.find(next[i]);
+        if (it != lines.end() && it->second >= 0 && it->second != i)
+        {
+            votes[i - it->second] += 1;
+        }
+    }
+
+    int best = 0;
+    int best_votes = 0;
+    for (auto &it : votes)
+    {
+        if (it.second > best_votes)
+        {
+            best = it.first;
+            best_votes = it.second;
+        }
+    }
+
+    if (best_votes == 0)
+    {
+        return false;
+    }
+
+    length = 0;
+    for (int i = std::max(best, 0), run = 0; i < count && i - best < count; i++)
+    {
+        run = next[i] == prev[i - best] ? run + 1 : 0;
+        if (run > length)
+        {
+            length = run;
+            start = i - run + 1;
+        }
+    }
+
+    shift = best;
+
+    return length >= min_band;
+}
+
+// Lines outside the band that differ from the previous frame, merged into spans.
+static void CollectDamage(const std::vector<uint64_t> &prev,
+                          const std::vector<uint64_t> &next,
+                          int start,
+                          int length,
+                          bool vertical,
+                          int extent,
+                          std::vector<Rect> &damage)
+{
+    int count = static_cast<int>(next.size());
+    for (int i = 0; i < count;)
+    {
+        if ((i >= start && i < start + length) || next[i] == prev[i])
+        {
+            i++;
+            continue;
+        }
+
+        int first = i;
+        while (i < count && !(i >= start && i < start + length) && next[i] != prev[i])
+        {
+            i++;
+        }
+
+        damage.push_back(vertical ? Rect{0, first, extent, i - first} : Rect{first, 0, i - first, extent});
+    }
+}
+
+bool IMotionDetector::Verify(const uint32_t *pixels, const FrameMove &move) const
+{
+    bool compared = false;
+    for (int y = (move.rect.y + MIN_BAND - 1) / MIN_BAND * MIN_BAND; y < move.rect.y + move.rect.height; y += MIN_BAND)
+    {
+        const uint32_t *prev = _samples.data() + static_cast<size_t>(y / MIN_BAND) * _width + move.rect.x;
+        const uint32_t *next = pixels + static_cast<size_t>(y + move.dy) * _width + move.rect.x + move.dx;
+        if (memcmp(prev, next, static_cast<size_t>(move.rect.width) * 4) != 0)
+        {
+            return false;
+        }
+
+        compared = true;
+    }
+
+    return compared;
+}
+
+void IMotionDetector::Sample(const uint32_t *pixels)
+{
+    _samples.resize(static_cast<size_t>((_height + MIN_BAND - 1) / MIN_BAND) * _width);
+    for (int y = 0; y < _height; y += MIN_BAND)
+    {
+        const uint32_t *row = pixels + static_cast<size_t>(y) * _width;
+        std::copy(row, row + _width, _samples.begin() + static_cast<size_t>(y / MIN_BAND) * _width);
+    }
+}
+
+bool IMotionDetector::Detect(const void *buffer, int width, int height, std::vector<Rect> &damage, FrameMove &move)
+{
+    auto pixels = static_cast<const uint32_t *>(buffer);
+    bool resized = width != _width || height != _height;
+
+    uint64_t area = 0;
+    for (auto &it : damage)
+    {
+        area += static_cast<uint64_t>(it.width) * it.height;
+    }
+
+    // Small damage, such as a blinking caret, is no scroll. Its rows are rehashed to keep the history in step.
+    if (!resized && area * 2 < static_cast<uint64_t>(width) * height)
+    {
+        for (auto &it : damage)
+        {
+            for (int y = std::max(it.y, 0); y < std::min(it.y + it.height, height); y++)
+            {
+                const uint32_t *row = pixels + static_cast<size_t>(y) * width;
+                _rows[y] = HashRow(row, width);
+
+                if (y % MIN_BAND == 0)
+                {
+                    std::copy(row, row + width, _samples.begin() + static_cast<size_t>(y / MIN_BAND) * width);
+                }
+            }
+        }
+
+        _columns_valid = false;
+
+        return false;
+    }
+
+    _next_rows.resize(height);
+    _next_columns.assign(width, 0);
+
+    for (int y = 0; y < height; y++)
+    {
+        const uint32_t *row = pixels + static_cast<size_t>(y) * width;
+        _next_rows[y] = HashRow(row, width);
+
+        // Column hashes advance one row at a time, a contiguous loop over the row.
+        for (int x = 0; x < width; x++)
+        {
+            _next_columns[x] = (_next_columns[x] ^ row[x]) * PRIME;
+        }
+    }
+
+    bool columns_valid = _columns_valid && !resized;
+    _width = width;
+    _height = height;
+    _columns_valid = true;
+
+    // From here on the _next_ hashes are the previous frame's.
+    std::swap(_rows, _next_rows);
+    std::swap(_columns, _next_columns);
+
+    bool found = false;
+    int shift;
+    int start;
+    int length;
+    if (!resized && FindShift(_next_rows, _rows, MIN_BAND, shift, start, length))
+    {
+        move.rect = {0, start - shift, width, length};
+        move.dx = 0;
+        move.dy = shift;
+
+        if (Verify(pixels, move))
+        {
+            damage.clear();
+            CollectDamage(_next_rows, _rows, start, length, true, width, damage);
+            found = true;
+        }
+    }
+
+    if (!found && columns_valid && FindShift(_next_columns, _columns, MIN_BAND, shift, start, length))
+    {
+        move.rect = {start - shift, 0, length, height};
+        move.dx = shift;
+        move.dy = 0;
+
+        if (Verify(pixels, move))
+        {
+            damage.clear();
+            CollectDamage(_next_columns, _columns, start, length, false, height, damage);
+            found = true;
+        }
+    }
+
+    Sample(pixels);
+
+    return found;
+}
@@ -0,0 +1,65 @@
+//
+//  motion.h
+//  webview
+//
+//  Scroll detection between successive windowless view frames
+//
+
+#ifndef motion_h
+#define motion_h
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "wew.h"
+
+///
+/// Finds the band of a frame that is the previous frame shifted vertically or horizontally, the way a scroll moves
+/// the page, so a remote client can copy it instead of receiving it again.
+///
+/// Row and column hashes of the previous frame are kept, plus every MIN_BAND-th row of its pixels to verify a move
+/// before it is reported, a hash collision would otherwise corrupt the client's frame.
+///
+class IMotionDetector
+{
+  public:
+    ///
+    /// Compares a view frame with the previous one, damage holds the dirty rects of the paint.
+    ///
+    /// Only a paint whose damage covers at least half of the frame is searched, as a scroll repaints all of it.
+    ///
+    /// Returns true when a moved band was found, move then holds the band in previous frame coordinates and damage
+    /// is replaced by the rects that still have to be sent, which is the newly exposed strip plus whatever changed
+    /// outside the band. Otherwise damage is left as it is.
+    ///
+    bool Detect(const void *buffer, int width, int height, std::vector<Rect> &damage, FrameMove &move);
+
+  private:
+    ///
+    /// Shorter bands are not worth a move. Every MIN_BAND-th row is sampled, so any band holds one.
+    ///
+    static const int MIN_BAND = 16;
+
+    ///
+    /// Compares the sampled rows of the band with where the move puts them in the frame.
+    ///
+    bool Verify(const uint32_t *pixels, const FrameMove &move) const;
+
+    void Sample(const uint32_t *pixels);
+
+    int _width = 0;
+    int _height = 0;
+    std::vector<uint64_t> _rows;
+    std::vector<uint64_t> _columns;
+    std::vector<uint64_t> _next_rows;
+    std::vector<uint64_t> _next_columns;
+    std::vector<uint32_t> _samples;
+
+    ///
+    /// Column hashes run through every row, a paint that only rehashed its damaged rows leaves them out of date.
+    ///
+    bool _columns_valid = false;
+};
+
+#endif /* motion_h */
@@ -0,0 +1,161 @@
+//
+//  overlay.cpp
+//  webview
+//
+//  Paint flashing of windowless view frames, a decaying heat map of the repainted tiles
+//
+
+#include "overlay.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+static int Cool(int heat)
+{
+    return std::max(heat - heat / 8 - 1, 0);
+}
+
+const void *IPaintFlashing::Apply(const CefRenderHandler::RectList &dirty_rects,
+                                  const void *buffer,
+                                  int width,
+                                  int height,
+                                  CefRenderHandler::RectList &output_rects)
+{
+    auto pixels = static_cast<const uint32_t *>(buffer);
+
+    // A new size starts from a clean copy of the whole frame.
+    bool resized = width != _width || height != _height;
+    if (resized)
+    {
+        _width = width;
+        _height = height;
+        _columns = (width + TILE - 1) / TILE;
+        _rows = (height + TILE - 1) / TILE;
+        _heat.assign(static_cast<size_t>(_columns) * _rows, 0);
+        _output.assign(pixels, pixels + static_cast<size_t>(width) * height);
+    }
+
+    // Every tile cools down, then the repainted ones heat up.
+    _next.resize(_heat.size());
+    for (size_t i = 0; i < _heat.size(); i++)
+    {
+        _next[i] = static_cast<uint8_t>(Cool(_heat[i]));
+    }
+
+    for (auto &rect : dirty_rects)
+    {
+        int left = std::max(rect.x, 0);
+        int top = std::max(rect.y, 0);
+        int right = std::min(rect.x + rect.width, width);
+        int bottom = std::min(rect.y + rect.height, height);
+        if (right <= left || bottom <= top)
+        {
+            continue;
+        }
+
+        for (int y = top; y < bottom; y++)
+        {
+            size_t offset = static_cast<size_t>(y) * width + left;
+            memcpy(_output.data() + offset, pixels + offset, (right - left) * sizeof(uint32_t));
+        }
+
+        for (int row = top / TILE; row <= (bottom - 1) / TILE; row++)
+        {
+            for (int column = left / TILE; column <= (right - 1) / TILE; column++)
+            {
+                // Derived from the previous heat, so a tile under several rects is heated once.
+                size_t index = static_cast<size_t>(row) * _columns + column;
+                int heat = std::min(Cool(_heat[index]) + HEAT_STEP, static_cast<int>(HEAT_MAX));
+                _next[index] = static_cast<uint8_t>(heat);
+            }
+        }
+    }
+
+    // Tiles that were or are tinted get redrawn from the frame, runs of them along a row form one rect.
+    output_rects.clear();
+    if (resized)
+    {
+        output_rects.push_back(CefRect(0, 0, width, height));
+    }
+
+    _fading = false;
+    for (int row = 0; row < _rows; row++)
+    {
+        int run = -1;
+        for (int column = 0; column <= _columns; column++)
+        {
+            size_t index = static_cast<size_t>(row) * _columns + column;
+            bool changed = column < _columns && (_heat[index] != 0 || _next[index] != 0);
+            if (changed)
+            {
+                Tint(pixels, column, row, _next[index]);
+                _fading |= _next[index] != 0;
+
+                if (run < 0)
+                {
+                    run = column;
+                }
+            }
+            else if (run >= 0)
+            {
+                if (!resized)
+                {
+                    int x = run * TILE;
+                    int y = row * TILE;
+                    output_rects.push_back(
+                        CefRect(x, y, std::min(column * TILE, width) - x, std::min(y + TILE, height) - y));
+                }
+
+                run = -1;
+            }
+        }
+    }
+
+    _heat.swap(_next);
+
+    return _output.data();
+}
+
+bool IPaintFlashing::IsFading() const
+{
+    return _fading;
+}
+
+void IPaintFlashing::Reset()
+{
+    _width = 0;
+    _height = 0;
+    _fading = false;
+}
+
+void IPaintFlashing::Tint(const uint32_t *buffer, int column, int row, int heat)
+{
+    int left = column * TILE;
+    int top = row * TILE;
+    int right = std::min(left + TILE, _width);
+    int bottom = std::min(top + TILE, _height);
+
+    // Premultiplied BGRA read as little endian words. Red moves towards alpha and the other channels towards zero,
+    // so the pixel stays premultiplied and its alpha, which the alpha tiles were classified by, is untouched.
+    for (int y = top; y < bottom; y++)
+    {
+        size_t offset = static_cast<size_t>(y) * _width;
+        const uint32_t *in = buffer + offset;
+        uint32_t *out = _output.data() + offset;
+        for (int x = left; x < right; x++)
+        {
+            uint32_t pixel = in[x];
+            int a = pixel >> 24;
+            int r = (pixel >> 16) & 0xff;
+            int g = (pixel >> 8) & 0xff;
+            int b = pixel & 0xff;
+
+            r += ((a - r) * heat) >> 8;
+            g -= (g * heat) >> 8;
+            b -= (b * heat) >> 8;
+
+            out[x] = (pixel & 0xff000000) | (r << 16) | (g << 8) | b;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+//
+//  overlay.h
+//  webview
+//
+//  Paint flashing of windowless view frames, a decaying heat map of the repainted tiles
+//
+
+#ifndef overlay_h
+#define overlay_h
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "include/cef_client.h"
+
+///
+/// Tints the tiles that were repainted into a copy of the frame, the more often a tile is repainted the redder it
+/// gets, and it fades back with every frame that leaves it alone.
+///
+class IPaintFlashing
+{
+  public:
+    ///
+    /// Tints the tiles under dirty_rects and fades the others into the overlay's own buffer, which is returned. The
+    /// tiles whose pixels changed, repainted or fading, are written to output_rects.
+    ///
+    const void *Apply(const CefRenderHandler::RectList &dirty_rects,
+                      const void *buffer,
+                      int width,
+                      int height,
+                      CefRenderHandler::RectList &output_rects);
+
+    ///
+    /// True while some tile is still tinted, more frames are needed to fade it out.
+    ///
+    bool IsFading() const;
+
+    ///
+    /// Forgets the heat map, the next frame is copied whole.
+    ///
+    void Reset();
+
+  private:
+    static const int TILE = 16;
+
+    ///
+    /// Heat added by a repaint and the most a tile holds, a tile repainted every frame saturates after a few.
+    ///
+    static const int HEAT_STEP = 96;
+    static const int HEAT_MAX = 224;
+
+    int _width = 0;
+    int _height = 0;
+    int _columns = 0;
+    int _rows = 0;
+    bool _fading = false;
+    std::vector<uint8_t> _heat;
+    std::vector<uint8_t> _next;
+    std::vector<uint32_t> _output;
+
+    void Tint(const uint32_t *buffer, int column, int row, int heat);
+};
+
+#endif /* overlay_h */
@@ -0,0 +1,312 @@
+//
+//  plugin.cpp
+//  webview
+//
+//  Native functions loaded into the renderer process and called from the page
+//
+
+#include "plugin.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#ifdef WIN32
+static const char PATH_SEPARATOR = ';';
+#else
+static const char PATH_SEPARATOR = ':';
+#endif
+
+namespace
+{
+    struct RegisteredFunction
+    {
+        std::string name;
+        PluginFunction function;
+        void *context;
+    };
+
+    struct PluginState
+    {
+        std::mutex mutex;
+        std::vector<PluginInit> pending;
+        std::map<std::string, CefRefPtr<IPluginFunction>> functions;
+        bool loaded = false;
+    };
+
+    PluginState &GetState()
+    {
+        static PluginState state;
+        return state;
+    }
+
+    class ReleaseCallback : public CefV8ArrayBufferReleaseCallback
+    {
+      public:
+        ReleaseCallback(void (*release)(void *data)) : _release(release)
+        {
+        }
+
+        void ReleaseBuffer(void *buffer) override
+        {
+            _release(buffer);
+        }
+
+      private:
+        void (*_release)(void *data);
+
+        IMPLEMENT_REFCOUNTING(ReleaseCallback);
+    };
+
+    void RegisterFunction(void *registrar, const char *name, PluginFunction function, void *context)
+    {
+        if (name != nullptr && function != nullptr)
+        {
+            static_cast<std::vector<RegisteredFunction> *>(registrar)->push_back({name, function, context});
+        }
+    }
+
+    // Plugins may hold on to the library for good, so a loaded library is only closed when its init fails.
+    void *OpenLibrary(const std::string &path, PluginInit &init)
+    {
+#ifdef WIN32
+        HMODULE module = LoadLibraryA(path.c_str());
+        if (module != nullptr)
+        {
+            init = reinterpret_cast<PluginInit>(GetProcAddress(module, WEW_PLUGIN_INIT));
+        }
+
+        return module;
+#else
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle != nullptr)
+        {
+            init = reinterpret_cast<PluginInit>(dlsym(handle, WEW_PLUGIN_INIT));
+        }
+
+        return handle;
+#endif
+    }
+
+    void CloseLibrary(void *handle)
+    {
+#ifdef WIN32
+        FreeLibrary(static_cast<HMODULE>(handle));
+#else
+        dlclose(handle);
+#endif
+    }
+
+    // Functions are only kept once the init succeeded, a failed plugin may have registered some before bailing out.
+    bool Initialize(PluginState &state, PluginInit init)
+    {
+        std::vector<RegisteredFunction> functions;
+        PluginRegistrar registrar{WEW_PLUGIN_API_VERSION, RegisterFunction, &functions};
+        if (!init(&registrar))
+        {
+            return false;
+        }
+
+        for (auto &it : functions)
+        {
+            state.functions[it.name] = new IPluginFunction(it.function, it.context);
+        }
+
+        return true;
+    }
+} // namespace
+
+/* IPluginFunction */
+
+IPluginFunction::IPluginFunction(PluginFunction function, void *context) : _function(function), _context(context)
+{
+}
+
+bool IPluginFunction::Execute(const CefString &name,
+                              CefRefPtr<CefV8Value> object,
+                              const CefV8ValueList &arguments,
+                              CefRefPtr<CefV8Value> &retval,
+                              CefString &exception)
+{
+    // Strings are converted to UTF-8 here, they must outlive the call.
+    std::vector<std::string> strings;
+    strings.reserve(arguments.size());
+
+    std::vector<PluginValue> values(arguments.size());
+    for (size_t i = 0; i < arguments.size(); i++)
+    {
+        auto &argument = arguments[i];
+        auto &value = values[i];
+        if (argument->IsUndefined())
+        {
+            value.type = WEW_VALUE_UNDEFINED;
+        }
+        else if (argument->IsNull())
+        {
+            value.type = WEW_VALUE_NULL;
+        }
+        else if (argument->IsBool())
+        {
+            value.type = WEW_VALUE_BOOL;
+            value.boolean = argument->GetBoolValue();
+        }
+        else if (argument->IsDouble())
+        {
+            value.type = WEW_VALUE_NUMBER;
+            value.number = argument->GetDoubleValue();
+        }
+        else if (argument->IsString())
+        {
+            strings.push_back(argument->GetStringValue().ToString());
+            value.type = WEW_VALUE_STRING;
+            value.data = strings.back().data();
+            value.size = strings.back().size();
+        }
+        else if (argument->IsArrayBuffer())
+        {
+            value.type = WEW_VALUE_BUFFER;
+            value.data = argument->GetArrayBufferData();
+            value.size = argument->GetArrayBufferByteLength();
+        }
+        else
+        {
+            exception = "NativePlugins." + name.ToString() + ": unsupported argument " + std::to_string(i);
+            return true;
+        }
+    }
+
+    PluginValue result{};
+    bool ok = _function(values.data(), values.size(), &result, _context);
+
+    if (!ok)
+    {
+        exception = result.type == WEW_VALUE_STRING && result.data != nullptr
+                        ? std::string(static_cast<const char *>(result.data), result.size)
+                        : "NativePlugins." + name.ToString() + " failed";
+    }
+
+    switch (result.type)
+    {
+    case WEW_VALUE_NULL:
+        retval = CefV8Value::CreateNull();
+        break;
+    case WEW_VALUE_BOOL:
+        retval = CefV8Value::CreateBool(result.boolean);
+        break;
+    case WEW_VALUE_NUMBER:
+        retval = CefV8Value::CreateDouble(result.number);
+        break;
+    case WEW_VALUE_STRING:
+        retval = CefV8Value::CreateString(std::string(static_cast<const char *>(result.data), result.size));
+
+        // Strings are always copied, the plugin gets its memory back right away.
+        if (result.release != nullptr)
+        {
+            result.release(const_cast<void *>(result.data));
+        }
+
+        break;
+    case WEW_VALUE_BUFFER:
+        if (result.release == nullptr)
+        {
+            retval = CefV8Value::CreateArrayBufferWithCopy(const_cast<void *>(result.data), result.size);
+        }
+        else if (ok)
+        {
+            retval = CefV8Value::CreateArrayBuffer(
+                const_cast<void *>(result.data), result.size, new ReleaseCallback(result.release));
+        }
+        else
+        {
+            // The page never sees the buffer of a failed call.
+            result.release(const_cast<void *>(result.data));
+        }
+
+        break;
+    default:
+        retval = CefV8Value::CreateUndefined();
+        break;
+    }
+
+    return true;
+}
+
+/* IPlugins */
+
+void IPlugins::Add(PluginInit init)
+{
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.pending.push_back(init);
+}
+
+void IPlugins::Load(const std::string &paths)
+{
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    if (state.loaded)
+    {
+        return;
+    }
+
+    state.loaded = true;
+
+    size_t start = 0;
+    while (start <= paths.size())
+    {
+        size_t end = paths.find(PATH_SEPARATOR, start);
+        if (end == std::string::npos)
+        {
+            end = paths.size();
+        }
+
+        std::string path = paths.substr(start, end - start);
+        start = end + 1;
+        if (path.empty())
+        {
+            continue;
+        }
+
+        // A missing library or symbol leaves the page without its functions, which it can detect.
+        PluginInit init = nullptr;
+        void *handle = OpenLibrary(path, init);
+        if (handle != nullptr && (init == nullptr || !Initialize(state, init)))
+        {
+            CloseLibrary(handle);
+        }
+    }
+}
+
+void IPlugins::Install(CefRefPtr<CefV8Value> global)
+{
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    for (auto init : state.pending)
+    {
+        Initialize(state, init);
+    }
+
+    state.pending.clear();
+
+    if (state.functions.empty())
+    {
+        return;
+    }
+
+    CefRefPtr<CefV8Value> plugins = CefV8Value::CreateObject(nullptr, nullptr);
+    for (auto &it : state.functions)
+    {
+        plugins->SetValue(it.first, CefV8Value::CreateFunction(it.first, it.second), V8_PROPERTY_ATTRIBUTE_NONE);
+    }
+
+    global->SetValue("NativePlugins", std::move(plugins), V8_PROPERTY_ATTRIBUTE_READONLY);
+}
@@ -0,0 +1,57 @@
+//
+//  plugin.h
+//  webview
+//
+//  Native functions loaded into the renderer process and called from the page
+//
+
+#ifndef plugin_h
+#define plugin_h
+#pragma once
+
+#include <string>
+
+#include "include/cef_v8.h"
+
+#include "wew.h"
+
+class IPluginFunction : public CefV8Handler
+{
+  public:
+    IPluginFunction(PluginFunction function, void *context);
+
+    bool Execute(const CefString &name,
+                 CefRefPtr<CefV8Value> object,
+                 const CefV8ValueList &arguments,
+                 CefRefPtr<CefV8Value> &retval,
+                 CefString &exception) override;
+
+  private:
+    PluginFunction _function;
+    void *_context;
+
+    IMPLEMENT_REFCOUNTING(IPluginFunction);
+};
+
+///
+/// The renderer plugins of the process. Plugins linked into the executable are added before execute_subprocess,
+/// shared libraries are loaded from the list the browser process passes on the command line.
+///
+class IPlugins
+{
+  public:
+    static void Add(PluginInit init);
+
+    ///
+    /// Loads the plugin shared libraries in a path list, only the first call of the process loads anything.
+    ///
+    static void Load(const std::string &paths);
+
+    ///
+    /// Initializes the plugins added since the last call and sets the NativePlugins object on a context's global
+    /// object, nothing is set while there are no plugin functions.
+    ///
+    static void Install(CefRefPtr<CefV8Value> global);
+};
+
+#endif /* plugin_h */
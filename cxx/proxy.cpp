@@ -0,0 +1,859 @@
+//
+//  proxy.cpp
+//  webview
+//
+//  The app-api scheme, proxied to an HTTP/1.1 server on a Unix domain socket
+//
+
+#include "proxy.h"
+
+#ifndef WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "metrics.h"
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static const size_t READ_SIZE = 64 * 1024;
+
+static std::string ToLower(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+    return value;
+}
+
+static std::string Trim(const std::string &value)
+{
+    size_t start = value.find_first_not_of(" \t");
+    size_t end = value.find_last_not_of(" \t");
+    return start == std::string::npos ? std::string() : value.substr(start, end - start + 1);
+}
+
+// Hop-by-hop headers describe one connection, they are not passed through in either direction.
+static bool IsHopByHop(const std::string &name)
+{
+    return name == "connection" || name == "keep-alive" || name == "transfer-encoding" || name == "te" ||
+           name == "upgrade" || name == "proxy-connection" || name == "host" || name == "content-length";
+}
+
+/* IApiConnection */
+
+std::shared_ptr<IApiConnection> IApiConnection::Create()
+{
+    std::shared_ptr<IApiConnection> connection(new IApiConnection());
+
+    // The thread owns a reference, the connection goes away once it is stopped and released everywhere else.
+    std::thread([connection]() { connection->Run(); }).detach();
+
+    return connection;
+}
+
+IApiConnection::~IApiConnection()
+{
+    Close();
+}
+
+void IApiConnection::Post(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _tasks.push_back(std::move(task));
+    _condvar.notify_one();
+}
+
+void IApiConnection::Stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _stop = true;
+    _condvar.notify_one();
+}
+
+void IApiConnection::Run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condvar.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+
+            if (_tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+bool IApiConnection::Connect(const std::string &path)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    _buffer.clear();
+    _offset = 0;
+
+    IMetrics::Add(MetricCounter::ApiConnections);
+
+    return true;
+}
+
+void IApiConnection::Close()
+{
+    int fd = _fd.exchange(-1);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+bool IApiConnection::IsOpen() const
+{
+    return _fd >= 0;
+}
+
+bool IApiConnection::IsStale() const
+{
+    if (_offset < _buffer.size())
+    {
+        return true;
+    }
+
+    char byte;
+    ssize_t size = recv(_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return size >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+}
+
+void IApiConnection::Shutdown()
+{
+    int fd = _fd;
+    if (fd >= 0)
+    {
+        shutdown(fd, SHUT_RDWR);
+    }
+}
+
+bool IApiConnection::Send(const void *data, size_t size)
+{
+    auto bytes = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t sent = send(_fd, bytes, size, SEND_FLAGS);
+        if (sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (sent <= 0)
+        {
+            return false;
+        }
+
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+
+    return true;
+}
+
+int64_t IApiConnection::Fill()
+{
+    if (_offset == _buffer.size())
+    {
+        _buffer.clear();
+        _offset = 0;
+    }
+
+    size_t used = _buffer.size();
+    _buffer.resize(used + READ_SIZE);
+
+    ssize_t size;
+    do
+    {
+        size = recv(_fd, &_buffer[used], READ_SIZE, 0);
+    } while (size < 0 && errno == EINTR);
+
+    _buffer.resize(used + std::max<ssize_t>(size, 0));
+
+    return size;
+}
+
+bool IApiConnection::ReadLine(std::string &line, bool blocking)
+{
+    while (true)
+    {
+        size_t end = _buffer.find("\r\n", _offset);
+        if (end != std::string::npos)
+        {
+            line.assign(_buffer, _offset, end - _offset);
+            _offset = end + 2;
+            return true;
+        }
+
+        // A line longer than a read is not HTTP this proxy talks.
+        if (!blocking || _buffer.size() - _offset > READ_SIZE || Fill() <= 0)
+        {
+            return false;
+        }
+    }
+}
+
+int64_t IApiConnection::Read(void *data, size_t size, bool blocking)
+{
+    if (_offset < _buffer.size())
+    {
+        size_t count = std::min(size, _buffer.size() - _offset);
+        memcpy(data, _buffer.data() + _offset, count);
+        _offset += count;
+        return static_cast<int64_t>(count);
+    }
+
+    if (!blocking)
+    {
+        return -2;
+    }
+
+    // Nothing buffered, large bodies go straight to the caller's buffer.
+    ssize_t count;
+    do
+    {
+        count = recv(_fd, data, size, 0);
+    } while (count < 0 && errno == EINTR);
+
+    return count;
+}
+
+bool IApiConnection::HasBuffered() const
+{
+    return _offset < _buffer.size();
+}
+
+/* IApiProxy */
+
+IApiProxy::IApiProxy(std::string path) : _path(std::move(path))
+{
+}
+
+IApiProxy::~IApiProxy()
+{
+    for (auto &connection : _idle)
+    {
+        connection->Stop();
+    }
+}
+
+CefRefPtr<CefResourceHandler> IApiProxy::Create(CefRefPtr<CefBrowser> browser,
+                                                CefRefPtr<CefFrame> frame,
+                                                const CefString &scheme_name,
+                                                CefRefPtr<CefRequest> request)
+{
+    IMetrics::Add(MetricCounter::ApiRequests);
+
+    return new IApiResourceHandler(this, request);
+}
+
+void IApiProxy::Acquire(Ready ready)
+{
+    std::shared_ptr<IApiConnection> connection;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_active >= MAX_ACTIVE)
+        {
+            _waiting.push_back(std::move(ready));
+            return;
+        }
+
+        _active++;
+        connection = Take();
+    }
+
+    ready(std::move(connection));
+}
+
+void IApiProxy::Recycle(std::shared_ptr<IApiConnection> connection)
+{
+    if (connection->HasBuffered())
+    {
+        Discard(std::move(connection));
+        return;
+    }
+
+    Ready ready;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_waiting.empty())
+        {
+            _active--;
+            if (_idle.size() < MAX_IDLE)
+            {
+                _idle.push_back(std::move(connection));
+                return;
+            }
+        }
+        else
+        {
+            // The waiting request takes the connection over, the count of active ones stays.
+            ready = std::move(_waiting.front());
+            _waiting.pop_front();
+        }
+    }
+
+    if (ready != nullptr)
+    {
+        ready(std::move(connection));
+    }
+    else
+    {
+        connection->Stop();
+    }
+}
+
+void IApiProxy::Discard(std::shared_ptr<IApiConnection> connection)
+{
+    connection->Stop();
+
+    Ready ready;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_waiting.empty())
+        {
+            _active--;
+            return;
+        }
+
+        ready = std::move(_waiting.front());
+        _waiting.pop_front();
+        connection = Take();
+    }
+
+    ready(std::move(connection));
+}
+
+std::shared_ptr<IApiConnection> IApiProxy::Take()
+{
+    while (!_idle.empty())
+    {
+        auto connection = std::move(_idle.back());
+        _idle.pop_back();
+
+        if (!connection->IsStale())
+        {
+            return connection;
+        }
+
+        connection->Stop();
+    }
+
+    return IApiConnection::Create();
+}
+
+const std::string &IApiProxy::GetPath() const
+{
+    return _path;
+}
+
+/* IApiResourceHandler */
+
+IApiResourceHandler::IApiResourceHandler(CefRefPtr<IApiProxy> proxy, CefRefPtr<CefRequest> request) : _proxy(proxy)
+{
+    std::string url = request->GetURL().ToString();
+    std::string method = request->GetMethod().ToString();
+
+    // app-api://host/path?query becomes a request for /path?query with the host passed through.
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+    size_t path = std::min(url.find_first_of("/?#", start), url.size());
+    std::string host = url.substr(start, path - start);
+    std::string target = url.substr(path, url.find('#', path) - path);
+    if (target.empty() || target[0] != '/')
+    {
+        target.insert(0, "/");
+    }
+
+    _head = method + " " + target + " HTTP/1.1\r\nHost: " + host + "\r\n";
+
+    CefRequest::HeaderMap headers;
+    request->GetHeaderMap(headers);
+    for (auto &it : headers)
+    {
+        std::string name = it.first.ToString();
+        if (!IsHopByHop(ToLower(name)))
+        {
+            _head += name + ": " + it.second.ToString() + "\r\n";
+        }
+    }
+
+    int64_t length = 0;
+    _body = request->GetPostData();
+    if (_body != nullptr)
+    {
+        CefPostData::ElementVector elements;
+        _body->GetElements(elements);
+        for (auto &element : elements)
+        {
+            if (element->GetType() == PDE_TYPE_BYTES)
+            {
+                length += element->GetBytesCount();
+            }
+            else if (element->GetType() == PDE_TYPE_FILE)
+            {
+                struct stat info;
+                if (stat(element->GetFile().ToString().c_str(), &info) == 0)
+                {
+                    length += info.st_size;
+                }
+            }
+        }
+    }
+
+    if (_body != nullptr || (method != "GET" && method != "HEAD" && method != "OPTIONS"))
+    {
+        _head += "Content-Length: " + std::to_string(length) + "\r\n";
+    }
+
+    _head += "\r\n";
+    _no_body = method == "HEAD";
+    _idempotent = method == "GET" || method == "HEAD" || method == "OPTIONS" || method == "PUT" || method == "DELETE";
+}
+
+IApiResourceHandler::~IApiResourceHandler()
+{
+    if (_connection != nullptr)
+    {
+        _proxy->Discard(std::move(_connection));
+    }
+}
+
+bool IApiResourceHandler::Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback)
+{
+    handle_request = false;
+
+    CefRefPtr<IApiResourceHandler> self = this;
+    _proxy->Acquire([self, callback](std::shared_ptr<IApiConnection> connection) {
+        {
+            std::lock_guard<std::mutex> lock(self->_mutex);
+            self->_connection = connection;
+        }
+
+        // Canceled while waiting for the connection, which goes to the next request right away.
+        if (self->_canceled)
+        {
+            self->Finish(false);
+            callback->Cancel();
+            return;
+        }
+
+        connection->Post([self, callback]() {
+            if (self->Exchange())
+            {
+                callback->Continue();
+            }
+            else
+            {
+                self->Finish(false);
+                callback->Cancel();
+            }
+        });
+    });
+
+    return true;
+}
+
+bool IApiResourceHandler::Exchange()
+{
+    auto connection = _connection.get();
+
+    // An idle connection may have been closed by the server in the meantime, such a request is sent again once on a
+    // new connection. Nothing was received for it, but the server may still have acted on it, so only idempotent
+    // requests are.
+    for (int attempt = 0; attempt < 2 && !_canceled; attempt++)
+    {
+        bool reused = connection->IsOpen();
+        if (!reused && !connection->Connect(_proxy->GetPath()))
+        {
+            return false;
+        }
+
+        bool received = false;
+        if (SendRequest(connection) && ReadHead(connection, received))
+        {
+            return true;
+        }
+
+        if (!reused || received || !_idempotent)
+        {
+            return false;
+        }
+
+        connection->Close();
+    }
+
+    return false;
+}
+
+bool IApiResourceHandler::SendRequest(IApiConnection *connection)
+{
+    if (!connection->Send(_head.data(), _head.size()))
+    {
+        return false;
+    }
+
+    if (_body == nullptr)
+    {
+        return true;
+    }
+
+    CefPostData::ElementVector elements;
+    _body->GetElements(elements);
+
+    std::vector<char> chunk;
+    for (auto &element : elements)
+    {
+        if (element->GetType() == PDE_TYPE_BYTES)
+        {
+            chunk.resize(element->GetBytesCount());
+            element->GetBytes(chunk.size(), chunk.data());
+            if (!connection->Send(chunk.data(), chunk.size()))
+            {
+                return false;
+            }
+        }
+        else if (element->GetType() == PDE_TYPE_FILE)
+        {
+            // Uploaded files are streamed, never held in memory whole.
+            FILE *file = fopen(element->GetFile().ToString().c_str(), "rb");
+            if (file == nullptr)
+            {
+                return false;
+            }
+
+            chunk.resize(READ_SIZE);
+
+            bool ok = true;
+            size_t size;
+            while (ok && (size = fread(chunk.data(), 1, chunk.size(), file)) > 0)
+            {
+                ok = connection->Send(chunk.data(), size);
+            }
+
+            fclose(file);
+            if (!ok)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool IApiResourceHandler::ReadHead(IApiConnection *connection, bool &received)
+{
+    std::string line;
+    do
+    {
+        if (!connection->ReadLine(line, true))
+        {
+            return false;
+        }
+
+        received = true;
+
+        // HTTP/1.1 200 OK
+        if (line.compare(0, 5, "HTTP/") != 0 || line.size() < 12)
+        {
+            return false;
+        }
+
+        _status = atoi(line.c_str() + 9);
+        _status_text = line.size() > 13 ? line.substr(13) : std::string();
+        _keep_alive = line.compare(5, 3, "1.1") == 0;
+        _headers.clear();
+        _mime_type.clear();
+
+        int64_t length = -1;
+        bool chunked = false;
+        while (true)
+        {
+            if (!connection->ReadLine(line, true))
+            {
+                return false;
+            }
+
+            if (line.empty())
+            {
+                break;
+            }
+
+            size_t colon = line.find(':');
+            if (colon == std::string::npos)
+            {
+                continue;
+            }
+
+            std::string name = Trim(line.substr(0, colon));
+            std::string value = Trim(line.substr(colon + 1));
+            std::string lower = ToLower(name);
+            if (lower == "content-length")
+            {
+                length = atoll(value.c_str());
+            }
+            else if (lower == "transfer-encoding")
+            {
+                chunked = ToLower(value).find("chunked") != std::string::npos;
+            }
+            else if (lower == "connection")
+            {
+                std::string option = ToLower(value);
+                _keep_alive = option.find("close") == std::string::npos &&
+                              (_keep_alive || option.find("keep-alive") != std::string::npos);
+            }
+            else if (lower == "content-type")
+            {
+                _mime_type = Trim(value.substr(0, value.find(';')));
+            }
+
+            if (!IsHopByHop(lower) || lower == "content-length")
+            {
+                _headers.insert({name, value});
+            }
+        }
+
+        if (_no_body || _status == 204 || _status == 304 || (_status >= 100 && _status < 200))
+        {
+            _framing = Framing::Length;
+            _remaining = 0;
+        }
+        else if (chunked)
+        {
+            _framing = Framing::Chunked;
+            _remaining = -1;
+        }
+        else if (length >= 0)
+        {
+            _framing = Framing::Length;
+            _remaining = length;
+        }
+        else
+        {
+            // The body ends with the connection.
+            _framing = Framing::Close;
+            _keep_alive = false;
+        }
+
+        // Interim responses such as 100 Continue are followed by the real one.
+    } while (_status >= 100 && _status < 200 && _status != 101);
+
+    return true;
+}
+
+void IApiResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
+                                             int64_t &response_length,
+                                             CefString &redirectUrl)
+{
+    response->SetStatus(_status);
+    response->SetStatusText(_status_text);
+    response->SetMimeType(_mime_type);
+    response->SetHeaderMap(_headers);
+
+    response_length = _framing == Framing::Length ? _remaining : -1;
+}
+
+int64_t IApiResourceHandler::ReadBody(void *data, size_t size, bool blocking)
+{
+    auto connection = _connection.get();
+    if (_framing == Framing::Close)
+    {
+        return connection->Read(data, size, blocking);
+    }
+
+    if (_framing == Framing::Chunked && _remaining <= 0)
+    {
+        std::string line;
+
+        // The CRLF that ends the previous chunk.
+        if (_remaining == 0)
+        {
+            if (!connection->ReadLine(line, blocking))
+            {
+                return blocking ? -1 : -2;
+            }
+
+            _remaining = -1;
+        }
+
+        if (!connection->ReadLine(line, blocking))
+        {
+            return blocking ? -1 : -2;
+        }
+
+        _remaining = strtoll(line.c_str(), nullptr, 16);
+        if (_remaining < 0)
+        {
+            return -1;
+        }
+
+        if (_remaining == 0)
+        {
+            // Trailers are dropped, the headers went out already.
+            do
+            {
+                if (!connection->ReadLine(line, true))
+                {
+                    return -1;
+                }
+            } while (!line.empty());
+
+            _framing = Framing::Length;
+            return 0;
+        }
+    }
+
+    if (_remaining == 0)
+    {
+        return 0;
+    }
+
+    int64_t count = connection->Read(data, static_cast<size_t>(std::min<int64_t>(size, _remaining)), blocking);
+    if (count == 0)
+    {
+        // The server closed the connection before the end of the body.
+        return -1;
+    }
+
+    if (count > 0)
+    {
+        _remaining -= count;
+    }
+
+    return count;
+}
+
+bool IApiResourceHandler::Read(void *data_out,
+                               int bytes_to_read,
+                               int &bytes_read,
+                               CefRefPtr<CefResourceReadCallback> callback)
+{
+    bytes_read = 0;
+    if (_canceled || _connection == nullptr)
+    {
+        return false;
+    }
+
+    int64_t count = ReadBody(data_out, static_cast<size_t>(bytes_to_read), false);
+    if (count > 0)
+    {
+        bytes_read = static_cast<int>(count);
+        IMetrics::Observe(MetricHistogram::ResourceReadBytes, count);
+        return true;
+    }
+
+    if (count != -2)
+    {
+        Finish(count == 0);
+        return false;
+    }
+
+    // data_out stays valid until the callback continues.
+    CefRefPtr<IApiResourceHandler> self = this;
+    _connection->Post([self, data_out, bytes_to_read, callback]() {
+        int64_t count = self->_canceled ? -1 : self->ReadBody(data_out, static_cast<size_t>(bytes_to_read), true);
+        if (count > 0)
+        {
+            IMetrics::Observe(MetricHistogram::ResourceReadBytes, count);
+        }
+        else
+        {
+            self->Finish(count == 0);
+        }
+
+        callback->Continue(count > 0 ? static_cast<int>(count) : count == 0 ? 0 : ERR_FAILED);
+    });
+
+    return true;
+}
+
+void IApiResourceHandler::Finish(bool complete)
+{
+    std::shared_ptr<IApiConnection> connection;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        connection = std::move(_connection);
+    }
+
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    if (complete && _keep_alive && !_canceled)
+    {
+        _proxy->Recycle(std::move(connection));
+    }
+    else
+    {
+        _proxy->Discard(std::move(connection));
+    }
+}
+
+void IApiResourceHandler::Cancel()
+{
+    _canceled = true;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_connection != nullptr)
+    {
+        _connection->Shutdown();
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+//
+//  proxy.h
+//  webview
+//
+//  The app-api scheme, proxied to an HTTP/1.1 server on a Unix domain socket
+//
+
+#ifndef proxy_h
+#define proxy_h
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "include/cef_resource_handler.h"
+#include "include/cef_scheme.h"
+
+#define WEW_API_SCHEME "app-api"
+
+///
+/// A keep-alive connection to the API socket with its own thread. The requests of a connection run on that thread one
+/// at a time, so a slow or streaming response only holds up its own connection.
+///
+class IApiConnection
+{
+  public:
+    static std::shared_ptr<IApiConnection> Create();
+
+    ~IApiConnection();
+
+    ///
+    /// Runs a task on the connection's thread.
+    ///
+    void Post(std::function<void()> task);
+
+    ///
+    /// Ends the connection's thread once the queued tasks ran, the socket is closed with the connection.
+    ///
+    void Stop();
+
+    bool Connect(const std::string &path);
+    void Close();
+    bool IsOpen() const;
+
+    ///
+    /// Whether an idle connection was closed by the server, or has unexpected bytes waiting.
+    ///
+    bool IsStale() const;
+
+    ///
+    /// Unblocks a send or receive in progress on the connection's thread, the connection is not reused.
+    ///
+    void Shutdown();
+
+    bool Send(const void *data, size_t size);
+
+    ///
+    /// Reads a line without its CRLF. Without blocking, returns false when the buffered bytes hold no full line.
+    ///
+    bool ReadLine(std::string &line, bool blocking);
+
+    ///
+    /// Reads up to size bytes, buffered bytes first. Returns 0 when the server closed the connection, -1 on errors and
+    /// -2 when it would block.
+    ///
+    int64_t Read(void *data, size_t size, bool blocking);
+
+    bool HasBuffered() const;
+
+  private:
+    IApiConnection() = default;
+
+    std::atomic<int> _fd{-1};
+    std::string _buffer;
+    size_t _offset = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _condvar;
+    std::deque<std::function<void()>> _tasks;
+    bool _stop = false;
+
+    void Run();
+    int64_t Fill();
+};
+
+///
+/// The scheme handler factory of app-api, with the pool of idle connections and the requests waiting for one.
+///
+class IApiProxy : public CefSchemeHandlerFactory
+{
+  public:
+    IApiProxy(std::string path);
+    ~IApiProxy();
+
+    CefRefPtr<CefResourceHandler> Create(CefRefPtr<CefBrowser> browser,
+                                         CefRefPtr<CefFrame> frame,
+                                         const CefString &scheme_name,
+                                         CefRefPtr<CefRequest> request) override;
+
+    using Ready = std::function<void(std::shared_ptr<IApiConnection> connection)>;
+
+    ///
+    /// Hands an idle connection, or a new one that is not connected yet, to ready. Past MAX_ACTIVE connections in
+    /// use the request waits for one to be handed back, ready then runs on the thread handing it back.
+    ///
+    void Acquire(Ready ready);
+
+    ///
+    /// Keeps a connection whose response was read to the end for the next request.
+    ///
+    void Recycle(std::shared_ptr<IApiConnection> connection);
+
+    ///
+    /// Stops a connection that cannot be reused, its place goes to the next waiting request.
+    ///
+    void Discard(std::shared_ptr<IApiConnection> connection);
+
+    const std::string &GetPath() const;
+
+  private:
+    ///
+    /// Idle connections kept open, enough for the requests a page runs in parallel.
+    ///
+    static const size_t MAX_IDLE = 8;
+
+    ///
+    /// Connections in use at once, each with its own thread and socket on the server.
+    ///
+    static const size_t MAX_ACTIVE = 16;
+
+    std::string _path;
+    std::mutex _mutex;
+    std::vector<std::shared_ptr<IApiConnection>> _idle;
+    std::deque<Ready> _waiting;
+    size_t _active = 0;
+
+    ///
+    /// Returns an idle connection that is still open, or a new one. Called with the mutex held.
+    ///
+    std::shared_ptr<IApiConnection> Take();
+
+    IMPLEMENT_REFCOUNTING(IApiProxy);
+};
+
+///
+/// One app-api request. The exchange runs on the connection's thread and reports back through the CEF callbacks,
+/// response bytes that are already buffered are returned right away.
+///
+class IApiResourceHandler : public CefResourceHandler
+{
+  public:
+    IApiResourceHandler(CefRefPtr<IApiProxy> proxy, CefRefPtr<CefRequest> request);
+    ~IApiResourceHandler();
+
+    bool Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback) override;
+
+    void GetResponseHeaders(CefRefPtr<CefResponse> response, int64_t &response_length, CefString &redirectUrl) override;
+
+    bool Read(void *data_out, int bytes_to_read, int &bytes_read, CefRefPtr<CefResourceReadCallback> callback) override;
+
+    void Cancel() override;
+
+  private:
+    enum class Framing
+    {
+        Length,
+        Chunked,
+        Close,
+    };
+
+    CefRefPtr<IApiProxy> _proxy;
+    std::string _head;
+    CefRefPtr<CefPostData> _body;
+    bool _no_body = false;
+
+    ///
+    /// Whether the request may be sent twice, the server may have acted on it before a connection dropped.
+    ///
+    bool _idempotent = false;
+
+    std::mutex _mutex;
+    std::shared_ptr<IApiConnection> _connection;
+    std::atomic<bool> _canceled{false};
+
+    int _status = 0;
+    std::string _status_text;
+    std::string _mime_type;
+    CefResponse::HeaderMap _headers;
+    Framing _framing = Framing::Close;
+    bool _keep_alive = false;
+
+    ///
+    /// Bytes left of the body with a length, or of the current chunk, -1 before the size line of a chunk.
+    ///
+    int64_t _remaining = 0;
+
+    bool Exchange();
+    bool SendRequest(IApiConnection *connection);
+    bool ReadHead(IApiConnection *connection, bool &received);
+
+    ///
+    /// Reads body bytes, returns 0 at the end of the body, -1 on errors and -2 when it would block.
+    ///
+    int64_t ReadBody(void *data, size_t size, bool blocking);
+
+    ///
+    /// Hands the connection back to the pool after a complete response, or closes it.
+    ///
+    void Finish(bool complete);
+
+    IMPLEMENT_REFCOUNTING(IApiResourceHandler);
+};
+
+#endif /* proxy_h */
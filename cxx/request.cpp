@@ -7,27 +7,57 @@
 
 #include "request.h"
 
+#include "blob.h"
+#include "scheduler.h"
+
 // clang-format off
-IResourceHandler::IResourceHandler(const RequestHandlerFactory *factory, RequestHandler *handler)
+IResourceHandler::IResourceHandler(const RequestHandlerFactory *factory, RequestHandler *handler, ResourceType type)
     : _handler(handler)
     , _factory(factory)
+    , _type(type)
 {
     assert(factory != nullptr);
     assert(handler != nullptr);
+
+    IMetrics::Add(MetricCounter::ResourceHandlers);
 }
 // clang-format on
 
 IResourceHandler::~IResourceHandler()
 {
-    _handler->destroy(_handler->context);
-    _factory->destroy_request_handler(_handler);
+    IWatchdog::Call(HostCallback::RequestHandlerDestroy, _handler->destroy, _handler->context);
+    IWatchdog::Call(HostCallback::RequestHandlerFactoryDestroy, _factory->destroy_request_handler, _handler);
 }
 
 bool IResourceHandler::Open(CefRefPtr<CefRequest> request, bool &handle_request, CefRefPtr<CefCallback> callback)
 {
-    bool result = _handler->open(_handler->context);
-    handle_request = result;
-    return result;
+    if (!IRequestScheduler::IsRunning())
+    {
+        bool result = IWatchdog::Call(HostCallback::RequestHandlerOpen, _handler->open, _handler->context);
+        handle_request = result;
+        return result;
+    }
+
+    CefRefPtr<IResourceHandler> self = this;
+    IRequestScheduler::Post(_type, [self, callback]() mutable {
+        if (!self->Enter())
+        {
+            return;
+        }
+
+        bool result = IWatchdog::Call(HostCallback::RequestHandlerOpen, self->_handler->open, self->_handler->context);
+        if (!self->Leave())
+        {
+            return;
+        }
+
+        // CEF keeps the handler until the request is done, it is released there rather than on this thread.
+        self = nullptr;
+        result ? callback->Continue() : callback->Cancel();
+    });
+
+    handle_request = false;
+    return true;
 }
 
 void IResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
@@ -36,7 +66,7 @@ void IResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
 {
     Response res = {.status_code = 0, .content_length = 0, .mime_type = new char[255]};
 
-    _handler->get_response(&res, _handler->context);
+    IWatchdog::Call(HostCallback::RequestHandlerGetResponse, _handler->get_response, &res, _handler->context);
 
     response->SetMimeType(std::string(res.mime_type));
     response->SetStatus(res.status_code);
@@ -48,7 +78,11 @@ void IResourceHandler::GetResponseHeaders(CefRefPtr<CefResponse> response,
 bool IResourceHandler::Skip(int64_t bytes_to_skip, int64_t &bytes_skipped, CefRefPtr<CefResourceSkipCallback> callback)
 {
     int cursor = 0;
-    bool result = _handler->skip(bytes_to_skip, &cursor, _handler->context);
+    bool result = IWatchdog::Call(HostCallback::RequestHandlerSkip,
+                                  _handler->skip,
+                                  static_cast<size_t>(bytes_to_skip),
+                                  &cursor,
+                                  _handler->context);
     bytes_skipped = cursor;
     return result;
 }
@@ -58,15 +92,148 @@ bool IResourceHandler::Read(void *data_out,
                             int &bytes_read,
                             CefRefPtr<CefResourceReadCallback> callback)
 {
+    TRACE_SPAN("IResourceHandler::Read");
+
+    if (IRequestScheduler::IsRunning())
+    {
+        // data_out stays valid until the callback runs or the request is canceled.
+        CefRefPtr<IResourceHandler> self = this;
+        IRequestScheduler::Post(_type, [self, data_out, bytes_to_read, callback]() mutable {
+            if (!self->Enter())
+            {
+                return;
+            }
+
+            int cursor = 0;
+            bool result = IWatchdog::Call(HostCallback::RequestHandlerRead,
+                                          self->_handler->read,
+                                          (uint8_t *)data_out,
+                                          static_cast<size_t>(bytes_to_read),
+                                          &cursor,
+                                          self->_handler->context);
+            if (!self->Leave())
+            {
+                return;
+            }
+
+            self = nullptr;
+
+            if (result)
+            {
+                IMetrics::Observe(MetricHistogram::ResourceReadBytes, cursor);
+            }
+
+            // 0 completes the response, a negative count fails it.
+            callback->Continue(result ? cursor : std::min(cursor, 0));
+        });
+
+        bytes_read = 0;
+        return true;
+    }
+
     int cursor = 0;
-    bool result = _handler->read((uint8_t *)data_out, bytes_to_read, &cursor, _handler->context);
+    bool result = IWatchdog::Call(HostCallback::RequestHandlerRead,
+                                  _handler->read,
+                                  (uint8_t *)data_out,
+                                  static_cast<size_t>(bytes_to_read),
+                                  &cursor,
+                                  _handler->context);
     bytes_read = cursor;
+
+    if (result)
+    {
+        IMetrics::Observe(MetricHistogram::ResourceReadBytes, cursor);
+    }
+
     return result;
 }
 
 void IResourceHandler::Cancel()
 {
-    _handler->cancel(_handler->context);
+    int state = _state.fetch_or(CANCELED, std::memory_order_acq_rel);
+
+    // A call in progress passes the cancel on when it returns.
+    if (state == 0)
+    {
+        IWatchdog::Call(HostCallback::RequestHandlerCancel, _handler->cancel, _handler->context);
+    }
+}
+
+bool IResourceHandler::Enter()
+{
+    int state = 0;
+    return _state.compare_exchange_strong(state, RUNNING, std::memory_order_acq_rel);
+}
+
+bool IResourceHandler::Leave()
+{
+    if (_state.fetch_and(~RUNNING, std::memory_order_acq_rel) & CANCELED)
+    {
+        IWatchdog::Call(HostCallback::RequestHandlerCancel, _handler->cancel, _handler->context);
+
+        return false;
+    }
+
+    return true;
+}
+
+// clang-format off
+IRequest::IRequest(CefRefPtr<CefRequest> request)
+    : _url(request->GetURL().ToString())
+    , _method(request->GetMethod().ToString())
+    , _referrer(request->GetReferrerURL().ToString())
+{
+    _request = {
+        .url = _url.c_str(),
+        .method = _method.c_str(),
+        .referrer = _referrer.c_str(),
+        .resource_type = WEW_RESOURCE_OTHER,
+    };
+
+    switch (request->GetResourceType())
+    {
+    case RT_MAIN_FRAME:
+    case RT_SUB_FRAME:
+    case RT_NAVIGATION_PRELOAD_MAIN_FRAME:
+    case RT_NAVIGATION_PRELOAD_SUB_FRAME:
+        _request.resource_type = WEW_RESOURCE_DOCUMENT;
+        break;
+    case RT_STYLESHEET:
+        _request.resource_type = WEW_RESOURCE_STYLESHEET;
+        break;
+    case RT_SCRIPT:
+    case RT_WORKER:
+    case RT_SHARED_WORKER:
+    case RT_SERVICE_WORKER:
+        _request.resource_type = WEW_RESOURCE_SCRIPT;
+        break;
+    case RT_FONT_RESOURCE:
+        _request.resource_type = WEW_RESOURCE_FONT;
+        break;
+    case RT_XHR:
+        _request.resource_type = WEW_RESOURCE_FETCH;
+        break;
+    case RT_IMAGE:
+    case RT_FAVICON:
+        _request.resource_type = WEW_RESOURCE_IMAGE;
+        break;
+    case RT_MEDIA:
+        _request.resource_type = WEW_RESOURCE_MEDIA;
+        break;
+    default:
+        break;
+    }
+}
+// clang-format on
+
+Request *IRequest::Get()
+{
+    return &_request;
+}
+
+ResourceType IRequest::GetResourceType() const
+{
+    return _request.resource_type;
 }
 
 ISchemeHandlerFactory::ISchemeHandlerFactory(ICustomSchemeAttributes &attr) : _attr(attr)
@@ -78,23 +245,30 @@ CefRefPtr<CefResourceHandler> ISchemeHandlerFactory::Create(CefRefPtr<CefBrowser
                                                             const CefString &scheme_name,
                                                             CefRefPtr<CefRequest> req)
 {
+    TRACE_SPAN("ISchemeHandlerFactory::Create");
+
+    // Registered blobs are served by the library, the factory never sees their requests.
+    if (auto blob = IBlobRegistry::Create(req))
+    {
+        return blob;
+    }
+
     if (_attr.factory == nullptr)
     {
         return nullptr;
     }
 
-    std::string referrer = req->GetReferrerURL().ToString();
-    std::string method = req->GetMethod().ToString();
-    std::string url = req->GetURL().ToString();
-
-    Request request = {.url = url.c_str(), .method = method.c_str(), .referrer = referrer.c_str()};
-    auto handler = _attr.factory->request(&request, _attr.factory->context);
+    IRequest request(req);
+    auto handler = IWatchdog::Call(
+        HostCallback::RequestHandlerFactoryRequest, _attr.factory->request, request.Get(), _attr.factory->context);
     if (handler == nullptr)
     {
+        IMetrics::Add(MetricCounter::ResourceRequestsUnhandled);
+
         return nullptr;
     }
 
-    return new IResourceHandler(_attr.factory, handler);
+    return new IResourceHandler(_attr.factory, handler, request.GetResourceType());
 }
 
 IResourceRequestHandler::IResourceRequestHandler(const RequestHandlerFactory *factory) : _factory(factory)
@@ -105,21 +279,27 @@ CefRefPtr<CefResourceHandler> IResourceRequestHandler::GetResourceHandler(CefRef
                                                                           CefRefPtr<CefFrame> frame,
                                                                           CefRefPtr<CefRequest> req)
 {
+    TRACE_SPAN("IResourceRequestHandler::GetResourceHandler");
+
+    if (auto blob = IBlobRegistry::Create(req))
+    {
+        return blob;
+    }
+
     if (_factory == nullptr)
     {
         return nullptr;
     }
 
-    std::string referrer = req->GetReferrerURL().ToString();
-    std::string method = req->GetMethod().ToString();
-    std::string url = req->GetURL().ToString();
-
-    Request request = {.url = url.c_str(), .method = method.c_str(), .referrer = referrer.c_str()};
-    auto handler = _factory->request(&request, _factory->context);
+    IRequest request(req);
+    auto handler = IWatchdog::Call(
+        HostCallback::RequestHandlerFactoryRequest, _factory->request, request.Get(), _factory->context);
     if (handler == nullptr)
     {
+        IMetrics::Add(MetricCounter::ResourceRequestsUnhandled);
+
         return nullptr;
     }
 
-    return new IResourceHandler(_factory, handler);
+    return new IResourceHandler(_factory, handler, request.GetResourceType());
 }
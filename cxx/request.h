@@ -9,11 +9,15 @@
 #define request_h
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include "include/cef_request_handler.h"
 #include "include/cef_scheme.h"
 
+#include "metrics.h"
+#include "trace.h"
+#include "watchdog.h"
 #include "wew.h"
 
 struct ICustomSchemeAttributes
@@ -26,7 +30,7 @@ struct ICustomSchemeAttributes
 class IResourceHandler : public CefResourceHandler
 {
   public:
-    IResourceHandler(const RequestHandlerFactory *factory, RequestHandler *handler);
+    IResourceHandler(const RequestHandlerFactory *factory, RequestHandler *handler, ResourceType type);
 
     ~IResourceHandler();
 
@@ -56,12 +60,56 @@ class IResourceHandler : public CefResourceHandler
     void Cancel() override;
 
   private:
+    enum State
+    {
+        ///
+        /// A call is in the handler on a request thread.
+        ///
+        RUNNING = 1,
+        CANCELED = 2,
+    };
+
     RequestHandler *_handler;
     const RequestHandlerFactory *_factory;
+    ResourceType _type;
+
+    ///
+    /// Calls on the request threads never overlap a cancel, which does not wait for them either. A cancel during a
+    /// call is passed to the handler by that call once it returns.
+    ///
+    std::atomic<int> _state{0};
+
+    ///
+    /// Claims the handler for a call on a request thread, false once canceled.
+    ///
+    bool Enter();
+
+    ///
+    /// Ends a call on a request thread, calls cancel and returns false when the request was canceled meanwhile.
+    ///
+    bool Leave();
 
     IMPLEMENT_REFCOUNTING(IResourceHandler);
 };
 
+///
+/// The request passed to the host, borrowing the strings it owns.
+///
+class IRequest
+{
+  public:
+    IRequest(CefRefPtr<CefRequest> request);
+
+    Request *Get();
+    ResourceType GetResourceType() const;
+
+  private:
+    std::string _url;
+    std::string _method;
+    std::string _referrer;
+    Request _request;
+};
+
 class ISchemeHandlerFactory : public CefSchemeHandlerFactory
 {
   public:
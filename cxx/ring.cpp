@@ -0,0 +1,544 @@
+//
+//  ring.cpp
+//  webview
+//
+//  Single producer single consumer rings in shared memory, between the host and a page
+//
+
+#include "ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "watchdog.h"
+
+static const uint32_t RING_MAGIC = 0x52574557; // "WEWR"
+static const uint32_t MIN_CAPACITY = 1 << 12;
+static const uint32_t MAX_CAPACITY = 1 << 30;
+
+static uint64_t GetRecordSize(uint32_t size)
+{
+    return 4 + ((static_cast<uint64_t>(size) + 3) & ~static_cast<uint64_t>(3));
+}
+
+namespace
+{
+    class ReleaseCallback : public CefV8ArrayBufferReleaseCallback
+    {
+      public:
+        ReleaseCallback(std::shared_ptr<ISharedMemory> memory) : _memory(std::move(memory))
+        {
+        }
+
+        void ReleaseBuffer(void *buffer) override
+        {
+            // Records read by the page are its own allocations, the shared buffer is unmapped with the last owner.
+            if (_memory == nullptr)
+            {
+                delete[] static_cast<uint8_t *>(buffer);
+            }
+        }
+
+      private:
+        std::shared_ptr<ISharedMemory> _memory;
+
+        IMPLEMENT_REFCOUNTING(ReleaseCallback);
+    };
+} // namespace
+
+/* ISharedMemory */
+
+ISharedMemory::ISharedMemory(std::string name, size_t size) : _name(std::move(name)), _size(size)
+{
+}
+
+ISharedMemory::~ISharedMemory()
+{
+#ifdef WIN32
+    if (_data != nullptr)
+    {
+        UnmapViewOfFile(_data);
+    }
+
+    if (_handle != nullptr)
+    {
+        CloseHandle(_handle);
+    }
+#else
+    if (_data != nullptr)
+    {
+        munmap(_data, _size);
+    }
+
+    // The renderers that mapped the region keep it, the name is only needed to open it.
+    if (_owner)
+    {
+        shm_unlink(_name.c_str());
+    }
+#endif
+}
+
+std::shared_ptr<ISharedMemory> ISharedMemory::Create(size_t size)
+{
+    static std::atomic<uint32_t> counter{0};
+
+    uint32_t index = counter.fetch_add(1, std::memory_order_relaxed);
+#ifdef WIN32
+    std::string name = "Local\\wew-" + std::to_string(GetCurrentProcessId()) + "-" + std::to_string(index);
+#else
+    std::string name = "/wew-" + std::to_string(getpid()) + "-" + std::to_string(index);
+#endif
+
+    std::shared_ptr<ISharedMemory> memory(new ISharedMemory(name, size));
+    return memory->Map(true) ? memory : nullptr;
+}
+
+std::shared_ptr<ISharedMemory> ISharedMemory::Open(const std::string &name, size_t size)
+{
+    std::shared_ptr<ISharedMemory> memory(new ISharedMemory(name, size));
+    return memory->Map(false) ? memory : nullptr;
+}
+
+bool ISharedMemory::Map(bool create)
+{
+#ifdef WIN32
+    HANDLE handle = create ? CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                                nullptr,
+                                                PAGE_READWRITE,
+                                                static_cast<DWORD>(static_cast<uint64_t>(_size) >> 32),
+                                                static_cast<DWORD>(_size),
+                                                _name.c_str())
+                           : OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, _name.c_str());
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    _handle = handle;
+    _data = static_cast<uint8_t *>(MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, _size));
+
+    return _data != nullptr;
+#else
+    int fd = create ? shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600) : shm_open(_name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    _owner = create;
+
+    // A region smaller than expected would fault on access instead of failing here.
+    struct stat info;
+    bool sized = create ? ftruncate(fd, static_cast<off_t>(_size)) == 0
+                        : fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= _size;
+    if (!sized)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    _data = static_cast<uint8_t *>(data);
+
+    return true;
+#endif
+}
+
+uint8_t *ISharedMemory::GetData() const
+{
+    return _data;
+}
+
+size_t ISharedMemory::GetSize() const
+{
+    return _size;
+}
+
+const std::string &ISharedMemory::GetName() const
+{
+    return _name;
+}
+
+/* ISharedRing */
+
+uint32_t ISharedRing::GetCapacity(uint32_t capacity)
+{
+    uint32_t result = MIN_CAPACITY;
+    while (result < capacity && result < MAX_CAPACITY)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+size_t ISharedRing::GetRegionSize(uint32_t capacity)
+{
+    return sizeof(ISharedRingHeader) + capacity;
+}
+
+// clang-format off
+ISharedRing::ISharedRing(std::shared_ptr<ISharedMemory> memory, uint32_t capacity, bool initialize)
+    : _memory(std::move(memory))
+    , _capacity(capacity)
+{
+    _header = reinterpret_cast<ISharedRingHeader *>(_memory->GetData());
+    _data = _memory->GetData() + sizeof(ISharedRingHeader);
+
+    if (initialize)
+    {
+        new (_header) ISharedRingHeader{RING_MAGIC, capacity, {0}, {0}, {0}};
+    }
+}
+// clang-format on
+
+void ISharedRing::CopyIn(uint64_t position, const void *buffer, uint32_t size)
+{
+    // Records wrap around at the capacity, a power of two.
+    uint32_t offset = static_cast<uint32_t>(position & (_capacity - 1));
+    uint32_t first = std::min(size, _capacity - offset);
+    memcpy(_data + offset, buffer, first);
+    memcpy(_data, static_cast<const uint8_t *>(buffer) + first, size - first);
+}
+
+void ISharedRing::CopyOut(uint64_t position, void *buffer, uint32_t size)
+{
+    uint32_t offset = static_cast<uint32_t>(position & (_capacity - 1));
+    uint32_t first = std::min(size, _capacity - offset);
+    memcpy(buffer, _data + offset, first);
+    memcpy(static_cast<uint8_t *>(buffer) + first, _data, size - first);
+}
+
+bool ISharedRing::Write(const void *data, uint32_t size, bool &notify)
+{
+    notify = false;
+
+    uint64_t head = _header->head.load(std::memory_order_relaxed);
+    uint64_t tail = _header->tail.load(std::memory_order_acquire);
+    uint64_t used = head - tail;
+    uint64_t record = GetRecordSize(size);
+    if (used > _capacity || record > _capacity - used)
+    {
+        return false;
+    }
+
+    CopyIn(head, &size, 4);
+    CopyIn(head + 4, data, size);
+
+    // Sequentially consistent with the consumer arming waiting and checking head again, one of the two always sees
+    // the other, so a record is never left behind without a notification.
+    _header->head.store(head + record, std::memory_order_seq_cst);
+    notify = _header->waiting.exchange(0, std::memory_order_seq_cst) != 0;
+
+    return true;
+}
+
+int64_t ISharedRing::Peek()
+{
+    uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    uint64_t head = _header->head.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+        _header->waiting.store(1, std::memory_order_seq_cst);
+
+        head = _header->head.load(std::memory_order_seq_cst);
+        if (head == tail)
+        {
+            return -1;
+        }
+
+        _header->waiting.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t used = head - tail;
+    if (used < 4 || used > _capacity)
+    {
+        return -1;
+    }
+
+    uint32_t size;
+    CopyOut(tail, &size, 4);
+
+    return GetRecordSize(size) <= used ? size : -1;
+}
+
+int64_t ISharedRing::Read(void *buffer, uint32_t size)
+{
+    int64_t record = Peek();
+    if (record < 0 || record > size)
+    {
+        return record;
+    }
+
+    uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+    CopyOut(tail + 4, buffer, static_cast<uint32_t>(record));
+    _header->tail.store(tail + GetRecordSize(static_cast<uint32_t>(record)), std::memory_order_release);
+
+    return record;
+}
+
+const std::shared_ptr<ISharedMemory> &ISharedRing::GetMemory() const
+{
+    return _memory;
+}
+
+uint32_t ISharedRing::GetCapacity() const
+{
+    return _capacity;
+}
+
+/* IRingChannel */
+
+// clang-format off
+IRingChannel::IRingChannel(int id, const RingSettings *settings, std::unique_ptr<ISharedRing> ring)
+    : _id(id)
+    , _name(settings->name)
+    , _settings(*settings)
+    , _ring(std::move(ring))
+{
+    _settings.name = nullptr;
+}
+// clang-format on
+
+bool IRingChannel::Write(const void *data, uint32_t size)
+{
+    if (_settings.direction != WEW_RING_TO_PAGE)
+    {
+        return false;
+    }
+
+    bool notify;
+    if (!_ring->Write(data, size, notify))
+    {
+        return false;
+    }
+
+    if (notify && _notifier)
+    {
+        _notifier();
+    }
+
+    return true;
+}
+
+int64_t IRingChannel::Read(void *buffer, uint32_t size)
+{
+    return _settings.direction == WEW_RING_FROM_PAGE ? _ring->Read(buffer, size) : -1;
+}
+
+void IRingChannel::OnReady()
+{
+    IWatchdog::Call(HostCallback::OnRingReady, _settings.on_ready, _settings.context);
+}
+
+void IRingChannel::SetNotifier(std::function<void()> notifier)
+{
+    _notifier = std::move(notifier);
+}
+
+int IRingChannel::GetId() const
+{
+    return _id;
+}
+
+size_t IRingChannel::GetSize() const
+{
+    return _ring->GetMemory()->GetSize();
+}
+
+void IRingChannel::GetDescriptor(CefRefPtr<CefListValue> args) const
+{
+    args->SetSize(5);
+    args->SetInt(0, _id);
+    args->SetString(1, _name);
+    args->SetString(2, _ring->GetMemory()->GetName());
+    args->SetInt(3, static_cast<int>(_ring->GetCapacity()));
+    args->SetInt(4, static_cast<int>(_settings.direction));
+}
+
+/* IRingBinding */
+
+// clang-format off
+IRingBinding::IRingBinding(CefRefPtr<CefBrowser> browser, int id, std::string name, RingDirection direction)
+    : _browser(browser)
+    , _id(id)
+    , _name(std::move(name))
+    , _direction(direction)
+{
+}
+// clang-format on
+
+CefRefPtr<IRingBinding> IRingBinding::Open(CefRefPtr<CefBrowser> browser, CefRefPtr<CefListValue> args)
+{
+    if (args->GetSize() != 5)
+    {
+        return nullptr;
+    }
+
+    uint32_t capacity = static_cast<uint32_t>(args->GetInt(3));
+    if (ISharedRing::GetCapacity(capacity) != capacity)
+    {
+        return nullptr;
+    }
+
+    auto memory = ISharedMemory::Open(args->GetString(2).ToString(), ISharedRing::GetRegionSize(capacity));
+    if (memory == nullptr)
+    {
+        return nullptr;
+    }
+
+    CefRefPtr<IRingBinding> binding = new IRingBinding(
+        browser, args->GetInt(0), args->GetString(1).ToString(), static_cast<RingDirection>(args->GetInt(4)));
+    binding->_ring = std::make_unique<ISharedRing>(std::move(memory), capacity, false);
+
+    return binding;
+}
+
+bool IRingBinding::Execute(const CefString &name,
+                           CefRefPtr<CefV8Value> object,
+                           const CefV8ValueList &arguments,
+                           CefRefPtr<CefV8Value> &retval,
+                           CefString &exception)
+{
+    std::string function = name.ToString();
+    if (function == "read")
+    {
+        int64_t size = _ring != nullptr && _direction == WEW_RING_TO_PAGE ? _ring->Peek() : -1;
+        if (size < 0)
+        {
+            retval = CefV8Value::CreateNull();
+            return true;
+        }
+
+        // One copy out of the ring, the page owns the record.
+        auto record = new uint8_t[size > 0 ? size : 1];
+        _ring->Read(record, static_cast<uint32_t>(size));
+        retval = CefV8Value::CreateArrayBuffer(record, static_cast<size_t>(size), new ReleaseCallback(nullptr));
+
+        return true;
+    }
+
+    if (function == "write")
+    {
+        if (arguments.size() != 1 || !(arguments[0]->IsArrayBuffer() || arguments[0]->IsString()))
+        {
+            exception = "SharedRings." + _name + ".write expects an ArrayBuffer or a string";
+            return true;
+        }
+
+        bool written = false;
+        bool notify = false;
+        if (_ring != nullptr && _direction == WEW_RING_FROM_PAGE)
+        {
+            if (arguments[0]->IsArrayBuffer())
+            {
+                written = _ring->Write(arguments[0]->GetArrayBufferData(),
+                                       static_cast<uint32_t>(arguments[0]->GetArrayBufferByteLength()),
+                                       notify);
+            }
+            else
+            {
+                std::string text = arguments[0]->GetStringValue().ToString();
+                written = _ring->Write(text.data(), static_cast<uint32_t>(text.size()), notify);
+            }
+        }
+
+        // The only process message of the ring, sent when the host is waiting for records.
+        if (notify)
+        {
+            auto msg = CefProcessMessage::Create("RING_NOTIFY");
+            msg->GetArgumentList()->SetInt(0, _id);
+            _browser->GetMainFrame()->SendProcessMessage(PID_BROWSER, msg);
+        }
+
+        retval = CefV8Value::CreateBool(written);
+        return true;
+    }
+
+    if (function == "on")
+    {
+        if (arguments.size() != 1 || !arguments[0]->IsFunction())
+        {
+            exception = "SharedRings." + _name + ".on expects a function";
+            return true;
+        }
+
+        _context = CefV8Context::GetCurrentContext();
+        _callback = arguments[0];
+        retval = CefV8Value::CreateUndefined();
+
+        return true;
+    }
+
+    return false;
+}
+
+int IRingBinding::GetId() const
+{
+    return _id;
+}
+
+const std::string &IRingBinding::GetName() const
+{
+    return _name;
+}
+
+CefRefPtr<CefV8Value> IRingBinding::CreateObject()
+{
+    auto &memory = _ring->GetMemory();
+
+    CefRefPtr<CefV8Value> object = CefV8Value::CreateObject(nullptr, nullptr);
+    object->SetValue("buffer",
+                     CefV8Value::CreateArrayBuffer(memory->GetData(), memory->GetSize(), new ReleaseCallback(memory)),
+                     V8_PROPERTY_ATTRIBUTE_READONLY);
+    object->SetValue(
+        "capacity", CefV8Value::CreateInt(static_cast<int32_t>(_ring->GetCapacity())), V8_PROPERTY_ATTRIBUTE_READONLY);
+
+    for (auto function : {"read", "write", "on"})
+    {
+        object->SetValue(function, CefV8Value::CreateFunction(function, this), V8_PROPERTY_ATTRIBUTE_READONLY);
+    }
+
+    return object;
+}
+
+void IRingBinding::Notify()
+{
+    if (_callback == nullptr || _context == nullptr || !_context->IsValid())
+    {
+        return;
+    }
+
+    _context->Enter();
+    _callback->ExecuteFunction(nullptr, {});
+    _context->Exit();
+}
+
+void IRingBinding::Reset()
+{
+    _context = nullptr;
+    _callback = nullptr;
+}
+
+void IRingBinding::Close()
+{
+    Reset();
+    _ring.reset();
+}
@@ -0,0 +1,226 @@
+//
+//  ring.h
+//  webview
+//
+//  Single producer single consumer rings in shared memory, between the host and a page
+//
+
+#ifndef ring_h
+#define ring_h
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "include/cef_process_message.h"
+#include "include/cef_v8.h"
+
+#include "wew.h"
+
+///
+/// A shared memory region mapped in this process. The browser process creates it under a unique name, the renderer
+/// opens it by that name.
+///
+class ISharedMemory
+{
+  public:
+    static std::shared_ptr<ISharedMemory> Create(size_t size);
+    static std::shared_ptr<ISharedMemory> Open(const std::string &name, size_t size);
+
+    ~ISharedMemory();
+
+    uint8_t *GetData() const;
+    size_t GetSize() const;
+    const std::string &GetName() const;
+
+  private:
+    ISharedMemory(std::string name, size_t size);
+
+    bool Map(bool create);
+
+    std::string _name;
+    size_t _size;
+    bool _owner = false;
+    uint8_t *_data = nullptr;
+    void *_handle = nullptr;
+};
+
+///
+/// Shared header of a ring, each index on its own cache line so the producer and the consumer do not share one.
+///
+struct ISharedRingHeader
+{
+    uint32_t magic;
+    uint32_t capacity;
+
+    ///
+    /// Bytes written and read since the ring was created, the producer owns head and the consumer tail.
+    ///
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+
+    ///
+    /// Set by the consumer when it found the ring empty, the next write notifies it.
+    ///
+    alignas(64) std::atomic<uint32_t> waiting;
+};
+
+static_assert(sizeof(ISharedRingHeader) == WEW_RING_HEADER_SIZE);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+///
+/// Length prefixed records in a ring buffer, the prefix is 4 bytes and records are padded to 4 bytes.
+///
+/// The peer may be a compromised renderer, so nothing read from the header is trusted beyond the indices and every
+/// record is checked against them.
+///
+class ISharedRing
+{
+  public:
+    ///
+    /// Rounds a requested capacity up to a supported power of two.
+    ///
+    static uint32_t GetCapacity(uint32_t capacity);
+
+    ///
+    /// Bytes of a region holding a ring of the given capacity, header included.
+    ///
+    static size_t GetRegionSize(uint32_t capacity);
+
+    ///
+    /// Uses the region as a ring, the creator of the region initializes the header.
+    ///
+    ISharedRing(std::shared_ptr<ISharedMemory> memory, uint32_t capacity, bool initialize);
+
+    ///
+    /// Appends a record, returns false when the ring has no room for it. notify is set when the consumer is waiting
+    /// for this write.
+    ///
+    bool Write(const void *data, uint32_t size, bool &notify);
+
+    ///
+    /// Returns the size of the next record, -1 when the ring is empty, which also has the next write notify.
+    ///
+    int64_t Peek();
+
+    ///
+    /// Copies the next record into the buffer and consumes it, when it fits. Returns the size of the record, -1 when
+    /// the ring is empty.
+    ///
+    int64_t Read(void *buffer, uint32_t size);
+
+    const std::shared_ptr<ISharedMemory> &GetMemory() const;
+    uint32_t GetCapacity() const;
+
+  private:
+    std::shared_ptr<ISharedMemory> _memory;
+    ISharedRingHeader *_header;
+    uint8_t *_data;
+    uint32_t _capacity;
+
+    void CopyIn(uint64_t position, const void *buffer, uint32_t size);
+    void CopyOut(uint64_t position, void *buffer, uint32_t size);
+};
+
+///
+/// The browser process end of a ring, the handle the host writes to or reads from.
+///
+class IRingChannel
+{
+  public:
+    IRingChannel(int id, const RingSettings *settings, std::unique_ptr<ISharedRing> ring);
+
+    ///
+    /// Writes from the host to a ring to the page, the notifier runs when the page waits for the record.
+    ///
+    bool Write(const void *data, uint32_t size);
+
+    ///
+    /// Reads from a ring from the page, see wew_ring_read.
+    ///
+    int64_t Read(void *buffer, uint32_t size);
+
+    ///
+    /// Calls the host's on_ready, the page wrote to a ring the host found empty.
+    ///
+    void OnReady();
+
+    void SetNotifier(std::function<void()> notifier);
+
+    int GetId() const;
+
+    ///
+    /// Bytes of the shared region, header included.
+    ///
+    size_t GetSize() const;
+
+    ///
+    /// Arguments of the message that opens the ring in the renderer.
+    ///
+    void GetDescriptor(CefRefPtr<CefListValue> args) const;
+
+  private:
+    int _id;
+    std::string _name;
+    RingSettings _settings;
+    std::unique_ptr<ISharedRing> _ring;
+    std::function<void()> _notifier;
+};
+
+///
+/// The renderer end of a ring, the page's SharedRings entry with buffer, read, write and on.
+///
+class IRingBinding : public CefV8Handler
+{
+  public:
+    ///
+    /// Opens the ring described by a RING_OPEN message, returns nullptr when the region cannot be mapped.
+    ///
+    static CefRefPtr<IRingBinding> Open(CefRefPtr<CefBrowser> browser, CefRefPtr<CefListValue> args);
+
+    bool Execute(const CefString &name,
+                 CefRefPtr<CefV8Value> object,
+                 const CefV8ValueList &arguments,
+                 CefRefPtr<CefV8Value> &retval,
+                 CefString &exception) override;
+
+    int GetId() const;
+    const std::string &GetName() const;
+
+    ///
+    /// Creates the page object of the ring, in the entered context.
+    ///
+    CefRefPtr<CefV8Value> CreateObject();
+
+    ///
+    /// Calls the page's on callback, records arrived after it found the ring empty.
+    ///
+    void Notify();
+
+    ///
+    /// Drops the page's callback, its context is gone.
+    ///
+    void Reset();
+
+    ///
+    /// Stops the page's object from using the ring, the host closed it.
+    ///
+    void Close();
+
+  private:
+    IRingBinding(CefRefPtr<CefBrowser> browser, int id, std::string name, RingDirection direction);
+
+    CefRefPtr<CefBrowser> _browser;
+    int _id;
+    std::string _name;
+    RingDirection _direction;
+    std::unique_ptr<ISharedRing> _ring;
+    CefRefPtr<CefV8Context> _context;
+    CefRefPtr<CefV8Value> _callback;
+
+    IMPLEMENT_REFCOUNTING(IRingBinding);
+};
+
+#endif /* ring_h */
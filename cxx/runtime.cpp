@@ -22,6 +22,20 @@ IRuntime::IRuntime(const RuntimeSettings *settings, CefSettings cef_settings, Ru
             .factory = settings->custom_scheme->factory,
         };
     }
+
+    if (settings->renderer_plugins != nullptr)
+    {
+        _renderer_plugins = std::string(settings->renderer_plugins);
+    }
+
+#ifndef WIN32
+    if (settings->api_socket != nullptr)
+    {
+        _api_socket = std::string(settings->api_socket);
+    }
+#endif
+
+    _request_threads = settings->request_threads;
 }
 // clang-format on
 
@@ -45,6 +59,13 @@ void IRuntime::OnRegisterCustomSchemes(CefRawPtr<CefSchemeRegistrar> registrar)
                                    CEF_SCHEME_OPTION_STANDARD | CEF_SCHEME_OPTION_SECURE |
                                        CEF_SCHEME_OPTION_CORS_ENABLED | CEF_SCHEME_OPTION_FETCH_ENABLED);
     }
+
+    if (!_api_socket.empty())
+    {
+        registrar->AddCustomScheme(WEW_API_SCHEME,
+                                   CEF_SCHEME_OPTION_STANDARD | CEF_SCHEME_OPTION_SECURE |
+                                       CEF_SCHEME_OPTION_CORS_ENABLED | CEF_SCHEME_OPTION_FETCH_ENABLED);
+    }
 }
 
 void IRuntime::OnBeforeCommandLineProcessing(const CefString &process_type, CefRefPtr<CefCommandLine> command_line)
@@ -63,7 +84,16 @@ void IRuntime::OnContextInitialized()
                                         new ISchemeHandlerFactory(_custom_scheme.value()));
     }
 
-    _handler.on_context_initialized(_handler.context);
+#ifndef WIN32
+    if (!_api_socket.empty())
+    {
+        CefRegisterSchemeHandlerFactory(WEW_API_SCHEME, "", new IApiProxy(_api_socket));
+    }
+#endif
+
+    IRequestScheduler::Start(_request_threads);
+
+    IWatchdog::Call(HostCallback::OnContextInitialized, _handler.on_context_initialized, _handler.context);
 }
 
 CefRefPtr<CefClient> IRuntime::GetDefaultClient()
@@ -75,7 +105,8 @@ void IRuntime::OnScheduleMessagePumpWork(int64_t delay_ms)
 {
     CHECK_REFCOUNTING();
 
-    _handler.on_schedule_message_pump_work(delay_ms, _handler.context);
+    IWatchdog::Call(
+        HostCallback::OnScheduleMessagePumpWork, _handler.on_schedule_message_pump_work, delay_ms, _handler.context);
 }
 
 void IRuntime::OnBeforeChildProcessLaunch(CefRefPtr<CefCommandLine> command_line)
@@ -84,6 +115,16 @@ void IRuntime::OnBeforeChildProcessLaunch(CefRefPtr<CefCommandLine> command_line
     {
         command_line->AppendSwitchWithValue("scheme-name", _custom_scheme.value().name);
     }
+
+    if (!_renderer_plugins.empty())
+    {
+        command_line->AppendSwitchWithValue("renderer-plugins", _renderer_plugins);
+    }
+
+    if (!_api_socket.empty())
+    {
+        command_line->AppendSwitch("app-api");
+    }
 }
 
 CefSettings &IRuntime::GetCefSettings()
@@ -131,8 +172,12 @@ CefRefPtr<IWebView> IRuntime::CreateWebView(std::string url, const WebViewSettin
         }
     }
 
+    // The renderer learns of the webview's settings with the browser.
+    CefRefPtr<CefDictionaryValue> extra_info = CefDictionaryValue::Create();
+    extra_info->SetBool("message_bus", settings->message_bus);
+
     CefRefPtr<IWebView> webview = new IWebView(_cef_settings, settings, handler);
-    if (!CefBrowserHost::CreateBrowser(window_info, webview, url, broswer_settings, nullptr, nullptr))
+    if (!CefBrowserHost::CreateBrowser(window_info, webview, url, broswer_settings, extra_info, nullptr))
     {
         return nullptr;
     }
@@ -143,4 +188,6 @@ CefRefPtr<IWebView> IRuntime::CreateWebView(std::string url, const WebViewSettin
 void IRuntime::Close()
 {
     CLOSE_RUNNING;
+
+    IRequestScheduler::Stop();
 }
@@ -14,7 +14,9 @@
 
 #include "include/cef_app.h"
 
+#include "proxy.h"
 #include "request.h"
+#include "scheduler.h"
 #include "webview.h"
 #include "wew.h"
 
@@ -73,6 +75,9 @@ class IRuntime : public CefApp, public CefBrowserProcessHandler
 
   private:
     std::optional<ICustomSchemeAttributes> _custom_scheme = std::nullopt;
+    std::string _renderer_plugins;
+    std::string _api_socket;
+    int _request_threads = 0;
     CefSettings _cef_settings;
     RuntimeHandler _handler;
 
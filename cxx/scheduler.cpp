@@ -0,0 +1,177 @@
+//
+//  scheduler.cpp
+//  webview
+//
+//  Request handler calls run on a thread pool, by resource type
+//
+
+#include "scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+namespace
+{
+    struct Task
+    {
+        std::function<void()> func;
+        std::chrono::steady_clock::time_point posted;
+    };
+
+    struct SchedulerState
+    {
+        std::mutex mutex;
+        std::condition_variable condvar;
+        std::deque<Task> queues[static_cast<size_t>(RequestPriority::Count)];
+        std::vector<std::thread> threads;
+        std::atomic<bool> running{false};
+        bool stop = false;
+    };
+
+    SchedulerState &GetState()
+    {
+        static SchedulerState state;
+        return state;
+    }
+
+    // The oldest call that waited too long, otherwise the first call of the highest priority.
+    bool Pop(SchedulerState &state, Task &task)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::deque<Task> *next = nullptr;
+        std::deque<Task> *starved = nullptr;
+        for (auto &queue : state.queues)
+        {
+            if (queue.empty())
+            {
+                continue;
+            }
+
+            if (next == nullptr)
+            {
+                next = &queue;
+            }
+
+            if (now - queue.front().posted >= std::chrono::milliseconds(IRequestScheduler::MAX_WAIT_MS) &&
+                (starved == nullptr || queue.front().posted < starved->front().posted))
+            {
+                starved = &queue;
+            }
+        }
+
+        if (starved != nullptr)
+        {
+            next = starved;
+        }
+
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        task = std::move(next->front());
+        next->pop_front();
+        return true;
+    }
+
+    void Run(SchedulerState &state)
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(state.mutex);
+                state.condvar.wait(lock, [&] { return Pop(state, task) || state.stop; });
+
+                if (task.func == nullptr)
+                {
+                    return;
+                }
+            }
+
+            IMetrics::Observe(MetricHistogram::RequestQueueDuration, IMetrics::Elapsed(task.posted));
+
+            task.func();
+        }
+    }
+} // namespace
+
+void IRequestScheduler::Start(int threads)
+{
+    auto &state = GetState();
+    if (threads <= 0 || state.running)
+    {
+        return;
+    }
+
+    state.stop = false;
+    for (int i = 0; i < threads; i++)
+    {
+        state.threads.emplace_back([&state] { Run(state); });
+    }
+
+    state.running = true;
+}
+
+void IRequestScheduler::Stop()
+{
+    auto &state = GetState();
+    if (!state.running)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.stop = true;
+    }
+
+    state.condvar.notify_all();
+    for (auto &thread : state.threads)
+    {
+        thread.join();
+    }
+
+    state.threads.clear();
+    state.running = false;
+}
+
+bool IRequestScheduler::IsRunning()
+{
+    return GetState().running;
+}
+
+void IRequestScheduler::Post(ResourceType type, std::function<void()> task)
+{
+    auto &state = GetState();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.queues[static_cast<size_t>(GetPriority(type))].push_back(
+            {std::move(task), std::chrono::steady_clock::now()});
+    }
+
+    state.condvar.notify_one();
+}
+
+RequestPriority IRequestScheduler::GetPriority(ResourceType type)
+{
+    switch (type)
+    {
+    case WEW_RESOURCE_DOCUMENT:
+    case WEW_RESOURCE_STYLESHEET:
+    case WEW_RESOURCE_SCRIPT:
+        return RequestPriority::High;
+    case WEW_RESOURCE_IMAGE:
+    case WEW_RESOURCE_MEDIA:
+        return RequestPriority::Low;
+    default:
+        return RequestPriority::Normal;
+    }
+}
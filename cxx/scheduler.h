@@ -0,0 +1,60 @@
+//
+//  scheduler.h
+//  webview
+//
+//  Request handler calls run on a thread pool, by resource type
+//
+
+#ifndef scheduler_h
+#define scheduler_h
+#pragma once
+
+#include <functional>
+
+#include "wew.h"
+
+enum class RequestPriority
+{
+    ///
+    /// Documents, scripts and stylesheets, the resources that block rendering.
+    ///
+    High,
+    Normal,
+
+    ///
+    /// Images and media.
+    ///
+    Low,
+    Count,
+};
+
+class IRequestScheduler
+{
+  public:
+    ///
+    /// A call that waited this long runs before the calls of higher priority, so a page busy loading scripts still
+    /// gets its images.
+    ///
+    static constexpr int MAX_WAIT_MS = 100;
+
+    ///
+    /// Starts the threads, calls run on the CEF IO thread while the scheduler is not running.
+    ///
+    static void Start(int threads);
+
+    ///
+    /// Runs the waiting calls and ends the threads.
+    ///
+    static void Stop();
+
+    static bool IsRunning();
+
+    ///
+    /// Runs the call on the first free thread, after the waiting calls of the same or a higher priority.
+    ///
+    static void Post(ResourceType type, std::function<void()> task);
+
+    static RequestPriority GetPriority(ResourceType type);
+};
+
+#endif /* scheduler_h */
@@ -7,6 +7,9 @@
 
 #include "subprocess.h"
 
+#include "plugin.h"
+#include "proxy.h"
+
 CefRefPtr<CefRenderProcessHandler> ISubProcess::GetRenderProcessHandler()
 {
     return this;
@@ -21,6 +24,21 @@ void ISubProcess::OnRegisterCustomSchemes(CefRawPtr<CefSchemeRegistrar> registra
                                    CEF_SCHEME_OPTION_STANDARD | CEF_SCHEME_OPTION_CORS_ENABLED |
                                        CEF_SCHEME_OPTION_FETCH_ENABLED);
     }
+
+    if (cmd->HasSwitch("app-api"))
+    {
+        registrar->AddCustomScheme(WEW_API_SCHEME,
+                                   CEF_SCHEME_OPTION_STANDARD | CEF_SCHEME_OPTION_SECURE |
+                                       CEF_SCHEME_OPTION_CORS_ENABLED | CEF_SCHEME_OPTION_FETCH_ENABLED);
+    }
+}
+
+void ISubProcess::OnBrowserCreated(CefRefPtr<CefBrowser> browser, CefRefPtr<CefDictionaryValue> extra_info)
+{
+    if (extra_info != nullptr && extra_info->GetBool("message_bus"))
+    {
+        _bus_browsers.insert(browser->GetIdentifier());
+    }
 }
 
 void ISubProcess::OnContextCreated(CefRefPtr<CefBrowser> browser,
@@ -35,6 +53,75 @@ void ISubProcess::OnContextCreated(CefRefPtr<CefBrowser> browser,
 
     CefRefPtr<CefV8Value> global = context->GetGlobal();
     global->SetValue("MessageTransport", std::move(native), V8_PROPERTY_ATTRIBUTE_NONE);
+
+    if (!frame->IsMain())
+    {
+        return;
+    }
+
+    // Plugins run native code, so only the main frame gets them and not the cross-origin iframes it embeds.
+    auto cmd = CefCommandLine::GetGlobalCommandLine();
+    if (cmd->HasSwitch("renderer-plugins"))
+    {
+        IPlugins::Load(cmd->GetSwitchValue("renderer-plugins"));
+    }
+
+    IPlugins::Install(global);
+
+    int id = browser->GetIdentifier();
+    _contexts[id] = context;
+
+    CefRefPtr<CefV8Value> rings = CefV8Value::CreateObject(nullptr, nullptr);
+    for (auto &it : _rings[id])
+    {
+        it.second->Reset();
+        rings->SetValue(it.second->GetName(), it.second->CreateObject(), V8_PROPERTY_ATTRIBUTE_NONE);
+    }
+
+    global->SetValue("SharedRings", std::move(rings), V8_PROPERTY_ATTRIBUTE_READONLY);
+
+    // The host may have opened rings before this renderer existed, it answers with a RING_OPEN for each ring.
+    frame->SendProcessMessage(PID_BROWSER, CefProcessMessage::Create("RING_SYNC"));
+
+    if (_bus_browsers.count(id) == 0)
+    {
+        return;
+    }
+
+    // Subscriptions belong to the page, the browser forgets the ones of the previous page.
+    _bus->Reset(id);
+    global->SetValue("MessageBus", _bus->CreateObject(), V8_PROPERTY_ATTRIBUTE_READONLY);
+    frame->SendProcessMessage(PID_BROWSER, CefProcessMessage::Create("BUS_RESET"));
+}
+
+void ISubProcess::OnContextReleased(CefRefPtr<CefBrowser> browser,
+                                    CefRefPtr<CefFrame> frame,
+                                    CefRefPtr<CefV8Context> context)
+{
+    auto it = _contexts.find(browser->GetIdentifier());
+    if (it != _contexts.end() && it->second->IsSame(context))
+    {
+        _contexts.erase(it);
+    }
+}
+
+void ISubProcess::OnBrowserDestroyed(CefRefPtr<CefBrowser> browser)
+{
+    int id = browser->GetIdentifier();
+    _contexts.erase(id);
+    _bus_browsers.erase(id);
+    _bus->Reset(id);
+
+    auto it = _rings.find(id);
+    if (it != _rings.end())
+    {
+        for (auto &ring : it->second)
+        {
+            ring.second->Close();
+        }
+
+        _rings.erase(it);
+    }
 }
 
 bool ISubProcess::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
@@ -42,6 +129,26 @@ bool ISubProcess::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
                                            CefProcessId source_process,
                                            CefRefPtr<CefProcessMessage> message)
 {
+    std::string name = message->GetName();
+    if (name == "RING_OPEN" || name == "RING_CLOSE" || name == "RING_NOTIFY")
+    {
+        OnRingMessage(browser, name, message->GetArgumentList());
+
+        return true;
+    }
+
+    if (name == "BUS_MESSAGE")
+    {
+        auto context = _contexts.find(browser->GetIdentifier());
+        if (context != _contexts.end())
+        {
+            auto args = message->GetArgumentList();
+            _bus->Recv(browser, context->second, args->GetString(0), args->GetString(1));
+        }
+
+        return true;
+    }
+
     auto args = message->GetArgumentList();
     std::string payload = args->GetString(0);
     _receiver->Recv(payload);
@@ -49,6 +156,74 @@ bool ISubProcess::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
     return true;
 }
 
+void ISubProcess::OnRingMessage(CefRefPtr<CefBrowser> browser,
+                                const std::string &name,
+                                CefRefPtr<CefListValue> args)
+{
+    int id = browser->GetIdentifier();
+    auto &rings = _rings[id];
+    auto it = rings.find(args->GetInt(0));
+
+    if (name == "RING_NOTIFY")
+    {
+        if (it != rings.end())
+        {
+            it->second->Notify();
+        }
+
+        return;
+    }
+
+    CefRefPtr<IRingBinding> binding;
+    if (name == "RING_OPEN")
+    {
+        // Every context creation asks for the rings again, the ones already mapped are kept.
+        if (it != rings.end())
+        {
+            return;
+        }
+
+        binding = IRingBinding::Open(browser, args);
+        if (binding == nullptr)
+        {
+            return;
+        }
+
+        rings[binding->GetId()] = binding;
+    }
+    else
+    {
+        if (it == rings.end())
+        {
+            return;
+        }
+
+        binding = it->second;
+        binding->Close();
+        rings.erase(it);
+    }
+
+    auto context = _contexts.find(id);
+    if (context == _contexts.end())
+    {
+        return;
+    }
+
+    context->second->Enter();
+
+    auto object = context->second->GetGlobal()->GetValue("SharedRings");
+    if (name == "RING_OPEN")
+    {
+        object->SetValue(binding->GetName(), binding->CreateObject(), V8_PROPERTY_ATTRIBUTE_NONE);
+    }
+    else
+    {
+        object->DeleteValue(binding->GetName());
+    }
+
+    context->second->Exit();
+}
+
 bool MessageSender::Execute(const CefString &name,
                             CefRefPtr<CefV8Value> object,
                             const CefV8ValueList &arguments,
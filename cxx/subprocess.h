@@ -9,10 +9,14 @@
 #define subprocess_h
 #pragma once
 
+#include <map>
 #include <optional>
+#include <set>
 #include <string>
 
+#include "bus.h"
 #include "include/cef_app.h"
+#include "ring.h"
 #include "wew.h"
 
 class MessageSender : public CefV8Handler
@@ -70,6 +74,16 @@ class ISubProcess : public CefApp, public CefRenderProcessHandler
 
     /* CefRenderProcessHandler */
 
+    ///
+    /// Called after a browser has been created, with the extra info of its webview.
+    ///
+    void OnBrowserCreated(CefRefPtr<CefBrowser> browser, CefRefPtr<CefDictionaryValue> extra_info) override;
+
+    ///
+    /// Called before a browser is destroyed.
+    ///
+    void OnBrowserDestroyed(CefRefPtr<CefBrowser> browser) override;
+
     ///
     /// Called immediately after the V8 context for a frame has been created.
     ///
@@ -77,6 +91,13 @@ class ISubProcess : public CefApp, public CefRenderProcessHandler
                           CefRefPtr<CefFrame> frame,
                           CefRefPtr<CefV8Context> context) override;
 
+    ///
+    /// Called immediately before the V8 context for a frame is released.
+    ///
+    void OnContextReleased(CefRefPtr<CefBrowser> browser,
+                           CefRefPtr<CefFrame> frame,
+                           CefRefPtr<CefV8Context> context) override;
+
     ///
     /// Called when a new message is received from a different process.
     ///
@@ -91,6 +112,21 @@ class ISubProcess : public CefApp, public CefRenderProcessHandler
   private:
     CefRefPtr<MessageSender> _sender = new MessageSender();
     CefRefPtr<MessageReceiver> _receiver = new MessageReceiver();
+    CefRefPtr<IBusBinding> _bus = new IBusBinding();
+
+    ///
+    /// Main frame context of each browser and the shared rings its host opened, by browser identifier. Rings outlive
+    /// navigations, every new context gets them again.
+    ///
+    std::map<int, CefRefPtr<CefV8Context>> _contexts;
+    std::map<int, std::map<int, CefRefPtr<IRingBinding>>> _rings;
+
+    ///
+    /// Browsers whose webview is on the message bus.
+    ///
+    std::set<int> _bus_browsers;
+
+    void OnRingMessage(CefRefPtr<CefBrowser> browser, const std::string &name, CefRefPtr<CefListValue> args);
 
     IMPLEMENT_REFCOUNTING(ISubProcess);
 };
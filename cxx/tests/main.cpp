@@ -0,0 +1,2468 @@
+//
+//  main.cpp
+//  webview
+//
+//  Headless tests for the cxx layer, running on the in-process CEF mock
+//
+
+// The checks below are plain asserts, keep them in release builds.
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "cef_mock.h"
+#include "wew.h"
+#include "wew.hpp"
+
+struct RuntimeContext
+{
+    int initialized = 0;
+    int scheduled = 0;
+};
+
+struct WebViewContext
+{
+    std::vector<WebViewState> states;
+    std::vector<std::string> messages;
+    std::vector<Frame> frames;
+
+    // Copied in the callback, the frame's pointers are only valid during it.
+    std::vector<std::vector<Rect>> dirty_rects;
+    std::vector<std::vector<FrameMove>> moves;
+    std::vector<std::vector<uint8_t>> alpha_tiles;
+    std::string title;
+};
+
+struct ResourceContext
+{
+    std::string body;
+    size_t cursor = 0;
+    int destroyed = 0;
+};
+
+static RuntimeContext RUNTIME_CONTEXT;
+static ResourceContext RESOURCE_CONTEXT;
+
+static void *RUNTIME = nullptr;
+
+static void on_context_initialized(void *context)
+{
+    static_cast<RuntimeContext *>(context)->initialized += 1;
+}
+
+static void on_schedule_message_pump_work(int64_t delay_ms, void *context)
+{
+    static_cast<RuntimeContext *>(context)->scheduled += 1;
+}
+
+static void on_state_change(WebViewState state, void *context)
+{
+    static_cast<WebViewContext *>(context)->states.push_back(state);
+}
+
+static void on_message(const char *message, void *context)
+{
+    static_cast<WebViewContext *>(context)->messages.push_back(message);
+}
+
+static void on_frame(const Frame *frame, void *context)
+{
+    auto webview = static_cast<WebViewContext *>(context);
+    webview->frames.push_back(*frame);
+    webview->dirty_rects.emplace_back(frame->dirty_rects, frame->dirty_rects + frame->dirty_rects_count);
+    webview->moves.emplace_back(frame->moves, frame->moves + frame->moves_count);
+
+    size_t tiles = frame->alpha_tiles != nullptr ? frame->alpha_tile_columns * frame->alpha_tile_rows : 0;
+    webview->alpha_tiles.emplace_back(frame->alpha_tiles, frame->alpha_tiles + tiles);
+}
+
+static void on_title_change(const char *title, void *context)
+{
+    static_cast<WebViewContext *>(context)->title = title;
+}
+
+static void on_cursor(CursorType type, void *context)
+{
+}
+
+static void on_ime_rect(Rect rect, void *context)
+{
+}
+
+static void on_fullscreen_change(bool fullscreen, void *context)
+{
+}
+
+static bool resource_open(void *context)
+{
+    static_cast<ResourceContext *>(context)->cursor = 0;
+    return true;
+}
+
+static bool resource_skip(size_t size, int *cursor, void *context)
+{
+    auto resource = static_cast<ResourceContext *>(context);
+    *cursor = static_cast<int>(std::min(size, resource->body.size() - resource->cursor));
+    resource->cursor += *cursor;
+    return true;
+}
+
+static bool resource_read(uint8_t *buffer, size_t size, int *cursor, void *context)
+{
+    auto resource = static_cast<ResourceContext *>(context);
+    size_t count = std::min(size, resource->body.size() - resource->cursor);
+    memcpy(buffer, resource->body.data() + resource->cursor, count);
+    resource->cursor += count;
+    *cursor = static_cast<int>(count);
+    return count > 0;
+}
+
+static void resource_get_response(Response *response, void *context)
+{
+    response->status_code = 200;
+    response->content_length = static_cast<ResourceContext *>(context)->body.size();
+    strcpy(response->mime_type, "text/html");
+}
+
+static void resource_cancel(void *context)
+{
+}
+
+static void resource_destroy(void *context)
+{
+    static_cast<ResourceContext *>(context)->destroyed += 1;
+}
+
+static RequestHandler *request_handler(Request *request, void *context)
+{
+    if (strcmp(request->url, "wew://localhost/index.html") != 0)
+    {
+        return nullptr;
+    }
+
+    return new RequestHandler{
+        .open = resource_open,
+        .skip = resource_skip,
+        .read = resource_read,
+        .get_response = resource_get_response,
+        .cancel = resource_cancel,
+        .destroy = resource_destroy,
+        .context = context,
+    };
+}
+
+static void destroy_request_handler(RequestHandler *handler)
+{
+    delete handler;
+}
+
+static const RequestHandlerFactory REQUEST_HANDLER_FACTORY = {
+    .request = request_handler,
+    .destroy_request_handler = destroy_request_handler,
+    .context = &RESOURCE_CONTEXT,
+};
+
+static const CustomSchemeAttributes CUSTOM_SCHEME = {
+    .name = "wew",
+    .domain = "localhost",
+    .factory = &REQUEST_HANDLER_FACTORY,
+};
+
+static const std::string API_SOCKET = "/tmp/wew-tests-" + std::to_string(getpid()) + ".sock";
+
+static WebViewSettings create_test_settings()
+{
+    WebViewSettings settings{};
+    settings.width = 800;
+    settings.height = 600;
+    settings.device_scale_factor = 1.0;
+    settings.javascript = true;
+    settings.windowless_frame_rate = 30;
+    settings.request_handler_factory = &REQUEST_HANDLER_FACTORY;
+
+    return settings;
+}
+
+static void *create_test_webview(WebViewContext *context, const WebViewSettings &settings = create_test_settings())
+{
+    WebViewHandler handler{
+        .on_cursor = on_cursor,
+        .on_state_change = on_state_change,
+        .on_ime_rect = on_ime_rect,
+        .on_frame = on_frame,
+        .on_title_change = on_title_change,
+        .on_fullscreen_change = on_fullscreen_change,
+        .on_message = on_message,
+        .context = context,
+    };
+
+    void *webview = create_webview(RUNTIME, "wew://localhost/index.html", &settings, handler);
+    cef_mock::Settle();
+    return webview;
+}
+
+static void test_runtime_initialize()
+{
+    const char *argv[] = {"wew_tests"};
+    assert(execute_subprocess(1, argv) == -1);
+
+    RuntimeSettings settings{};
+    settings.custom_scheme = &CUSTOM_SCHEME;
+    settings.windowless_rendering_enabled = true;
+
+    // Missing plugin libraries are skipped, the pages load without them.
+    settings.renderer_plugins = "/nonexistent/libwew_plugin.so";
+
+    // Connected on the first app-api request.
+    settings.api_socket = API_SOCKET.c_str();
+
+    // One thread, so test_request_priority sees the calls in the order they are scheduled.
+    settings.request_threads = 1;
+
+    RuntimeHandler handler{
+        .on_context_initialized = on_context_initialized,
+        .on_schedule_message_pump_work = on_schedule_message_pump_work,
+        .context = &RUNTIME_CONTEXT,
+    };
+
+    RUNTIME = create_runtime(&settings, handler);
+    assert(RUNTIME != nullptr);
+    assert(execute_runtime(RUNTIME, 1, argv));
+    assert(RUNTIME_CONTEXT.initialized == 0);
+
+    cef_mock::Settle();
+    assert(RUNTIME_CONTEXT.initialized == 1);
+}
+
+static void test_post_task_with_main_thread()
+{
+    int count = 0;
+    auto callback = [](void *context) { *static_cast<int *>(context) += 1; };
+
+    assert(post_task_with_main_thread(callback, &count));
+    assert(post_task_with_main_thread(callback, &count));
+    assert(count == 0);
+
+    poll_message_loop();
+    assert(count == 2);
+}
+
+static void test_webview_lifecycle()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    assert(webview != nullptr);
+
+    assert(context.states.size() == 2);
+    assert(context.states[0] == WEW_BEFORE_LOAD);
+    assert(context.states[1] == WEW_LOADED);
+
+    auto browser = cef_mock::GetLastBrowser();
+    auto host = cef_mock::GetHost(browser);
+    assert(host->HasFocus());
+    assert(host->GetSettings().windowless_frame_rate == 30);
+    assert(host->last_view_rect.width == 800);
+    assert(host->last_view_rect.height == 600);
+
+    close_webview(webview);
+    cef_mock::Settle();
+
+    // The handler stops forwarding once the host closed the webview, so no close states are reported back.
+    assert(host->IsClosed());
+    assert(context.states.size() == 2);
+    assert(cef_mock::GetLastBrowser() == nullptr);
+}
+
+static void test_input_forwarding()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto host = cef_mock::GetHost(cef_mock::GetLastBrowser());
+
+    MouseEvent mouse{.x = 10, .y = 20, .modifiers = WEW_EVENTFLAG_SHIFT_DOWN};
+    webview_mouse_click(webview, mouse, WEW_MBT_RIGHT, true);
+    assert(host->last_mouse_event.x == 10);
+    assert(host->last_mouse_event.y == 20);
+    assert(host->last_mouse_event.modifiers == WEW_EVENTFLAG_SHIFT_DOWN);
+    assert(host->last_mouse_button == MBT_RIGHT);
+    assert(!host->last_mouse_up);
+
+    webview_mouse_move(webview, mouse);
+    webview_mouse_move(webview, mouse);
+    assert(host->GetEventCount(cef_mock::HostEvent::MouseMove) == 2);
+
+    webview_mouse_wheel(webview, mouse, 0, -120);
+    assert(host->last_wheel_delta_x == 0);
+    assert(host->last_wheel_delta_y == -120);
+
+    KeyEvent key{};
+    key.type = WEW_KEYEVENT_CHAR;
+    key.windows_key_code = 65;
+    key.character = 'a';
+    webview_keyboard(webview, key);
+    assert(host->last_key_event.type == KEYEVENT_CHAR);
+    assert(host->last_key_event.windows_key_code == 65);
+    assert(host->last_key_event.character == 'a');
+
+    TouchEvent touch{};
+    touch.id = 3;
+    touch.x = 1.5;
+    touch.type = WEW_TET_MOVED;
+    webview_touch(webview, touch);
+    assert(host->last_touch_event.id == 3);
+    assert(host->last_touch_event.type == CEF_TET_MOVED);
+
+    webview_ime_composition(webview, "hello");
+    assert(host->last_ime_text == "hello");
+    assert(host->GetEventCount(cef_mock::HostEvent::ImeCommitText) == 1);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_on_frame()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<uint8_t> buffer(800 * 600 * 4);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(4, 8, 16, 16)}, buffer.data(), 800, 600);
+
+    assert(context.frames.size() == 1);
+    assert(!context.frames[0].is_popup);
+    assert(context.frames[0].buffer == buffer.data());
+    assert(context.frames[0].width == 800);
+    assert(context.frames[0].height == 600);
+    assert(context.frames[0].x == 4);
+    assert(context.frames[0].y == 8);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_message_transport()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    // The page echoes every message it receives back to the host.
+    cef_mock::RunInRenderer(browser, [](CefRefPtr<CefV8Context> v8) {
+        auto transport = v8->GetGlobal()->GetValue("MessageTransport");
+        auto send = transport->GetValue("send");
+        auto echo = cef_mock::CreateFunction("echo", [send](const CefV8ValueList &arguments) {
+            return send->ExecuteFunction(nullptr, arguments);
+        });
+
+        transport->GetValue("on")->ExecuteFunction(nullptr, {echo});
+    });
+
+    cef_mock::Settle();
+
+    webview_send_message(webview, "ping");
+    webview_send_message(webview, "pong");
+    cef_mock::Settle();
+
+    assert(context.messages.size() == 2);
+    assert(context.messages[0] == "ping");
+    assert(context.messages[1] == "pong");
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_custom_scheme()
+{
+    RESOURCE_CONTEXT.body = "<html><body>hello</body></html>";
+    RESOURCE_CONTEXT.destroyed = 0;
+
+    {
+        auto request = cef_mock::CreateRequest("wew://localhost/index.html");
+        auto handler = cef_mock::CreateSchemeHandler(nullptr, request);
+        assert(handler != nullptr);
+
+        auto resource = cef_mock::LoadResource(handler, request, 8);
+        assert(resource.handled);
+        assert(resource.status == 200);
+        assert(resource.mime_type == "text/html");
+        assert(resource.content_length == static_cast<int64_t>(RESOURCE_CONTEXT.body.size()));
+        assert(resource.body == RESOURCE_CONTEXT.body);
+        assert(RESOURCE_CONTEXT.destroyed == 0);
+    }
+
+    assert(RESOURCE_CONTEXT.destroyed == 1);
+
+    auto missing = cef_mock::CreateRequest("wew://localhost/missing.html");
+    assert(cef_mock::CreateSchemeHandler(nullptr, missing) == nullptr);
+}
+
+static void test_request_handler()
+{
+    RESOURCE_CONTEXT.body = "body";
+    RESOURCE_CONTEXT.destroyed = 0;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    {
+        auto request = cef_mock::CreateRequest("wew://localhost/index.html");
+        auto resource = cef_mock::LoadResource(cef_mock::CreateResourceHandler(browser, request), request);
+        assert(resource.handled);
+        assert(resource.body == "body");
+    }
+
+    assert(RESOURCE_CONTEXT.destroyed == 1);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+struct CookieContext
+{
+    std::vector<std::string> names;
+    int destroyed = 0;
+};
+
+static bool visit_cookie(const Cookie *cookie, int count, int total, bool *delete_cookie, void *context)
+{
+    static_cast<CookieContext *>(context)->names.push_back(cookie->name);
+    return true;
+}
+
+static void destroy_cookie_visitor(void *context)
+{
+    static_cast<CookieContext *>(context)->destroyed += 1;
+}
+
+static void test_cookies()
+{
+    void *manager = wew_get_global_cookie_manager();
+    assert(manager != nullptr);
+
+    Cookie cookie{};
+    cookie.name = "session";
+    cookie.value = "1234";
+    cookie.domain = "localhost";
+    cookie.path = "/";
+    assert(wew_set_cookie(manager, "wew://localhost/", &cookie));
+
+    CookieContext context;
+    CookieVisitor visitor{.visit = visit_cookie, .destroy = destroy_cookie_visitor, .context = &context};
+    wew_visit_all_cookies(manager, &visitor);
+    cef_mock::Settle();
+
+    assert(context.names.size() == 1);
+    assert(context.names[0] == "session");
+
+    assert(wew_delete_cookies(manager, "wew://localhost/", "session"));
+    assert(wew_flush_cookie_store(manager));
+
+    context.names.clear();
+    wew_visit_all_cookies(manager, &visitor);
+    cef_mock::Settle();
+    assert(context.names.empty());
+
+    wew_destroy_cookie_manager(manager);
+}
+
+static const Metric *find_metric(const std::vector<Metric> &metrics, const char *name)
+{
+    for (auto &metric : metrics)
+    {
+        if (strcmp(metric.name, name) == 0)
+        {
+            return &metric;
+        }
+    }
+
+    return nullptr;
+}
+
+static std::vector<Metric> snapshot_metrics()
+{
+    std::vector<Metric> metrics(wew_metrics_snapshot(nullptr, 0));
+    assert(wew_metrics_snapshot(metrics.data(), metrics.size()) == metrics.size());
+
+    return metrics;
+}
+
+static void test_metrics()
+{
+    auto before = snapshot_metrics();
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<uint8_t> buffer(64 * 32 * 4);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 10, 10), CefRect(20, 0, 5, 4)}, buffer.data(), 64, 32);
+
+    webview_send_message(webview, std::string(100, 'x').c_str());
+    cef_mock::Settle();
+
+    auto after = snapshot_metrics();
+    assert(after.size() == before.size());
+
+    auto delta = [&](const char *name) {
+        return find_metric(after, name)->count - find_metric(before, name)->count;
+    };
+
+    assert(delta("wew_frames_total") == 1);
+    assert(delta("wew_frame_bytes_total") == 64 * 32 * 4);
+    assert(delta("wew_frame_dirty_pixels") == 1);
+    assert(delta("wew_message_sent_bytes") == 1);
+
+    // 120 dirty pixels land in the first bucket, a 100 byte message in the second one.
+    auto dirty = find_metric(after, "wew_frame_dirty_pixels");
+    assert(dirty->kind == WEW_METRIC_HISTOGRAM);
+    assert(dirty->buckets[0] - find_metric(before, "wew_frame_dirty_pixels")->buckets[0] == 1);
+    assert(dirty->bounds[WEW_METRIC_BUCKETS - 1] == UINT64_MAX);
+
+    auto sent = find_metric(after, "wew_message_sent_bytes");
+    assert(sent->bounds[0] == 64 && sent->bounds[1] == 256);
+    assert(sent->buckets[1] - find_metric(before, "wew_message_sent_bytes")->buckets[1] == 1);
+    assert(sent->sum - find_metric(before, "wew_message_sent_bytes")->sum == 100);
+
+    size_t size = wew_metrics_prometheus(nullptr, 0);
+    std::string text(size, '\0');
+    assert(wew_metrics_prometheus(text.data(), size + 1) == size);
+    assert(text.find("# TYPE wew_frames_total counter\n") != std::string::npos);
+    assert(text.find("wew_message_sent_bytes_bucket{le=\"+Inf\"} ") != std::string::npos);
+    assert(text.find("wew_message_sent_bytes_sum ") != std::string::npos);
+
+    // Truncated output is still null terminated.
+    char truncated[8];
+    assert(wew_metrics_prometheus(truncated, sizeof(truncated)) == size);
+    assert(strlen(truncated) == sizeof(truncated) - 1);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void on_slow_callback(const char *name, uint64_t duration_ns, void *context)
+{
+    static_cast<std::vector<std::string> *>(context)->push_back(name);
+}
+
+static void test_slow_callback()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<std::string> slow;
+    SlowCallbackHandler handler{
+        .on_slow_callback = on_slow_callback,
+        .threshold_ns = 0,
+        .context = &slow,
+    };
+
+    // A zero threshold reports every callback.
+    wew_set_slow_callback_handler(&handler);
+
+    auto before = snapshot_metrics();
+
+    std::vector<uint8_t> buffer(64 * 32 * 4);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 64, 32)}, buffer.data(), 64, 32);
+    assert(slow.size() == 1 && slow[0] == "on_frame");
+
+    auto after = snapshot_metrics();
+    assert(find_metric(after, "wew_callback_on_frame_duration_ns")->count -
+               find_metric(before, "wew_callback_on_frame_duration_ns")->count ==
+           1);
+
+    handler.threshold_ns = UINT64_MAX - 1;
+    wew_set_slow_callback_handler(&handler);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 64, 32)}, buffer.data(), 64, 32);
+    assert(slow.size() == 1);
+
+    wew_set_slow_callback_handler(nullptr);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 64, 32)}, buffer.data(), 64, 32);
+    assert(slow.size() == 1);
+    assert(context.frames.size() == 3);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_trace()
+{
+    std::string path = "wew_tests_trace.json";
+
+#ifdef WEW_TRACING
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<uint8_t> buffer(64 * 32 * 4);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 64, 32)}, buffer.data(), 64, 32);
+    webview_send_message(webview, "trace");
+    cef_mock::Settle();
+
+    assert(wew_trace_flush(path.c_str()));
+
+    FILE *file = fopen(path.c_str(), "r");
+    assert(file != nullptr);
+
+    std::string trace;
+    char chunk[4096];
+    for (size_t size; (size = fread(chunk, 1, sizeof(chunk), file)) > 0;)
+    {
+        trace.append(chunk, size);
+    }
+
+    fclose(file);
+    remove(path.c_str());
+
+    assert(trace.find("\"traceEvents\"") != std::string::npos);
+    assert(trace.find("\"name\":\"create_webview\",\"cat\":\"wew\",\"ph\":\"X\"") != std::string::npos);
+    assert(trace.find("\"name\":\"IWebViewRender::OnPaint\"") != std::string::npos);
+    assert(trace.find("\"name\":\"IWebView::SendMessage\"") != std::string::npos);
+
+    // Flushing drains the buffers.
+    assert(wew_trace_flush(path.c_str()));
+    remove(path.c_str());
+
+    // Threads that exited hand their drained buffers to new threads instead of adding one each.
+    size_t lane = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        std::thread([&]() { webview_send_message(webview, "trace"); }).join();
+        assert(wew_trace_flush(path.c_str()));
+
+        file = fopen(path.c_str(), "r");
+        assert(file != nullptr);
+
+        trace.clear();
+        for (size_t size; (size = fread(chunk, 1, sizeof(chunk), file)) > 0;)
+        {
+            trace.append(chunk, size);
+        }
+
+        fclose(file);
+        remove(path.c_str());
+
+        size_t tid = 0;
+        size_t offset = trace.find("\"name\":\"IWebView::SendMessage\"");
+        assert(offset != std::string::npos);
+        sscanf(trace.c_str() + trace.find("\"tid\":", offset), "\"tid\":%zu", &tid);
+        assert(lane == 0 || tid == lane);
+        lane = tid;
+    }
+
+    close_webview(webview);
+    cef_mock::Settle();
+#else
+    assert(!wew_trace_flush(path.c_str()));
+#endif
+}
+
+static void test_memory_usage()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+
+    MemoryUsage usage;
+    memset(&usage, 0xff, sizeof(usage));
+    webview_get_memory_usage(webview, &usage);
+    for (size_t i = 0; i < WEW_MEMORY_TOTAL; i++)
+    {
+        assert(usage.bytes[i] == 0);
+    }
+
+    assert(usage.total == 0 && usage.peak == 0 && usage.evicted == 0);
+
+    webview_set_memory_budget(webview, WEW_MEMORY_FRAME_BUFFERS, 1024 * 1024);
+    webview_set_memory_budget(webview, WEW_MEMORY_TOTAL, 4 * 1024 * 1024);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_ignored_events()
+{
+    WebViewContext context;
+
+    WebViewSettings settings = create_test_settings();
+    settings.ignored_events = WEW_EVENT_FRAME | WEW_EVENT_MESSAGE;
+
+    WebViewHandler handler{
+        .on_state_change = on_state_change,
+        .on_frame = on_frame,
+        .on_message = on_message,
+        .context = &context,
+    };
+
+    void *webview = create_webview(RUNTIME, "wew://localhost/index.html", &settings, handler);
+    cef_mock::Settle();
+
+    // State changes are still delivered, the null callbacks are skipped.
+    assert(!context.states.empty());
+
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<uint8_t> buffer(800 * 600 * 4);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, buffer.data(), 800, 600);
+    assert(context.frames.empty());
+
+    webview_send_message(webview, "ping");
+    cef_mock::Settle();
+    assert(context.messages.empty());
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_frame_buffers()
+{
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    const uint32_t stride = 800 * 4 + 64;
+    std::vector<uint8_t> first(stride * 600);
+    std::vector<uint8_t> second(stride * 600);
+    FrameBuffer buffers[] = {
+        {first.data(), first.size(), stride},
+        {second.data(), second.size(), stride},
+    };
+
+    assert(webview_set_frame_buffers(webview, buffers, 2));
+
+    std::vector<uint8_t> view(800 * 600 * 4, 1);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    assert(context.frames.size() == 1);
+    assert(context.frames[0].buffer_index == 0);
+    assert(context.frames[0].buffer == first.data());
+    assert(context.frames[0].stride == stride);
+    assert(first[599 * stride + 799 * 4] == 1);
+
+    view[0] = 2;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 1, 1)}, view.data(), 800, 600);
+    assert(context.frames.size() == 2);
+    assert(context.frames[1].buffer_index == 1);
+    assert(second[0] == 2 && second[599 * stride + 799 * 4] == 1);
+
+    // Both buffers are held by the host, the paint is dropped but its damage is kept.
+    view[800 * 4] = 3;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 1, 16, 1)}, view.data(), 800, 600);
+    assert(context.frames.size() == 2);
+
+    // The released buffer only receives the damage it missed.
+    first[599 * stride] = 9;
+    webview_release_frame_buffer(webview, 0);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(8, 8, 1, 1)}, view.data(), 800, 600);
+    assert(context.frames.size() == 3);
+    assert(context.frames[2].buffer_index == 0);
+    assert(first[0] == 2);
+    assert(first[stride] == 3);
+    assert(first[599 * stride] == 9);
+
+    // The dropped paint's damage is not part of this frame's rects, the host is told to take the whole buffer.
+    assert(context.dirty_rects[2].size() == 1 && context.dirty_rects[2][0].width == 800);
+
+    assert(webview_set_frame_buffers(webview, nullptr, 0));
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 1, 1)}, view.data(), 800, 600);
+    assert(context.frames.size() == 4);
+    assert(context.frames[3].buffer_index == -1);
+    assert(context.frames[3].buffer == view.data());
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_motion_detection()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.motion_detection = true;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    // Every pixel is unique, so every row and column is too.
+    std::vector<uint32_t> view(800 * 600);
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        view[i] = static_cast<uint32_t>(i);
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    assert(context.moves.back().empty());
+    assert(context.dirty_rects.back().size() == 1);
+
+    // Scroll down by 40 rows, the bottom strip is new content.
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        view[i] = i < 560 * 800 ? view[i + 40 * 800] : static_cast<uint32_t>(i) | 0x80000000;
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &moves = context.moves.back();
+        auto &dirty_rects = context.dirty_rects.back();
+        assert(moves.size() == 1);
+        assert(moves[0].dx == 0 && moves[0].dy == -40);
+        assert(moves[0].rect.y == 40 && moves[0].rect.height == 560);
+        assert(dirty_rects.size() == 1);
+        assert(dirty_rects[0].y == 560 && dirty_rects[0].height == 40);
+        assert(dirty_rects[0].width == 800);
+    }
+
+    // Scroll right by 10 columns.
+    for (size_t y = 0; y < 600; y++)
+    {
+        uint32_t *row = view.data() + y * 800;
+        memmove(row + 10, row, 790 * 4);
+        for (size_t x = 0; x < 10; x++)
+        {
+            row[x] = 0x40000000 | static_cast<uint32_t>(y * 800 + x);
+        }
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &moves = context.moves.back();
+        auto &dirty_rects = context.dirty_rects.back();
+        assert(moves.size() == 1);
+        assert(moves[0].dx == 10 && moves[0].dy == 0);
+        assert(moves[0].rect.x == 0 && moves[0].rect.width == 790);
+        assert(dirty_rects.size() == 1);
+        assert(dirty_rects[0].x == 0 && dirty_rects[0].width == 10);
+    }
+
+    // Small damage is passed through without a search, its rows are still taken into the history.
+    for (size_t i = 100 * 800; i < 113 * 800; i++)
+    {
+        view[i] = 0x20000000 | static_cast<uint32_t>(i);
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 100, 800, 13)}, view.data(), 800, 600);
+    assert(context.moves.back().empty());
+    assert(context.dirty_rects.back().size() == 1);
+    assert(context.dirty_rects.back()[0].y == 100 && context.dirty_rects.back()[0].height == 13);
+
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        view[i] = i < 560 * 800 ? view[i + 40 * 800] : static_cast<uint32_t>(i) | 0x10000000;
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &moves = context.moves.back();
+        assert(moves.size() == 1);
+        assert(moves[0].dy == -40 && moves[0].rect.y == 40 && moves[0].rect.height == 560);
+    }
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_alpha_tiles()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.alpha_tile_size = 64;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    // Transparent, with an opaque first tile and a half opaque second one.
+    std::vector<uint32_t> view(800 * 600, 0);
+    for (size_t y = 0; y < 64; y++)
+    {
+        for (size_t x = 0; x < 96; x++)
+        {
+            view[y * 800 + x] = 0xff102030;
+        }
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &frame = context.frames.back();
+        auto &tiles = context.alpha_tiles.back();
+        assert(frame.alpha_tile_size == 64);
+        assert(frame.alpha_tile_columns == 13 && frame.alpha_tile_rows == 10);
+        assert(tiles.size() == 13 * 10);
+        assert(tiles[0] == WEW_TILE_OPAQUE);
+        assert(tiles[1] == WEW_TILE_MIXED);
+        assert(tiles[2] == WEW_TILE_TRANSPARENT);
+        assert(tiles[13 * 10 - 1] == WEW_TILE_TRANSPARENT);
+    }
+
+    // Only the tiles under the dirty rects are rescanned.
+    view[0] = 0;
+    view[64 * 800 + 64 * 2] = 0xff000000;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(128, 64, 1, 1)}, view.data(), 800, 600);
+    {
+        auto &tiles = context.alpha_tiles.back();
+        assert(tiles[0] == WEW_TILE_OPAQUE);
+        assert(tiles[13 + 2] == WEW_TILE_MIXED);
+    }
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_output_transform()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.output_transform = WEW_TRANSFORM_90;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+    auto host = cef_mock::GetHost(browser);
+
+    std::vector<uint32_t> view(800 * 600);
+    for (size_t i = 0; i < view.size(); i++)
+    {
+        view[i] = static_cast<uint32_t>(i);
+    }
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &frame = context.frames.back();
+        auto pixels = static_cast<const uint32_t *>(frame.buffer);
+        assert(frame.width == 600 && frame.height == 800);
+        assert(pixels[599] == view[0]);
+        assert(pixels[799 * 600] == view[599 * 800 + 799]);
+    }
+
+    // Only the dirty rect is rotated, and the rect with it.
+    view[8 * 800 + 4] = 7;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(4, 8, 16, 16)}, view.data(), 800, 600);
+    {
+        auto &frame = context.frames.back();
+        auto pixels = static_cast<const uint32_t *>(frame.buffer);
+        auto &dirty_rects = context.dirty_rects.back();
+        assert(dirty_rects.size() == 1);
+        assert(dirty_rects[0].x == 576 && dirty_rects[0].y == 4);
+        assert(dirty_rects[0].width == 16 && dirty_rects[0].height == 16);
+        assert(frame.x == 576 && frame.y == 4);
+        assert(pixels[4 * 600 + 591] == 7);
+    }
+
+    // Input arrives in output coordinates.
+    MouseEvent mouse{.x = 590, .y = 10};
+    webview_mouse_click(webview, mouse, WEW_MBT_LEFT, true);
+    assert(host->last_mouse_event.x == 10 && host->last_mouse_event.y == 10);
+
+    webview_mouse_wheel(webview, mouse, 0, -120);
+    assert(host->last_wheel_delta_x == -120 && host->last_wheel_delta_y == 0);
+
+    TouchEvent touch{};
+    touch.x = 100;
+    touch.y = 50;
+    webview_touch(webview, touch);
+    assert(host->last_touch_event.x == 50 && host->last_touch_event.y == 500);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+struct FanoutContext
+{
+    std::vector<Frame> frames;
+    std::vector<std::vector<Rect>> dirty_rects;
+    bool retain = false;
+};
+
+static void on_consumer_frame(const Frame *frame, void *context)
+{
+    auto fanout = static_cast<FanoutContext *>(context);
+    fanout->frames.push_back(*frame);
+    fanout->dirty_rects.emplace_back(frame->dirty_rects, frame->dirty_rects + frame->dirty_rects_count);
+
+    if (fanout->retain)
+    {
+        wew_frame_retain(frame);
+    }
+}
+
+static void test_fanout()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.ignored_events = WEW_EVENT_FRAME;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    FanoutContext every;
+    every.retain = true;
+    FanoutContext limited;
+    limited.retain = true;
+
+    FrameConsumer every_consumer{0, WEW_FRAME_BGRA, on_consumer_frame, &every};
+    FrameConsumer limited_consumer{10, WEW_FRAME_RGBA, on_consumer_frame, &limited};
+    int every_id = webview_subscribe_frames(webview, &every_consumer);
+    int limited_id = webview_subscribe_frames(webview, &limited_consumer);
+    assert(every_id >= 0 && limited_id >= 0 && every_id != limited_id);
+
+    std::vector<uint32_t> view(800 * 600, 0xff102030);
+    for (int i = 0; i < 3; i++)
+    {
+        cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    }
+
+    // The host callback is ignored, consumers still receive frames at their own rate.
+    assert(context.frames.empty());
+    assert(every.frames.size() == 3);
+    assert(limited.frames.size() == 1);
+
+    // Consumers of a format share one snapshot, which is not the view buffer.
+    assert(every.frames[0].buffer != view.data());
+    assert(static_cast<const uint32_t *>(every.frames[0].buffer)[0] == 0xff102030);
+    assert(static_cast<const uint32_t *>(limited.frames[0].buffer)[0] == 0xff302010);
+    assert(every.frames[0].stride == 800 * 4);
+
+    // Retained snapshots stay valid and are accounted until released.
+    MemoryUsage usage;
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] >= 4 * 800 * 600 * 4);
+    for (auto &frame : every.frames)
+    {
+        assert(static_cast<const uint32_t *>(frame.buffer)[0] == 0xff102030);
+        wew_frame_release(&frame);
+    }
+
+    wew_frame_release(&limited.frames[0]);
+    webview_unsubscribe_frames(webview, limited_id);
+
+    // Damage is relative to the previous frame, a consumer that did not get it, like one subscribed since, gets the
+    // whole frame.
+    FanoutContext late;
+    FrameConsumer late_consumer{0, WEW_FRAME_RGBA, on_consumer_frame, &late};
+    int late_id = webview_subscribe_frames(webview, &late_consumer);
+
+    every.dirty_rects.clear();
+    every.retain = false;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    assert(every.dirty_rects.size() == 1 && every.dirty_rects[0].size() == 1);
+    assert(every.dirty_rects[0][0].width == 8);
+    assert(late.dirty_rects.size() == 1 && late.dirty_rects[0].size() == 1);
+    assert(late.dirty_rects[0][0].width == 800 && late.dirty_rects[0][0].height == 600);
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    assert(late.dirty_rects.size() == 2 && late.dirty_rects[1][0].width == 8);
+
+    webview_unsubscribe_frames(webview, every_id);
+    webview_unsubscribe_frames(webview, late_id);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    assert(every.dirty_rects.size() == 2 && late.dirty_rects.size() == 2);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_memory_budgets()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.ignored_events = WEW_EVENT_FRAME;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    FanoutContext fanout;
+    FrameConsumer consumer{0, WEW_FRAME_BGRA, on_consumer_frame, &fanout};
+    int id = webview_subscribe_frames(webview, &consumer);
+
+    std::vector<uint32_t> view(800 * 600, 0xff102030);
+    uint64_t snapshot = 800 * 600 * 4;
+
+    // A snapshot that does not fit the frame budget is dropped instead of allocated.
+    webview_set_memory_budget(webview, WEW_MEMORY_FRAME_BUFFERS, snapshot - 1);
+    auto before = snapshot_metrics();
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    auto after = snapshot_metrics();
+    assert(fanout.frames.empty());
+    assert(find_metric(after, "wew_frames_dropped_total")->count -
+               find_metric(before, "wew_frames_dropped_total")->count ==
+           1);
+
+    MemoryUsage usage;
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] == 0 && usage.evicted == 0);
+
+    // Released snapshots stay idle in the pool, they are the first to go when the webview needs the memory.
+    webview_set_memory_budget(webview, WEW_MEMORY_FRAME_BUFFERS, 0);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    assert(fanout.frames.size() == 1);
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] == snapshot);
+
+    webview_set_memory_budget(webview, WEW_MEMORY_TOTAL, snapshot);
+    RingSettings ring_settings{.name = "budget", .capacity = 100, .direction = WEW_RING_TO_PAGE};
+    void *ring = webview_open_ring(webview, &ring_settings);
+    assert(ring != nullptr);
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] == 0 && usage.evicted == snapshot);
+    assert(usage.bytes[WEW_MEMORY_MESSAGE_QUEUES] > 0 && usage.total <= snapshot);
+
+    // Nothing can be evicted from rings, the charge fails and the ring is not opened.
+    uint64_t rings = usage.bytes[WEW_MEMORY_MESSAGE_QUEUES];
+    webview_set_memory_budget(webview, WEW_MEMORY_MESSAGE_QUEUES, rings);
+    RingSettings other_settings{.name = "over", .capacity = 100, .direction = WEW_RING_TO_PAGE};
+    assert(webview_open_ring(webview, &other_settings) == nullptr);
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_MESSAGE_QUEUES] == rings);
+
+    // Neither can snapshots out with a consumer, frames are dropped while the subsystem stays over budget.
+    webview_set_memory_budget(webview, WEW_MEMORY_TOTAL, 0);
+    fanout.retain = true;
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    assert(fanout.frames.size() == 2);
+
+    webview_set_memory_budget(webview, WEW_MEMORY_FRAME_BUFFERS, snapshot - 1);
+    before = snapshot_metrics();
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    after = snapshot_metrics();
+    assert(fanout.frames.size() == 2);
+    assert(find_metric(after, "wew_frames_dropped_total")->count -
+               find_metric(before, "wew_frames_dropped_total")->count ==
+           1);
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] == snapshot && usage.evicted == snapshot);
+
+    wew_frame_release(&fanout.frames[1]);
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_FRAME_BUFFERS] == snapshot);
+
+    webview_unsubscribe_frames(webview, id);
+    webview_close_ring(webview, ring);
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void test_paint_flashing()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.paint_flashing = true;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+    auto host = cef_mock::GetHost(browser);
+
+    std::vector<uint32_t> view(800 * 600, 0xff808080);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    {
+        auto &frame = context.frames.back();
+        auto pixels = static_cast<const uint32_t *>(frame.buffer);
+        assert(frame.buffer != view.data());
+        assert(frame.damaged_pixels == 800 * 600);
+        assert(pixels[0] >> 24 == 0xff && ((pixels[0] >> 16) & 0xff) > ((pixels[0] >> 8) & 0xff));
+        assert(view[0] == 0xff808080);
+    }
+
+    // The repainted tile gets hotter while the rest fades, and every tile that changed is damage.
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, view.data(), 800, 600);
+    {
+        auto &frame = context.frames.back();
+        auto pixels = static_cast<const uint32_t *>(frame.buffer);
+        assert(frame.damaged_pixels == 64);
+        assert(context.moves.back().empty());
+        assert(context.dirty_rects.back().size() == (600 + 15) / 16);
+        assert(context.dirty_rects.back()[0].width == 800 && context.dirty_rects.back()[0].height == 16);
+        assert(((pixels[0] >> 16) & 0xff) > ((pixels[20 * 800 + 20] >> 16) & 0xff));
+        assert(((pixels[20 * 800 + 20] >> 16) & 0xff) > 0x80);
+    }
+
+    assert(host->GetEventCount(cef_mock::HostEvent::Invalidate) == 2);
+
+    // Turning it off repaints the view, which is delivered untouched again.
+    webview_set_paint_flashing(webview, false);
+    assert(host->GetEventCount(cef_mock::HostEvent::Invalidate) == 3);
+
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    assert(context.frames.back().buffer == view.data());
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+struct EncoderContext
+{
+    std::atomic<int> packets{0};
+    std::atomic<int> keyframes{0};
+};
+
+static void on_packet(const EncodedPacket *packet, void *context)
+{
+    auto encoder = static_cast<EncoderContext *>(context);
+    assert(packet->size > 0);
+
+    encoder->keyframes += packet->keyframe ? 1 : 0;
+    encoder->packets += 1;
+}
+
+static void test_video_encoder()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.ignored_events = WEW_EVENT_FRAME;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    EncoderContext encoder;
+    VideoEncoderSettings encoder_settings{WEW_CODEC_VP8, 1000, 0, on_packet, &encoder};
+
+#ifdef WEW_VPX
+    assert(webview_start_encoder(webview, &encoder_settings));
+
+    std::vector<uint32_t> view(800 * 600, 0xff204060);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    while (encoder.packets < 1)
+    {
+        std::this_thread::yield();
+    }
+
+    assert(encoder.keyframes == 1);
+
+    webview_set_encoder_bitrate(webview, 500);
+    webview_request_keyframe(webview);
+    while (encoder.packets < 2)
+    {
+        std::this_thread::yield();
+    }
+
+    assert(encoder.keyframes == 2);
+
+    webview_stop_encoder(webview);
+#else
+    // Without libvpx there is no codec, the webview keeps working without an encoder.
+    assert(!webview_start_encoder(webview, &encoder_settings));
+    webview_request_keyframe(webview);
+    webview_stop_encoder(webview);
+
+    std::vector<uint32_t> view(800 * 600);
+    cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 800, 600)}, view.data(), 800, 600);
+    assert(encoder.packets == 0);
+#endif
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+struct CursorContext
+{
+    std::vector<CursorType> types;
+    std::vector<uint64_t> hashes;
+};
+
+static void on_cursor_type(CursorType type, void *context)
+{
+    static_cast<CursorContext *>(context)->types.push_back(type);
+}
+
+static void on_cursor_image(const CursorImage *image, void *context)
+{
+    assert(image->width == 2 && image->height == 2 && image->hotspot_x == 1);
+    static_cast<CursorContext *>(context)->hashes.push_back(image->hash);
+}
+
+static void test_cursor_images()
+{
+    CursorContext context;
+    WebViewHandler handler{
+        .on_cursor = on_cursor_type,
+        .on_cursor_image = on_cursor_image,
+        .context = &context,
+    };
+
+    WebViewSettings settings = create_test_settings();
+    void *webview = create_webview(RUNTIME, "wew://localhost/index.html", &settings, handler);
+    cef_mock::Settle();
+    auto browser = cef_mock::GetLastBrowser();
+
+    // Repeats of the current cursor are dropped.
+    cef_mock::ChangeCursor(browser, CT_HAND);
+    cef_mock::ChangeCursor(browser, CT_HAND);
+    cef_mock::ChangeCursor(browser, CT_POINTER);
+    assert(context.types.size() == 2 && context.types[0] == WEW_CT_HAND && context.types[1] == WEW_CT_POINTER);
+
+    uint32_t pixels[4] = {0xff000000, 0xffffffff, 0xffffffff, 0xff000000};
+    CefCursorInfo info;
+    info.buffer = pixels;
+    info.size = CefSize(2, 2);
+    info.hotspot = CefPoint(1, 1);
+
+    cef_mock::ChangeCursor(browser, CT_CUSTOM, info);
+    cef_mock::ChangeCursor(browser, CT_CUSTOM, info);
+    assert(context.hashes.size() == 1);
+
+    // A custom cursor with other pixels is a change, going back to the first one hashes the same as before.
+    uint32_t other[4] = {0xffffffff, 0xff000000, 0xff000000, 0xffffffff};
+    info.buffer = other;
+    cef_mock::ChangeCursor(browser, CT_CUSTOM, info);
+    info.buffer = pixels;
+    cef_mock::ChangeCursor(browser, CT_CUSTOM, info);
+    assert(context.hashes.size() == 3);
+    assert(context.hashes[1] != context.hashes[0] && context.hashes[2] == context.hashes[0]);
+    assert(context.types.size() == 2);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static std::atomic<int> PLUGIN_RELEASED{0};
+
+static bool plugin_sum(const PluginValue *arguments, size_t count, PluginValue *result, void *context)
+{
+    result->type = WEW_VALUE_NUMBER;
+    for (size_t i = 0; i < count; i++)
+    {
+        result->number += arguments[i].number;
+    }
+
+    return true;
+}
+
+static bool plugin_invert(const PluginValue *arguments, size_t count, PluginValue *result, void *context)
+{
+    if (count != 1 || arguments[0].type != WEW_VALUE_BUFFER)
+    {
+        const char *message = "expected an ArrayBuffer";
+        result->type = WEW_VALUE_STRING;
+        result->data = message;
+        result->size = strlen(message);
+        return false;
+    }
+
+    auto bytes = static_cast<uint8_t *>(const_cast<void *>(arguments[0].data));
+    for (size_t i = 0; i < arguments[0].size; i++)
+    {
+        bytes[i] = ~bytes[i];
+    }
+
+    result->type = WEW_VALUE_BUFFER;
+    result->data = new uint8_t[2]{1, 2};
+    result->size = 2;
+    result->release = [](void *data) {
+        delete[] static_cast<uint8_t *>(data);
+        PLUGIN_RELEASED++;
+    };
+
+    return true;
+}
+
+static bool plugin_greet(const PluginValue *arguments, size_t count, PluginValue *result, void *context)
+{
+    result->type = WEW_VALUE_STRING;
+    result->data = new char[5]{'h', 'e', 'l', 'l', 'o'};
+    result->size = 5;
+    result->release = [](void *data) {
+        delete[] static_cast<char *>(data);
+        PLUGIN_RELEASED++;
+    };
+
+    return true;
+}
+
+static void test_renderer_plugins()
+{
+    add_renderer_plugin([](const PluginRegistrar *registrar) {
+        if (registrar->version != WEW_PLUGIN_API_VERSION)
+        {
+            return false;
+        }
+
+        registrar->register_function(registrar->registrar, "sum", plugin_sum, nullptr);
+        registrar->register_function(registrar->registrar, "invert", plugin_invert, nullptr);
+        registrar->register_function(registrar->registrar, "greet", plugin_greet, nullptr);
+        return true;
+    });
+
+    // A plugin that fails its init contributes nothing, not even the functions it registered first.
+    add_renderer_plugin([](const PluginRegistrar *registrar) {
+        registrar->register_function(registrar->registrar, "broken", plugin_sum, nullptr);
+        return false;
+    });
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::atomic<bool> ran{false};
+    cef_mock::RunInRenderer(browser, [&](CefRefPtr<CefV8Context> v8) {
+        auto plugins = v8->GetGlobal()->GetValue("NativePlugins");
+        assert(plugins->IsObject());
+        assert(!plugins->HasValue("broken"));
+
+        auto sum = plugins->GetValue("sum")->ExecuteFunction(
+            nullptr, {CefV8Value::CreateInt(1), CefV8Value::CreateDouble(2.5)});
+        assert(sum != nullptr && sum->GetDoubleValue() == 3.5);
+
+        // ArrayBuffers are passed without a copy, a returned buffer with a release callback is adopted.
+        uint8_t bytes[2] = {0x0f, 0xf0};
+        auto buffer = CefV8Value::CreateArrayBuffer(bytes, sizeof(bytes), nullptr);
+        auto inverted = plugins->GetValue("invert")->ExecuteFunction(nullptr, {buffer});
+        assert(bytes[0] == 0xf0 && bytes[1] == 0x0f);
+        assert(inverted != nullptr && inverted->IsArrayBuffer() && inverted->GetArrayBufferByteLength() == 2);
+        assert(static_cast<uint8_t *>(inverted->GetArrayBufferData())[1] == 2);
+
+        inverted = nullptr;
+        assert(PLUGIN_RELEASED == 1);
+
+        // A returned string is copied and released right away.
+        auto greeting = plugins->GetValue("greet")->ExecuteFunction(nullptr, {});
+        assert(greeting != nullptr && greeting->GetStringValue().ToString() == "hello");
+        assert(PLUGIN_RELEASED == 2);
+
+        // A failed call throws, unsupported arguments never reach the plugin.
+        assert(plugins->GetValue("invert")->ExecuteFunction(nullptr, {CefV8Value::CreateInt(1)}) == nullptr);
+        assert(plugins->GetValue("sum")->ExecuteFunction(nullptr, {plugins}) == nullptr);
+
+        ran = true;
+    });
+
+    cef_mock::Settle();
+    assert(ran);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+static void on_ring_ready(void *context)
+{
+    static_cast<std::atomic<int> *>(context)->fetch_add(1);
+}
+
+static void test_shared_rings()
+{
+    WebViewContext context;
+    WebViewHandler handler{.context = &context};
+    WebViewSettings settings = create_test_settings();
+    void *webview = create_webview(RUNTIME, "wew://localhost/index.html", &settings, handler);
+
+    // Opened before the renderer exists, the page context asks for it once created.
+    RingSettings to_page{.name = "telemetry", .capacity = 100, .direction = WEW_RING_TO_PAGE};
+    void *telemetry = webview_open_ring(webview, &to_page);
+    assert(telemetry != nullptr);
+
+    cef_mock::Settle();
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<std::string> received;
+    std::atomic<int> wakeups{0};
+    CefRefPtr<CefV8Value> drain;
+    cef_mock::RunInRenderer(browser, [&](CefRefPtr<CefV8Context> v8) {
+        auto ring = v8->GetGlobal()->GetValue("SharedRings")->GetValue("telemetry");
+        assert(ring->IsObject() && ring->GetValue("capacity")->GetIntValue() == 4096);
+        assert(ring->GetValue("buffer")->GetArrayBufferByteLength() == WEW_RING_HEADER_SIZE + 4096);
+
+        auto read = ring->GetValue("read");
+        drain = cef_mock::CreateFunction("drain", [&, read](const CefV8ValueList &arguments) {
+            wakeups++;
+            for (auto record = read->ExecuteFunction(nullptr, {}); !record->IsNull();
+                 record = read->ExecuteFunction(nullptr, {}))
+            {
+                auto data = static_cast<const char *>(record->GetArrayBufferData());
+                received.emplace_back(data, record->GetArrayBufferByteLength());
+            }
+
+            return CefV8Value::CreateUndefined();
+        });
+
+        ring->GetValue("on")->ExecuteFunction(nullptr, {drain});
+    });
+
+    cef_mock::Settle();
+
+    // Records written while the page is not waiting cost no message, the page picks them up on its own.
+    assert(wew_ring_write(telemetry, "a", 1));
+    assert(wew_ring_write(telemetry, "bc", 2));
+    cef_mock::Settle();
+    assert(wakeups == 0);
+
+    cef_mock::RunInRenderer(browser, [&](CefRefPtr<CefV8Context> v8) { drain->ExecuteFunction(nullptr, {}); });
+    cef_mock::Settle();
+    assert(received.size() == 2 && received[0] == "a" && received[1] == "bc");
+
+    // The page found the ring empty, the next record wakes it.
+    assert(wew_ring_write(telemetry, "def", 3));
+    cef_mock::Settle();
+    assert(wakeups == 2 && received.size() == 3 && received[2] == "def");
+
+    // Records wrap around the end of the ring, a record larger than the ring is refused.
+    std::string record(197, 'x');
+    for (int round = 0; round < 30; round++)
+    {
+        record[0] = static_cast<char>('A' + round);
+        assert(wew_ring_write(telemetry, record.data(), static_cast<uint32_t>(record.size())));
+        cef_mock::Settle();
+    }
+
+    assert(wakeups == 32 && received.size() == 33 && received.back() == record);
+    std::vector<char> oversized(4096);
+    assert(!wew_ring_write(telemetry, oversized.data(), static_cast<uint32_t>(oversized.size())));
+
+    std::atomic<int> ready{0};
+    RingSettings from_page{
+        .name = "input",
+        .capacity = 4096,
+        .direction = WEW_RING_FROM_PAGE,
+        .on_ready = on_ring_ready,
+        .context = &ready,
+    };
+
+    void *input = webview_open_ring(webview, &from_page);
+    assert(input != nullptr);
+    cef_mock::Settle();
+
+    char buffer[8];
+    assert(wew_ring_read(input, buffer, sizeof(buffer)) == -1);
+
+    cef_mock::RunInRenderer(browser, [](CefRefPtr<CefV8Context> v8) {
+        auto write = v8->GetGlobal()->GetValue("SharedRings")->GetValue("input")->GetValue("write");
+        char bytes[] = "0123456789";
+        assert(write->ExecuteFunction(nullptr, {CefV8Value::CreateString("hello")})->GetBoolValue());
+        assert(write->ExecuteFunction(nullptr, {CefV8Value::CreateArrayBufferWithCopy(bytes, 10)})->GetBoolValue());
+        assert(write->ExecuteFunction(nullptr, {CefV8Value::CreateInt(1)}) == nullptr);
+    });
+
+    cef_mock::Settle();
+    assert(ready == 1);
+
+    // A record larger than the buffer stays in the ring.
+    assert(wew_ring_read(input, buffer, sizeof(buffer)) == 5 && memcmp(buffer, "hello", 5) == 0);
+    assert(wew_ring_read(input, buffer, sizeof(buffer)) == 10);
+    char large[16];
+    assert(wew_ring_read(input, large, sizeof(large)) == 10 && memcmp(large, "0123456789", 10) == 0);
+    assert(wew_ring_read(input, buffer, sizeof(buffer)) == -1);
+
+    // Each ring only goes one way.
+    assert(!wew_ring_write(input, "x", 1));
+    assert(wew_ring_read(telemetry, buffer, sizeof(buffer)) == -1);
+
+    MemoryUsage usage;
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_MESSAGE_QUEUES] == 2 * (WEW_RING_HEADER_SIZE + 4096));
+
+    // Rings outlive navigations, a closed ring leaves the page.
+    webview_close_ring(webview, telemetry);
+    browser->GetMainFrame()->LoadURL("wew://localhost/index.html");
+    cef_mock::Settle();
+
+    webview_get_memory_usage(webview, &usage);
+    assert(usage.bytes[WEW_MEMORY_MESSAGE_QUEUES] == WEW_RING_HEADER_SIZE + 4096);
+
+    std::atomic<bool> ran{false};
+    cef_mock::RunInRenderer(browser, [&](CefRefPtr<CefV8Context> v8) {
+        auto rings = v8->GetGlobal()->GetValue("SharedRings");
+        assert(!rings->HasValue("telemetry") && rings->HasValue("input"));
+        ran = true;
+    });
+
+    cef_mock::Settle();
+    assert(ran);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+#ifndef WIN32
+// A keep-alive HTTP/1.1 server on API_SOCKET: /echo describes the request, /stream sends a chunked body, /close
+// ends the body with the connection, /hold answers once released and /drop closes the connection without an answer.
+struct ApiServer
+{
+    int fd = -1;
+    std::thread thread;
+    std::atomic<int> connections{0};
+    std::atomic<int> drops{0};
+    std::mutex mutex;
+    std::vector<int> clients;
+    std::vector<std::thread> workers;
+    std::condition_variable condvar;
+    int held = 0;
+    int peak_held = 0;
+    bool released = false;
+
+    void Start()
+    {
+        unlink(API_SOCKET.c_str());
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        strcpy(address.sun_path, API_SOCKET.c_str());
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert(bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+        assert(listen(fd, 8) == 0);
+
+        thread = std::thread([this]() {
+            int client;
+            while ((client = accept(fd, nullptr, nullptr)) >= 0)
+            {
+                connections++;
+                std::lock_guard<std::mutex> lock(mutex);
+                clients.push_back(client);
+                workers.emplace_back([this, client]() { Serve(client); });
+            }
+        });
+    }
+
+    void Stop()
+    {
+        shutdown(fd, SHUT_RDWR);
+        close(fd);
+        thread.join();
+        unlink(API_SOCKET.c_str());
+
+        // The idle connections in the pool see the server go away.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int client : clients)
+            {
+                shutdown(client, SHUT_RDWR);
+            }
+        }
+
+        // The server goes away with the test, its client threads must not outlive it.
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void WaitHeld(int count)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condvar.wait(lock, [&]() { return held >= count; });
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        condvar.notify_all();
+    }
+
+    void Disconnect(int client)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        clients.erase(std::find(clients.begin(), clients.end(), client));
+        close(client);
+    }
+
+    void Serve(int client)
+    {
+        std::string buffer;
+        char chunk[4096];
+        while (true)
+        {
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos)
+            {
+                ssize_t size = recv(client, chunk, sizeof(chunk), 0);
+                if (size <= 0)
+                {
+                    Disconnect(client);
+                    return;
+                }
+
+                buffer.append(chunk, size);
+            }
+
+            std::string head = buffer.substr(0, end);
+            buffer.erase(0, end + 4);
+
+            auto header = [&head](const char *name) {
+                size_t start = head.find(std::string("\r\n") + name + ": ");
+                if (start == std::string::npos)
+                {
+                    return std::string();
+                }
+
+                start = head.find(": ", start) + 2;
+                return head.substr(start, head.find("\r\n", start) - start);
+            };
+
+            size_t length = atoi(header("Content-Length").c_str());
+            while (buffer.size() < length)
+            {
+                ssize_t size = recv(client, chunk, sizeof(chunk), 0);
+                assert(size > 0);
+                buffer.append(chunk, size);
+            }
+
+            std::string body = buffer.substr(0, length);
+            buffer.erase(0, length);
+
+            std::string line = head.substr(0, head.find("\r\n"));
+            std::string target = line.substr(line.find(' ') + 1, line.rfind(' ') - line.find(' ') - 1);
+
+            if (target.rfind("/drop", 0) == 0)
+            {
+                drops++;
+                Disconnect(client);
+                return;
+            }
+
+            std::string response;
+            if (target.rfind("/stream", 0) == 0)
+            {
+                response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nTransfer-Encoding: chunked\r\n\r\n";
+                for (size_t size : {5, 70000, 3})
+                {
+                    char hex[16];
+                    snprintf(hex, sizeof(hex), "%zx\r\n", size);
+                    response += hex + std::string(size, 'a' + size % 26) + "\r\n";
+                }
+
+                response += "0\r\n\r\n";
+            }
+            else if (target.rfind("/close", 0) == 0)
+            {
+                response = "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\nbye";
+            }
+            else if (target.rfind("/hold", 0) == 0)
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                held++;
+                peak_held = std::max(peak_held, held);
+                condvar.notify_all();
+                condvar.wait(lock, [this]() { return released; });
+                held--;
+
+                response = "HTTP/1.1 200 OK\r\nContent-Length: 4\r\n\r\nheld";
+            }
+            else
+            {
+                std::string text = line.substr(0, line.find(' ')) + " " + target + " " + header("Host") + " " +
+                                   header("X-Token") + " " + (header("Keep-Alive").empty() ? "" : "hop ") + body;
+                response = "HTTP/1.1 201 Created\r\nContent-Type: application/json; charset=utf-8\r\nX-Api: "
+                           "yes\r\nContent-Length: " +
+                           std::to_string(text.size()) + "\r\n\r\n" + text;
+            }
+
+            send(client, response.data(), response.size(), MSG_NOSIGNAL);
+            if (target.rfind("/close", 0) == 0)
+            {
+                Disconnect(client);
+                return;
+            }
+        }
+    }
+};
+
+static void test_api_proxy()
+{
+    ApiServer server;
+    server.Start();
+
+    auto request = cef_mock::CreateRequest("app-api://backend/echo?x=1#fragment", "POST");
+    request->SetHeaderMap({{"X-Token", "abc"}, {"Keep-Alive", "timeout=5"}});
+
+    auto element = CefPostDataElement::Create();
+    element->SetToBytes(5, "hello");
+    auto post_data = CefPostData::Create();
+    post_data->AddElement(element);
+    request->SetPostData(post_data);
+
+    // Path, query, method, host, headers and body reach the server, hop-by-hop headers do not.
+    auto metrics = snapshot_metrics();
+    auto resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, request), request, 7);
+    auto after = snapshot_metrics();
+    assert(resource.handled && resource.status == 201 && resource.status_text == "Created");
+    assert(resource.mime_type == "application/json");
+    assert(resource.body == "POST /echo?x=1 backend abc hello");
+    assert(resource.content_length == static_cast<int64_t>(resource.body.size()));
+
+    auto header = resource.headers.find("X-Api");
+    assert(header != resource.headers.end() && header->second == "yes");
+
+    // Proxied requests have their own counter, they are no request handler factory handlers.
+    assert(find_metric(after, "wew_api_requests_total")->count -
+               find_metric(metrics, "wew_api_requests_total")->count ==
+           1);
+    assert(find_metric(after, "wew_resource_handlers_total")->count ==
+           find_metric(metrics, "wew_resource_handlers_total")->count);
+
+    // Requests in sequence share one keep-alive connection.
+    for (int i = 0; i < 3; i++)
+    {
+        auto get = cef_mock::CreateRequest("app-api://backend/echo");
+        resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, get), get);
+        assert(resource.body == "GET /echo backend  ");
+    }
+
+    assert(server.connections == 1);
+
+    // Chunked bodies are streamed through reads smaller than a chunk.
+    auto stream = cef_mock::CreateRequest("app-api://backend/stream");
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, stream), stream, 4096);
+    assert(resource.status == 200 && resource.content_length == -1);
+    assert(resource.body == std::string(5, 'f') + std::string(70000, 'a' + 70000 % 26) + std::string(3, 'd'));
+    assert(server.connections == 1);
+
+    // A body that ends with the connection does not leave it in the pool.
+    auto bye = cef_mock::CreateRequest("app-api://backend/close");
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, bye), bye);
+    assert(resource.body == "bye");
+
+    auto get = cef_mock::CreateRequest("app-api://backend/echo");
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, get), get);
+    assert(resource.status == 201 && server.connections == 2);
+
+    // A connection dropped after the request went out is retried for idempotent requests only, the server may have
+    // acted on it.
+    auto drop = cef_mock::CreateRequest("app-api://backend/drop", "POST");
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, drop), drop);
+    assert(!resource.handled && server.drops == 1);
+
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, get), get);
+    assert(resource.status == 201);
+
+    drop = cef_mock::CreateRequest("app-api://backend/drop");
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, drop), drop);
+    assert(!resource.handled && server.drops == 3);
+
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, get), get);
+    assert(resource.status == 201);
+    int before = server.connections;
+
+    // Past the 16 connections in use at once, requests wait for one to be handed back instead of opening more.
+    const int active = 16;
+    std::vector<std::thread> holds;
+    std::atomic<int> loaded{0};
+    for (int i = 0; i < active + 4; i++)
+    {
+        holds.emplace_back([&loaded]() {
+            auto hold = cef_mock::CreateRequest("app-api://backend/hold");
+            auto resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, hold), hold);
+            assert(resource.body == "held");
+            loaded++;
+        });
+    }
+
+    server.WaitHeld(active);
+    server.Release();
+    for (auto &hold : holds)
+    {
+        hold.join();
+    }
+
+    // The first one reused the idle connection.
+    assert(loaded == active + 4);
+    assert(server.peak_held == active && server.connections <= before + active - 1);
+
+    server.Stop();
+
+    // Without the server the request fails, the page sees a network error.
+    resource = cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, get), get);
+    assert(!resource.handled);
+}
+#endif
+
+static void on_bus_message(const char *channel, const char *message, void *context)
+{
+    static_cast<std::vector<std::string> *>(context)->push_back(std::string(channel) + ":" + message);
+}
+
+static void test_message_bus()
+{
+    WebViewSettings settings = create_test_settings();
+    settings.message_bus = true;
+
+    WebViewContext panel_context, first_context, second_context, outsider_context;
+    void *panel = create_test_webview(&panel_context, settings);
+    auto panel_browser = cef_mock::GetLastBrowser();
+    void *first = create_test_webview(&first_context, settings);
+    auto first_browser = cef_mock::GetLastBrowser();
+    void *second = create_test_webview(&second_context, settings);
+    auto second_browser = cef_mock::GetLastBrowser();
+    void *outsider = create_test_webview(&outsider_context);
+    auto outsider_browser = cef_mock::GetLastBrowser();
+
+    std::vector<std::string> panel_received, first_received, second_received, observed;
+    auto subscribe = [](CefRefPtr<CefBrowser> browser, const char *channel, std::vector<std::string> *received) {
+        cef_mock::RunInRenderer(browser, [=](CefRefPtr<CefV8Context> v8) {
+            auto callback = cef_mock::CreateFunction("callback", [=](const CefV8ValueList &arguments) {
+                received->push_back(arguments[1]->GetStringValue().ToString() + ":" +
+                                    arguments[0]->GetStringValue().ToString());
+                return CefV8Value::CreateUndefined();
+            });
+
+            auto bus = v8->GetGlobal()->GetValue("MessageBus");
+            bus->GetValue("subscribe")->ExecuteFunction(nullptr, {CefV8Value::CreateString(channel), callback});
+        });
+    };
+
+    auto publish = [](CefRefPtr<CefBrowser> browser, const char *channel, const char *message) {
+        cef_mock::RunInRenderer(browser, [=](CefRefPtr<CefV8Context> v8) {
+            auto bus = v8->GetGlobal()->GetValue("MessageBus");
+            bus->GetValue("publish")->ExecuteFunction(
+                nullptr, {CefV8Value::CreateString(channel), CefV8Value::CreateString(message)});
+        });
+    };
+
+    subscribe(first_browser, "display", &first_received);
+    subscribe(second_browser, "display", &second_received);
+    subscribe(second_browser, "audio", &second_received);
+    subscribe(panel_browser, "display", &panel_received);
+    cef_mock::Settle();
+
+    // The publisher does not get its own message, the other subscribers get it without the host.
+    BusObserver observer{.on_message = on_bus_message, .context = &observed};
+    int id = wew_bus_observe("display", &observer);
+    publish(panel_browser, "display", "show");
+    publish(first_browser, "audio", "mute");
+    cef_mock::Settle();
+
+    assert(panel_received.empty());
+    assert(first_received.size() == 1 && first_received[0] == "display:show");
+    assert(second_received.size() == 2 && second_received[0] == "display:show" && second_received[1] == "audio:mute");
+    assert(observed.size() == 1 && observed[0] == "display:show");
+    assert(panel_context.messages.empty() && first_context.messages.empty() && second_context.messages.empty());
+
+    // A webview that is not on the bus has no MessageBus, and the browser ignores bus messages its renderer forges.
+    bool has_bus = true;
+    cef_mock::RunInRenderer(outsider_browser, [&](CefRefPtr<CefV8Context> v8) {
+        has_bus = v8->GetGlobal()->HasValue("MessageBus");
+
+        auto subscribe = CefProcessMessage::Create("BUS_SUBSCRIBE");
+        subscribe->GetArgumentList()->SetString(0, "display");
+        v8->GetFrame()->SendProcessMessage(PID_BROWSER, subscribe);
+
+        auto message = CefProcessMessage::Create("BUS_MESSAGE");
+        message->GetArgumentList()->SetString(0, "display");
+        message->GetArgumentList()->SetString(1, "forged");
+        v8->GetFrame()->SendProcessMessage(PID_BROWSER, message);
+    });
+
+    cef_mock::Settle();
+    assert(!has_bus);
+    assert(first_received.size() == 1 && observed.size() == 1);
+
+    // The host publishes too, an unobserved channel never reaches it.
+    wew_bus_unobserve(id);
+    cef_mock::RunInRenderer(second_browser, [](CefRefPtr<CefV8Context> v8) {
+        auto bus = v8->GetGlobal()->GetValue("MessageBus");
+        bus->GetValue("unsubscribe")->ExecuteFunction(nullptr, {CefV8Value::CreateString("display")});
+    });
+
+    cef_mock::Settle();
+    wew_bus_publish("display", "hide");
+    cef_mock::Settle();
+
+    assert(first_received.size() == 2 && first_received[1] == "display:hide");
+    assert(second_received.size() == 2 && observed.size() == 1);
+
+    // Subscriptions belong to the page, and to the webview.
+    first_browser->GetMainFrame()->LoadURL("wew://localhost/index.html");
+    close_webview(second);
+    cef_mock::Settle();
+
+    publish(panel_browser, "display", "dim");
+    wew_bus_publish("audio", "unmute");
+    cef_mock::Settle();
+
+    assert(first_received.size() == 2 && second_received.size() == 2);
+    assert(panel_received.size() == 1 && panel_received[0] == "display:hide");
+
+    close_webview(first);
+    close_webview(panel);
+    close_webview(outsider);
+    cef_mock::Settle();
+}
+
+static void on_blob_release(const void *data, void *context)
+{
+    (*static_cast<int *>(context))++;
+}
+
+static void test_register_blob()
+{
+    static const std::string BLOB = "0123456789abcdef";
+    int released = 0;
+
+    wew_register_blob("wew://localhost/blob.bin#ignored", BLOB.data(), BLOB.size(), "application/octet-stream",
+                      on_blob_release, &released);
+
+    auto load = [](const char *range) {
+        auto request = cef_mock::CreateRequest("wew://localhost/blob.bin");
+        if (range != nullptr)
+        {
+            request->SetHeaderMap({{"Range", range}});
+        }
+
+        return cef_mock::LoadResource(cef_mock::CreateSchemeHandler(nullptr, request), request, 5);
+    };
+
+    // Served without the factory, the host's resource is never created.
+    RESOURCE_CONTEXT.destroyed = 0;
+    auto before = snapshot_metrics();
+    auto resource = load(nullptr);
+    auto after = snapshot_metrics();
+    assert(resource.handled && resource.status == 200);
+    assert(resource.mime_type == "application/octet-stream");
+    assert(resource.content_length == static_cast<int64_t>(BLOB.size()) && resource.body == BLOB);
+    assert(resource.headers.find("Accept-Ranges")->second == "bytes");
+    assert(RESOURCE_CONTEXT.destroyed == 0);
+    assert(find_metric(after, "wew_blob_requests_total")->count -
+               find_metric(before, "wew_blob_requests_total")->count ==
+           1);
+    assert(find_metric(after, "wew_resource_handlers_total")->count ==
+           find_metric(before, "wew_resource_handlers_total")->count);
+
+    resource = load("bytes=2-5");
+    assert(resource.status == 206 && resource.body == "2345");
+    assert(resource.headers.find("Content-Range")->second == "bytes 2-5/16");
+
+    resource = load("bytes=-3");
+    assert(resource.status == 206 && resource.body == "def");
+
+    resource = load("bytes=10-");
+    assert(resource.status == 206 && resource.body == "abcdef");
+
+    resource = load("bytes=16-");
+    assert(resource.status == 416 && resource.body.empty());
+    assert(resource.headers.find("Content-Range")->second == "bytes */16");
+
+    // A request in progress keeps the memory until it is done.
+    auto request = cef_mock::CreateRequest("wew://localhost/blob.bin");
+    auto handler = cef_mock::CreateSchemeHandler(nullptr, request);
+    assert(wew_unregister_blob("wew://localhost/blob.bin"));
+    assert(!wew_unregister_blob("wew://localhost/blob.bin"));
+    assert(released == 0);
+
+    resource = cef_mock::LoadResource(handler, request, 16);
+    assert(resource.body == BLOB);
+    handler = nullptr;
+    assert(released == 1);
+
+    auto missing = cef_mock::CreateRequest("wew://localhost/blob.bin");
+    assert(cef_mock::CreateSchemeHandler(nullptr, missing) == nullptr);
+
+    // Replacing a blob releases the previous one, webviews serve blobs through their request handlers too.
+    wew_register_blob("wew://localhost/index.html", BLOB.data(), 4, "text/plain", on_blob_release, &released);
+    wew_register_blob("wew://localhost/index.html", BLOB.data() + 4, 4, "text/plain", on_blob_release, &released);
+    assert(released == 2);
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context);
+    auto browser = cef_mock::GetLastBrowser();
+
+    request = cef_mock::CreateRequest("wew://localhost/index.html");
+    resource = cef_mock::LoadResource(cef_mock::CreateResourceHandler(browser, request), request);
+    assert(resource.handled && resource.body == "4567");
+
+    assert(wew_unregister_blob("wew://localhost/index.html"));
+    assert(released == 3);
+
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+struct PriorityContext
+{
+    std::mutex mutex;
+    std::condition_variable condvar;
+    bool blocked = false;
+    bool released = false;
+    std::vector<ResourceType> opened;
+    std::vector<std::thread::id> canceled;
+};
+
+static PriorityContext PRIORITY_CONTEXT;
+
+// Requests of other resources hold the request thread until released.
+static bool priority_open(void *context)
+{
+    auto type = static_cast<ResourceType>(reinterpret_cast<intptr_t>(context));
+
+    std::unique_lock<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+    if (type == WEW_RESOURCE_OTHER)
+    {
+        PRIORITY_CONTEXT.blocked = true;
+        PRIORITY_CONTEXT.condvar.notify_all();
+        PRIORITY_CONTEXT.condvar.wait(lock, [] { return PRIORITY_CONTEXT.released; });
+        PRIORITY_CONTEXT.blocked = PRIORITY_CONTEXT.released = false;
+    }
+    else
+    {
+        PRIORITY_CONTEXT.opened.push_back(type);
+        PRIORITY_CONTEXT.condvar.notify_all();
+    }
+
+    return true;
+}
+
+static void priority_cancel(void *context)
+{
+    std::lock_guard<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+    PRIORITY_CONTEXT.canceled.push_back(std::this_thread::get_id());
+    PRIORITY_CONTEXT.condvar.notify_all();
+}
+
+static RequestHandler *priority_request(Request *request, void *context)
+{
+    return new RequestHandler{
+        .open = priority_open,
+        .cancel = priority_cancel,
+        .destroy = resource_cancel,
+        .context = reinterpret_cast<void *>(static_cast<intptr_t>(request->resource_type)),
+    };
+}
+
+struct OpenCallback : public CefCallback
+{
+    void Continue() override
+    {
+    }
+
+    void Cancel() override
+    {
+    }
+
+    IMPLEMENT_REFCOUNTING(OpenCallback);
+};
+
+static void test_request_priority()
+{
+    RequestHandlerFactory factory{
+        .request = priority_request,
+        .destroy_request_handler = destroy_request_handler,
+        .context = nullptr,
+    };
+
+    auto settings = create_test_settings();
+    settings.request_handler_factory = &factory;
+
+    WebViewContext context;
+    void *webview = create_test_webview(&context, settings);
+    auto browser = cef_mock::GetLastBrowser();
+
+    std::vector<CefRefPtr<CefResourceHandler>> handlers;
+    auto open = [&](cef_resource_type_t type) {
+        auto request = cef_mock::CreateRequest("wew://localhost/" + std::to_string(type));
+        request->SetResourceType(type);
+
+        bool handle_request = true;
+        auto handler = cef_mock::CreateResourceHandler(browser, request);
+        assert(handler->Open(request, handle_request, new OpenCallback()) && !handle_request);
+        handlers.push_back(handler);
+    };
+
+    auto wait = [](std::function<bool()> done) {
+        std::unique_lock<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+        PRIORITY_CONTEXT.condvar.wait(lock, done);
+    };
+
+    auto release = []() {
+        std::lock_guard<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+        PRIORITY_CONTEXT.released = true;
+        PRIORITY_CONTEXT.condvar.notify_all();
+    };
+
+    // Render blocking resources first, in the order they were requested, images and media last.
+    open(RT_PING);
+    wait([] { return PRIORITY_CONTEXT.blocked; });
+    for (auto type : {RT_IMAGE, RT_MEDIA, RT_FONT_RESOURCE, RT_SCRIPT, RT_FAVICON, RT_XHR, RT_STYLESHEET, RT_SUB_FRAME})
+    {
+        open(type);
+    }
+
+    release();
+    wait([] { return PRIORITY_CONTEXT.opened.size() == 8; });
+
+    std::vector<ResourceType> expected = {WEW_RESOURCE_SCRIPT,
+                                          WEW_RESOURCE_STYLESHEET,
+                                          WEW_RESOURCE_DOCUMENT,
+                                          WEW_RESOURCE_FONT,
+                                          WEW_RESOURCE_FETCH,
+                                          WEW_RESOURCE_IMAGE,
+                                          WEW_RESOURCE_MEDIA,
+                                          WEW_RESOURCE_IMAGE};
+    assert(PRIORITY_CONTEXT.opened == expected);
+
+    // An image that waited too long goes ahead of the scripts requested after it.
+    PRIORITY_CONTEXT.opened.clear();
+    open(RT_PING);
+    wait([] { return PRIORITY_CONTEXT.blocked; });
+    open(RT_IMAGE);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    open(RT_SCRIPT);
+    open(RT_SCRIPT);
+
+    release();
+    wait([] { return PRIORITY_CONTEXT.opened.size() == 3; });
+
+    expected = {WEW_RESOURCE_IMAGE, WEW_RESOURCE_SCRIPT, WEW_RESOURCE_SCRIPT};
+    assert(PRIORITY_CONTEXT.opened == expected);
+
+    // A cancel does not wait for the call in progress, the handler hears of it on the request thread once it returned.
+    PRIORITY_CONTEXT.opened.clear();
+    open(RT_PING);
+    wait([] { return PRIORITY_CONTEXT.blocked; });
+    handlers.back()->Cancel();
+    {
+        std::lock_guard<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+        assert(PRIORITY_CONTEXT.canceled.empty());
+    }
+
+    // A request still waiting is canceled right away and never opened.
+    open(RT_SCRIPT);
+    handlers.back()->Cancel();
+    {
+        std::lock_guard<std::mutex> lock(PRIORITY_CONTEXT.mutex);
+        assert(PRIORITY_CONTEXT.canceled.size() == 1);
+        assert(PRIORITY_CONTEXT.canceled[0] == std::this_thread::get_id());
+    }
+
+    release();
+    wait([] { return PRIORITY_CONTEXT.canceled.size() == 2; });
+    assert(PRIORITY_CONTEXT.canceled[1] != std::this_thread::get_id());
+
+    open(RT_STYLESHEET);
+    wait([] { return PRIORITY_CONTEXT.opened.size() == 1; });
+    assert(PRIORITY_CONTEXT.opened[0] == WEW_RESOURCE_STYLESHEET);
+
+    handlers.clear();
+    close_webview(webview);
+    cef_mock::Settle();
+}
+
+#ifdef LINUX
+struct DirectoryContext
+{
+    std::mutex mutex;
+    std::condition_variable condvar;
+    std::vector<std::string> changes;
+};
+
+static void on_directory_change(const char *path, void *context)
+{
+    auto directory = static_cast<DirectoryContext *>(context);
+
+    std::lock_guard<std::mutex> lock(directory->mutex);
+    directory->changes.push_back(path);
+    directory->condvar.notify_all();
+}
+
+static void write_file(const std::string &path, const char *content)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    assert(file != nullptr);
+    fputs(content, file);
+    fclose(file);
+}
+
+static void test_directory_watcher()
+{
+    char root[] = "/tmp/wew-tests-XXXXXX";
+    assert(mkdtemp(root) != nullptr);
+    std::string dir = root;
+    assert(mkdir((dir + "/css").c_str(), 0755) == 0);
+
+    DirectoryContext context;
+    DirectoryObserver observer{.on_change = on_directory_change, .context = &context};
+    assert(wew_watch_directory((dir + "/missing").c_str(), &observer) == -1);
+
+    int id = wew_watch_directory(dir.c_str(), &observer);
+    assert(id >= 0);
+
+    // Waits for the path to be reported, the changes reported before are dropped.
+    auto changed = [&](const std::string &path) {
+        std::unique_lock<std::mutex> lock(context.mutex);
+        bool found = context.condvar.wait_for(lock, std::chrono::seconds(5), [&]() {
+            return std::find(context.changes.begin(), context.changes.end(), path) != context.changes.end();
+        });
+
+        context.changes.clear();
+        return found;
+    };
+
+    write_file(dir + "/index.html", "<html></html>");
+    assert(changed("index.html"));
+
+    write_file(dir + "/css/app.css", "body {}");
+    assert(changed("css/app.css"));
+
+    // Directories created while watching are watched too.
+    assert(mkdir((dir + "/fonts").c_str(), 0755) == 0);
+    assert(changed("fonts"));
+    write_file(dir + "/fonts/a.woff", "woff");
+    assert(changed("fonts/a.woff"));
+
+    assert(rename((dir + "/css/app.css").c_str(), (dir + "/css/site.css").c_str()) == 0);
+    assert(changed("css/site.css"));
+    assert(unlink((dir + "/index.html").c_str()) == 0);
+    assert(changed("index.html"));
+
+    wew_unwatch_directory(id);
+    write_file(dir + "/css/site.css", "body { margin: 0 }");
+    assert(context.changes.empty());
+
+    unlink((dir + "/css/site.css").c_str());
+    unlink((dir + "/fonts/a.woff").c_str());
+    rmdir((dir + "/css").c_str());
+    rmdir((dir + "/fonts").c_str());
+    rmdir(dir.c_str());
+}
+#endif
+
+struct CppObserver
+{
+    std::vector<Frame> frames;
+    std::vector<std::string> messages;
+
+    void on_frame(const Frame &frame)
+    {
+        frames.push_back(frame);
+    }
+
+    void on_message(std::string_view message)
+    {
+        messages.emplace_back(message);
+    }
+};
+
+struct CppResource
+{
+    std::string body;
+    size_t cursor = 0;
+
+    bool read(uint8_t *buffer, size_t size, int &cursor)
+    {
+        size_t count = std::min(size, body.size() - this->cursor);
+        memcpy(buffer, body.data() + this->cursor, count);
+        this->cursor += count;
+        cursor = static_cast<int>(count);
+        return count > 0;
+    }
+
+    void get_response(Response &response)
+    {
+        response.status_code = 200;
+        response.content_length = body.size();
+        strcpy(response.mime_type, "text/plain");
+    }
+};
+
+struct CppResourceFactory
+{
+    std::unique_ptr<CppResource> request(const Request &request)
+    {
+        return std::make_unique<CppResource>(CppResource{"cpp"});
+    }
+};
+
+static void test_cpp_api()
+{
+    CppObserver observer;
+
+    // Only the implemented methods are dispatched, the rest are never called.
+    WebViewHandler table = wew::make_webview_handler(observer);
+    assert(table.on_frame != nullptr && table.on_message != nullptr);
+    assert(table.on_cursor == nullptr && table.on_state_change == nullptr && table.on_title_change == nullptr);
+    assert(table.context == &observer);
+
+    CppResourceFactory resources;
+    RequestHandlerFactory factory = wew::make_request_handler_factory(resources);
+
+    WebViewSettings settings{};
+    settings.width = 800;
+    settings.height = 600;
+    settings.device_scale_factor = 1.0;
+    settings.javascript = true;
+    settings.windowless_frame_rate = 30;
+    settings.request_handler_factory = &factory;
+
+    {
+        wew::WebView<CppObserver> webview(RUNTIME, "wew://localhost/index.html", settings, observer);
+        assert(webview);
+        cef_mock::Settle();
+
+        auto browser = cef_mock::GetLastBrowser();
+
+        std::vector<uint8_t> buffer(800 * 600 * 4);
+        cef_mock::Paint(browser, PET_VIEW, {CefRect(0, 0, 8, 8)}, buffer.data(), 800, 600);
+        assert(observer.frames.size() == 1);
+        assert(observer.frames[0].buffer == buffer.data());
+
+        webview.send_message(std::string("ping"));
+        cef_mock::Settle();
+        assert(observer.messages.size() == 1);
+        assert(observer.messages[0] == "ping");
+
+        auto request = cef_mock::CreateRequest("wew://localhost/data.txt");
+        auto resource = cef_mock::LoadResource(cef_mock::CreateResourceHandler(browser, request), request);
+        assert(resource.handled);
+        assert(resource.mime_type == "text/plain");
+        assert(resource.body == "cpp");
+    }
+
+    cef_mock::Settle();
+}
+
+int main()
+{
+    printf("Running wew cxx tests...\n");
+
+    test_runtime_initialize();
+    test_post_task_with_main_thread();
+    test_webview_lifecycle();
+    test_input_forwarding();
+    test_on_frame();
+    test_message_transport();
+    test_custom_scheme();
+    test_request_handler();
+    test_cookies();
+    test_metrics();
+    test_slow_callback();
+    test_trace();
+    test_memory_usage();
+    test_ignored_events();
+    test_frame_buffers();
+    test_motion_detection();
+    test_alpha_tiles();
+    test_output_transform();
+    test_fanout();
+    test_memory_budgets();
+    test_paint_flashing();
+    test_video_encoder();
+    test_cursor_images();
+    test_renderer_plugins();
+    test_shared_rings();
+    test_message_bus();
+    test_register_blob();
+    test_request_priority();
+#ifndef WIN32
+    test_api_proxy();
+#endif
+#ifdef LINUX
+    test_directory_watcher();
+#endif
+    test_cpp_api();
+
+    close_runtime(RUNTIME);
+
+    printf("All tests passed!\n");
+    return 0;
+}
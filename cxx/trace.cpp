@@ -0,0 +1,100 @@
+//
+//  trace.cpp
+//  webview
+//
+//  Library level spans written as Chrome trace events, only compiled in with WEW_TRACING
+//
+
+#include "trace.h"
+
+#ifdef WEW_TRACING
+
+#include <stdio.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Buffers outlive their threads so that spans of exited threads can still be flushed, a drained buffer of an
+// exited thread is reused by the next thread, which keeps the set bounded by the number of live threads.
+static std::mutex BUFFERS_MUTEX;
+static std::vector<std::unique_ptr<ITraceBuffer>> BUFFERS;
+
+// Serializes flushes, each buffer allows a single reader.
+static std::mutex FLUSH_MUTEX;
+
+ITraceBuffer *ITrace::Register()
+{
+    std::lock_guard<std::mutex> lock(BUFFERS_MUTEX);
+
+    for (auto &it : BUFFERS)
+    {
+        if (it->retired && it->Drained())
+        {
+            it->retired = false;
+            return it.get();
+        }
+    }
+
+    BUFFERS.push_back(std::make_unique<ITraceBuffer>(static_cast<uint32_t>(BUFFERS.size() + 1)));
+    return BUFFERS.back().get();
+}
+
+void ITrace::Release(ITraceBuffer *buffer)
+{
+    std::lock_guard<std::mutex> lock(BUFFERS_MUTEX);
+
+    buffer->retired = true;
+}
+
+bool ITrace::Flush(const char *path)
+{
+    std::lock_guard<std::mutex> flush_lock(FLUSH_MUTEX);
+
+    std::vector<ITraceBuffer *> buffers;
+    {
+        std::lock_guard<std::mutex> lock(BUFFERS_MUTEX);
+        for (auto &it : BUFFERS)
+        {
+            buffers.push_back(it.get());
+        }
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"wew\"}}");
+
+    for (auto buffer : buffers)
+    {
+        buffer->Drain([&](const ITraceEvent &event) {
+            fprintf(file,
+                    ",\n{\"name\":\"%s\",\"cat\":\"wew\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.name,
+                    buffer->tid,
+                    event.start / 1000.0,
+                    event.duration / 1000.0);
+        });
+
+        uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            fprintf(file,
+                    ",\n{\"name\":\"dropped\",\"cat\":\"wew\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+                    "\"args\":{\"events\":%llu}}",
+                    buffer->tid,
+                    ITrace::Now() / 1000.0,
+                    static_cast<unsigned long long>(dropped));
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0;
+}
+
+#endif
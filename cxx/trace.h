@@ -0,0 +1,164 @@
+//
+//  trace.h
+//  webview
+//
+//  Library level spans written as Chrome trace events, only compiled in with WEW_TRACING
+//
+
+#ifndef trace_h
+#define trace_h
+#pragma once
+
+#ifdef WEW_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+struct ITraceEvent
+{
+    ///
+    /// Statically allocated span name.
+    ///
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+};
+
+///
+/// Single producer, single consumer ring of finished spans. The owning thread is the only writer, a flush is the
+/// only reader, so neither side takes a lock.
+///
+class ITraceBuffer
+{
+  public:
+    static const size_t CAPACITY = 16384;
+
+    ITraceBuffer(uint32_t tid) : tid(tid)
+    {
+    }
+
+    void Push(const char *name, uint64_t start, uint64_t duration)
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        _events[head % CAPACITY] = {name, start, duration};
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    template <typename F> void Drain(F &&func)
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_acquire);
+        for (; tail != head; tail++)
+        {
+            func(_events[tail % CAPACITY]);
+        }
+
+        _tail.store(tail, std::memory_order_release);
+    }
+
+    ///
+    /// Whether a flush has taken every span written so far.
+    ///
+    bool Drained()
+    {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire) &&
+               dropped.load(std::memory_order_relaxed) == 0;
+    }
+
+    const uint32_t tid;
+
+    ///
+    /// Set once the owning thread exits, the buffer and its tid lane go to a new thread after its spans are flushed.
+    ///
+    bool retired = false;
+    std::atomic<uint64_t> dropped{0};
+
+  private:
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+    ITraceEvent _events[CAPACITY];
+};
+
+class ITrace
+{
+  public:
+    static uint64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static ITraceBuffer &GetBuffer()
+    {
+        static thread_local ITraceLease lease;
+
+        return *lease.buffer;
+    }
+
+    ///
+    /// Drains the buffers of all threads into a Chrome trace event JSON file, which Perfetto opens as well.
+    ///
+    static bool Flush(const char *path);
+
+  private:
+    ///
+    /// Holds the calling thread's buffer and gives it back when the thread exits.
+    ///
+    struct ITraceLease
+    {
+        ITraceLease() : buffer(Register())
+        {
+        }
+
+        ~ITraceLease()
+        {
+            Release(buffer);
+        }
+
+        ITraceBuffer *buffer;
+    };
+
+    static ITraceBuffer *Register();
+    static void Release(ITraceBuffer *buffer);
+};
+
+class ITraceSpan
+{
+  public:
+    ITraceSpan(const char *name) : _name(name), _start(ITrace::Now())
+    {
+    }
+
+    ~ITraceSpan()
+    {
+        ITrace::GetBuffer().Push(_name, _start, ITrace::Now() - _start);
+    }
+
+  private:
+    const char *_name;
+    uint64_t _start;
+};
+
+#define TRACE_SPAN_CONCAT_INNER(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_INNER(a, b)
+
+///
+/// Records a span from here to the end of the enclosing scope.
+///
+#define TRACE_SPAN(name) ITraceSpan TRACE_SPAN_CONCAT(_trace_span_, __LINE__)(name)
+
+#else
+
+#define TRACE_SPAN(name)
+
+#endif
+
+#endif /* trace_h */
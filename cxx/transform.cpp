@@ -0,0 +1,153 @@
+//
+//  transform.cpp
+//  webview
+//
+//  Rotated and mirrored output of windowless frames, and the matching input mapping
+//
+
+#include "transform.h"
+
+#include <algorithm>
+
+IFrameTransform::IFrameTransform(FrameTransform transform) : _transform(transform)
+{
+}
+
+bool IFrameTransform::IsIdentity() const
+{
+    return _transform == WEW_TRANSFORM_NORMAL;
+}
+
+void IFrameTransform::GetSize(int width, int height, int &output_width, int &output_height) const
+{
+    bool swap = (_transform & 1) != 0;
+    output_width = swap ? height : width;
+    output_height = swap ? width : height;
+}
+
+IFrameTransform::Affine IFrameTransform::GetAffine(int width, int height, bool pixels) const
+{
+    // The far edge is the last pixel for pixel indices and the border itself for continuous coordinates.
+    int right = pixels ? width - 1 : width;
+    int bottom = pixels ? height - 1 : height;
+
+    // Mirroring happens before the rotation, x1 = mx * x + m0.
+    bool flipped = _transform >= WEW_TRANSFORM_FLIPPED;
+    int mx = flipped ? -1 : 1;
+    int m0 = flipped ? right : 0;
+
+    switch (_transform & 3)
+    {
+    case 1: // 90 degrees clockwise, u = bottom - y, v = x1
+        return {0, -1, bottom, mx, 0, m0};
+    case 2: // 180 degrees, u = right - x1, v = bottom - y
+        return {-mx, 0, right - m0, 0, -1, bottom};
+    case 3: // 270 degrees clockwise, u = y, v = right - x1
+        return {0, 1, 0, -mx, 0, right - m0};
+    default:
+        return {mx, 0, m0, 0, 1, 0};
+    }
+}
+
+CefRect IFrameTransform::MapRect(const CefRect &rect, int width, int height, bool pixels) const
+{
+    auto affine = GetAffine(width, height, pixels);
+
+    int edge = pixels ? 1 : 0;
+    int x[2] = {rect.x, rect.x + rect.width - edge};
+    int y[2] = {rect.y, rect.y + rect.height - edge};
+
+    int u[2] = {affine.ux * x[0] + affine.uy * y[0] + affine.u0, affine.ux * x[1] + affine.uy * y[1] + affine.u0};
+    int v[2] = {affine.vx * x[0] + affine.vy * y[0] + affine.v0, affine.vx * x[1] + affine.vy * y[1] + affine.v0};
+
+    int left = std::min(u[0], u[1]);
+    int top = std::min(v[0], v[1]);
+
+    return CefRect(left, top, std::max(u[0], u[1]) - left + edge, std::max(v[0], v[1]) - top + edge);
+}
+
+void IFrameTransform::UnmapPoint(float &x, float &y, int width, int height) const
+{
+    auto affine = GetAffine(width, height, false);
+
+    // The inverse of an orthogonal matrix is its transpose.
+    float u = x - affine.u0;
+    float v = y - affine.v0;
+    x = affine.ux * u + affine.vx * v;
+    y = affine.uy * u + affine.vy * v;
+}
+
+void IFrameTransform::UnmapVector(int &x, int &y) const
+{
+    auto affine = GetAffine(0, 0, false);
+
+    int u = x;
+    int v = y;
+    x = affine.ux * u + affine.vx * v;
+    y = affine.uy * u + affine.vy * v;
+}
+
+const void *IFrameTransform::Apply(const CefRenderHandler::RectList &dirty_rects,
+                                   const void *buffer,
+                                   int width,
+                                   int height,
+                                   CefRenderHandler::RectList &output_rects)
+{
+    int output_width;
+    int output_height;
+    GetSize(width, height, output_width, output_height);
+
+    // A new size invalidates the whole output.
+    CefRenderHandler::RectList everything = {CefRect(0, 0, width, height)};
+    const CefRenderHandler::RectList *rects = &dirty_rects;
+    if (width != _width || height != _height)
+    {
+        _width = width;
+        _height = height;
+        _output.resize(static_cast<size_t>(width) * height);
+        rects = &everything;
+    }
+
+    auto affine = GetAffine(width, height, true);
+    ptrdiff_t step_x = static_cast<ptrdiff_t>(affine.vx) * output_width + affine.ux;
+    ptrdiff_t step_y = static_cast<ptrdiff_t>(affine.vy) * output_width + affine.uy;
+    ptrdiff_t origin = static_cast<ptrdiff_t>(affine.v0) * output_width + affine.u0;
+
+    auto src = static_cast<const uint32_t *>(buffer);
+    auto dst = _output.data();
+
+    output_rects.clear();
+    for (auto &rect : *rects)
+    {
+        int left = std::max(rect.x, 0);
+        int top = std::max(rect.y, 0);
+        int right = std::min(rect.x + rect.width, width);
+        int bottom = std::min(rect.y + rect.height, height);
+        if (right <= left || bottom <= top)
+        {
+            continue;
+        }
+
+        for (int by = top; by < bottom; by += BLOCK)
+        {
+            for (int bx = left; bx < right; bx += BLOCK)
+            {
+                int block_right = std::min(bx + BLOCK, right);
+                int block_bottom = std::min(by + BLOCK, bottom);
+                for (int y = by; y < block_bottom; y++)
+                {
+                    const uint32_t *row = src + static_cast<size_t>(y) * width;
+                    uint32_t *out = dst + origin + y * step_y;
+                    for (int x = bx; x < block_right; x++)
+                    {
+                        out[x * step_x] = row[x];
+                    }
+                }
+            }
+        }
+
+        output_rects.push_back(MapRect(CefRect(left, top, right - left, bottom - top), width, height));
+    }
+
+    return _output.data();
+}
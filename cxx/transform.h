@@ -0,0 +1,86 @@
+//
+//  transform.h
+//  webview
+//
+//  Rotated and mirrored output of windowless frames, and the matching input mapping
+//
+
+#ifndef transform_h
+#define transform_h
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "include/cef_client.h"
+
+#include "wew.h"
+
+///
+/// Applies a FrameTransform to frames, rects and points. The output buffer is kept between paints, so only the dirty
+/// rects are transformed into it.
+///
+class IFrameTransform
+{
+  public:
+    IFrameTransform(FrameTransform transform);
+
+    bool IsIdentity() const;
+
+    ///
+    /// Size of the output of a width x height frame.
+    ///
+    void GetSize(int width, int height, int &output_width, int &output_height) const;
+
+    ///
+    /// Maps a rect of a width x height frame to output coordinates, pixels when pixels is true, otherwise continuous
+    /// coordinates such as DIPs.
+    ///
+    CefRect MapRect(const CefRect &rect, int width, int height, bool pixels = true) const;
+
+    ///
+    /// Maps a point in output coordinates back to the width x height view, the inverse of MapRect for continuous
+    /// coordinates.
+    ///
+    void UnmapPoint(float &x, float &y, int width, int height) const;
+
+    ///
+    /// Maps a vector such as a wheel delta back to the view.
+    ///
+    void UnmapVector(int &x, int &y) const;
+
+    ///
+    /// Transforms the dirty rects of a frame into the output buffer, which is returned. The rects in output
+    /// coordinates are written to output_rects.
+    ///
+    const void *Apply(const CefRenderHandler::RectList &dirty_rects,
+                      const void *buffer,
+                      int width,
+                      int height,
+                      CefRenderHandler::RectList &output_rects);
+
+  private:
+    ///
+    /// Edge of the square blocks the pixels are moved in, a block of source rows and its destination columns both
+    /// stay in L1.
+    ///
+    static const int BLOCK = 32;
+
+    ///
+    /// u = ux * x + uy * y + u0 and v = vx * x + vy * y + v0, the 2x2 part is orthogonal.
+    ///
+    struct Affine
+    {
+        int ux, uy, u0;
+        int vx, vy, v0;
+    };
+
+    Affine GetAffine(int width, int height, bool pixels) const;
+
+    FrameTransform _transform;
+    int _width = 0;
+    int _height = 0;
+    std::vector<uint32_t> _output;
+};
+
+#endif /* transform_h */
@@ -9,8 +9,13 @@
 #define util_h
 #pragma once
 
+#include <chrono>
+
 #include "include/cef_app.h"
 
+#include "metrics.h"
+#include "watchdog.h"
+
 // clang-format off
 #define IMPLEMENT_RUNNING \
   private: \
@@ -38,18 +43,22 @@ class ITask : public CefTask
     ITask(ITaskCallback callback, void *context) 
         : _callback(callback)
         , _context(context)
+        , _posted(std::chrono::steady_clock::now())
     {
     }
     // clang-format on
 
     void Execute() override
     {
-        _callback(_context);
+        IMetrics::Observe(MetricHistogram::TaskQueueDuration, IMetrics::Elapsed(_posted));
+
+        IWatchdog::Call(HostCallback::Task, _callback, _context);
     }
 
   private:
     ITaskCallback _callback = nullptr;
     void *_context = nullptr;
+    std::chrono::steady_clock::time_point _posted;
 
     IMPLEMENT_REFCOUNTING(ITask);
 };
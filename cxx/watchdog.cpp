@@ -0,0 +1,84 @@
+//
+//  watchdog.cpp
+//  webview
+//
+//  Times every host callback and reports the ones that block a CEF thread for too long
+//
+
+#include "watchdog.h"
+
+static const char *NAMES[] = {
+    "on_context_initialized",
+    "on_schedule_message_pump_work",
+    "on_cursor",
+    "on_cursor_image",
+    "on_state_change",
+    "on_ime_rect",
+    "on_frame",
+    "frame_consumer.on_frame",
+    "video_encoder.on_packet",
+    "on_title_change",
+    "on_fullscreen_change",
+    "on_message",
+    "ring.on_ready",
+    "bus.on_message",
+    "blob.release",
+    "directory.on_change",
+    "request_handler_factory.request",
+    "request_handler_factory.destroy_request_handler",
+    "request_handler.open",
+    "request_handler.get_response",
+    "request_handler.skip",
+    "request_handler.read",
+    "request_handler.cancel",
+    "request_handler.destroy",
+    "cookie_visitor.visit",
+    "cookie_visitor.destroy",
+    "task",
+};
+
+static_assert(sizeof(NAMES) / sizeof(const char *) == static_cast<size_t>(HostCallback::Count));
+
+std::atomic<uint64_t> IWatchdog::_threshold{UINT64_MAX};
+
+std::mutex IWatchdog::_mutex;
+
+SlowCallbackHandler IWatchdog::_handler = {};
+
+void IWatchdog::SetHandler(const SlowCallbackHandler *handler)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (handler == nullptr || handler->on_slow_callback == nullptr)
+    {
+        _handler = {};
+        _threshold.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+    else
+    {
+        _handler = *handler;
+        _threshold.store(handler->threshold_ns, std::memory_order_relaxed);
+    }
+}
+
+const char *IWatchdog::GetName(HostCallback callback)
+{
+    return NAMES[static_cast<size_t>(callback)];
+}
+
+void IWatchdog::Report(HostCallback callback, uint64_t duration)
+{
+    SlowCallbackHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        handler = _handler;
+    }
+
+    // The handler may have been removed after the threshold was read.
+    if (handler.on_slow_callback == nullptr || duration < handler.threshold_ns)
+    {
+        return;
+    }
+
+    handler.on_slow_callback(GetName(callback), duration, handler.context);
+}
@@ -0,0 +1,79 @@
+//
+//  watchdog.h
+//  webview
+//
+//  Times every host callback and reports the ones that block a CEF thread for too long
+//
+
+#ifndef watchdog_h
+#define watchdog_h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "metrics.h"
+#include "wew.h"
+
+class IWatchdog
+{
+  public:
+    ///
+    /// Calls a host callback, records its duration and reports it when it exceeds the slow callback threshold.
+    ///
+    /// A null callback is one the host did not implement, it is skipped and yields a value initialized result.
+    ///
+    template <typename R, typename... Params, typename... Args>
+    static R Call(HostCallback callback, R (*func)(Params...), Args &&...args)
+    {
+        if (func == nullptr)
+        {
+            return R();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        if constexpr (std::is_void_v<R>)
+        {
+            func(std::forward<Args>(args)...);
+            Record(callback, start);
+        }
+        else
+        {
+            R result = func(std::forward<Args>(args)...);
+            Record(callback, start);
+
+            return result;
+        }
+    }
+
+    ///
+    /// Replaces the slow callback handler, nullptr disables the reports.
+    ///
+    static void SetHandler(const SlowCallbackHandler *handler);
+
+    static const char *GetName(HostCallback callback);
+
+  private:
+    static std::atomic<uint64_t> _threshold;
+    static std::mutex _mutex;
+    static SlowCallbackHandler _handler;
+
+    static void Record(HostCallback callback, std::chrono::steady_clock::time_point start)
+    {
+        uint64_t duration = IMetrics::Elapsed(start);
+        IMetrics::Observe(callback, duration);
+
+        if (duration >= _threshold.load(std::memory_order_relaxed))
+        {
+            Report(callback, duration);
+        }
+    }
+
+    static void Report(HostCallback callback, uint64_t duration);
+};
+
+#endif /* watchdog_h */
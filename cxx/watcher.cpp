@@ -0,0 +1,276 @@
+//
+//  watcher.cpp
+//  webview
+//
+//  Changes under a served directory, reported to the host as they happen
+//
+
+#include "watcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef LINUX
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "watchdog.h"
+
+namespace
+{
+    struct WatcherState
+    {
+        std::mutex mutex;
+        std::map<int, std::unique_ptr<IDirectoryWatcher>> watchers;
+        int next_id = 0;
+    };
+
+    WatcherState &GetState()
+    {
+        static WatcherState state;
+        return state;
+    }
+
+#ifdef LINUX
+    // Written files are reported once closed, not on every write.
+    const uint32_t EVENTS = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    std::string Join(const std::string &directory, const std::string &name)
+    {
+        return directory.empty() ? name : name.empty() ? directory : directory + "/" + name;
+    }
+#endif
+} // namespace
+
+int IDirectoryWatcher::Watch(const std::string &path, const DirectoryObserver *observer)
+{
+    auto watcher = std::make_unique<IDirectoryWatcher>(path, *observer);
+    if (!watcher->Start())
+    {
+        return -1;
+    }
+
+    auto &state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    int id = state.next_id++;
+    state.watchers[id] = std::move(watcher);
+
+    return id;
+}
+
+void IDirectoryWatcher::Unwatch(int id)
+{
+    auto &state = GetState();
+
+    // Stopped outside the lock, the observer may watch another directory from its callback meanwhile.
+    std::unique_ptr<IDirectoryWatcher> watcher;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        auto it = state.watchers.find(id);
+        if (it == state.watchers.end())
+        {
+            return;
+        }
+
+        watcher = std::move(it->second);
+        state.watchers.erase(it);
+    }
+}
+
+// clang-format off
+IDirectoryWatcher::IDirectoryWatcher(std::string root, DirectoryObserver observer)
+    : _root(std::move(root))
+    , _observer(observer)
+{
+    while (_root.size() > 1 && _root.back() == '/')
+    {
+        _root.pop_back();
+    }
+}
+// clang-format on
+
+#ifdef LINUX
+
+IDirectoryWatcher::~IDirectoryWatcher()
+{
+    if (_thread.joinable())
+    {
+        // Closing the write end wakes the thread up.
+        close(_wake[1]);
+        _wake[1] = -1;
+        _thread.join();
+    }
+
+    for (int fd : {_fd, _wake[0], _wake[1]})
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool IDirectoryWatcher::Start()
+{
+    _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_fd < 0 || pipe2(_wake, O_CLOEXEC) != 0)
+    {
+        return false;
+    }
+
+    AddTree("");
+    if (_directories.empty())
+    {
+        return false;
+    }
+
+    _thread = std::thread([this]() { Run(); });
+    return true;
+}
+
+void IDirectoryWatcher::Run()
+{
+    pollfd fds[2] = {{_fd, POLLIN, 0}, {_wake[0], POLLIN, 0}};
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true)
+    {
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return;
+        }
+
+        if (fds[1].revents != 0)
+        {
+            return;
+        }
+
+        ssize_t size = read(_fd, buffer, sizeof(buffer));
+        if (size <= 0)
+        {
+            continue;
+        }
+
+        // A file saved by an editor comes as several events, it is reported once per read.
+        std::vector<std::string> changes;
+        for (char *ptr = buffer; ptr < buffer + size;)
+        {
+            auto event = reinterpret_cast<inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            std::string path;
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were dropped, anything may have changed.
+                path = "";
+            }
+            else if (event->mask & IN_IGNORED)
+            {
+                _directories.erase(event->wd);
+                continue;
+            }
+            else
+            {
+                auto it = _directories.find(event->wd);
+                if (it == _directories.end())
+                {
+                    continue;
+                }
+
+                path = Join(it->second, event->len > 0 ? std::string(event->name) : "");
+                if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                {
+                    AddTree(path);
+                }
+            }
+
+            if (std::find(changes.begin(), changes.end(), path) == changes.end())
+            {
+                changes.push_back(path);
+            }
+        }
+
+        for (auto &path : changes)
+        {
+            IWatchdog::Call(HostCallback::OnDirectoryChange, _observer.on_change, path.c_str(), _observer.context);
+        }
+    }
+}
+
+void IDirectoryWatcher::AddTree(const std::string &relative)
+{
+    std::string path = Join(_root, relative);
+
+    int wd = inotify_add_watch(_fd, path.c_str(), EVENTS | IN_ONLYDIR);
+    if (wd < 0)
+    {
+        return;
+    }
+
+    _directories[wd] = relative;
+
+    DIR *dir = opendir(path.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+
+    while (auto entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..")
+        {
+            continue;
+        }
+
+        bool directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN)
+        {
+            struct stat info;
+            directory = lstat(Join(path, name).c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+        }
+
+        if (directory)
+        {
+            AddTree(Join(relative, name));
+        }
+    }
+
+    closedir(dir);
+}
+
+#else
+
+IDirectoryWatcher::~IDirectoryWatcher()
+{
+}
+
+bool IDirectoryWatcher::Start()
+{
+    return false;
+}
+
+void IDirectoryWatcher::Run()
+{
+}
+
+void IDirectoryWatcher::AddTree(const std::string &relative)
+{
+}
+
+#endif
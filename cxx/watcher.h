@@ -0,0 +1,58 @@
+//
+//  watcher.h
+//  webview
+//
+//  Changes under a served directory, reported to the host as they happen
+//
+
+#ifndef watcher_h
+#define watcher_h
+#pragma once
+
+#include <map>
+#include <string>
+#include <thread>
+
+#include "wew.h"
+
+///
+/// Watches a directory and its subdirectories with inotify on its own thread. Only supported on Linux.
+///
+class IDirectoryWatcher
+{
+  public:
+    ///
+    /// Returns the id of the watch, -1 when the directory cannot be watched.
+    ///
+    static int Watch(const std::string &path, const DirectoryObserver *observer);
+
+    ///
+    /// Stops the watch, the observer is not called anymore once this returns.
+    ///
+    static void Unwatch(int id);
+
+    IDirectoryWatcher(std::string root, DirectoryObserver observer);
+    ~IDirectoryWatcher();
+
+  private:
+    std::string _root;
+    DirectoryObserver _observer;
+    int _fd = -1;
+    int _wake[2] = {-1, -1};
+    std::thread _thread;
+
+    ///
+    /// Watched directories by watch descriptor, relative to the root. Only used on the watcher's thread once started.
+    ///
+    std::map<int, std::string> _directories;
+
+    bool Start();
+    void Run();
+
+    ///
+    /// Watches a directory and, recursively, the directories in it.
+    ///
+    void AddTree(const std::string &relative);
+};
+
+#endif /* watcher_h */
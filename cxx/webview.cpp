@@ -7,6 +7,10 @@
 
 #include "webview.h"
 
+#include <string.h>
+
+#include "bus.h"
+
 /* CefContextMenuHandler */
 
 void IWebViewContextMenu::OnBeforeContextMenu(CefRefPtr<CefBrowser> browser,
@@ -39,12 +43,13 @@ IWebViewLoad::IWebViewLoad(WebViewHandler &handler) : _handler(handler)
 
 void IWebViewLoad::OnLoadStart(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, TransitionType transition_type)
 {
-    _handler.on_state_change(WebViewState::WEW_BEFORE_LOAD, _handler.context);
+    IWatchdog::Call(
+        HostCallback::OnStateChange, _handler.on_state_change, WebViewState::WEW_BEFORE_LOAD, _handler.context);
 }
 
 void IWebViewLoad::OnLoadEnd(CefRefPtr<CefBrowser> browser, CefRefPtr<CefFrame> frame, int httpStatusCode)
 {
-    _handler.on_state_change(WebViewState::WEW_LOADED, _handler.context);
+    IWatchdog::Call(HostCallback::OnStateChange, _handler.on_state_change, WebViewState::WEW_LOADED, _handler.context);
     browser->GetHost()->SetFocus(true);
 }
 
@@ -54,7 +59,8 @@ void IWebViewLoad::OnLoadError(CefRefPtr<CefBrowser> browser,
                                const CefString &error_text,
                                const CefString &failed_url)
 {
-    _handler.on_state_change(WebViewState::WEW_LOAD_ERROR, _handler.context);
+    IWatchdog::Call(
+        HostCallback::OnStateChange, _handler.on_state_change, WebViewState::WEW_LOAD_ERROR, _handler.context);
 }
 
 /* CefLifeSpanHandler */
@@ -76,7 +82,8 @@ void IWebViewLifeSpan::OnAfterCreated(CefRefPtr<CefBrowser> browser)
 
 bool IWebViewLifeSpan::DoClose(CefRefPtr<CefBrowser> browser)
 {
-    _handler.on_state_change(WebViewState::WEW_REQUEST_CLOSE, _handler.context);
+    IWatchdog::Call(
+        HostCallback::OnStateChange, _handler.on_state_change, WebViewState::WEW_REQUEST_CLOSE, _handler.context);
 
     return false;
 }
@@ -104,7 +111,7 @@ void IWebViewLifeSpan::OnBeforeClose(CefRefPtr<CefBrowser> browser)
 {
     _browser = std::nullopt;
 
-    _handler.on_state_change(WebViewState::WEW_CLOSE, _handler.context);
+    IWatchdog::Call(HostCallback::OnStateChange, _handler.on_state_change, WebViewState::WEW_CLOSE, _handler.context);
 }
 
 /* CefDragHandler */
@@ -118,19 +125,57 @@ bool IWebViewDrag::OnDragEnter(CefRefPtr<CefBrowser> browser,
 
 /* CefDisplayHandler */
 
+static const uint64_t CURSOR_HASH_PRIME = 0x100000001b3;
+
+static uint64_t HashCursor(const CefCursorInfo &info)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    auto mix = [&](uint64_t value) { hash = (hash ^ value) * CURSOR_HASH_PRIME; };
+
+    uint32_t scale;
+    memcpy(&scale, &info.image_scale_factor, sizeof(scale));
+
+    mix(static_cast<uint32_t>(info.size.width));
+    mix(static_cast<uint32_t>(info.size.height));
+    mix(static_cast<uint32_t>(info.hotspot.x));
+    mix(static_cast<uint32_t>(info.hotspot.y));
+    mix(scale);
+
+    // Cursors are at most a few thousand pixels, two pixels per step is plenty.
+    auto pixels = static_cast<const uint32_t *>(info.buffer);
+    size_t count = static_cast<size_t>(info.size.width) * info.size.height;
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+    {
+        mix(pixels[i] | (static_cast<uint64_t>(pixels[i + 1]) << 32));
+    }
+
+    if (i < count)
+    {
+        mix(pixels[i]);
+    }
+
+    return hash;
+}
+
 IWebViewDisplay::IWebViewDisplay(WebViewHandler &handler) : _handler(handler)
 {
 }
 
 void IWebViewDisplay::OnTitleChange(CefRefPtr<CefBrowser> browser, const CefString &title)
 {
+    if (_handler.on_title_change == nullptr)
+    {
+        return;
+    }
+
     std::string value = title.ToString();
-    _handler.on_title_change(value.c_str(), _handler.context);
+    IWatchdog::Call(HostCallback::OnTitleChange, _handler.on_title_change, value.c_str(), _handler.context);
 };
 
 void IWebViewDisplay::OnFullscreenModeChange(CefRefPtr<CefBrowser> browser, bool fullscreen)
 {
-    _handler.on_fullscreen_change(fullscreen, _handler.context);
+    IWatchdog::Call(HostCallback::OnFullscreenChange, _handler.on_fullscreen_change, fullscreen, _handler.context);
 };
 
 bool IWebViewDisplay::OnCursorChange(CefRefPtr<CefBrowser> browser,
@@ -138,7 +183,43 @@ bool IWebViewDisplay::OnCursorChange(CefRefPtr<CefBrowser> browser,
                                      cef_cursor_type_t type,
                                      const CefCursorInfo &custom_cursor_info)
 {
-    _handler.on_cursor(static_cast<CursorType>(static_cast<int>(type)), _handler.context);
+    bool custom = type == CT_CUSTOM && _handler.on_cursor_image != nullptr && custom_cursor_info.buffer != nullptr &&
+                  custom_cursor_info.size.width > 0 && custom_cursor_info.size.height > 0;
+    if (_handler.on_cursor == nullptr && !custom)
+    {
+        return true;
+    }
+
+    // Pages that set the cursor on every mouse move report the same one over and over.
+    uint64_t hash = custom ? HashCursor(custom_cursor_info) : 0;
+    if (static_cast<int>(type) == _cursor_type && hash == _cursor_hash)
+    {
+        return true;
+    }
+
+    _cursor_type = static_cast<int>(type);
+    _cursor_hash = hash;
+
+    if (custom)
+    {
+        CursorImage image;
+        image.buffer = custom_cursor_info.buffer;
+        image.width = custom_cursor_info.size.width;
+        image.height = custom_cursor_info.size.height;
+        image.hotspot_x = custom_cursor_info.hotspot.x;
+        image.hotspot_y = custom_cursor_info.hotspot.y;
+        image.scale = custom_cursor_info.image_scale_factor;
+        image.hash = hash;
+
+        IWatchdog::Call(HostCallback::OnCursorImage, _handler.on_cursor_image, &image, _handler.context);
+    }
+    else
+    {
+        IWatchdog::Call(HostCallback::OnCursor,
+                        _handler.on_cursor,
+                        static_cast<CursorType>(static_cast<int>(type)),
+                        _handler.context);
+    }
 
     return true;
 }
@@ -146,14 +227,25 @@ bool IWebViewDisplay::OnCursorChange(CefRefPtr<CefBrowser> browser,
 /* CefRenderHandler */
 
 // clang-format off
-IWebViewRender::IWebViewRender(const WebViewSettings *settings, WebViewHandler &handler)
+IWebViewRender::IWebViewRender(const WebViewSettings *settings, WebViewHandler &handler, IMemoryAccount &memory)
     : _handler(handler)
     , _device_scale_factor(settings->device_scale_factor)
+    , _motion_detection(settings->motion_detection)
+    , _transform(settings->output_transform)
+    , _popup_transform(settings->output_transform)
+    , _fanout(&memory)
+    , _paint_flashing_enabled(settings->paint_flashing)
+    , _memory(memory)
 {
     assert(settings != nullptr);
 
     _view_rect.width = settings->width;
     _view_rect.height = settings->height;
+
+    if (settings->alpha_tile_size > 0)
+    {
+        _alpha_tiles.emplace(settings->alpha_tile_size);
+    }
 }
 // clang-format on
 
@@ -168,12 +260,12 @@ void IWebViewRender::OnImeCompositionRangeChanged(CefRefPtr<CefBrowser> browser,
                                                   const CefRange &selected_range,
                                                   const RectList &character_bounds)
 {
-    if (character_bounds.size() == 0)
+    if (_handler.on_ime_rect == nullptr || character_bounds.size() == 0)
     {
         return;
     }
 
-    auto first_rect = character_bounds[0];
+    auto first_rect = _transform.MapRect(character_bounds[0], _view_rect.width, _view_rect.height, false);
 
     Rect rect;
     rect.x = first_rect.x;
@@ -181,7 +273,7 @@ void IWebViewRender::OnImeCompositionRangeChanged(CefRefPtr<CefBrowser> browser,
     rect.width = first_rect.width;
     rect.height = first_rect.height;
 
-    _handler.on_ime_rect(rect, _handler.context);
+    IWatchdog::Call(HostCallback::OnImeRect, _handler.on_ime_rect, rect, _handler.context);
 }
 
 void IWebViewRender::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect &rect)
@@ -199,22 +291,181 @@ void IWebViewRender::OnPaint(CefRefPtr<CefBrowser> browser,
                              int width,
                              int height)
 {
+    TRACE_SPAN("IWebViewRender::OnPaint");
+
     if (buffer == nullptr)
     {
         return;
     }
 
+    uint64_t dirty_pixels = 0;
+    for (auto &it : dirtyRects)
+    {
+        dirty_pixels += static_cast<uint64_t>(it.width) * it.height;
+    }
+
+    IMetrics::Add(MetricCounter::Frames);
+    IMetrics::Add(MetricCounter::FrameBytes, static_cast<uint64_t>(width) * height * 4);
+    IMetrics::Observe(MetricHistogram::FrameDirtyPixels, dirty_pixels);
+
+    bool is_popup = type == PaintElementType::PET_POPUP;
+    bool has_consumers = !is_popup && _fanout.HasConsumers();
+    bool has_encoder = !is_popup && _encoding.load(std::memory_order_relaxed);
+    if (_handler.on_frame == nullptr && !has_consumers && !has_encoder)
+    {
+        return;
+    }
+
+    CefRect popup_rect = _popup_rect;
+
+    // Everything after the transform, host buffers, motion and alpha included, works in output orientation.
+    const RectList *rects = &dirtyRects;
+    if (!_transform.IsIdentity())
+    {
+        auto &transform = is_popup ? _popup_transform : _transform;
+        buffer = transform.Apply(dirtyRects, buffer, width, height, _transformed_rects);
+        rects = &_transformed_rects;
+
+        int output_width;
+        int output_height;
+        transform.GetSize(width, height, output_width, output_height);
+        width = output_width;
+        height = output_height;
+
+        popup_rect = _transform.MapRect(_popup_rect, _view_rect.width, _view_rect.height, false);
+    }
+
+    if (rects->empty())
+    {
+        return;
+    }
+
     Frame frame;
     frame.width = width;
     frame.height = height;
     frame.buffer = buffer;
-    frame.is_popup = type == PaintElementType::PET_POPUP;
+    frame.stride = width * 4;
+    frame.buffer_index = -1;
+    frame.shared = nullptr;
+    frame.damaged_pixels = dirty_pixels;
+    frame.is_popup = is_popup;
+
+    auto rect = (*rects)[0];
+    frame.x = frame.is_popup ? popup_rect.x : rect.x;
+    frame.y = frame.is_popup ? popup_rect.y : rect.y;
 
-    auto rect = dirtyRects[0];
-    frame.x = frame.is_popup ? _popup_rect.x : rect.x;
-    frame.y = frame.is_popup ? _popup_rect.y : rect.y;
+    _dirty_rects.clear();
+    _moves.clear();
+
+    for (auto &it : *rects)
+    {
+        _dirty_rects.push_back({it.x, it.y, it.width, it.height});
+    }
+
+    FrameMove move;
+    if (!frame.is_popup && _motion_detection && _motion.Detect(buffer, width, height, _dirty_rects, move))
+    {
+        _moves.push_back(move);
+    }
 
-    _handler.on_frame(&frame, _handler.context);
+    frame.dirty_rects = _dirty_rects.data();
+    frame.dirty_rects_count = _dirty_rects.size();
+    frame.moves = _moves.empty() ? nullptr : _moves.data();
+    frame.moves_count = _moves.size();
+
+    frame.alpha_tiles = nullptr;
+    frame.alpha_tile_size = 0;
+    frame.alpha_tile_columns = 0;
+    frame.alpha_tile_rows = 0;
+    if (!frame.is_popup && _alpha_tiles.has_value())
+    {
+        _alpha_tiles->Update(*rects, buffer, width, height);
+
+        frame.alpha_tiles = _alpha_tiles->GetTiles();
+        frame.alpha_tile_size = _alpha_tiles->GetSize();
+        frame.alpha_tile_columns = _alpha_tiles->GetColumns();
+        frame.alpha_tile_rows = _alpha_tiles->GetRows();
+    }
+
+    // The tints go over the analysed frame, motion and alpha describe the page itself. Moved regions would carry
+    // tints along, so the tinted tiles are reported as damage instead.
+    if (!frame.is_popup && _paint_flashing_enabled.load(std::memory_order_relaxed))
+    {
+        buffer = _paint_flashing.Apply(*rects, buffer, width, height, _flashing_rects);
+        rects = &_flashing_rects;
+
+        _dirty_rects.clear();
+        for (auto &it : _flashing_rects)
+        {
+            _dirty_rects.push_back({it.x, it.y, it.width, it.height});
+        }
+
+        frame.buffer = buffer;
+        frame.dirty_rects = _dirty_rects.data();
+        frame.dirty_rects_count = _dirty_rects.size();
+        frame.moves = nullptr;
+        frame.moves_count = 0;
+
+        // Fading needs frames even when the page stopped painting.
+        if (_paint_flashing.IsFading())
+        {
+            browser->GetHost()->Invalidate(PET_VIEW);
+        }
+    }
+    else if (!frame.is_popup)
+    {
+        _paint_flashing.Reset();
+    }
+
+    if (has_consumers)
+    {
+        _fanout.Dispatch(frame);
+    }
+
+    if (has_encoder)
+    {
+        std::lock_guard<std::mutex> lock(_encoder_mutex);
+
+        if (_encoder != nullptr)
+        {
+            _encoder->Submit(*rects, buffer, width, height);
+        }
+    }
+
+    if (_handler.on_frame == nullptr)
+    {
+        return;
+    }
+
+    if (!frame.is_popup && _frame_buffers.IsEnabled())
+    {
+        FrameBuffer output;
+        frame.buffer_index = _frame_buffers.Write(*rects, buffer, width, height, &output);
+        if (frame.buffer_index < 0)
+        {
+            IMetrics::Add(MetricCounter::FramesDropped);
+            _frame_buffers_dropped = true;
+
+            return;
+        }
+
+        frame.buffer = output.data;
+        frame.stride = output.stride;
+
+        // The host missed the damage and moves of the dropped frames, its buffer is whole again though.
+        if (_frame_buffers_dropped)
+        {
+            _frame_buffers_dropped = false;
+
+            _dirty_rects.assign(1, {0, 0, width, height});
+            frame.dirty_rects = _dirty_rects.data();
+            frame.dirty_rects_count = 1;
+            frame.moves = nullptr;
+            frame.moves_count = 0;
+        }
+    }
+
+    IWatchdog::Call(HostCallback::OnFrame, _handler.on_frame, &frame, _handler.context);
 }
 
 void IWebViewRender::OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect &rect)
@@ -231,6 +482,83 @@ void IWebViewRender::Resize(int width, int height)
     _view_rect.height = height;
 }
 
+const IFrameTransform &IWebViewRender::GetTransform()
+{
+    return _transform;
+}
+
+void IWebViewRender::UnmapPoint(float &x, float &y)
+{
+    _transform.UnmapPoint(x, y, _view_rect.width, _view_rect.height);
+}
+
+IFrameBuffers &IWebViewRender::GetFrameBuffers()
+{
+    return _frame_buffers;
+}
+
+void IWebViewRender::SetPaintFlashing(bool enable)
+{
+    _paint_flashing_enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool IWebViewRender::StartEncoder(const VideoEncoderSettings *settings)
+{
+    auto encoder = IVideoEncoder::Create(settings, _memory);
+    if (encoder == nullptr)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_encoder_mutex);
+
+        _encoder.swap(encoder);
+        _encoding.store(true, std::memory_order_relaxed);
+    }
+
+    // The replaced encoder joins its thread outside the lock, paints keep going meanwhile.
+    encoder.reset();
+
+    return true;
+}
+
+void IWebViewRender::StopEncoder()
+{
+    std::unique_ptr<IVideoEncoder> encoder;
+    {
+        std::lock_guard<std::mutex> lock(_encoder_mutex);
+
+        _encoder.swap(encoder);
+        _encoding.store(false, std::memory_order_relaxed);
+    }
+}
+
+void IWebViewRender::RequestKeyframe()
+{
+    std::lock_guard<std::mutex> lock(_encoder_mutex);
+
+    if (_encoder != nullptr)
+    {
+        _encoder->RequestKeyframe();
+    }
+}
+
+void IWebViewRender::SetEncoderBitrate(uint32_t bitrate)
+{
+    std::lock_guard<std::mutex> lock(_encoder_mutex);
+
+    if (_encoder != nullptr)
+    {
+        _encoder->SetBitrate(bitrate);
+    }
+}
+
+IFrameFanout &IWebViewRender::GetFrameFanout()
+{
+    return _fanout;
+}
+
 /* CefRequestHandler */
 
 IWebViewRequest::IWebViewRequest(const WebViewSettings *settings)
@@ -257,6 +585,46 @@ IWebView::IWebView(CefSettings &cef_settings, const WebViewSettings *settings, W
 {
     assert(settings != nullptr);
 
+    _message_bus = settings->message_bus;
+
+    // Ignored events are dropped by nulling their callbacks, every call site checks for null before converting.
+    uint32_t ignored = settings->ignored_events;
+    if (ignored & WEW_EVENT_CURSOR)
+    {
+        _handler.on_cursor = nullptr;
+        _handler.on_cursor_image = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_STATE_CHANGE)
+    {
+        _handler.on_state_change = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_IME_RECT)
+    {
+        _handler.on_ime_rect = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_FRAME)
+    {
+        _handler.on_frame = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_TITLE_CHANGE)
+    {
+        _handler.on_title_change = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_FULLSCREEN_CHANGE)
+    {
+        _handler.on_fullscreen_change = nullptr;
+    }
+
+    if (ignored & WEW_EVENT_MESSAGE)
+    {
+        _handler.on_message = nullptr;
+    }
+
     _drag_handler = new IWebViewDrag();
     _load_handler = new IWebViewLoad(_handler);
     _display_handler = new IWebViewDisplay(_handler);
@@ -265,7 +633,7 @@ IWebView::IWebView(CefSettings &cef_settings, const WebViewSettings *settings, W
 
     if (cef_settings.windowless_rendering_enabled)
     {
-        _render_handler = new IWebViewRender(settings, _handler);
+        _render_handler = new IWebViewRender(settings, _handler, _memory);
     }
 
     if (settings->request_handler_factory)
@@ -277,6 +645,13 @@ IWebView::IWebView(CefSettings &cef_settings, const WebViewSettings *settings, W
 IWebView::~IWebView()
 {
     this->Close();
+
+    // Consumer snapshots can outlive the webview and its memory account, the encoder is stopped with it.
+    if (_render_handler != nullptr)
+    {
+        _render_handler->GetFrameFanout().Detach();
+        _render_handler->StopEncoder();
+    }
 }
 
 CefRefPtr<CefDragHandler> IWebView::GetDragHandler()
@@ -340,9 +715,46 @@ bool IWebView::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
         return false;
     }
 
+    if (IMessageBus::OnProcessMessage(browser, message, _message_bus))
+    {
+        return true;
+    }
+
+    std::string name = message->GetName();
+    if (name == "RING_SYNC" || name == "RING_NOTIFY")
+    {
+        std::lock_guard<std::recursive_mutex> lock(_rings_mutex);
+
+        if (name == "RING_SYNC")
+        {
+            for (auto &it : _rings)
+            {
+                SendRingMessage("RING_OPEN", it.second.get());
+            }
+        }
+        else
+        {
+            // The renderer only names a ring, a ring closed in the meantime is ignored.
+            auto it = _rings.find(message->GetArgumentList()->GetInt(0));
+            if (it != _rings.end())
+            {
+                it->second->OnReady();
+            }
+        }
+
+        return true;
+    }
+
+    if (_handler.on_message == nullptr)
+    {
+        return true;
+    }
+
     auto args = message->GetArgumentList();
     std::string payload = args->GetString(0);
-    _handler.on_message(payload.c_str(), _handler.context);
+    IMetrics::Observe(MetricHistogram::MessageReceivedBytes, payload.size());
+
+    IWatchdog::Call(HostCallback::OnMessage, _handler.on_message, payload.c_str(), _handler.context);
 
     return true;
 }
@@ -381,6 +793,8 @@ RawWindowHandle IWebView::GetWindowHandle()
 
 void IWebView::SendMessage(std::string message)
 {
+    TRACE_SPAN("IWebView::SendMessage");
+
     CHECK_REFCOUNTING();
 
     if (!_browser.has_value())
@@ -388,6 +802,8 @@ void IWebView::SendMessage(std::string message)
         return;
     }
 
+    IMetrics::Observe(MetricHistogram::MessageSentBytes, message.size());
+
     auto msg = CefProcessMessage::Create("MESSAGE_TRANSPORT");
     CefRefPtr<CefListValue> args = msg->GetArgumentList();
     args->SetSize(1);
@@ -404,6 +820,8 @@ void IWebView::Close()
         return;
     }
 
+    IMessageBus::Remove(_browser.value()->GetIdentifier());
+
     _browser.value()->GetHost()->CloseBrowser(true);
     _browser = std::nullopt;
 
@@ -446,6 +864,7 @@ void IWebView::OnMouseClick(cef_mouse_event_t event, cef_mouse_button_type_t but
         return;
     }
 
+    UnmapMouseEvent(event);
     _browser.value()->GetHost()->SendMouseClickEvent(event, button, !pressed, 1);
 }
 
@@ -458,6 +877,7 @@ void IWebView::OnMouseMove(cef_mouse_event_t event)
         return;
     }
 
+    UnmapMouseEvent(event);
     _browser.value()->GetHost()->SendMouseMoveEvent(event, false);
 }
 
@@ -470,9 +890,30 @@ void IWebView::OnMouseWheel(cef_mouse_event_t event, int x, int y)
         return;
     }
 
+    UnmapMouseEvent(event);
+    if (_render_handler != nullptr)
+    {
+        _render_handler->GetTransform().UnmapVector(x, y);
+    }
+
     _browser.value()->GetHost()->SendMouseWheelEvent(event, x, y);
 }
 
+void IWebView::UnmapMouseEvent(cef_mouse_event_t &event)
+{
+    if (_render_handler == nullptr)
+    {
+        return;
+    }
+
+    float x = event.x;
+    float y = event.y;
+    _render_handler->UnmapPoint(x, y);
+
+    event.x = static_cast<int>(x);
+    event.y = static_cast<int>(y);
+}
+
 void IWebView::OnKeyboard(cef_key_event_t event)
 {
     CHECK_REFCOUNTING();
@@ -494,6 +935,11 @@ void IWebView::OnTouch(cef_touch_event_t event)
         return;
     }
 
+    if (_render_handler != nullptr)
+    {
+        _render_handler->UnmapPoint(event.x, event.y);
+    }
+
     _browser.value()->GetHost()->SendTouchEvent(event);
 }
 
@@ -513,6 +959,183 @@ void IWebView::Resize(int width, int height)
     }
 }
 
+IMemoryAccount &IWebView::GetMemoryAccount()
+{
+    return _memory;
+}
+
+bool IWebView::SetFrameBuffers(const FrameBuffer *buffers, size_t count)
+{
+    if (_render_handler == nullptr)
+    {
+        return false;
+    }
+
+    _render_handler->GetFrameBuffers().Set(buffers, count);
+
+    return true;
+}
+
+void IWebView::ReleaseFrameBuffer(uint32_t index)
+{
+    if (_render_handler != nullptr)
+    {
+        _render_handler->GetFrameBuffers().Release(index);
+    }
+}
+
+void IWebView::SetPaintFlashing(bool enable)
+{
+    CHECK_REFCOUNTING();
+
+    if (_render_handler == nullptr)
+    {
+        return;
+    }
+
+    _render_handler->SetPaintFlashing(enable);
+
+    // The host's copy of the view still holds the tints.
+    if (!enable && _browser.has_value())
+    {
+        _browser.value()->GetHost()->Invalidate(PET_VIEW);
+    }
+}
+
+bool IWebView::StartEncoder(const VideoEncoderSettings *settings)
+{
+    if (_render_handler == nullptr)
+    {
+        return false;
+    }
+
+    if (!_render_handler->StartEncoder(settings))
+    {
+        return false;
+    }
+
+    // The encoder only sees damage from now on, a full paint gives it the whole view.
+    if (_browser.has_value())
+    {
+        _browser.value()->GetHost()->Invalidate(PET_VIEW);
+    }
+
+    return true;
+}
+
+void IWebView::StopEncoder()
+{
+    if (_render_handler != nullptr)
+    {
+        _render_handler->StopEncoder();
+    }
+}
+
+void IWebView::RequestKeyframe()
+{
+    if (_render_handler != nullptr)
+    {
+        _render_handler->RequestKeyframe();
+    }
+}
+
+void IWebView::SetEncoderBitrate(uint32_t bitrate)
+{
+    if (_render_handler != nullptr)
+    {
+        _render_handler->SetEncoderBitrate(bitrate);
+    }
+}
+
+IRingChannel *IWebView::OpenRing(const RingSettings *settings)
+{
+    CHECK_REFCOUNTING(nullptr);
+
+    // Ring memory is never evicted, a ring over the budget is not opened.
+    uint32_t capacity = ISharedRing::GetCapacity(settings->capacity);
+    size_t size = ISharedRing::GetRegionSize(capacity);
+    if (!_memory.Charge(WEW_MEMORY_MESSAGE_QUEUES, size))
+    {
+        _memory.Release(WEW_MEMORY_MESSAGE_QUEUES, size);
+
+        return nullptr;
+    }
+
+    auto memory = ISharedMemory::Create(size);
+    if (memory == nullptr)
+    {
+        _memory.Release(WEW_MEMORY_MESSAGE_QUEUES, size);
+
+        return nullptr;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_rings_mutex);
+
+    int id = _next_ring_id++;
+    auto ring = new IRingChannel(id, settings, std::make_unique<ISharedRing>(std::move(memory), capacity, true));
+    ring->SetNotifier([this, ring]() { SendRingMessage("RING_NOTIFY", ring); });
+    _rings[id] = std::unique_ptr<IRingChannel>(ring);
+
+    // A renderer that does not exist yet asks for the rings once its page context is created.
+    SendRingMessage("RING_OPEN", ring);
+
+    return ring;
+}
+
+void IWebView::CloseRing(IRingChannel *ring)
+{
+    std::lock_guard<std::recursive_mutex> lock(_rings_mutex);
+
+    auto it = _rings.find(ring->GetId());
+    if (it == _rings.end() || it->second.get() != ring)
+    {
+        return;
+    }
+
+    SendRingMessage("RING_CLOSE", ring);
+
+    _memory.Release(WEW_MEMORY_MESSAGE_QUEUES, ring->GetSize());
+    _rings.erase(it);
+}
+
+void IWebView::SendRingMessage(const char *name, IRingChannel *ring)
+{
+    if (!_browser.has_value())
+    {
+        return;
+    }
+
+    auto msg = CefProcessMessage::Create(name);
+    if (strcmp(name, "RING_OPEN") == 0)
+    {
+        ring->GetDescriptor(msg->GetArgumentList());
+    }
+    else
+    {
+        msg->GetArgumentList()->SetInt(0, ring->GetId());
+    }
+
+    _browser.value()->GetMainFrame()->SendProcessMessage(PID_RENDERER, msg);
+}
+
+int IWebView::SubscribeFrames(const FrameConsumer *consumer)
+{
+    if (_render_handler == nullptr)
+    {
+        return -1;
+    }
+
+    return _render_handler->GetFrameFanout().Subscribe(consumer);
+}
+
+void IWebView::UnsubscribeFrames(int id)
+{
+    if (_render_handler != nullptr)
+    {
+        _render_handler->GetFrameFanout().Unsubscribe(id);
+    }
+}
+
 void IWebView::SetFocus(bool enable)
 {
     CHECK_REFCOUNTING();
@@ -10,11 +10,25 @@
 #pragma once
 
 #include <float.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 
 #include "include/cef_app.h"
 
+#include "accounting.h"
+#include "alpha.h"
+#include "encoder.h"
+#include "fanout.h"
+#include "framebuffer.h"
+#include "motion.h"
+#include "overlay.h"
+#include "transform.h"
 #include "request.h"
+#include "ring.h"
+#include "trace.h"
 #include "util.h"
 #include "wew.h"
 
@@ -163,13 +177,19 @@ class IWebViewDisplay : public CefDisplayHandler
   private:
     WebViewHandler &_handler;
 
+    ///
+    /// The cursor last reported, -1 before the first one. The hash is only set for custom cursors.
+    ///
+    int _cursor_type = -1;
+    uint64_t _cursor_hash = 0;
+
     IMPLEMENT_REFCOUNTING(IWebViewDisplay);
 };
 
 class IWebViewRender : public CefRenderHandler
 {
   public:
-    IWebViewRender(const WebViewSettings *settings, WebViewHandler &handler);
+    IWebViewRender(const WebViewSettings *settings, WebViewHandler &handler, IMemoryAccount &memory);
 
     ///
     /// Called to allow the client to fill in the CefScreenInfo object with
@@ -209,12 +229,44 @@ class IWebViewRender : public CefRenderHandler
 
     void Resize(int width, int height);
 
+    IFrameBuffers &GetFrameBuffers();
+    IFrameFanout &GetFrameFanout();
+    const IFrameTransform &GetTransform();
+    void SetPaintFlashing(bool enable);
+    bool StartEncoder(const VideoEncoderSettings *settings);
+    void StopEncoder();
+    void RequestKeyframe();
+    void SetEncoderBitrate(uint32_t bitrate);
+
+    ///
+    /// Maps a point in output coordinates, such as an input event position, back to the view.
+    ///
+    void UnmapPoint(float &x, float &y);
+
   private:
     float _device_scale_factor;
     WebViewHandler &_handler;
     CefRect _popup_rect;
     CefRect _view_rect;
     Rect _texture_rect;
+    IFrameBuffers _frame_buffers;
+    bool _frame_buffers_dropped = false;
+    bool _motion_detection;
+    IFrameTransform _transform;
+    IFrameTransform _popup_transform;
+    RectList _transformed_rects;
+    IMotionDetector _motion;
+    std::vector<Rect> _dirty_rects;
+    std::vector<FrameMove> _moves;
+    std::optional<IAlphaTiles> _alpha_tiles;
+    IFrameFanout _fanout;
+    std::atomic<bool> _paint_flashing_enabled;
+    IPaintFlashing _paint_flashing;
+    RectList _flashing_rects;
+    IMemoryAccount &_memory;
+    std::mutex _encoder_mutex;
+    std::unique_ptr<IVideoEncoder> _encoder;
+    std::atomic<bool> _encoding{false};
 
     IMPLEMENT_REFCOUNTING(IWebViewRender);
 };
@@ -309,6 +361,22 @@ class IWebView : public CefClient
     void OnIMEComposition(std::string input);
     void OnIMESetComposition(std::string input, int x, int y);
     RawWindowHandle GetWindowHandle();
+    bool SetFrameBuffers(const FrameBuffer *buffers, size_t count);
+    void ReleaseFrameBuffer(uint32_t index);
+    int SubscribeFrames(const FrameConsumer *consumer);
+    void UnsubscribeFrames(int id);
+    void SetPaintFlashing(bool enable);
+    bool StartEncoder(const VideoEncoderSettings *settings);
+    void StopEncoder();
+    void RequestKeyframe();
+    void SetEncoderBitrate(uint32_t bitrate);
+    IRingChannel *OpenRing(const RingSettings *settings);
+    void CloseRing(IRingChannel *ring);
+
+    ///
+    /// Memory the library holds for this webview, shared by its handlers.
+    ///
+    IMemoryAccount &GetMemoryAccount();
 
   private:
     CefRefPtr<IWebViewDrag> _drag_handler = nullptr;
@@ -321,6 +389,25 @@ class IWebView : public CefClient
 
     std::optional<CefRefPtr<CefBrowser>> _browser = std::nullopt;
     WebViewHandler _handler;
+    IMemoryAccount _memory;
+    bool _message_bus;
+
+    ///
+    /// Shared rings by id, recursive so on_ready can close its own ring.
+    ///
+    std::recursive_mutex _rings_mutex;
+    std::map<int, std::unique_ptr<IRingChannel>> _rings;
+    int _next_ring_id = 0;
+
+    ///
+    /// Sends a ring message with the ring's id, or its descriptor for RING_OPEN, to the renderer.
+    ///
+    void SendRingMessage(const char *name, IRingChannel *ring);
+
+    ///
+    /// Maps a mouse position from the output orientation back to the view.
+    ///
+    void UnmapMouseEvent(cef_mouse_event_t &event);
 
     IMPLEMENT_RUNNING;
     IMPLEMENT_REFCOUNTING(IWebView);
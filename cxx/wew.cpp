@@ -9,14 +9,26 @@
 #include "include/wrapper/cef_library_loader.h"
 #endif
 
+#include <algorithm>
+#include <string.h>
+
+#include "blob.h"
+#include "bus.h"
+#include "metrics.h"
+#include "plugin.h"
 #include "runtime.h"
 #include "subprocess.h"
+#include "trace.h"
 #include "util.h"
+#include "watchdog.h"
+#include "watcher.h"
 #include "webview.h"
 #include "wew.h"
 
 bool post_task_with_main_thread(void (*callback)(void *context), void *context)
 {
+    IMetrics::Add(MetricCounter::TasksPosted);
+
     return CefPostTask(TID_UI, new ITask(callback, context));
 }
 
@@ -54,6 +66,13 @@ int execute_subprocess(int argc, const char **argv)
     return CefExecuteProcess(main_args, new ISubProcess, nullptr);
 }
 
+void add_renderer_plugin(PluginInit init)
+{
+    assert(init != nullptr);
+
+    IPlugins::Add(init);
+}
+
 void *create_runtime(const RuntimeSettings *settings, RuntimeHandler handler)
 {
 #ifdef MACOS
@@ -166,6 +185,8 @@ void close_runtime(void *runtime)
 
 void *create_webview(void *runtime, const char *url, const WebViewSettings *settings, WebViewHandler handler)
 {
+    TRACE_SPAN("create_webview");
+
     assert(runtime != nullptr);
     assert(settings != nullptr);
     assert(url != nullptr);
@@ -306,3 +327,223 @@ void webview_set_focus(void *webview, bool enable)
 
     static_cast<WebView *>(webview)->ref->SetFocus(enable);
 }
+
+void webview_get_memory_usage(void *webview, MemoryUsage *usage)
+{
+    assert(webview != nullptr);
+    assert(usage != nullptr);
+
+    static_cast<WebView *>(webview)->ref->GetMemoryAccount().GetUsage(usage);
+}
+
+bool webview_set_frame_buffers(void *webview, const FrameBuffer *buffers, size_t count)
+{
+    assert(webview != nullptr);
+    assert(buffers != nullptr || count == 0);
+
+    return static_cast<WebView *>(webview)->ref->SetFrameBuffers(buffers, count);
+}
+
+void webview_release_frame_buffer(void *webview, uint32_t index)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->ReleaseFrameBuffer(index);
+}
+
+int webview_subscribe_frames(void *webview, const FrameConsumer *consumer)
+{
+    assert(webview != nullptr);
+    assert(consumer != nullptr);
+
+    return static_cast<WebView *>(webview)->ref->SubscribeFrames(consumer);
+}
+
+void webview_unsubscribe_frames(void *webview, int id)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->UnsubscribeFrames(id);
+}
+
+bool webview_start_encoder(void *webview, const VideoEncoderSettings *settings)
+{
+    assert(webview != nullptr);
+    assert(settings != nullptr);
+
+    return static_cast<WebView *>(webview)->ref->StartEncoder(settings);
+}
+
+void webview_stop_encoder(void *webview)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->StopEncoder();
+}
+
+void webview_request_keyframe(void *webview)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->RequestKeyframe();
+}
+
+void webview_set_encoder_bitrate(void *webview, uint32_t bitrate)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->SetEncoderBitrate(bitrate);
+}
+
+void *webview_open_ring(void *webview, const RingSettings *settings)
+{
+    assert(webview != nullptr);
+    assert(settings != nullptr && settings->name != nullptr);
+
+    return static_cast<WebView *>(webview)->ref->OpenRing(settings);
+}
+
+void webview_close_ring(void *webview, void *ring)
+{
+    assert(webview != nullptr);
+    assert(ring != nullptr);
+
+    static_cast<WebView *>(webview)->ref->CloseRing(static_cast<IRingChannel *>(ring));
+}
+
+bool wew_ring_write(void *ring, const void *data, uint32_t size)
+{
+    assert(ring != nullptr);
+
+    return static_cast<IRingChannel *>(ring)->Write(data, size);
+}
+
+int64_t wew_ring_read(void *ring, void *buffer, uint32_t size)
+{
+    assert(ring != nullptr);
+
+    return static_cast<IRingChannel *>(ring)->Read(buffer, size);
+}
+
+void webview_set_paint_flashing(void *webview, bool enable)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->SetPaintFlashing(enable);
+}
+
+void wew_frame_retain(const Frame *frame)
+{
+    assert(frame != nullptr && frame->shared != nullptr);
+
+    IFramePool::Retain(static_cast<IPooledFrame *>(frame->shared));
+}
+
+void wew_frame_release(const Frame *frame)
+{
+    assert(frame != nullptr && frame->shared != nullptr);
+
+    IFramePool::Release(static_cast<IPooledFrame *>(frame->shared));
+}
+
+void webview_set_memory_budget(void *webview, MemorySubsystem subsystem, uint64_t bytes)
+{
+    assert(webview != nullptr);
+
+    static_cast<WebView *>(webview)->ref->GetMemoryAccount().SetBudget(subsystem, bytes);
+}
+
+void wew_register_blob(const char *url,
+                       const void *data,
+                       size_t size,
+                       const char *mime_type,
+                       void (*release)(const void *data, void *context),
+                       void *context)
+{
+    assert(url != nullptr && (data != nullptr || size == 0) && mime_type != nullptr);
+
+    auto blob = std::make_shared<IBlob>();
+    blob->data = static_cast<const uint8_t *>(data);
+    blob->size = size;
+    blob->mime_type = mime_type;
+    blob->release = release;
+    blob->context = context;
+
+    IBlobRegistry::Register(url, std::move(blob));
+}
+
+bool wew_unregister_blob(const char *url)
+{
+    assert(url != nullptr);
+
+    return IBlobRegistry::Unregister(url);
+}
+
+int wew_watch_directory(const char *path, const DirectoryObserver *observer)
+{
+    assert(path != nullptr && observer != nullptr && observer->on_change != nullptr);
+
+    return IDirectoryWatcher::Watch(path, observer);
+}
+
+void wew_unwatch_directory(int id)
+{
+    IDirectoryWatcher::Unwatch(id);
+}
+
+void wew_bus_publish(const char *channel, const char *message)
+{
+    assert(channel != nullptr && message != nullptr);
+
+    IMessageBus::Publish(channel, message);
+}
+
+int wew_bus_observe(const char *channel, const BusObserver *observer)
+{
+    assert(channel != nullptr && observer != nullptr);
+
+    return IMessageBus::Observe(channel, observer);
+}
+
+void wew_bus_unobserve(int id)
+{
+    IMessageBus::Unobserve(id);
+}
+
+size_t wew_metrics_snapshot(Metric *metrics, size_t capacity)
+{
+    assert(metrics != nullptr || capacity == 0);
+
+    return IMetrics::Snapshot(metrics, capacity);
+}
+
+size_t wew_metrics_prometheus(char *buffer, size_t size)
+{
+    assert(buffer != nullptr || size == 0);
+
+    std::string text = IMetrics::Prometheus();
+    if (size > 0)
+    {
+        size_t length = std::min(text.size(), size - 1);
+        memcpy(buffer, text.data(), length);
+        buffer[length] = '\0';
+    }
+
+    return text.size();
+}
+
+void wew_set_slow_callback_handler(const SlowCallbackHandler *handler)
+{
+    IWatchdog::SetHandler(handler);
+}
+
+bool wew_trace_flush(const char *path)
+{
+    assert(path != nullptr);
+
+#ifdef WEW_TRACING
+    return ITrace::Flush(path);
+#else
+    return false;
+#endif
+}
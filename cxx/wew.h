@@ -27,11 +27,38 @@ typedef struct
     int height;
 } Rect;
 
+///
+/// What a request loads, as reported by the browser.
+///
+typedef enum
+{
+    ///
+    /// The document of a frame.
+    ///
+    WEW_RESOURCE_DOCUMENT = 0,
+    WEW_RESOURCE_STYLESHEET,
+
+    ///
+    /// Scripts, including the scripts of workers.
+    ///
+    WEW_RESOURCE_SCRIPT,
+    WEW_RESOURCE_FONT,
+
+    ///
+    /// XMLHttpRequest and fetch.
+    ///
+    WEW_RESOURCE_FETCH,
+    WEW_RESOURCE_IMAGE,
+    WEW_RESOURCE_MEDIA,
+    WEW_RESOURCE_OTHER,
+} ResourceType;
+
 typedef struct
 {
     const char *url;
     const char *method;
     const char *referrer;
+    ResourceType resource_type;
 } Request;
 
 typedef struct
@@ -265,6 +292,21 @@ typedef struct
 
     /// Specify whether signal handlers must be disabled on POSIX systems.
     bool disable_signal_handlers;
+
+    /// Renderer plugin shared libraries loaded by execute_subprocess, separated by the platform path list separator
+    /// (":" or ";" on Windows). See PluginRegistrar.
+    const char *renderer_plugins;
+
+    /// Path of a Unix domain socket with an HTTP/1.1 server behind it. Requests to app-api:// URLs are proxied to it
+    /// over pooled keep-alive connections, with the path, query, method, headers and body passed through. At most 16
+    /// connections are in use at once, further requests wait for one. Not supported on Windows.
+    const char *api_socket;
+
+    /// Number of threads running the request handlers of the custom scheme and of webviews, 0 runs them on the CEF IO
+    /// thread. With threads, waiting requests are served by resource type: documents, scripts and stylesheets first,
+    /// images and media last, and a request that waited too long goes ahead of the others. The handler of a request
+    /// may then be called on any of the threads, one call at a time, and a cancel during a call comes once it returned.
+    int request_threads;
 } RuntimeSettings;
 
 typedef struct
@@ -274,6 +316,36 @@ typedef struct
     void *context;
 } RuntimeHandler;
 
+///
+/// Orientation of windowless output, rotations are clockwise and mirroring is horizontal, applied before the
+/// rotation.
+///
+typedef enum
+{
+    WEW_TRANSFORM_NORMAL = 0,
+    WEW_TRANSFORM_90,
+    WEW_TRANSFORM_180,
+    WEW_TRANSFORM_270,
+    WEW_TRANSFORM_FLIPPED,
+    WEW_TRANSFORM_FLIPPED_90,
+    WEW_TRANSFORM_FLIPPED_180,
+    WEW_TRANSFORM_FLIPPED_270,
+} FrameTransform;
+
+///
+/// Webview events, one bit per WebViewHandler callback.
+///
+typedef enum
+{
+    WEW_EVENT_CURSOR = 1 << 0,
+    WEW_EVENT_STATE_CHANGE = 1 << 1,
+    WEW_EVENT_IME_RECT = 1 << 2,
+    WEW_EVENT_FRAME = 1 << 3,
+    WEW_EVENT_TITLE_CHANGE = 1 << 4,
+    WEW_EVENT_FULLSCREEN_CHANGE = 1 << 5,
+    WEW_EVENT_MESSAGE = 1 << 6,
+} WebViewEvent;
+
 #ifdef LINUX
 typedef unsigned long RawWindowHandle;
 #else
@@ -336,6 +408,31 @@ typedef struct
 
     /// The request handler factory.
     const RequestHandlerFactory *request_handler_factory;
+
+    /// Look for scrolled regions between successive view frames and report them as Frame::moves, the dirty rects
+    /// then only cover the newly exposed strip. Frames whose dirty rects cover at least half of the view cost a hash
+    /// of every row and column, smaller paints only rehash their rows.
+    bool motion_detection;
+
+    /// Side of the square tiles that view frames are classified in by alpha, reported as Frame::alpha_tiles. Zero
+    /// disables the classification, only the tiles under the dirty rects are rescanned per frame.
+    uint32_t alpha_tile_size;
+
+    /// Orientation of frames, dirty rects and the IME rect, input event positions are mapped back from it. The
+    /// width and height above stay the page's own size.
+    FrameTransform output_transform;
+
+    /// Events that are never delivered, a bit set of WebViewEvent. Their callbacks are not called and may be null,
+    /// the event is dropped before it is converted for the handler.
+    uint32_t ignored_events;
+
+    /// Tint repainted tiles of view frames red, fading over the following frames, to find what keeps repainting.
+    /// A debugging aid, the tints are part of the delivered pixels and no moves are reported while it is on.
+    bool paint_flashing;
+
+    /// Give the main frame the MessageBus object. A page on the bus reads and publishes every channel of every
+    /// webview on it, only enable it for webviews showing trusted content.
+    bool message_bus;
 } WebViewSettings;
 
 typedef enum
@@ -347,6 +444,42 @@ typedef enum
     WEW_CLOSE = 5,
 } WebViewState;
 
+///
+/// A region of the previous frame that reappears moved in the current one, see WebViewSettings::motion_detection.
+///
+typedef struct
+{
+    /// The region in the previous frame.
+    Rect rect;
+    int dx;
+    int dy;
+} FrameMove;
+
+///
+/// Pixel layout of consumer frames, see webview_subscribe_frames.
+///
+typedef enum
+{
+    WEW_FRAME_BGRA = 0,
+    WEW_FRAME_RGBA,
+    WEW_FRAME_FORMAT_COUNT,
+} FrameFormat;
+
+///
+/// Alpha of a frame tile, see WebViewSettings::alpha_tile_size.
+///
+typedef enum
+{
+    WEW_TILE_TRANSPARENT = 0,
+    WEW_TILE_OPAQUE = 1,
+    WEW_TILE_MIXED = 2,
+} FrameTileAlpha;
+
+///
+/// A painted frame, its pointers are only valid during the callback it is passed to. wew_frame_retain keeps the
+/// buffer of a consumer frame alive and nothing else, dirty_rects, moves and alpha_tiles must be copied to outlive
+/// the callback.
+///
 typedef struct
 {
     bool is_popup;
@@ -355,10 +488,211 @@ typedef struct
     uint32_t height;
     uint32_t x;
     uint32_t y;
+
+    /// Bytes per row of buffer.
+    uint32_t stride;
+
+    /// Index of the host frame buffer holding the frame, or -1 when buffer is the library's own.
+    int32_t buffer_index;
+
+    /// The areas that changed since the previous frame, after the moves are applied.
+    const Rect *dirty_rects;
+    size_t dirty_rects_count;
+
+    /// Regions of the previous frame to copy before the dirty rects, only found with motion detection.
+    const FrameMove *moves;
+    size_t moves_count;
+
+    /// FrameTileAlpha of every tile in row major order, null unless alpha classification is enabled.
+    const uint8_t *alpha_tiles;
+    uint32_t alpha_tile_size;
+    uint32_t alpha_tile_columns;
+    uint32_t alpha_tile_rows;
+
+    /// Refcounted snapshot behind a consumer frame, see wew_frame_retain. Null for frames passed to on_frame.
+    void *shared;
+
+    /// Area of the rects the browser repainted for this frame, before motion detection and paint flashing.
+    uint64_t damaged_pixels;
 } Frame;
 
 typedef struct
 {
+    /// Frames per second delivered at most, zero delivers every frame.
+    uint32_t max_fps;
+    FrameFormat format;
+    void (*on_frame)(const Frame *frame, void *context);
+    void *context;
+} FrameConsumer;
+
+///
+/// Host memory that windowless frames are written into, see webview_set_frame_buffers.
+///
+typedef struct
+{
+    void *data;
+
+    /// Size of data in bytes, at least stride * height.
+    size_t size;
+
+    /// Bytes per row, at least width * 4.
+    uint32_t stride;
+} FrameBuffer;
+
+///
+/// Codecs of the video encoder, see webview_start_encoder.
+///
+typedef enum
+{
+    WEW_CODEC_VP8 = 0,
+    WEW_CODEC_VP9,
+} VideoCodec;
+
+typedef struct
+{
+    const uint8_t *data;
+    size_t size;
+
+    /// Milliseconds since the encoder started.
+    int64_t pts;
+    bool keyframe;
+} EncodedPacket;
+
+typedef struct
+{
+    VideoCodec codec;
+
+    /// Target bitrate in kilobits per second.
+    uint32_t bitrate;
+
+    /// Most frames between two keyframes, zero leaves it to the codec.
+    uint32_t keyframe_interval;
+
+    /// Called on the encoder thread for every packet, the data is only valid during the call.
+    void (*on_packet)(const EncodedPacket *packet, void *context);
+    void *context;
+} VideoEncoderSettings;
+
+///
+/// Bytes of the header at the start of a ring's shared buffer. The header holds the capacity as a uint32 at offset 4,
+/// the bytes written (head) and read (tail) so far as uint64 at offsets 64 and 128, and the record data follows it.
+/// Records are a uint32 length and the bytes, padded to 4 bytes, and wrap around at the capacity.
+///
+#define WEW_RING_HEADER_SIZE 256
+
+///
+/// Direction of a shared ring, the host is the producer of rings to the page and the consumer of rings from it.
+///
+typedef enum
+{
+    WEW_RING_TO_PAGE = 0,
+    WEW_RING_FROM_PAGE,
+} RingDirection;
+
+typedef struct
+{
+    ///
+    /// Name of the ring on the page's SharedRings object.
+    ///
+    const char *name;
+
+    ///
+    /// Bytes of record data the ring holds, rounded up to a power of two between 4 KiB and 1 GiB.
+    ///
+    uint32_t capacity;
+    RingDirection direction;
+
+    ///
+    /// Rings from the page: called on the CEF UI thread when the page wrote records after wew_ring_read found the
+    /// ring empty.
+    ///
+    void (*on_ready)(void *context);
+    void *context;
+} RingSettings;
+
+typedef struct
+{
+    ///
+    /// Called on the CEF UI thread for every message a page publishes to the channel. The strings are only valid
+    /// during the call.
+    ///
+    void (*on_message)(const char *channel, const char *message, void *context);
+    void *context;
+} BusObserver;
+
+typedef struct
+{
+    ///
+    /// Called on the watcher's thread with the path of a file or directory that was written, created, deleted or
+    /// moved, relative to the watched directory and separated by "/". An empty path means that events were lost and
+    /// anything may have changed. The path is only valid during the call.
+    ///
+    void (*on_change)(const char *path, void *context);
+    void *context;
+} DirectoryObserver;
+
+///
+/// Library subsystems that hold memory on behalf of a webview.
+///
+typedef enum
+{
+    WEW_MEMORY_FRAME_BUFFERS = 0,
+    WEW_MEMORY_MESSAGE_QUEUES,
+
+    ///
+    /// All subsystems of a webview together, only valid as a budget.
+    ///
+    WEW_MEMORY_TOTAL,
+} MemorySubsystem;
+
+typedef struct
+{
+    ///
+    /// Bytes currently held by each subsystem.
+    ///
+    uint64_t bytes[WEW_MEMORY_TOTAL];
+
+    ///
+    /// Bytes currently held by all subsystems.
+    ///
+    uint64_t total;
+
+    ///
+    /// Highest total seen so far.
+    ///
+    uint64_t peak;
+
+    ///
+    /// Bytes freed by eviction so far.
+    ///
+    uint64_t evicted;
+} MemoryUsage;
+
+///
+/// Image of a custom cursor, see WebViewHandler::on_cursor_image.
+///
+typedef struct
+{
+    /// BGRA pixels with width * 4 bytes per row, only valid during the callback.
+    const void *buffer;
+    uint32_t width;
+    uint32_t height;
+    int hotspot_x;
+    int hotspot_y;
+
+    /// Device pixels per DIP of the image.
+    float scale;
+
+    /// Hash of the pixels, size, hotspot and scale. Equal cursors hash equal, so OS cursor objects can be cached by
+    /// it.
+    uint64_t hash;
+} CursorImage;
+
+typedef struct
+{
+    ///
+    /// Called when the cursor changes, repeats of the current cursor are not reported.
+    ///
     void (*on_cursor)(CursorType type, void *context);
     void (*on_state_change)(WebViewState state, void *context);
     void (*on_ime_rect)(Rect rect, void *context);
@@ -366,6 +700,11 @@ typedef struct
     void (*on_title_change)(const char *title, void *context);
     void (*on_fullscreen_change)(bool fullscreen, void *context);
     void (*on_message)(const char *message, void *context);
+
+    ///
+    /// Called instead of on_cursor for WEW_CT_CUSTOM when set, with the image of the cursor.
+    ///
+    void (*on_cursor_image)(const CursorImage *image, void *context);
     void *context;
 } WebViewHandler;
 
@@ -594,6 +933,137 @@ typedef struct
 
 } TouchEvent;
 
+///
+/// Number of buckets of every histogram metric.
+///
+#define WEW_METRIC_BUCKETS 16
+
+typedef enum
+{
+    WEW_METRIC_COUNTER = 0,
+    WEW_METRIC_HISTOGRAM = 1,
+} MetricKind;
+
+///
+/// A single metric of the process wide registry.
+///
+typedef struct
+{
+    ///
+    /// Metric name in the Prometheus naming scheme, statically allocated.
+    ///
+    const char *name;
+
+    ///
+    /// One line description, statically allocated.
+    ///
+    const char *help;
+
+    MetricKind kind;
+
+    ///
+    /// Counter value, or the number of observations of a histogram.
+    ///
+    uint64_t count;
+
+    ///
+    /// Sum of all observed values, zero for counters.
+    ///
+    uint64_t sum;
+
+    ///
+    /// Inclusive upper bound of each histogram bucket, the last bucket is unbounded (UINT64_MAX).
+    ///
+    uint64_t bounds[WEW_METRIC_BUCKETS];
+
+    ///
+    /// Number of observations in each histogram bucket, not cumulative.
+    ///
+    uint64_t buckets[WEW_METRIC_BUCKETS];
+} Metric;
+
+typedef struct
+{
+    ///
+    /// Called on the thread that ran the slow callback, right after it returned. The name is statically allocated,
+    /// for example "on_frame" or "request_handler.read".
+    ///
+    void (*on_slow_callback)(const char *name, uint64_t duration_ns, void *context);
+
+    ///
+    /// Host callbacks running at least this long are reported.
+    ///
+    uint64_t threshold_ns;
+    void *context;
+} SlowCallbackHandler;
+
+///
+/// Version of the renderer plugin ABI in PluginRegistrar, a plugin returns false from its init for a version it was
+/// not built for.
+///
+#define WEW_PLUGIN_API_VERSION 1
+
+///
+/// Symbol a renderer plugin shared library exports, a PluginInit.
+///
+#define WEW_PLUGIN_INIT "wew_plugin_init"
+
+typedef enum
+{
+    WEW_VALUE_UNDEFINED = 0,
+    WEW_VALUE_NULL,
+    WEW_VALUE_BOOL,
+    WEW_VALUE_NUMBER,
+    WEW_VALUE_STRING,
+    WEW_VALUE_BUFFER,
+} PluginValueType;
+
+///
+/// A page value passed to or returned from a plugin function.
+///
+typedef struct
+{
+    PluginValueType type;
+    bool boolean;
+    double number;
+
+    ///
+    /// UTF-8 text of a string, not null terminated, or the bytes of an ArrayBuffer. Arguments point into the page's
+    /// memory, an ArrayBuffer argument may be written in place.
+    ///
+    const void *data;
+    size_t size;
+
+    ///
+    /// Only for a returned string or buffer. A string is always copied and this is called right after the copy, a
+    /// buffer is taken by the page without a copy and this is called once the ArrayBuffer is collected. Without it
+    /// the data is copied before the function returns to the page and must stay valid until then.
+    ///
+    void (*release)(void *data);
+} PluginValue;
+
+///
+/// A native function called from the page on the renderer main thread. Return false to throw, a string result is
+/// used as the exception message.
+///
+typedef bool (*PluginFunction)(const PluginValue *arguments, size_t count, PluginValue *result, void *context);
+
+typedef struct
+{
+    uint32_t version;
+
+    ///
+    /// Adds a function to the NativePlugins object of the page's main frame, a name registered twice is replaced.
+    ///
+    void (*register_function)(void *registrar, const char *name, PluginFunction function, void *context);
+    void *registrar;
+} PluginRegistrar;
+
+///
+/// Called once per renderer process before the first page context is created, return false to be unloaded.
+///
+typedef bool (*PluginInit)(const PluginRegistrar *registrar);
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -606,6 +1076,12 @@ extern "C"
 
     EXPORT int execute_subprocess(int argc, const char **argv);
 
+    ///
+    /// Adds a renderer plugin linked into the subprocess executable, call it before execute_subprocess. Shared
+    /// library plugins are listed in RuntimeSettings::renderer_plugins instead.
+    ///
+    EXPORT void add_renderer_plugin(PluginInit init);
+
     EXPORT void run_message_loop();
 
     EXPORT void quit_message_loop();
@@ -668,6 +1144,114 @@ extern "C"
 
     EXPORT void webview_set_focus(void *webview, bool enable);
 
+    ///
+    /// Get the bytes the library currently holds on behalf of the webview.
+    ///
+    EXPORT void webview_get_memory_usage(void *webview, MemoryUsage *usage);
+
+    ///
+    /// Register host buffers for windowless view frames, an empty list goes back to the library's own buffer.
+    ///
+    /// Each paint copies only the damage the next free buffer has not seen yet into it, then calls on_frame with
+    /// Frame::buffer_index set. The buffer stays with the host until webview_release_frame_buffer, paints are dropped
+    /// while every buffer is held. Popups keep using the library's buffer.
+    ///
+    /// Returns false for webviews without windowless rendering.
+    ///
+    EXPORT bool webview_set_frame_buffers(void *webview, const FrameBuffer *buffers, size_t count);
+
+    ///
+    /// Hand a host frame buffer back to the webview once the host is done reading it.
+    ///
+    EXPORT void webview_release_frame_buffer(void *webview, uint32_t index);
+
+    ///
+    /// Add a consumer of windowless view frames, independent of on_frame and of the other consumers.
+    ///
+    /// Consumers share immutable snapshots, one per format and frame, and each one only receives frames at its own
+    /// rate. A consumer that skipped frames gets the whole frame as its dirty rect.
+    ///
+    /// Returns the consumer id, or -1 for webviews without windowless rendering.
+    ///
+    EXPORT int webview_subscribe_frames(void *webview, const FrameConsumer *consumer);
+
+    ///
+    /// Remove a consumer, its callback is not running and will not run once this returns.
+    ///
+    EXPORT void webview_unsubscribe_frames(void *webview, int id);
+
+    ///
+    /// Keep the buffer of a consumer frame beyond its callback, until the matching wew_frame_release. The snapshot
+    /// returns to the pool when its last consumer released it. The frame's other pointers are not kept.
+    ///
+    EXPORT void wew_frame_retain(const Frame *frame);
+
+    EXPORT void wew_frame_release(const Frame *frame);
+
+    ///
+    /// Encode view frames with VP8 or VP9 for streaming, replacing the running encoder if there is one. Frames are
+    /// encoded on a dedicated thread as fast as it keeps up, paints in between are merged and paints without damage
+    /// are skipped. Popups are not part of the encoded frames.
+    ///
+    /// Returns false for webviews without windowless rendering, or when the library was built without WEW_VPX.
+    ///
+    EXPORT bool webview_start_encoder(void *webview, const VideoEncoderSettings *settings);
+
+    ///
+    /// Stop the encoder, on_packet is not running and will not run once this returns. Must not be called from
+    /// on_packet.
+    ///
+    EXPORT void webview_stop_encoder(void *webview);
+
+    ///
+    /// Make the next encoded frame a keyframe, such as when a new viewer joins or a packet was lost.
+    ///
+    EXPORT void webview_request_keyframe(void *webview);
+
+    ///
+    /// Change the target bitrate in kilobits per second, applied from the next encoded frame.
+    ///
+    EXPORT void webview_set_encoder_bitrate(void *webview, uint32_t bitrate);
+
+    ///
+    /// Open a single producer single consumer ring in memory shared with the page's renderer, for streams too
+    /// frequent for messages. The page finds it as SharedRings[name], an object with the shared buffer, read() for
+    /// rings to the page, write() for rings from the page, and on(callback). A record costs a memory write, the
+    /// consumer is only woken when it found the ring empty before.
+    ///
+    /// The ring is charged to WEW_MEMORY_MESSAGE_QUEUES, returns nullptr over budget or when shared memory is
+    /// unavailable. The handle is valid until webview_close_ring or close_webview.
+    ///
+    EXPORT void *webview_open_ring(void *webview, const RingSettings *settings);
+
+    EXPORT void webview_close_ring(void *webview, void *ring);
+
+    ///
+    /// Append a record to a ring to the page, from one thread at a time. Returns false when the ring is full, the
+    /// record is dropped.
+    ///
+    EXPORT bool wew_ring_write(void *ring, const void *data, uint32_t size);
+
+    ///
+    /// Take the next record of a ring from the page, from one thread at a time. Returns the size of the record, which
+    /// is only consumed when it fits the buffer, or -1 when the ring is empty and on_ready is called for the next
+    /// record.
+    ///
+    EXPORT int64_t wew_ring_read(void *ring, void *buffer, uint32_t size);
+
+    ///
+    /// Turn paint flashing on or off while the webview runs, see WebViewSettings::paint_flashing. Turning it off
+    /// repaints the whole view without the tints.
+    ///
+    EXPORT void webview_set_paint_flashing(void *webview, bool enable);
+
+    ///
+    /// Set the memory budget of a subsystem, or of the whole webview with WEW_MEMORY_TOTAL. Zero means unlimited.
+    ///
+    /// Going over a budget evicts what the subsystem can rebuild, such as pooled frame buffers.
+    ///
+    EXPORT void webview_set_memory_budget(void *webview, MemorySubsystem subsystem, uint64_t bytes);
+
     ///
     /// Cookie management functions
     ///
@@ -685,6 +1269,90 @@ extern "C"
     
     EXPORT bool wew_flush_cookie_store(void *manager);
 
+    ///
+    /// Blob functions
+    ///
+    /// Serves size bytes at data under a URL, with the mime type. Requests for the URL through the custom scheme or a
+    /// webview's request handler are answered from that memory, with single byte ranges, and without calling the
+    /// host. A blob registered under the URL before is replaced.
+    ///
+    /// The memory must stay valid and unchanged until release is called, once the blob is unregistered or replaced and
+    /// no request reads it anymore. It may be called on a CEF IO thread.
+    ///
+    EXPORT void wew_register_blob(const char *url,
+                                  const void *data,
+                                  size_t size,
+                                  const char *mime_type,
+                                  void (*release)(const void *data, void *context),
+                                  void *context);
+
+    ///
+    /// Returns false when no blob is registered under the URL.
+    ///
+    EXPORT bool wew_unregister_blob(const char *url);
+
+    ///
+    /// Directory watcher functions
+    ///
+    /// Watches a directory and its subdirectories, such as the root a custom scheme serves files from, so caches in
+    /// front of it are invalidated for exactly the changed paths. The observer is copied. Only supported on Linux.
+    ///
+    /// Returns the identifier for wew_unwatch_directory, -1 when the directory cannot be watched.
+    ///
+    EXPORT int wew_watch_directory(const char *path, const DirectoryObserver *observer);
+
+    ///
+    /// The observer is no longer called once this returns. Must not be called from the observer of the watch.
+    ///
+    EXPORT void wew_unwatch_directory(int id);
+
+    ///
+    /// Message bus functions
+    ///
+    /// Pages publish with MessageBus.publish(channel, message) and receive with MessageBus.subscribe(channel,
+    /// callback), the callback is called with the message and the channel. The browser process forwards a message to
+    /// the other pages subscribed to the channel, in every webview of the process with WebViewSettings::message_bus,
+    /// without calling the host.
+    ///
+    /// Publishes a message of the host to every page subscribed to the channel, from any thread.
+    ///
+    EXPORT void wew_bus_publish(const char *channel, const char *message);
+
+    ///
+    /// Observes the messages pages publish to a channel, the observer is copied. Returns the identifier for
+    /// wew_bus_unobserve, the observer is no longer called once that returns.
+    ///
+    EXPORT int wew_bus_observe(const char *channel, const BusObserver *observer);
+
+    EXPORT void wew_bus_unobserve(int id);
+
+    ///
+    /// Metrics functions
+    ///
+    /// Copies up to capacity metrics into the array and returns the total number of metrics, call it with a zero
+    /// capacity to query the required size.
+    ///
+    EXPORT size_t wew_metrics_snapshot(Metric *metrics, size_t capacity);
+
+    ///
+    /// Writes the metrics in the Prometheus text exposition format, truncated and null terminated like snprintf.
+    ///
+    /// Returns the length of the full text excluding the null terminator.
+    ///
+    EXPORT size_t wew_metrics_prometheus(char *buffer, size_t size);
+
+    ///
+    /// Sets the handler notified when a host callback blocks its CEF thread for longer than the threshold, the
+    /// handler is copied. Pass nullptr to stop the reports, every callback duration is still recorded as a metric.
+    ///
+    EXPORT void wew_set_slow_callback_handler(const SlowCallbackHandler *handler);
+
+    ///
+    /// Drains the recorded library spans into a Chrome trace event JSON file, which chrome://tracing and Perfetto
+    /// open. Spans are only recorded when the library is built with WEW_TRACING, otherwise this returns false.
+    ///
+    EXPORT bool wew_trace_flush(const char *path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,433 @@
+//
+//  wew.hpp
+//  webview
+//
+//  Header-only C++17 API over wew.h. Handlers are plain classes whose methods are found at compile time, every
+//  implemented method gets a direct, inlinable trampoline and every missing one is left null so the library never
+//  calls it.
+//
+//  struct Observer
+//  {
+//      void on_frame(const Frame &frame);
+//      void on_message(std::string_view message);
+//  };
+//
+//  Observer observer;
+//  wew::WebView<Observer> webview(runtime, "https://example.com", settings, observer);
+//
+
+#ifndef wew_hpp
+#define wew_hpp
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "wew.h"
+
+namespace wew
+{
+namespace detail
+{
+#define WEW_DETECT_METHOD(name)                                                                                        \
+    template <typename T, typename Args, typename = void> struct has_##name : std::false_type                        \
+    {                                                                                                                  \
+    };                                                                                                                 \
+                                                                                                                       \
+    template <typename T, typename... Args>                                                                            \
+    struct has_##name<T,                                                                                               \
+                      void(Args...),                                                                                   \
+                      std::void_t<decltype(std::declval<T &>().name(std::declval<Args>()...))>> : std::true_type        \
+    {                                                                                                                  \
+    };
+
+WEW_DETECT_METHOD(on_context_initialized)
+WEW_DETECT_METHOD(on_schedule_message_pump_work)
+WEW_DETECT_METHOD(on_cursor)
+WEW_DETECT_METHOD(on_state_change)
+WEW_DETECT_METHOD(on_ime_rect)
+WEW_DETECT_METHOD(on_frame)
+WEW_DETECT_METHOD(on_title_change)
+WEW_DETECT_METHOD(on_fullscreen_change)
+WEW_DETECT_METHOD(on_message)
+WEW_DETECT_METHOD(on_cursor_image)
+WEW_DETECT_METHOD(open)
+WEW_DETECT_METHOD(skip)
+WEW_DETECT_METHOD(read)
+WEW_DETECT_METHOD(get_response)
+WEW_DETECT_METHOD(cancel)
+
+#undef WEW_DETECT_METHOD
+
+#define WEW_IMPLEMENTS(name, signature) detail::has_##name<T, signature>::value
+
+template <typename T> struct RuntimeDispatch
+{
+    static void on_context_initialized(void *context)
+    {
+        static_cast<T *>(context)->on_context_initialized();
+    }
+
+    static void on_schedule_message_pump_work(int64_t delay_ms, void *context)
+    {
+        static_cast<T *>(context)->on_schedule_message_pump_work(delay_ms);
+    }
+};
+
+template <typename T> struct WebViewDispatch
+{
+    static void on_cursor(CursorType type, void *context)
+    {
+        static_cast<T *>(context)->on_cursor(type);
+    }
+
+    static void on_state_change(WebViewState state, void *context)
+    {
+        static_cast<T *>(context)->on_state_change(state);
+    }
+
+    static void on_ime_rect(Rect rect, void *context)
+    {
+        static_cast<T *>(context)->on_ime_rect(rect);
+    }
+
+    static void on_frame(const Frame *frame, void *context)
+    {
+        static_cast<T *>(context)->on_frame(*frame);
+    }
+
+    static void on_title_change(const char *title, void *context)
+    {
+        static_cast<T *>(context)->on_title_change(std::string_view(title));
+    }
+
+    static void on_fullscreen_change(bool fullscreen, void *context)
+    {
+        static_cast<T *>(context)->on_fullscreen_change(fullscreen);
+    }
+
+    static void on_message(const char *message, void *context)
+    {
+        static_cast<T *>(context)->on_message(std::string_view(message));
+    }
+
+    static void on_cursor_image(const CursorImage *image, void *context)
+    {
+        static_cast<T *>(context)->on_cursor_image(*image);
+    }
+};
+
+///
+/// The C request handler table and the C++ handler it dispatches to, allocated together per request.
+///
+template <typename T> struct RequestHandlerBox
+{
+    RequestHandler table;
+    std::unique_ptr<T> handler;
+
+    static bool open(void *context)
+    {
+        if constexpr (WEW_IMPLEMENTS(open, void()))
+        {
+            return static_cast<RequestHandlerBox *>(context)->handler->open();
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    static bool skip(size_t size, int *cursor, void *context)
+    {
+        if constexpr (WEW_IMPLEMENTS(skip, void(size_t, int &)))
+        {
+            return static_cast<RequestHandlerBox *>(context)->handler->skip(size, *cursor);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    static bool read(uint8_t *buffer, size_t size, int *cursor, void *context)
+    {
+        return static_cast<RequestHandlerBox *>(context)->handler->read(buffer, size, *cursor);
+    }
+
+    static void get_response(Response *response, void *context)
+    {
+        static_cast<RequestHandlerBox *>(context)->handler->get_response(*response);
+    }
+
+    static void cancel(void *context)
+    {
+        if constexpr (WEW_IMPLEMENTS(cancel, void()))
+        {
+            static_cast<RequestHandlerBox *>(context)->handler->cancel();
+        }
+    }
+
+    static void destroy(void *context)
+    {
+        static_cast<RequestHandlerBox *>(context)->handler.reset();
+    }
+};
+
+template <typename F> struct RequestHandlerFactoryDispatch
+{
+    using Handler = typename decltype(std::declval<F &>().request(std::declval<const Request &>()))::element_type;
+    using Box = RequestHandlerBox<Handler>;
+
+    static RequestHandler *request(Request *request, void *context)
+    {
+        std::unique_ptr<Handler> handler = static_cast<F *>(context)->request(*request);
+        if (handler == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto box = new Box();
+        box->handler = std::move(handler);
+        box->table.open = Box::open;
+        box->table.skip = Box::skip;
+        box->table.read = Box::read;
+        box->table.get_response = Box::get_response;
+        box->table.cancel = Box::cancel;
+        box->table.destroy = Box::destroy;
+        box->table.context = box;
+
+        return &box->table;
+    }
+
+    static void destroy_request_handler(RequestHandler *handler)
+    {
+        delete static_cast<Box *>(handler->context);
+    }
+};
+} // namespace detail
+
+///
+/// Builds a runtime handler table for T, on_context_initialized() and on_schedule_message_pump_work(int64_t) are
+/// both optional.
+///
+template <typename T> RuntimeHandler make_runtime_handler(T &handler)
+{
+    RuntimeHandler table{};
+    table.context = &handler;
+
+    if constexpr (WEW_IMPLEMENTS(on_context_initialized, void()))
+    {
+        table.on_context_initialized = detail::RuntimeDispatch<T>::on_context_initialized;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_schedule_message_pump_work, void(int64_t)))
+    {
+        table.on_schedule_message_pump_work = detail::RuntimeDispatch<T>::on_schedule_message_pump_work;
+    }
+
+    return table;
+}
+
+///
+/// Builds a webview handler table for T, only the methods T implements are set:
+///
+/// on_cursor(CursorType), on_state_change(WebViewState), on_ime_rect(Rect), on_frame(const Frame &),
+/// on_title_change(std::string_view), on_fullscreen_change(bool), on_message(std::string_view) and
+/// on_cursor_image(const CursorImage &).
+///
+template <typename T> WebViewHandler make_webview_handler(T &handler)
+{
+    using Dispatch = detail::WebViewDispatch<T>;
+
+    WebViewHandler table{};
+    table.context = &handler;
+
+    if constexpr (WEW_IMPLEMENTS(on_cursor, void(CursorType)))
+    {
+        table.on_cursor = Dispatch::on_cursor;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_state_change, void(WebViewState)))
+    {
+        table.on_state_change = Dispatch::on_state_change;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_ime_rect, void(Rect)))
+    {
+        table.on_ime_rect = Dispatch::on_ime_rect;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_frame, void(const Frame &)))
+    {
+        table.on_frame = Dispatch::on_frame;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_title_change, void(std::string_view)))
+    {
+        table.on_title_change = Dispatch::on_title_change;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_fullscreen_change, void(bool)))
+    {
+        table.on_fullscreen_change = Dispatch::on_fullscreen_change;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_message, void(std::string_view)))
+    {
+        table.on_message = Dispatch::on_message;
+    }
+
+    if constexpr (WEW_IMPLEMENTS(on_cursor_image, void(const CursorImage &)))
+    {
+        table.on_cursor_image = Dispatch::on_cursor_image;
+    }
+
+    return table;
+}
+
+///
+/// Builds a request handler factory table for F. F::request(const Request &) returns a std::unique_ptr to a handler
+/// with read(uint8_t *, size_t, int &) and get_response(Response &), and optionally open(), skip(size_t, int &) and
+/// cancel().
+///
+template <typename F> RequestHandlerFactory make_request_handler_factory(F &factory)
+{
+    using Dispatch = detail::RequestHandlerFactoryDispatch<F>;
+
+    RequestHandlerFactory table{};
+    table.request = Dispatch::request;
+    table.destroy_request_handler = Dispatch::destroy_request_handler;
+    table.context = &factory;
+
+    return table;
+}
+
+#undef WEW_IMPLEMENTS
+
+///
+/// Owns a runtime created with create_runtime, the handler must outlive it.
+///
+template <typename T> class Runtime
+{
+  public:
+    Runtime(const RuntimeSettings &settings, T &handler)
+        : _raw(create_runtime(&settings, make_runtime_handler(handler)))
+    {
+    }
+
+    ~Runtime()
+    {
+        if (_raw != nullptr)
+        {
+            close_runtime(_raw);
+        }
+    }
+
+    Runtime(const Runtime &) = delete;
+    Runtime &operator=(const Runtime &) = delete;
+
+    bool execute(int argc, const char **argv)
+    {
+        return execute_runtime(_raw, argc, argv);
+    }
+
+    void *get() const
+    {
+        return _raw;
+    }
+
+  private:
+    void *_raw;
+};
+
+///
+/// Owns a webview created with create_webview, the handler must outlive it.
+///
+template <typename T> class WebView
+{
+  public:
+    WebView(void *runtime, const char *url, const WebViewSettings &settings, T &handler)
+        : _raw(create_webview(runtime, url, &settings, make_webview_handler(handler)))
+    {
+    }
+
+    ~WebView()
+    {
+        if (_raw != nullptr)
+        {
+            close_webview(_raw);
+        }
+    }
+
+    WebView(const WebView &) = delete;
+    WebView &operator=(const WebView &) = delete;
+
+    explicit operator bool() const
+    {
+        return _raw != nullptr;
+    }
+
+    void *get() const
+    {
+        return _raw;
+    }
+
+    void send_message(const char *message)
+    {
+        webview_send_message(_raw, message);
+    }
+
+    void send_message(const std::string &message)
+    {
+        webview_send_message(_raw, message.c_str());
+    }
+
+    void mouse_click(MouseEvent event, MouseButton button, bool pressed)
+    {
+        webview_mouse_click(_raw, event, button, pressed);
+    }
+
+    void mouse_wheel(MouseEvent event, int x, int y)
+    {
+        webview_mouse_wheel(_raw, event, x, y);
+    }
+
+    void mouse_move(MouseEvent event)
+    {
+        webview_mouse_move(_raw, event);
+    }
+
+    void keyboard(KeyEvent event)
+    {
+        webview_keyboard(_raw, event);
+    }
+
+    void touch(TouchEvent event)
+    {
+        webview_touch(_raw, event);
+    }
+
+    void resize(int width, int height)
+    {
+        webview_resize(_raw, width, height);
+    }
+
+    void set_focus(bool enable)
+    {
+        webview_set_focus(_raw, enable);
+    }
+
+    void set_devtools_state(bool is_open)
+    {
+        webview_set_devtools_state(_raw, is_open);
+    }
+
+  private:
+    void *_raw;
+};
+} // namespace wew
+
+#endif /* wew_hpp */
@@ -0,0 +1,335 @@
+//! MessageTransport round trip benchmark.
+//!
+//! Loads a page served from a custom scheme that echoes every
+//! `MessageTransport` message back to the host, then measures the round trip
+//! time percentiles and the sustained message rate for payloads from 16 B to
+//! 16 MB. Messages travel through `IWebView::SendMessage` -> `ISubProcess` ->
+//! `MessageSender` and back to `on_message`.
+//!
+//! Every payload size produces one JSON object per line on stdout:
+//!
+//! ```text
+//! {"size":16,"samples":1000,"rtt_us":{"min":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..},
+//!  "throughput":{"window":64,"messages":4096,"messages_per_sec":..,"mib_per_sec":..}}
+//! ```
+
+use std::{
+    sync::mpsc::{Receiver, Sender, channel},
+    thread,
+    time::{Duration, Instant},
+};
+
+use parking_lot::Mutex;
+use wew::{
+    MainThreadMessageLoop, MessageLoopAbstract, WindowlessRenderWebView,
+    request::{
+        CustomRequestHandlerFactory, CustomSchemeAttributes, Request, RequestHandler,
+        RequestHandlerFactory, Response,
+    },
+    runtime::{LogLevel, Runtime, RuntimeHandler},
+    utils::post_main,
+    webview::{
+        WebView, WebViewAttributesBuilder, WebViewHandler, WebViewState,
+        WindowlessRenderWebViewHandler,
+    },
+};
+
+const PAGE: &str = include_str!("./page.html");
+
+const PAGE_URL: &str = "bench://localhost/index.html";
+
+const SIZES: &[usize] = &[
+    16,
+    256,
+    4 * 1024,
+    64 * 1024,
+    1024 * 1024,
+    4 * 1024 * 1024,
+    16 * 1024 * 1024,
+];
+
+// Number of messages kept in flight when measuring the sustained rate.
+const WINDOW: usize = 64;
+
+// Upper bound of the bytes sent per size and phase, keeps the large payloads
+// from dominating the run time.
+const BYTES_PER_PHASE: usize = 256 * 1024 * 1024;
+
+const TIMEOUT: Duration = Duration::from_secs(30);
+
+// Serves the embedded echo page for every request on the benchmark scheme.
+struct PageRequestHandler {
+    cursor: usize,
+}
+
+impl RequestHandler for PageRequestHandler {
+    fn open(&mut self) -> bool {
+        self.cursor = 0;
+
+        true
+    }
+
+    fn get_response(&mut self) -> Option<Response> {
+        Some(Response {
+            status_code: 200,
+            content_length: PAGE.len() as u64,
+            mime_type: "text/html".to_string(),
+        })
+    }
+
+    fn skip(&mut self, size: usize) -> Option<usize> {
+        let size = size.min(PAGE.len() - self.cursor);
+        self.cursor += size;
+
+        Some(size)
+    }
+
+    fn read(&mut self, buffer: &mut [u8]) -> Option<usize> {
+        let size = buffer.len().min(PAGE.len() - self.cursor);
+        buffer[..size].copy_from_slice(&PAGE.as_bytes()[self.cursor..self.cursor + size]);
+        self.cursor += size;
+
+        Some(size)
+    }
+
+    fn cancel(&mut self) {}
+}
+
+struct PageRequestHandlerFactory;
+
+impl RequestHandlerFactory for PageRequestHandlerFactory {
+    fn request(&self, _: &Request) -> Option<Box<dyn RequestHandler>> {
+        Some(Box::new(PageRequestHandler { cursor: 0 }))
+    }
+}
+
+struct WebViewObserver {
+    loaded: Mutex<Option<Sender<()>>>,
+    // Only the length of the echo is forwarded, the payload itself is not
+    // needed and copying it would skew the large sizes.
+    echo: Mutex<Sender<usize>>,
+}
+
+impl WebViewHandler for WebViewObserver {
+    fn on_state_change(&self, state: WebViewState) {
+        if state == WebViewState::Loaded {
+            if let Some(tx) = self.loaded.lock().take() {
+                let _ = tx.send(());
+            }
+        }
+    }
+
+    fn on_message(&self, message: &str) {
+        let _ = self.echo.lock().send(message.len());
+    }
+}
+
+impl WindowlessRenderWebViewHandler for WebViewObserver {}
+
+struct RuntimeObserver {
+    tx: Sender<()>,
+}
+
+impl RuntimeHandler for RuntimeObserver {
+    fn on_context_initialized(&self) {
+        let _ = self.tx.send(());
+    }
+}
+
+struct Latency {
+    min: f64,
+    mean: f64,
+    p50: f64,
+    p90: f64,
+    p99: f64,
+    max: f64,
+}
+
+impl Latency {
+    fn new(mut samples: Vec<f64>) -> Self {
+        samples.sort_by(|a, b| a.partial_cmp(b).unwrap());
+
+        let percentile = |p: f64| samples[((samples.len() - 1) as f64 * p).round() as usize];
+
+        Self {
+            min: samples[0],
+            mean: samples.iter().sum::<f64>() / samples.len() as f64,
+            p50: percentile(0.5),
+            p90: percentile(0.9),
+            p99: percentile(0.99),
+            max: samples[samples.len() - 1],
+        }
+    }
+}
+
+fn wait_echo(echo: &Receiver<usize>, size: usize) -> Option<()> {
+    let len = echo.recv_timeout(TIMEOUT).ok()?;
+    assert_eq!(len, size, "echo payload size mismatch");
+
+    Some(())
+}
+
+fn measure_rtt(
+    webview: &WebView<WindowlessRenderWebView>,
+    echo: &Receiver<usize>,
+    payload: &str,
+) -> Option<Vec<f64>> {
+    let samples = (BYTES_PER_PHASE / payload.len()).clamp(10, 1000);
+
+    let mut rtts = Vec::with_capacity(samples);
+    for _ in 0..samples {
+        let start = Instant::now();
+
+        webview.send_message(payload);
+        wait_echo(echo, payload.len())?;
+
+        rtts.push(start.elapsed().as_secs_f64() * 1_000_000.0);
+    }
+
+    Some(rtts)
+}
+
+fn measure_throughput(
+    webview: &WebView<WindowlessRenderWebView>,
+    echo: &Receiver<usize>,
+    payload: &str,
+) -> Option<(usize, Duration)> {
+    let messages = (BYTES_PER_PHASE / payload.len()).clamp(16, WINDOW * 64);
+
+    let start = Instant::now();
+
+    let mut sent = 0;
+    let mut received = 0;
+    while received < messages {
+        while sent < messages && sent - received < WINDOW {
+            webview.send_message(payload);
+            sent += 1;
+        }
+
+        wait_echo(echo, payload.len())?;
+        received += 1;
+    }
+
+    Some((messages, start.elapsed()))
+}
+
+fn run(runtime: &Runtime<MainThreadMessageLoop, WindowlessRenderWebView>) -> Option<()> {
+    let (loaded_tx, loaded_rx) = channel();
+    let (echo_tx, echo_rx) = channel();
+    let (webview_tx, webview_rx) = channel();
+
+    {
+        let runtime = runtime.clone();
+
+        post_main(move || {
+            let webview = runtime.create_webview(
+                PAGE_URL,
+                WebViewAttributesBuilder::default()
+                    .with_width(64)
+                    .with_height(64)
+                    .with_windowless_frame_rate(1)
+                    .build(),
+                WebViewObserver {
+                    loaded: Mutex::new(Some(loaded_tx)),
+                    echo: Mutex::new(echo_tx),
+                },
+            );
+
+            let _ = webview_tx.send(webview.ok());
+        });
+    }
+
+    let webview = webview_rx.recv().ok()??;
+    let result = (|| {
+        loaded_rx.recv_timeout(TIMEOUT).ok()?;
+
+        for &size in SIZES {
+            let payload = "x".repeat(size);
+
+            // Warm up the channel and the page before measuring.
+            measure_rtt(&webview, &echo_rx, &payload[..size.min(1024)])?;
+
+            let rtts = measure_rtt(&webview, &echo_rx, &payload)?;
+            let samples = rtts.len();
+            let latency = Latency::new(rtts);
+            let (messages, elapsed) = measure_throughput(&webview, &echo_rx, &payload)?;
+
+            let messages_per_sec = messages as f64 / elapsed.as_secs_f64();
+            println!(
+                concat!(
+                    "{{\"size\":{},\"samples\":{},",
+                    "\"rtt_us\":{{\"min\":{:.1},\"mean\":{:.1},\"p50\":{:.1},\"p90\":{:.1},\"p99\":{:.1},\"max\":{:.1}}},",
+                    "\"throughput\":{{\"window\":{},\"messages\":{},\"messages_per_sec\":{:.1},\"mib_per_sec\":{:.2}}}}}"
+                ),
+                size,
+                samples,
+                latency.min,
+                latency.mean,
+                latency.p50,
+                latency.p90,
+                latency.p99,
+                latency.max,
+                WINDOW,
+                messages,
+                messages_per_sec,
+                messages_per_sec * size as f64 / (1024.0 * 1024.0),
+            );
+        }
+
+        Some(())
+    })();
+
+    post_main(move || drop(webview));
+
+    result
+}
+
+fn main() {
+    if wew::is_subprocess() {
+        wew::execute_subprocess();
+
+        return;
+    }
+
+    #[cfg(target_os = "macos")]
+    wew::utils::inject_nsapplication();
+
+    let message_loop = MainThreadMessageLoop::default();
+
+    let mut runtime_attributes_builder =
+        message_loop.create_runtime_attributes_builder::<WindowlessRenderWebView>();
+
+    runtime_attributes_builder = runtime_attributes_builder
+        .with_custom_scheme(CustomSchemeAttributes::new(
+            "bench",
+            "localhost",
+            CustomRequestHandlerFactory::new(PageRequestHandlerFactory),
+        ))
+        // Set cache path, here we use environment variables passed by the build script.
+        .with_root_cache_path(option_env!("CACHE_PATH").unwrap())
+        .with_cache_path(option_env!("CACHE_PATH").unwrap())
+        .with_log_severity(LogLevel::Error);
+
+    let (tx, rx) = channel();
+
+    let runtime = runtime_attributes_builder
+        .build()
+        .create_runtime(RuntimeObserver { tx })
+        .unwrap();
+
+    thread::spawn(move || {
+        rx.recv().unwrap();
+
+        if run(&runtime).is_none() {
+            eprintln!("message benchmark timed out waiting for the echo page");
+        }
+
+        post_main(move || {
+            drop(runtime);
+
+            message_loop.quit();
+        });
+    });
+
+    message_loop.block_run();
+}
@@ -0,0 +1,393 @@
+//! Off-screen rendering throughput benchmark.
+//!
+//! Loads an animated page served from a custom scheme, so no network is
+//! involved, and measures the frames delivered through `on_frame` at several
+//! resolutions and `windowless_frame_rate` values: achieved fps, paint
+//! interval jitter, bytes per second and browser process CPU time per frame.
+//!
+//! ```text
+//! osr-benchmark [--duration <seconds>]
+//! ```
+
+use std::{
+    sync::{
+        Arc,
+        mpsc::{Sender, channel},
+    },
+    thread,
+    time::{Duration, Instant},
+};
+
+use parking_lot::Mutex;
+use wew::{
+    MainThreadMessageLoop, MessageLoopAbstract, WindowlessRenderWebView,
+    request::{
+        CustomRequestHandlerFactory, CustomSchemeAttributes, Request, RequestHandler,
+        RequestHandlerFactory, Response,
+    },
+    runtime::{LogLevel, RuntimeHandler},
+    utils::post_main,
+    webview::{
+        Frame, WebViewAttributesBuilder, WebViewHandler, WebViewState,
+        WindowlessRenderWebViewHandler,
+    },
+};
+
+const PAGE: &str = include_str!("./page.html");
+
+const PAGE_URL: &str = "bench://localhost/index.html";
+
+const WARMUP: Duration = Duration::from_secs(2);
+
+struct Scenario {
+    name: &'static str,
+    width: u32,
+    height: u32,
+    frame_rate: u32,
+}
+
+const SCENARIOS: &[Scenario] = &[
+    Scenario {
+        name: "1080p",
+        width: 1920,
+        height: 1080,
+        frame_rate: 24,
+    },
+    Scenario {
+        name: "1080p",
+        width: 1920,
+        height: 1080,
+        frame_rate: 30,
+    },
+    Scenario {
+        name: "1080p",
+        width: 1920,
+        height: 1080,
+        frame_rate: 60,
+    },
+    Scenario {
+        name: "4k",
+        width: 3840,
+        height: 2160,
+        frame_rate: 24,
+    },
+    Scenario {
+        name: "4k",
+        width: 3840,
+        height: 2160,
+        frame_rate: 30,
+    },
+    Scenario {
+        name: "4k",
+        width: 3840,
+        height: 2160,
+        frame_rate: 60,
+    },
+];
+
+// Serves the embedded test page for every request on the benchmark scheme.
+struct PageRequestHandler {
+    cursor: usize,
+}
+
+impl RequestHandler for PageRequestHandler {
+    fn open(&mut self) -> bool {
+        self.cursor = 0;
+
+        true
+    }
+
+    fn get_response(&mut self) -> Option<Response> {
+        Some(Response {
+            status_code: 200,
+            content_length: PAGE.len() as u64,
+            mime_type: "text/html".to_string(),
+        })
+    }
+
+    fn skip(&mut self, size: usize) -> Option<usize> {
+        let size = size.min(PAGE.len() - self.cursor);
+        self.cursor += size;
+
+        Some(size)
+    }
+
+    fn read(&mut self, buffer: &mut [u8]) -> Option<usize> {
+        let size = buffer.len().min(PAGE.len() - self.cursor);
+        buffer[..size].copy_from_slice(&PAGE.as_bytes()[self.cursor..self.cursor + size]);
+        self.cursor += size;
+
+        Some(size)
+    }
+
+    fn cancel(&mut self) {}
+}
+
+struct PageRequestHandlerFactory;
+
+impl RequestHandlerFactory for PageRequestHandlerFactory {
+    fn request(&self, _: &Request) -> Option<Box<dyn RequestHandler>> {
+        Some(Box::new(PageRequestHandler { cursor: 0 }))
+    }
+}
+
+#[derive(Default)]
+struct FrameStats {
+    frames: u64,
+    bytes: u64,
+    last: Option<Instant>,
+    intervals: Vec<Duration>,
+}
+
+struct WebViewObserver {
+    stats: Arc<Mutex<FrameStats>>,
+    loaded: Mutex<Option<Sender<()>>>,
+}
+
+impl WebViewHandler for WebViewObserver {
+    fn on_state_change(&self, state: WebViewState) {
+        if state == WebViewState::Loaded {
+            if let Some(tx) = self.loaded.lock().take() {
+                let _ = tx.send(());
+            }
+        }
+    }
+}
+
+impl WindowlessRenderWebViewHandler for WebViewObserver {
+    fn on_frame(&self, frame: &Frame) {
+        let now = Instant::now();
+
+        let mut stats = self.stats.lock();
+        stats.frames += 1;
+        stats.bytes += frame.buffer.len() as u64;
+
+        if let Some(last) = stats.last.replace(now) {
+            stats.intervals.push(now - last);
+        }
+    }
+}
+
+struct RuntimeObserver {
+    tx: Sender<()>,
+}
+
+impl RuntimeHandler for RuntimeObserver {
+    fn on_context_initialized(&self) {
+        let _ = self.tx.send(());
+    }
+}
+
+// Process CPU time (user + system) of the browser process. The renderer and
+// GPU processes are not included.
+#[cfg(unix)]
+fn cpu_time() -> Option<Duration> {
+    let mut usage: libc::rusage = unsafe { std::mem::zeroed() };
+    if unsafe { libc::getrusage(libc::RUSAGE_SELF, &mut usage) } != 0 {
+        return None;
+    }
+
+    let to_duration = |it: libc::timeval| {
+        Duration::from_secs(it.tv_sec as u64) + Duration::from_micros(it.tv_usec as u64)
+    };
+
+    Some(to_duration(usage.ru_utime) + to_duration(usage.ru_stime))
+}
+
+#[cfg(not(unix))]
+fn cpu_time() -> Option<Duration> {
+    None
+}
+
+struct Report {
+    fps: f64,
+    interval_mean_ms: f64,
+    interval_p50_ms: f64,
+    interval_p99_ms: f64,
+    jitter_ms: f64,
+    mib_per_sec: f64,
+    cpu_ms_per_frame: Option<f64>,
+}
+
+impl Report {
+    fn new(stats: &FrameStats, elapsed: Duration, cpu: Option<Duration>) -> Self {
+        let mut intervals = stats
+            .intervals
+            .iter()
+            .map(|it| it.as_secs_f64() * 1000.0)
+            .collect::<Vec<_>>();
+
+        intervals.sort_by(|a, b| a.partial_cmp(b).unwrap());
+
+        let percentile = |p: f64| {
+            if intervals.is_empty() {
+                0.0
+            } else {
+                intervals[((intervals.len() - 1) as f64 * p).round() as usize]
+            }
+        };
+
+        let mean = intervals.iter().sum::<f64>() / intervals.len().max(1) as f64;
+        let variance = intervals.iter().map(|it| (it - mean).powi(2)).sum::<f64>()
+            / intervals.len().max(1) as f64;
+
+        Self {
+            fps: stats.frames as f64 / elapsed.as_secs_f64(),
+            interval_mean_ms: mean,
+            interval_p50_ms: percentile(0.5),
+            interval_p99_ms: percentile(0.99),
+            jitter_ms: variance.sqrt(),
+            mib_per_sec: stats.bytes as f64 / elapsed.as_secs_f64() / (1024.0 * 1024.0),
+            cpu_ms_per_frame: cpu.map(|it| it.as_secs_f64() * 1000.0 / stats.frames.max(1) as f64),
+        }
+    }
+}
+
+fn run_scenario(
+    runtime: &wew::runtime::Runtime<MainThreadMessageLoop, WindowlessRenderWebView>,
+    scenario: &Scenario,
+    duration: Duration,
+) -> Option<Report> {
+    let stats = Arc::new(Mutex::new(FrameStats::default()));
+
+    let (loaded_tx, loaded_rx) = channel();
+    let (webview_tx, webview_rx) = channel();
+
+    // Windowless webviews are created and destroyed on the UI thread.
+    {
+        let runtime = runtime.clone();
+        let stats = stats.clone();
+        let (width, height, frame_rate) = (scenario.width, scenario.height, scenario.frame_rate);
+
+        post_main(move || {
+            let webview = runtime.create_webview(
+                PAGE_URL,
+                WebViewAttributesBuilder::default()
+                    .with_width(width)
+                    .with_height(height)
+                    .with_windowless_frame_rate(frame_rate)
+                    .build(),
+                WebViewObserver {
+                    stats,
+                    loaded: Mutex::new(Some(loaded_tx)),
+                },
+            );
+
+            let _ = webview_tx.send(webview.ok());
+        });
+    }
+
+    let webview = webview_rx.recv().ok()??;
+    if loaded_rx.recv_timeout(Duration::from_secs(30)).is_err() {
+        post_main(move || drop(webview));
+
+        return None;
+    }
+
+    thread::sleep(WARMUP);
+
+    *stats.lock() = FrameStats::default();
+
+    let cpu_start = cpu_time();
+    let start = Instant::now();
+
+    thread::sleep(duration);
+
+    let elapsed = start.elapsed();
+    let cpu = cpu_time().zip(cpu_start).map(|(end, start)| end - start);
+    let report = Report::new(&stats.lock(), elapsed, cpu);
+
+    post_main(move || drop(webview));
+
+    Some(report)
+}
+
+fn main() {
+    if wew::is_subprocess() {
+        wew::execute_subprocess();
+
+        return;
+    }
+
+    #[cfg(target_os = "macos")]
+    wew::utils::inject_nsapplication();
+
+    let duration = std::env::args()
+        .skip_while(|it| it != "--duration")
+        .nth(1)
+        .and_then(|it| it.parse().ok())
+        .map(Duration::from_secs)
+        .unwrap_or(Duration::from_secs(10));
+
+    let message_loop = MainThreadMessageLoop::default();
+
+    let mut runtime_attributes_builder =
+        message_loop.create_runtime_attributes_builder::<WindowlessRenderWebView>();
+
+    runtime_attributes_builder = runtime_attributes_builder
+        .with_custom_scheme(CustomSchemeAttributes::new(
+            "bench",
+            "localhost",
+            CustomRequestHandlerFactory::new(PageRequestHandlerFactory),
+        ))
+        // Set cache path, here we use environment variables passed by the build script.
+        .with_root_cache_path(option_env!("CACHE_PATH").unwrap())
+        .with_cache_path(option_env!("CACHE_PATH").unwrap())
+        .with_log_severity(LogLevel::Error);
+
+    let (tx, rx) = channel();
+
+    let runtime = runtime_attributes_builder
+        .build()
+        .create_runtime(RuntimeObserver { tx })
+        .unwrap();
+
+    thread::spawn(move || {
+        rx.recv().unwrap();
+
+        println!(
+            "{:<8} {:>6} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>12}",
+            "size",
+            "target",
+            "fps",
+            "mean ms",
+            "p50 ms",
+            "p99 ms",
+            "jitter ms",
+            "MiB/s",
+            "cpu ms/frame"
+        );
+
+        for scenario in SCENARIOS {
+            match run_scenario(&runtime, scenario, duration) {
+                Some(report) => println!(
+                    "{:<8} {:>6} {:>8.2} {:>10.2} {:>10.2} {:>10.2} {:>10.2} {:>10.1} {:>12}",
+                    scenario.name,
+                    scenario.frame_rate,
+                    report.fps,
+                    report.interval_mean_ms,
+                    report.interval_p50_ms,
+                    report.interval_p99_ms,
+                    report.jitter_ms,
+                    report.mib_per_sec,
+                    report
+                        .cpu_ms_per_frame
+                        .map(|it| format!("{:.3}", it))
+                        .unwrap_or_else(|| "n/a".to_string()),
+                ),
+                None => println!(
+                    "{:<8} {:>6} failed to load the test page",
+                    scenario.name, scenario.frame_rate
+                ),
+            }
+        }
+
+        post_main(move || {
+            drop(runtime);
+
+            message_loop.quit();
+        });
+    });
+
+    message_loop.block_run();
+}
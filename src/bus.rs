@@ -0,0 +1,98 @@
+//! Message bus between pages.
+//!
+//! Pages publish to named channels with
+//! `MessageBus.publish(channel, message)` and receive the messages of a
+//! channel with `MessageBus.subscribe(channel, callback)`, the callback is
+//! called with the message and the channel. The browser process forwards each
+//! message straight to the other pages subscribed to the channel, in every
+//! webview on the bus, without going through the host. A control panel page
+//! can drive display pages without a router in the application.
+//!
+//! Only the webviews built with
+//! `WebViewAttributesBuilder::with_message_bus` are on the bus, a page on it
+//! reads and publishes every channel.
+//!
+//! ## Example
+//!
+//! ```no_run
+//! // The host can publish to the pages as well.
+//! wew::bus::publish("display", "show");
+//!
+//! // And observe a channel, until the observation is dropped.
+//! let observation = wew::bus::observe("display", |channel, message| {
+//!     println!("{}: {}", channel, message);
+//! });
+//! ```
+
+use std::ffi::{CStr, CString, c_char, c_int, c_void};
+
+use crate::sys;
+
+type BusCallback = Box<dyn Fn(&str, &str) + Send + Sync>;
+
+/// Publish a message to every page subscribed to the channel
+///
+/// Can be called from any thread.
+pub fn publish(channel: &str, message: &str) {
+    let (Ok(channel), Ok(message)) = (CString::new(channel), CString::new(message)) else {
+        return;
+    };
+
+    unsafe { sys::wew_bus_publish(channel.as_ptr(), message.as_ptr()) }
+}
+
+/// Observe the messages pages publish to a channel
+///
+/// The callback runs on the CEF UI thread. Only observed channels reach the
+/// host, the others are routed between the pages alone.
+pub fn observe<F>(channel: &str, callback: F) -> Option<BusObservation>
+where
+    F: Fn(&str, &str) + Send + Sync + 'static,
+{
+    let channel = CString::new(channel).ok()?;
+    let callback: Box<BusCallback> = Box::new(Box::new(callback));
+    let observer = sys::BusObserver {
+        on_message: Some(on_bus_message_callback),
+        context: &*callback as *const BusCallback as _,
+    };
+
+    let id = unsafe { sys::wew_bus_observe(channel.as_ptr(), &observer) };
+    Some(BusObservation { id, callback })
+}
+
+/// A channel observed with `observe`
+///
+/// The observer is removed when this is dropped.
+pub struct BusObservation {
+    id: c_int,
+    // Dropped after the observer is removed, the library no longer calls it
+    // by then.
+    #[allow(unused)]
+    callback: Box<BusCallback>,
+}
+
+impl Drop for BusObservation {
+    fn drop(&mut self) {
+        unsafe { sys::wew_bus_unobserve(self.id) }
+    }
+}
+
+extern "C" fn on_bus_message_callback(
+    channel: *const c_char,
+    message: *const c_char,
+    context: *mut c_void,
+) {
+    if context.is_null() || channel.is_null() || message.is_null() {
+        return;
+    }
+
+    let (Ok(channel), Ok(message)) = (
+        unsafe { CStr::from_ptr(channel) }.to_str(),
+        unsafe { CStr::from_ptr(message) }.to_str(),
+    ) else {
+        return;
+    };
+
+    let callback = unsafe { &*(context as *const BusCallback) };
+    callback(channel, message);
+}
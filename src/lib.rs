@@ -109,8 +109,10 @@
 )]
 #![allow(clippy::needless_doctest_main)]
 
+pub mod bus;
 pub mod cookie;
 pub mod events;
+pub mod metrics;
 pub mod request;
 pub mod runtime;
 pub mod utils;
@@ -159,6 +161,7 @@ impl std::fmt::Display for Error {
 }
 
 /// Represents a rectangular area
+#[repr(C)]
 #[derive(Debug, Clone, Copy, Default)]
 pub struct Rect {
     pub x: u32,
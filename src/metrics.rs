@@ -0,0 +1,206 @@
+//! Process wide metrics recorded by the library.
+//!
+//! The browser side subsystems record into a registry of counters and fixed
+//! bucket histograms: painted frames, messages exchanged with the page,
+//! resource handler reads, cookie operations and tasks posted to the main
+//! thread. Recording is a relaxed atomic add on a per-thread shard, reading
+//! merges the shards.
+//!
+//! ## Example
+//!
+//! ```no_run
+//! for metric in wew::metrics::snapshot() {
+//!     println!("{} = {}", metric.name, metric.count);
+//! }
+//!
+//! // Or in the Prometheus text exposition format.
+//! print!("{}", wew::metrics::prometheus());
+//! ```
+//!
+//! ## Slow callbacks
+//!
+//! Every handler method called by the library, such as `on_frame`,
+//! `on_message` or `RequestHandler::read`, runs on a CEF thread and is timed.
+//! The durations are recorded as `wew_callback_*_duration_ns` histograms, and
+//! a slow callback handler can be notified whenever a callback exceeds a
+//! threshold:
+//!
+//! ```no_run
+//! use std::time::Duration;
+//!
+//! wew::metrics::set_slow_callback_handler(Duration::from_millis(8), |name, duration| {
+//!     eprintln!("{} blocked a browser thread for {:?}", name, duration);
+//! });
+//! ```
+
+use std::{
+    ffi::{CStr, CString, c_char, c_void},
+    path::Path,
+    ptr::{null, null_mut},
+    time::Duration,
+};
+
+use parking_lot::RwLock;
+
+use crate::sys;
+
+type SlowCallbackHandler = Box<dyn Fn(&str, Duration) + Send + Sync>;
+
+static SLOW_CALLBACK_HANDLER: RwLock<Option<SlowCallbackHandler>> = RwLock::new(None);
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MetricKind {
+    Counter,
+    Histogram,
+}
+
+/// A histogram bucket
+#[derive(Debug, Clone, Copy)]
+pub struct Bucket {
+    /// Inclusive upper bound of the bucket, `u64::MAX` for the last bucket.
+    pub bound: u64,
+    /// Number of observations in this bucket, not cumulative.
+    pub count: u64,
+}
+
+#[derive(Debug, Clone)]
+pub struct Metric {
+    /// Metric name in the Prometheus naming scheme, such as `wew_frames_total`.
+    pub name: &'static str,
+    /// One line description of the metric.
+    pub help: &'static str,
+    pub kind: MetricKind,
+    /// Counter value, or the number of observations of a histogram.
+    pub count: u64,
+    /// Sum of all observed values, zero for counters.
+    pub sum: u64,
+    /// Histogram buckets, empty for counters.
+    pub buckets: Vec<Bucket>,
+}
+
+impl From<&sys::Metric> for Metric {
+    fn from(value: &sys::Metric) -> Self {
+        // Names and descriptions are statically allocated by the library.
+        let to_str = |ptr| unsafe { CStr::from_ptr(ptr) }.to_str().unwrap_or_default();
+
+        let kind = match value.kind {
+            sys::MetricKind::WEW_METRIC_COUNTER => MetricKind::Counter,
+            sys::MetricKind::WEW_METRIC_HISTOGRAM => MetricKind::Histogram,
+        };
+
+        Self {
+            name: to_str(value.name),
+            help: to_str(value.help),
+            count: value.count,
+            sum: value.sum,
+            buckets: if kind == MetricKind::Histogram {
+                value
+                    .bounds
+                    .iter()
+                    .zip(value.buckets.iter())
+                    .map(|(bound, count)| Bucket {
+                        bound: *bound,
+                        count: *count,
+                    })
+                    .collect()
+            } else {
+                Vec::new()
+            },
+            kind,
+        }
+    }
+}
+
+/// Take a snapshot of all metrics
+///
+/// Can be called from any thread.
+pub fn snapshot() -> Vec<Metric> {
+    let size = unsafe { sys::wew_metrics_snapshot(null_mut(), 0) };
+
+    let mut metrics: Vec<sys::Metric> = Vec::with_capacity(size);
+    unsafe {
+        let size = sys::wew_metrics_snapshot(metrics.as_mut_ptr(), size).min(size);
+        metrics.set_len(size);
+    }
+
+    metrics.iter().map(Metric::from).collect()
+}
+
+/// Render all metrics in the Prometheus text exposition format
+///
+/// Can be called from any thread.
+pub fn prometheus() -> String {
+    let mut buffer = vec![0u8; 4096];
+
+    loop {
+        let size = unsafe { sys::wew_metrics_prometheus(buffer.as_mut_ptr() as _, buffer.len()) };
+
+        if size < buffer.len() {
+            buffer.truncate(size);
+
+            return String::from_utf8(buffer).unwrap_or_default();
+        }
+
+        buffer.resize(size + 1, 0);
+    }
+}
+
+/// Write the recorded library spans to a Chrome trace event file
+///
+/// Spans such as `create_webview`, `IWebViewRender::OnPaint` or
+/// `IResourceHandler::Read` are recorded into per-thread buffers when the
+/// `tracing` feature is enabled. Flushing drains the buffers into a JSON file
+/// that can be opened with `chrome://tracing` or Perfetto.
+///
+/// Returns `false` if the file could not be written or the feature is
+/// disabled.
+pub fn flush_trace<P: AsRef<Path>>(path: P) -> bool {
+    let Some(path) = path.as_ref().to_str().and_then(|it| CString::new(it).ok()) else {
+        return false;
+    };
+
+    unsafe { sys::wew_trace_flush(path.as_ptr()) }
+}
+
+/// Set the slow callback handler
+///
+/// The handler is called on the thread that ran the slow callback, right
+/// after it returned, with the callback name and its duration. Keep it cheap,
+/// it runs on a CEF thread as well. Replaces any previous handler.
+pub fn set_slow_callback_handler<F>(threshold: Duration, handler: F)
+where
+    F: Fn(&str, Duration) + Send + Sync + 'static,
+{
+    SLOW_CALLBACK_HANDLER.write().replace(Box::new(handler));
+
+    unsafe {
+        sys::wew_set_slow_callback_handler(&sys::SlowCallbackHandler {
+            on_slow_callback: Some(on_slow_callback),
+            threshold_ns: threshold.as_nanos().min(u64::MAX as u128) as u64,
+            context: null_mut(),
+        });
+    }
+}
+
+/// Remove the slow callback handler
+///
+/// Callback durations are still recorded as metrics.
+pub fn remove_slow_callback_handler() {
+    unsafe {
+        sys::wew_set_slow_callback_handler(null());
+    }
+
+    SLOW_CALLBACK_HANDLER.write().take();
+}
+
+extern "C" fn on_slow_callback(name: *const c_char, duration_ns: u64, _: *mut c_void) {
+    if name.is_null() {
+        return;
+    }
+
+    if let Some(handler) = SLOW_CALLBACK_HANDLER.read().as_ref() {
+        if let Ok(name) = unsafe { CStr::from_ptr(name) }.to_str() {
+            handler(name, Duration::from_nanos(duration_ns));
+        }
+    }
+}
@@ -37,7 +37,8 @@
 //! handling.
 
 use std::{
-    ffi::{CStr, CString, c_void},
+    collections::{BTreeMap, HashMap},
+    ffi::{CStr, CString, c_char, c_int, c_void},
     fs::File,
     io::{Read, Seek, SeekFrom},
     path::{Path, PathBuf},
@@ -45,6 +46,7 @@ use std::{
     sync::Arc,
 };
 
+use parking_lot::Mutex;
 use url::Url;
 
 use crate::{
@@ -52,19 +54,154 @@ use crate::{
     utils::{GetSharedRef, ThreadSafePointer},
 };
 
+/// Files larger than this are always read from the disk
+const MAX_CACHED_FILE_SIZE: u64 = 8 * 1024 * 1024;
+
+/// Bytes of files kept in memory, the least recently used files go first
+const MAX_CACHE_SIZE: u64 = 64 * 1024 * 1024;
+
+struct CachedFile {
+    data: Arc<Vec<u8>>,
+    used: u64,
+}
+
+#[derive(Default)]
+struct LocalDiskCache {
+    files: HashMap<PathBuf, CachedFile>,
+    // The cached files by last use, the oldest first.
+    recent: BTreeMap<u64, PathBuf>,
+    size: u64,
+    uses: u64,
+    // Bumped on every change, a file read before a change is not cached after
+    // it.
+    generation: u64,
+}
+
+impl LocalDiskCache {
+    fn get(&mut self, path: &Path) -> Option<Arc<Vec<u8>>> {
+        let file = self.files.get_mut(path)?;
+
+        self.uses += 1;
+        self.recent.remove(&file.used);
+        self.recent.insert(self.uses, path.to_path_buf());
+        file.used = self.uses;
+
+        Some(file.data.clone())
+    }
+
+    fn insert(&mut self, path: PathBuf, data: Arc<Vec<u8>>) {
+        self.remove(&path);
+
+        let size = data.len() as u64;
+        while self.size + size > MAX_CACHE_SIZE {
+            let Some((_, oldest)) = self.recent.pop_first() else {
+                break;
+            };
+
+            if let Some(file) = self.files.remove(&oldest) {
+                self.size -= file.data.len() as u64;
+            }
+        }
+
+        self.uses += 1;
+        self.size += size;
+        self.recent.insert(self.uses, path.clone());
+        self.files.insert(
+            path,
+            CachedFile {
+                data,
+                used: self.uses,
+            },
+        );
+    }
+
+    fn remove(&mut self, path: &Path) {
+        if let Some(file) = self.files.remove(path) {
+            self.recent.remove(&file.used);
+            self.size -= file.data.len() as u64;
+        }
+    }
+
+    fn invalidate(&mut self, path: &Path) {
+        self.generation += 1;
+
+        let changed = self
+            .files
+            .keys()
+            .filter(|it| it.starts_with(path))
+            .cloned()
+            .collect::<Vec<_>>();
+
+        for it in changed {
+            self.remove(&it);
+        }
+    }
+}
+
 struct LocalDiskRequestHandler {
     file: Option<File>,
     path: PathBuf,
+    cache: Option<Arc<Mutex<LocalDiskCache>>>,
+    data: Option<Arc<Vec<u8>>>,
+    cursor: usize,
 }
 
 impl LocalDiskRequestHandler {
-    fn new(path: PathBuf) -> Self {
-        Self { file: None, path }
+    fn new(path: PathBuf, cache: Option<Arc<Mutex<LocalDiskCache>>>) -> Self {
+        Self {
+            file: None,
+            path,
+            cache,
+            data: None,
+            cursor: 0,
+        }
+    }
+
+    fn open_cached(&mut self, cache: &Mutex<LocalDiskCache>) -> bool {
+        let generation = {
+            let mut cache = cache.lock();
+            if let Some(data) = cache.get(&self.path) {
+                self.data = Some(data);
+
+                return true;
+            }
+
+            cache.generation
+        };
+
+        let Ok(metadata) = std::fs::metadata(&self.path) else {
+            return false;
+        };
+
+        if !metadata.is_file() || metadata.len() > MAX_CACHED_FILE_SIZE {
+            return false;
+        }
+
+        let Ok(data) = std::fs::read(&self.path) else {
+            return false;
+        };
+
+        let data = Arc::new(data);
+        {
+            let mut cache = cache.lock();
+            if cache.generation == generation {
+                cache.insert(self.path.clone(), data.clone());
+            }
+        }
+
+        self.data = Some(data);
+        true
     }
 }
 
 impl RequestHandler for LocalDiskRequestHandler {
     fn open(&mut self) -> bool {
+        if let Some(cache) = self.cache.clone() {
+            if self.open_cached(&cache) {
+                return true;
+            }
+        }
+
         if let Ok(file) = File::open(&self.path) {
             self.file.replace(file);
 
@@ -75,14 +212,26 @@ impl RequestHandler for LocalDiskRequestHandler {
     }
 
     fn get_response(&mut self) -> Option<Response> {
+        let content_length = if let Some(data) = &self.data {
+            data.len() as u64
+        } else {
+            self.file.as_ref()?.metadata().ok()?.len()
+        };
+
         Some(Response {
             status_code: 200,
             mime_type: get_mime_type(self.path.as_path())?,
-            content_length: self.file.as_ref()?.metadata().ok()?.len(),
+            content_length,
         })
     }
 
     fn skip(&mut self, size: usize) -> Option<usize> {
+        if let Some(data) = &self.data {
+            self.cursor = size.min(data.len());
+
+            return Some(self.cursor);
+        }
+
         Some(
             self.file
                 .as_mut()?
@@ -92,11 +241,20 @@ impl RequestHandler for LocalDiskRequestHandler {
     }
 
     fn read(&mut self, buffer: &mut [u8]) -> Option<usize> {
+        if let Some(data) = &self.data {
+            let len = buffer.len().min(data.len() - self.cursor);
+            buffer[..len].copy_from_slice(&data[self.cursor..self.cursor + len]);
+            self.cursor += len;
+
+            return Some(len);
+        }
+
         self.file.as_mut()?.read(buffer).ok()
     }
 
     fn cancel(&mut self) {
         drop(self.file.take());
+        drop(self.data.take());
     }
 }
 
@@ -126,6 +284,9 @@ impl RequestHandler for LocalDiskRequestHandler {
 /// internally.
 pub struct RequestHandlerWithLocalDisk {
     root_dir: PathBuf,
+    cache: Option<Arc<Mutex<LocalDiskCache>>>,
+    on_change: Option<Arc<dyn Fn(&str) + Send + Sync>>,
+    watch: Option<DirectoryWatch>,
 }
 
 impl RequestHandlerWithLocalDisk {
@@ -137,8 +298,70 @@ impl RequestHandlerWithLocalDisk {
     pub fn new(root_dir: &str) -> Self {
         Self {
             root_dir: PathBuf::from(root_dir),
+            cache: None,
+            on_change: None,
+            watch: None,
         }
     }
+
+    /// Keep the files in memory once read
+    ///
+    /// Files up to 8 MiB are served from memory after their first request,
+    /// up to 64 MiB in all, the least recently used files are dropped first.
+    /// This memory is shared by every webview using the handler and is not
+    /// part of their memory usage and budgets.
+    ///
+    /// The root directory is watched, a file that changes on the disk is read
+    /// from it again on its next request. Only supported on Linux, the files
+    /// are always read from the disk elsewhere.
+    pub fn with_cache(mut self) -> Self {
+        self.cache = Some(Default::default());
+        self.watch();
+
+        // Without a watcher the cache would go stale.
+        if self.watch.is_none() {
+            self.cache = None;
+        }
+
+        self
+    }
+
+    /// Call back when files change under the root directory
+    ///
+    /// The callback runs on the watcher's thread with the changed path,
+    /// relative to the root directory, so the pages using it can be reloaded.
+    /// An empty path means that anything may have changed. Only supported on
+    /// Linux.
+    pub fn on_change<F>(mut self, callback: F) -> Self
+    where
+        F: Fn(&str) + Send + Sync + 'static,
+    {
+        self.on_change = Some(Arc::new(callback));
+        self.watch();
+        self
+    }
+
+    fn watch(&mut self) {
+        // The previous watch stops before the new one starts.
+        drop(self.watch.take());
+
+        let Some(root_dir) = self.root_dir.to_str() else {
+            return;
+        };
+
+        let root = self.root_dir.clone();
+        let cache = self.cache.clone();
+        let on_change = self.on_change.clone();
+        self.watch = watch_directory(root_dir, move |path| {
+            if let Some(cache) = &cache {
+                cache.lock().invalidate(&root.join(path));
+            }
+
+            if let Some(on_change) = &on_change {
+                on_change(path);
+            }
+        });
+    }
 }
 
 impl RequestHandlerFactory for RequestHandlerWithLocalDisk {
@@ -156,10 +379,42 @@ impl RequestHandlerFactory for RequestHandlerWithLocalDisk {
 
         Some(Box::new(LocalDiskRequestHandler::new(
             self.root_dir.join(path),
+            self.cache.clone(),
         )))
     }
 }
 
+/// What a request loads
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ResourceType {
+    /// The document of a frame
+    Document,
+    Stylesheet,
+    /// Scripts, including the scripts of workers
+    Script,
+    Font,
+    /// XMLHttpRequest and fetch
+    Fetch,
+    Image,
+    Media,
+    Other,
+}
+
+impl From<sys::ResourceType> for ResourceType {
+    fn from(value: sys::ResourceType) -> Self {
+        match value {
+            sys::ResourceType::WEW_RESOURCE_DOCUMENT => Self::Document,
+            sys::ResourceType::WEW_RESOURCE_STYLESHEET => Self::Stylesheet,
+            sys::ResourceType::WEW_RESOURCE_SCRIPT => Self::Script,
+            sys::ResourceType::WEW_RESOURCE_FONT => Self::Font,
+            sys::ResourceType::WEW_RESOURCE_FETCH => Self::Fetch,
+            sys::ResourceType::WEW_RESOURCE_IMAGE => Self::Image,
+            sys::ResourceType::WEW_RESOURCE_MEDIA => Self::Media,
+            sys::ResourceType::WEW_RESOURCE_OTHER => Self::Other,
+        }
+    }
+}
+
 /// Request information
 #[derive(Debug)]
 pub struct Request<'a> {
@@ -169,6 +424,8 @@ pub struct Request<'a> {
     pub method: &'a str,
     /// Request referrer
     pub referrer: &'a str,
+    /// What the request loads
+    pub resource_type: ResourceType,
 }
 
 impl<'a> Request<'a> {
@@ -179,6 +436,7 @@ impl<'a> Request<'a> {
             url: unsafe { CStr::from_ptr(request.url).to_str().ok()? },
             method: unsafe { CStr::from_ptr(request.method).to_str().ok()? },
             referrer: unsafe { CStr::from_ptr(request.referrer).to_str().ok()? },
+            resource_type: request.resource_type.into(),
         })
     }
 }
@@ -310,6 +568,121 @@ impl<'a> CustomSchemeAttributes {
     }
 }
 
+/// Serve memory under a URL
+///
+/// Requests for the URL, through a custom scheme or the
+/// **`request_handler_factory`** of a `WebView`, are answered straight from
+/// the data, with single byte ranges, without calling a request handler. The
+/// data is dropped once the blob is unregistered or replaced and no request
+/// reads it anymore.
+///
+/// ```no_run
+/// let bundle: Vec<u8> = std::fs::read("/assets/app.js").unwrap();
+///
+/// wew::request::register_blob("webview://localhost/app.js", "text/javascript", bundle);
+/// ```
+pub fn register_blob<T>(url: &str, mime_type: &str, data: T)
+where
+    T: AsRef<[u8]> + Send + 'static,
+{
+    let (Ok(url), Ok(mime_type)) = (CString::new(url), CString::new(mime_type)) else {
+        return;
+    };
+
+    let data = Box::new(data);
+    let bytes = (*data).as_ref();
+    let (ptr, len) = (bytes.as_ptr(), bytes.len());
+
+    unsafe {
+        sys::wew_register_blob(
+            url.as_ptr(),
+            ptr as _,
+            len,
+            mime_type.as_ptr(),
+            Some(on_release_blob::<T>),
+            Box::into_raw(data) as _,
+        )
+    }
+}
+
+/// Stop serving the blob registered under a URL
+///
+/// Returns false when no blob is registered under the URL.
+pub fn unregister_blob(url: &str) -> bool {
+    let Ok(url) = CString::new(url) else {
+        return false;
+    };
+
+    unsafe { sys::wew_unregister_blob(url.as_ptr()) }
+}
+
+extern "C" fn on_release_blob<T>(_data: *const c_void, context: *mut c_void) {
+    drop(unsafe { Box::from_raw(context as *mut T) });
+}
+
+type DirectoryCallback = Box<dyn Fn(&str) + Send + Sync>;
+
+/// Watch a directory and its subdirectories
+///
+/// The callback runs on the watcher's thread with the path of every file or
+/// directory that is written, created, deleted or moved, relative to the
+/// directory and separated by `/`. An empty path means that events were lost
+/// and anything may have changed. Only supported on Linux, returns `None`
+/// elsewhere or when the directory cannot be watched.
+///
+/// ```no_run
+/// let watch = wew::request::watch_directory("/assets", |path| {
+///     println!("changed: {}", path);
+/// });
+/// ```
+pub fn watch_directory<F>(path: &str, callback: F) -> Option<DirectoryWatch>
+where
+    F: Fn(&str) + Send + Sync + 'static,
+{
+    let path = CString::new(path).ok()?;
+    let callback: Box<DirectoryCallback> = Box::new(Box::new(callback));
+    let observer = sys::DirectoryObserver {
+        on_change: Some(on_directory_change_callback),
+        context: &*callback as *const DirectoryCallback as _,
+    };
+
+    let id = unsafe { sys::wew_watch_directory(path.as_ptr(), &observer) };
+    if id < 0 {
+        return None;
+    }
+
+    Some(DirectoryWatch { id, callback })
+}
+
+/// A directory watched with `watch_directory`
+///
+/// The watch stops when this is dropped.
+pub struct DirectoryWatch {
+    id: c_int,
+    // Dropped after the watch stops, the library no longer calls it by then.
+    #[allow(unused)]
+    callback: Box<DirectoryCallback>,
+}
+
+impl Drop for DirectoryWatch {
+    fn drop(&mut self) {
+        unsafe { sys::wew_unwatch_directory(self.id) }
+    }
+}
+
+extern "C" fn on_directory_change_callback(path: *const c_char, context: *mut c_void) {
+    if context.is_null() || path.is_null() {
+        return;
+    }
+
+    let Ok(path) = unsafe { CStr::from_ptr(path) }.to_str() else {
+        return;
+    };
+
+    let callback = unsafe { &*(context as *const DirectoryCallback) };
+    callback(path);
+}
+
 pub(crate) struct ICustomRequestHandlerFactory {
     raw: ThreadSafePointer<Box<dyn RequestHandlerFactory>>,
     raw_handler: ThreadSafePointer<sys::RequestHandlerFactory>,
@@ -196,6 +196,16 @@ pub struct RuntimeAttributes<R, W> {
 
     /// Whether to disable signal handlers
     disable_signal_handlers: bool,
+
+    /// Renderer plugin shared libraries, joined with the platform path list
+    /// separator
+    renderer_plugins: Option<CString>,
+
+    /// Unix socket of the HTTP/1.1 server behind `app-api://`
+    api_socket: Option<CString>,
+
+    /// Threads running the request handlers, 0 runs them on the CEF IO thread
+    request_threads: u32,
 }
 
 impl<W> RuntimeAttributes<MainThreadMessageLoop, W> {
@@ -359,6 +369,44 @@ impl<R, W> RuntimeAttributesBuilder<R, W> {
         self.0.persist_session_cookies = value;
         self
     }
+
+    /// Set the renderer plugin shared libraries
+    ///
+    /// `execute_subprocess` loads them in renderer processes, each library
+    /// exports a `wew_plugin_init` function that registers native functions
+    /// on the page's `NativePlugins` object, see `PluginRegistrar` in wew.h.
+    /// Only the main frame of a page gets the object, iframes do not.
+    pub fn with_renderer_plugins(mut self, paths: &[&str]) -> Self {
+        let separator = if cfg!(target_os = "windows") {
+            ";"
+        } else {
+            ":"
+        };
+        self.0.renderer_plugins = Some(CString::new(paths.join(separator)).unwrap());
+        self
+    }
+
+    /// Set the Unix socket of the local API server
+    ///
+    /// Requests to `app-api://` URLs are proxied to the HTTP/1.1 server on the
+    /// socket over pooled keep-alive connections, with the path, query,
+    /// method, headers and body passed through. Not supported on Windows.
+    pub fn with_api_socket(mut self, path: &str) -> Self {
+        self.0.api_socket = Some(CString::new(path).unwrap());
+        self
+    }
+
+    /// Set the number of threads running the request handlers
+    ///
+    /// By default the request handlers of the custom scheme and of webviews
+    /// run on the CEF IO thread. With threads, waiting requests are served by
+    /// resource type: documents, scripts and stylesheets first, images and
+    /// media last, and a request that waited too long goes ahead of the
+    /// others. A request handler may then be called on any of the threads.
+    pub fn with_request_threads(mut self, threads: u32) -> Self {
+        self.0.request_threads = threads;
+        self
+    }
 }
 
 impl RuntimeAttributesBuilder<MultiThreadMessageLoop, NativeWindowWebView> {
@@ -496,6 +544,9 @@ impl IRuntime {
             background_color: attr.background_color,
             command_line_args_disabled: attr.command_line_args_disabled,
             disable_signal_handlers: attr.disable_signal_handlers,
+            renderer_plugins: attr.renderer_plugins.as_raw(),
+            api_socket: attr.api_socket.as_raw(),
+            request_threads: attr.request_threads as _,
             javascript_flags: attr.javascript_flags.as_raw(),
             persist_session_cookies: attr.persist_session_cookies,
             user_agent: attr.user_agent.as_raw(),
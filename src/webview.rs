@@ -68,6 +68,7 @@ use std::{
     sync::Arc,
 };
 
+use bitflags::bitflags;
 use parking_lot::Mutex;
 use raw_window_handle::RawWindowHandle;
 
@@ -139,6 +140,21 @@ pub enum CursorType {
     NumValues = 50,
 }
 
+/// Image of a custom cursor
+#[derive(Debug, Clone, Copy)]
+pub struct CursorImage<'a> {
+    /// BGRA pixels with `width * 4` bytes per row
+    pub buffer: &'a [u8],
+    pub width: u32,
+    pub height: u32,
+    pub hotspot_x: i32,
+    pub hotspot_y: i32,
+    /// Device pixels per DIP of the image
+    pub scale: f32,
+    /// Hash of the pixels, size, hotspot and scale
+    pub hash: u64,
+}
+
 /// Represents the type of a frame
 #[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
 pub enum FrameType {
@@ -146,6 +162,85 @@ pub enum FrameType {
     Popup,
 }
 
+/// A region of the previous frame that reappears moved in the current one
+///
+/// Only reported with `WebViewAttributes::motion_detection`, a remote client
+/// copies `rect` by `dx` and `dy` before applying the dirty rects.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct FrameMove {
+    /// The region in the previous frame
+    pub rect: Rect,
+    pub dx: i32,
+    pub dy: i32,
+}
+
+/// Orientation of windowless output
+///
+/// Rotations are clockwise, mirroring is horizontal and applied before the
+/// rotation.
+#[derive(Debug, Default, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum FrameTransform {
+    #[default]
+    Normal,
+    Rotate90,
+    Rotate180,
+    Rotate270,
+    Flipped,
+    Flipped90,
+    Flipped180,
+    Flipped270,
+}
+
+/// Pixel layout of the frames delivered to a frame consumer
+#[derive(Debug, Default, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum FrameFormat {
+    #[default]
+    Bgra,
+    Rgba,
+}
+
+/// Codec of the video encoder, see `WebView::start_encoder`
+#[derive(Debug, Default, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum VideoCodec {
+    #[default]
+    Vp8,
+    Vp9,
+}
+
+/// A packet produced by the video encoder
+#[derive(Debug, Clone, Copy)]
+pub struct EncodedPacket<'a> {
+    pub data: &'a [u8],
+    /// Milliseconds since the encoder started
+    pub pts: i64,
+    pub keyframe: bool,
+}
+
+/// Alpha of a frame tile
+#[repr(u8)]
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum TileAlpha {
+    /// Every pixel is fully transparent, the tile can be skipped
+    Transparent = 0,
+    /// Every pixel is fully opaque, the tile can be copied without blending
+    Opaque = 1,
+    Mixed = 2,
+}
+
+/// Per tile alpha classification of a view frame
+///
+/// Only reported with `WebViewAttributes::alpha_tile_size`.
+#[derive(Debug, Clone, Copy)]
+pub struct AlphaTiles<'a> {
+    /// Side of the square tiles in pixels
+    pub size: u32,
+    pub columns: u32,
+    pub rows: u32,
+    /// Tiles in row major order
+    pub tiles: &'a [TileAlpha],
+}
+
 /// Represents a rendered frame of a web page
 #[derive(Clone, Copy)]
 pub struct Frame<'a> {
@@ -160,6 +255,20 @@ pub struct Frame<'a> {
     pub width: u32,
     /// The height of the frame
     pub height: u32,
+    /// Bytes per row of the buffer
+    pub stride: u32,
+    /// The host frame buffer holding the frame, see
+    /// `WebView::set_frame_buffers`
+    pub buffer_index: Option<u32>,
+    /// The areas that changed since the previous frame, after the moves are
+    /// applied
+    pub dirty_rects: &'a [Rect],
+    /// Regions of the previous frame to copy before the dirty rects
+    pub moves: &'a [FrameMove],
+    /// Alpha of the view tiles
+    pub alpha_tiles: Option<AlphaTiles<'a>>,
+    /// Area of the rects the browser repainted for this frame
+    pub damaged_pixels: u64,
 }
 
 impl std::fmt::Debug for Frame<'_> {
@@ -170,10 +279,132 @@ impl std::fmt::Debug for Frame<'_> {
             .field("y", &self.y)
             .field("width", &self.width)
             .field("height", &self.height)
+            .field("stride", &self.stride)
+            .field("buffer_index", &self.buffer_index)
+            .field("dirty_rects", &self.dirty_rects)
+            .field("moves", &self.moves)
+            .field("alpha_tiles", &self.alpha_tiles)
+            .field("damaged_pixels", &self.damaged_pixels)
             .finish()
     }
 }
 
+type FrameConsumerCallback = Box<dyn Fn(&Frame) + Send + Sync>;
+
+/// A frame consumer added with `WebView::subscribe_frames`
+///
+/// The consumer is removed when the subscription is dropped.
+pub struct FrameSubscription {
+    id: c_int,
+    webview: Arc<IWebView>,
+    // Dropped after the consumer is removed, the library no longer calls it
+    // by then.
+    #[allow(unused)]
+    callback: Box<FrameConsumerCallback>,
+}
+
+impl Drop for FrameSubscription {
+    fn drop(&mut self) {
+        unsafe { sys::webview_unsubscribe_frames(self.webview.raw.lock().as_ptr(), self.id) }
+    }
+}
+
+type EncodedPacketCallback = Box<dyn Fn(&EncodedPacket) + Send + Sync>;
+
+/// The video encoder started with `WebView::start_encoder`
+///
+/// The encoder is stopped when this is dropped. A webview runs one encoder at
+/// a time, drop the previous one before starting another.
+pub struct VideoEncoder {
+    webview: Arc<IWebView>,
+    // Dropped after the encoder thread is stopped.
+    #[allow(unused)]
+    callback: Box<EncodedPacketCallback>,
+}
+
+impl VideoEncoder {
+    /// Make the next encoded frame a keyframe
+    pub fn request_keyframe(&self) {
+        unsafe { sys::webview_request_keyframe(self.webview.raw.lock().as_ptr()) }
+    }
+
+    /// Change the target bitrate in kilobits per second
+    pub fn set_bitrate(&self, bitrate: u32) {
+        unsafe { sys::webview_set_encoder_bitrate(self.webview.raw.lock().as_ptr(), bitrate) }
+    }
+}
+
+impl Drop for VideoEncoder {
+    fn drop(&mut self) {
+        unsafe { sys::webview_stop_encoder(self.webview.raw.lock().as_ptr()) }
+    }
+}
+
+/// Direction of a shared ring, see `WebView::open_ring`
+#[derive(Debug, Default, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum RingDirection {
+    /// The host writes records and the page reads them
+    #[default]
+    ToPage,
+    /// The page writes records and the host reads them
+    FromPage,
+}
+
+type RingReadyCallback = Box<dyn Fn() + Send + Sync>;
+
+/// A shared memory ring opened with `WebView::open_ring`
+///
+/// The ring is closed when this is dropped, the page's object stops working.
+pub struct SharedRing {
+    raw: *mut c_void,
+    webview: Arc<IWebView>,
+    // Dropped after the ring is closed, the library no longer calls it by
+    // then.
+    #[allow(unused)]
+    callback: Box<RingReadyCallback>,
+}
+
+unsafe impl Send for SharedRing {}
+
+impl SharedRing {
+    /// Append a record to a ring to the page
+    ///
+    /// Returns false when the ring is full, the record is dropped.
+    pub fn write(&mut self, data: &[u8]) -> bool {
+        let Ok(size) = u32::try_from(data.len()) else {
+            return false;
+        };
+
+        unsafe { sys::wew_ring_write(self.raw, data.as_ptr() as _, size) }
+    }
+
+    /// Take the next record of a ring from the page
+    ///
+    /// Returns `None` when the ring is empty, the ready callback runs for the
+    /// next record. Returns `Some(Err(size))` when the record does not fit
+    /// the buffer, it stays in the ring.
+    pub fn read(&mut self, buffer: &mut [u8]) -> Option<Result<usize, usize>> {
+        let capacity = u32::try_from(buffer.len()).unwrap_or(u32::MAX);
+        let size = unsafe { sys::wew_ring_read(self.raw, buffer.as_mut_ptr() as _, capacity) };
+        if size < 0 {
+            return None;
+        }
+
+        let size = size as usize;
+        Some(if size <= buffer.len() {
+            Ok(size)
+        } else {
+            Err(size)
+        })
+    }
+}
+
+impl Drop for SharedRing {
+    fn drop(&mut self) {
+        unsafe { sys::webview_close_ring(self.webview.raw.lock().as_ptr(), self.raw) }
+    }
+}
+
 /// Represents the state of a web page
 ///
 /// The order of events is as follows:
@@ -201,6 +432,57 @@ pub enum WebViewState {
     Close = 5,
 }
 
+/// Host memory that windowless frames are written into
+#[derive(Debug, Clone, Copy)]
+pub struct FrameBuffer {
+    pub data: *mut u8,
+    /// Size of data in bytes, at least `stride * height`
+    pub size: usize,
+    /// Bytes per row, at least `width * 4`
+    pub stride: u32,
+}
+
+/// Library subsystem holding memory on behalf of a webview
+#[derive(Debug, Copy, Clone, Hash, PartialEq, Eq)]
+pub enum MemorySubsystem {
+    /// Frame buffers kept by the library, such as pooled or host registered
+    /// buffers
+    FrameBuffers,
+    /// Messages waiting to be delivered
+    MessageQueues,
+    /// All subsystems together, only valid as a budget
+    Total,
+}
+
+/// Bytes the library holds on behalf of a webview
+#[derive(Debug, Clone, Copy, Default)]
+pub struct MemoryUsage {
+    pub frame_buffers: u64,
+    pub message_queues: u64,
+    pub total: u64,
+    /// Highest total seen so far
+    pub peak: u64,
+    /// Bytes freed by eviction so far
+    pub evicted: u64,
+}
+
+bitflags! {
+    /// Webview events, one per handler callback
+    ///
+    /// Events set in `WebViewAttributes::ignored_events` are dropped before
+    /// they are converted, their handler methods are never called.
+    #[derive(PartialEq, Eq, Debug, Clone, Copy, Default)]
+    pub struct WebViewEvents: u32 {
+        const Cursor = 1 << 0;
+        const StateChange = 1 << 1;
+        const ImeRect = 1 << 2;
+        const Frame = 1 << 3;
+        const TitleChange = 1 << 4;
+        const FullscreenChange = 1 << 5;
+        const Message = 1 << 6;
+    }
+}
+
 /// WebView handler
 ///
 /// This trait is used to handle web view events.
@@ -209,8 +491,18 @@ pub trait WebViewHandler: Send + Sync {
     /// Called when the cursor changes
     ///
     /// When the web page wants to change the mouse pointer style, it will be
-    /// triggered, such as moving to a link.
+    /// triggered, such as moving to a link. Repeats of the current cursor
+    /// are not reported.
     fn on_cursor_change(&self, ty: CursorType) {}
+
+    /// Called instead of `on_cursor_change` for custom cursors
+    ///
+    /// `CursorImage::hash` identifies the image, so OS cursor objects can be
+    /// cached by it. Falls back to `on_cursor_change` with
+    /// `CursorType::Custom` unless implemented.
+    fn on_cursor_image(&self, image: &CursorImage) {
+        self.on_cursor_change(CursorType::Custom);
+    }
     /// Called when the web page state changes
     ///
     /// You need to pay attention to status changes, determine whether loading
@@ -292,6 +584,21 @@ pub struct WebViewAttributes {
     pub local_storage: bool,
     /// END values that map to WebPreferences settings.
     pub background_color: u32,
+    /// Report scrolled regions between frames as `Frame::moves`.
+    pub motion_detection: bool,
+    /// Tile size of the alpha classification in `Frame::alpha_tiles`, zero
+    /// disables it.
+    pub alpha_tile_size: u32,
+    /// Orientation of frames and input positions.
+    pub output_transform: FrameTransform,
+    /// Events that are never delivered to the handler.
+    pub ignored_events: WebViewEvents,
+    /// Tint repainted tiles of view frames, see
+    /// `WebViewAttributesBuilder::with_paint_flashing`.
+    pub paint_flashing: bool,
+    /// Give the page the `MessageBus` object, see
+    /// `WebViewAttributesBuilder::with_message_bus`.
+    pub message_bus: bool,
 }
 
 unsafe impl Send for WebViewAttributes {}
@@ -318,6 +625,12 @@ impl Default for WebViewAttributes {
             background_color: 0xFFFFFFFF,
             minimum_font_size: 12,
             minimum_logical_font_size: 12,
+            motion_detection: false,
+            alpha_tile_size: 0,
+            output_transform: FrameTransform::Normal,
+            ignored_events: WebViewEvents::empty(),
+            paint_flashing: false,
+            message_bus: false,
         }
     }
 }
@@ -490,6 +803,72 @@ impl WebViewAttributesBuilder {
         self
     }
 
+    /// Set whether scrolled regions are detected
+    ///
+    /// Successive view frames are compared by row and column hashes, a band
+    /// that moved is reported as a `FrameMove` and the dirty rects then only
+    /// cover the newly exposed strip. Only paints that cover at least half
+    /// of the view are searched, and a move is checked against the pixels of
+    /// the previous frame before it is reported. Meant for streaming frames
+    /// to remote clients, where a scroll would otherwise resend the whole
+    /// frame.
+    pub fn with_motion_detection(mut self, value: bool) -> Self {
+        self.0.motion_detection = value;
+        self
+    }
+
+    /// Set the tile size of the alpha classification
+    ///
+    /// Every view frame is classified in square tiles as fully transparent,
+    /// fully opaque or mixed, so a compositor overlaying a transparent
+    /// webview can skip or plainly copy most tiles instead of blending the
+    /// whole frame. Zero disables the classification.
+    pub fn with_alpha_tile_size(mut self, value: u32) -> Self {
+        self.0.alpha_tile_size = value;
+        self
+    }
+
+    /// Set the orientation of windowless output
+    ///
+    /// Frames, their dirty rects and the IME rect are delivered rotated or
+    /// mirrored, only the dirty rects are transformed per frame. Mouse and
+    /// touch positions are taken in the same orientation and mapped back to
+    /// the page. The width and height stay the page's own size.
+    pub fn with_output_transform(mut self, value: FrameTransform) -> Self {
+        self.0.output_transform = value;
+        self
+    }
+
+    /// Set the events that are never delivered to the handler
+    ///
+    /// Cursor and IME events are frequent while hovering and typing, ignoring
+    /// the ones the handler does not use saves their conversion and callback.
+    pub fn with_ignored_events(mut self, value: WebViewEvents) -> Self {
+        self.0.ignored_events = value;
+        self
+    }
+
+    /// Set whether repainted tiles are tinted
+    ///
+    /// A debugging aid like Chrome's paint flashing: view tiles turn redder
+    /// the more often they are repainted and fade over the following frames.
+    /// The tints are part of the delivered frames, no moves are reported
+    /// while it is on.
+    pub fn with_paint_flashing(mut self, value: bool) -> Self {
+        self.0.paint_flashing = value;
+        self
+    }
+
+    /// Set whether the page is on the message bus
+    ///
+    /// The main frame gets the `MessageBus` object of the `bus` module. A
+    /// page on the bus reads and publishes every channel of every webview on
+    /// it, only enable it for webviews showing trusted content.
+    pub fn with_message_bus(mut self, value: bool) -> Self {
+        self.0.message_bus = value;
+        self
+    }
+
     pub fn build(self) -> WebViewAttributes {
         self.0
     }
@@ -566,6 +945,12 @@ impl IWebView {
             } else {
                 null()
             },
+            motion_detection: attr.motion_detection,
+            alpha_tile_size: attr.alpha_tile_size,
+            output_transform: attr.output_transform.into(),
+            ignored_events: attr.ignored_events.bits(),
+            paint_flashing: attr.paint_flashing,
+            message_bus: attr.message_bus,
         };
 
         let context: *mut WebViewContext = Box::into_raw(Box::new(WebViewContext {
@@ -587,6 +972,7 @@ impl IWebView {
                     on_title_change: Some(on_title_change_callback),
                     on_fullscreen_change: Some(on_fullscreen_change_callback),
                     on_message: Some(on_message_callback),
+                    on_cursor_image: Some(on_cursor_image_callback),
                     context: context as _,
                 },
             )
@@ -713,6 +1099,38 @@ impl<W> WebView<W> {
     pub fn devtools_enabled(&self, enable: bool) {
         unsafe { sys::webview_set_devtools_state(self.inner.raw.lock().as_ptr(), enable) }
     }
+
+    /// Get the memory usage
+    ///
+    /// Returns the bytes the library currently holds on behalf of this
+    /// webview, per subsystem. Memory owned by Chromium is not included.
+    pub fn memory_usage(&self) -> MemoryUsage {
+        let mut usage: sys::MemoryUsage = unsafe { std::mem::zeroed() };
+        unsafe { sys::webview_get_memory_usage(self.inner.raw.lock().as_ptr(), &mut usage) }
+
+        MemoryUsage {
+            frame_buffers: usage.bytes[sys::MemorySubsystem::WEW_MEMORY_FRAME_BUFFERS as usize],
+            message_queues: usage.bytes[sys::MemorySubsystem::WEW_MEMORY_MESSAGE_QUEUES as usize],
+            total: usage.total,
+            peak: usage.peak,
+            evicted: usage.evicted,
+        }
+    }
+
+    /// Set a memory budget
+    ///
+    /// Going over the budget of a subsystem, or over the `Total` budget of the
+    /// webview, evicts what the library can rebuild, such as pooled frame
+    /// buffers. `None` removes the budget.
+    pub fn set_memory_budget(&self, subsystem: MemorySubsystem, bytes: Option<u64>) {
+        unsafe {
+            sys::webview_set_memory_budget(
+                self.inner.raw.lock().as_ptr(),
+                subsystem.into(),
+                bytes.unwrap_or(0),
+            )
+        }
+    }
 }
 
 impl WebView<WindowlessRenderWebView> {
@@ -818,6 +1236,170 @@ impl WebView<WindowlessRenderWebView> {
         }
     }
 
+    /// Register host buffers that view frames are written into
+    ///
+    /// Each paint copies only the damage the next free buffer has not seen
+    /// yet into it and delivers it through `on_frame` with
+    /// `Frame::buffer_index` set. The buffer stays with the host until
+    /// `release_frame_buffer`, paints are dropped while every buffer is held.
+    /// An empty list goes back to the library's own buffer.
+    ///
+    /// # Safety
+    ///
+    /// The buffers must stay valid until they are replaced or the webview is
+    /// dropped, and the host must not touch a buffer the webview owns.
+    pub unsafe fn set_frame_buffers(&self, buffers: &[FrameBuffer]) -> bool {
+        let buffers = buffers
+            .iter()
+            .map(|it| sys::FrameBuffer {
+                data: it.data as _,
+                size: it.size,
+                stride: it.stride,
+            })
+            .collect::<Vec<_>>();
+
+        unsafe {
+            sys::webview_set_frame_buffers(
+                self.inner.raw.lock().as_ptr(),
+                buffers.as_ptr(),
+                buffers.len(),
+            )
+        }
+    }
+
+    /// Hand a frame buffer back once the host is done reading it
+    pub fn release_frame_buffer(&self, index: u32) {
+        unsafe { sys::webview_release_frame_buffer(self.inner.raw.lock().as_ptr(), index) }
+    }
+
+    /// Add a frame consumer
+    ///
+    /// View frames are delivered to the callback at most `max_fps` times per
+    /// second, zero delivers every frame. Consumers of the same format share
+    /// one copy of each frame, so encoders, thumbnails and the main
+    /// `on_frame` handler can each run at their own rate. A consumer that
+    /// skipped frames gets the whole frame as damage.
+    ///
+    /// Returns `None` if the webview does not render windowless.
+    pub fn subscribe_frames<F>(
+        &self,
+        max_fps: u32,
+        format: FrameFormat,
+        callback: F,
+    ) -> Option<FrameSubscription>
+    where
+        F: Fn(&Frame) + Send + Sync + 'static,
+    {
+        let callback: Box<FrameConsumerCallback> = Box::new(Box::new(callback));
+        let consumer = sys::FrameConsumer {
+            max_fps,
+            format: format.into(),
+            on_frame: Some(on_consumer_frame_callback),
+            context: &*callback as *const FrameConsumerCallback as _,
+        };
+
+        let id =
+            unsafe { sys::webview_subscribe_frames(self.inner.raw.lock().as_ptr(), &consumer) };
+        if id < 0 {
+            return None;
+        }
+
+        Some(FrameSubscription {
+            id,
+            webview: self.inner.clone(),
+            callback,
+        })
+    }
+
+    /// Encode view frames with VP8 or VP9
+    ///
+    /// Frames are converted to I420 as they are painted and encoded on a
+    /// dedicated thread, paints that arrive while it is busy are merged and
+    /// paints without damage are skipped. The callback runs on the encoder
+    /// thread at `bitrate` kilobits per second, with a keyframe at least every
+    /// `keyframe_interval` frames unless it is zero.
+    ///
+    /// Returns `None` if the webview does not render windowless or the `vpx`
+    /// feature is disabled.
+    pub fn start_encoder<F>(
+        &self,
+        codec: VideoCodec,
+        bitrate: u32,
+        keyframe_interval: u32,
+        callback: F,
+    ) -> Option<VideoEncoder>
+    where
+        F: Fn(&EncodedPacket) + Send + Sync + 'static,
+    {
+        let callback: Box<EncodedPacketCallback> = Box::new(Box::new(callback));
+        let settings = sys::VideoEncoderSettings {
+            codec: codec.into(),
+            bitrate,
+            keyframe_interval,
+            on_packet: Some(on_packet_callback),
+            context: &*callback as *const EncodedPacketCallback as _,
+        };
+
+        if !unsafe { sys::webview_start_encoder(self.inner.raw.lock().as_ptr(), &settings) } {
+            return None;
+        }
+
+        Some(VideoEncoder {
+            webview: self.inner.clone(),
+            callback,
+        })
+    }
+
+    /// Open a shared memory ring between the host and the page
+    ///
+    /// The page finds it as `SharedRings[name]`, with the shared buffer,
+    /// `read()` for rings to the page, `write()` for rings from the page and
+    /// `on(callback)`. Records cost a memory write, the consumer is only woken
+    /// when it found the ring empty. `on_ready` runs on the CEF UI thread when
+    /// the page wrote to a ring from the page that `SharedRing::read` found
+    /// empty.
+    ///
+    /// Returns `None` over the message queue memory budget or when shared
+    /// memory is unavailable.
+    pub fn open_ring<F>(
+        &self,
+        name: &str,
+        capacity: u32,
+        direction: RingDirection,
+        on_ready: F,
+    ) -> Option<SharedRing>
+    where
+        F: Fn() + Send + Sync + 'static,
+    {
+        let name = CString::new(name).ok()?;
+        let callback: Box<RingReadyCallback> = Box::new(Box::new(on_ready));
+        let settings = sys::RingSettings {
+            name: name.as_ptr(),
+            capacity,
+            direction: direction.into(),
+            on_ready: Some(on_ring_ready_callback),
+            context: &*callback as *const RingReadyCallback as _,
+        };
+
+        let raw = unsafe { sys::webview_open_ring(self.inner.raw.lock().as_ptr(), &settings) };
+        if raw.is_null() {
+            return None;
+        }
+
+        Some(SharedRing {
+            raw,
+            webview: self.inner.clone(),
+            callback,
+        })
+    }
+
+    /// Turn paint flashing on or off
+    ///
+    /// Turning it off repaints the whole view without the tints.
+    pub fn set_paint_flashing(&self, enable: bool) {
+        unsafe { sys::webview_set_paint_flashing(self.inner.raw.lock().as_ptr(), enable) }
+    }
+
     /// Resize the window
     ///
     /// This function is used to resize the window.
@@ -855,6 +1437,58 @@ impl From<sys::WebViewState> for WebViewState {
     }
 }
 
+impl From<MemorySubsystem> for sys::MemorySubsystem {
+    fn from(value: MemorySubsystem) -> Self {
+        match value {
+            MemorySubsystem::FrameBuffers => Self::WEW_MEMORY_FRAME_BUFFERS,
+            MemorySubsystem::MessageQueues => Self::WEW_MEMORY_MESSAGE_QUEUES,
+            MemorySubsystem::Total => Self::WEW_MEMORY_TOTAL,
+        }
+    }
+}
+
+impl From<FrameTransform> for sys::FrameTransform {
+    fn from(value: FrameTransform) -> Self {
+        match value {
+            FrameTransform::Normal => Self::WEW_TRANSFORM_NORMAL,
+            FrameTransform::Rotate90 => Self::WEW_TRANSFORM_90,
+            FrameTransform::Rotate180 => Self::WEW_TRANSFORM_180,
+            FrameTransform::Rotate270 => Self::WEW_TRANSFORM_270,
+            FrameTransform::Flipped => Self::WEW_TRANSFORM_FLIPPED,
+            FrameTransform::Flipped90 => Self::WEW_TRANSFORM_FLIPPED_90,
+            FrameTransform::Flipped180 => Self::WEW_TRANSFORM_FLIPPED_180,
+            FrameTransform::Flipped270 => Self::WEW_TRANSFORM_FLIPPED_270,
+        }
+    }
+}
+
+impl From<FrameFormat> for sys::FrameFormat {
+    fn from(value: FrameFormat) -> Self {
+        match value {
+            FrameFormat::Bgra => Self::WEW_FRAME_BGRA,
+            FrameFormat::Rgba => Self::WEW_FRAME_RGBA,
+        }
+    }
+}
+
+impl From<VideoCodec> for sys::VideoCodec {
+    fn from(value: VideoCodec) -> Self {
+        match value {
+            VideoCodec::Vp8 => Self::WEW_CODEC_VP8,
+            VideoCodec::Vp9 => Self::WEW_CODEC_VP9,
+        }
+    }
+}
+
+impl From<RingDirection> for sys::RingDirection {
+    fn from(value: RingDirection) -> Self {
+        match value {
+            RingDirection::ToPage => Self::WEW_RING_TO_PAGE,
+            RingDirection::FromPage => Self::WEW_RING_FROM_PAGE,
+        }
+    }
+}
+
 impl From<KeyboardEventType> for sys::KeyEventType {
     fn from(val: KeyboardEventType) -> Self {
         match val {
@@ -942,23 +1576,51 @@ extern "C" fn on_ime_rect_callback(rect: sys::Rect, context: *mut c_void) {
     }
 }
 
-extern "C" fn on_frame_callback(frame: *const sys::Frame, context: *mut c_void) {
-    if context.is_null() || frame.is_null() {
-        return;
+unsafe fn raw_slice<'a, T>(ptr: *const T, len: usize) -> &'a [T] {
+    if ptr.is_null() || len == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ptr, len) }
     }
+}
 
-    let raw_frame = unsafe { &*frame };
-    let context = unsafe { &*(context as *mut WebViewContext) };
-
-    let frame = Frame {
+unsafe fn frame_from_raw(raw_frame: &sys::Frame) -> Frame<'_> {
+    Frame {
         x: raw_frame.x,
         y: raw_frame.y,
         width: raw_frame.width,
         height: raw_frame.height,
+        stride: raw_frame.stride,
+        buffer_index: u32::try_from(raw_frame.buffer_index).ok(),
+        damaged_pixels: raw_frame.damaged_pixels,
+        // The C rects are never negative, so they share the layout of `Rect`.
+        dirty_rects: unsafe {
+            raw_slice(
+                raw_frame.dirty_rects as *const Rect,
+                raw_frame.dirty_rects_count,
+            )
+        },
+        moves: unsafe { raw_slice(raw_frame.moves as *const FrameMove, raw_frame.moves_count) },
+        alpha_tiles: if raw_frame.alpha_tiles.is_null() {
+            None
+        } else {
+            Some(AlphaTiles {
+                size: raw_frame.alpha_tile_size,
+                columns: raw_frame.alpha_tile_columns,
+                rows: raw_frame.alpha_tile_rows,
+                // The library only writes `FrameTileAlpha` values.
+                tiles: unsafe {
+                    raw_slice(
+                        raw_frame.alpha_tiles as *const TileAlpha,
+                        raw_frame.alpha_tile_columns as usize * raw_frame.alpha_tile_rows as usize,
+                    )
+                },
+            })
+        },
         buffer: unsafe {
             std::slice::from_raw_parts(
                 raw_frame.buffer as *const u8,
-                raw_frame.width as usize * raw_frame.height as usize * 4,
+                raw_frame.stride as usize * raw_frame.height as usize,
             )
         },
         ty: if raw_frame.is_popup {
@@ -966,13 +1628,54 @@ extern "C" fn on_frame_callback(frame: *const sys::Frame, context: *mut c_void)
         } else {
             FrameType::View
         },
-    };
+    }
+}
+
+extern "C" fn on_frame_callback(frame: *const sys::Frame, context: *mut c_void) {
+    if context.is_null() || frame.is_null() {
+        return;
+    }
+
+    let frame = unsafe { frame_from_raw(&*frame) };
+    let context = unsafe { &*(context as *mut WebViewContext) };
 
     if let MixWebviewHnadler::WindowlessRenderWebViewHandler(handler) = &context.handler {
         handler.on_frame(&frame);
     }
 }
 
+extern "C" fn on_consumer_frame_callback(frame: *const sys::Frame, context: *mut c_void) {
+    if context.is_null() || frame.is_null() {
+        return;
+    }
+
+    let callback = unsafe { &*(context as *const FrameConsumerCallback) };
+    callback(&unsafe { frame_from_raw(&*frame) });
+}
+
+extern "C" fn on_packet_callback(packet: *const sys::EncodedPacket, context: *mut c_void) {
+    if context.is_null() || packet.is_null() {
+        return;
+    }
+
+    let raw_packet = unsafe { &*packet };
+    let callback = unsafe { &*(context as *const EncodedPacketCallback) };
+    callback(&EncodedPacket {
+        data: unsafe { raw_slice(raw_packet.data, raw_packet.size) },
+        pts: raw_packet.pts,
+        keyframe: raw_packet.keyframe,
+    });
+}
+
+extern "C" fn on_ring_ready_callback(context: *mut c_void) {
+    if context.is_null() {
+        return;
+    }
+
+    let callback = unsafe { &*(context as *const RingReadyCallback) };
+    callback();
+}
+
 extern "C" fn on_title_change_callback(title: *const c_char, context: *mut c_void) {
     if context.is_null() || title.is_null() {
         return;
@@ -1021,6 +1724,36 @@ extern "C" fn on_message_callback(message: *const c_char, context: *mut c_void)
     }
 }
 
+extern "C" fn on_cursor_image_callback(image: *const sys::CursorImage, context: *mut c_void) {
+    if context.is_null() || image.is_null() {
+        return;
+    }
+
+    let raw_image = unsafe { &*image };
+    let image = CursorImage {
+        buffer: unsafe {
+            raw_slice(
+                raw_image.buffer as *const u8,
+                raw_image.width as usize * raw_image.height as usize * 4,
+            )
+        },
+        width: raw_image.width,
+        height: raw_image.height,
+        hotspot_x: raw_image.hotspot_x,
+        hotspot_y: raw_image.hotspot_y,
+        scale: raw_image.scale,
+        hash: raw_image.hash,
+    };
+
+    let context = unsafe { &*(context as *mut WebViewContext) };
+    match &context.handler {
+        MixWebviewHnadler::WebViewHandler(handler) => handler.on_cursor_image(&image),
+        MixWebviewHnadler::WindowlessRenderWebViewHandler(handler) => {
+            handler.on_cursor_image(&image)
+        }
+    }
+}
+
 extern "C" fn on_cursor_callback(ty: sys::CursorType, context: *mut c_void) {
     if context.is_null() {
         return;